@@ -0,0 +1,150 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_CORE_IO_REACTOR_H
+#define HRI_PHYSIO_CORE_IO_REACTOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include <HriPhysio/Stream/streamerInterface.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Core {
+        class IoReactor;
+    }
+}
+
+class hriPhysio::Core::IoReactor {
+
+public:
+    //-- Called with the epoll events that made a descriptor ready.
+    using Handler    = std::function<void(uint32_t)>;
+    using Task       = std::function<void(void)>;
+    using Dispatcher = std::function<void(Task)>;
+
+private:
+    struct Source {
+        Handler  handler;
+        uint32_t events;
+        bool     dispatch;
+        bool     owned;
+    };
+
+    //-- A streamer and the descriptor it is watched through, which a reconnect changes.
+    struct Watched {
+        hriPhysio::Stream::StreamerInterface* streamer;
+        Task callback;
+        bool dispatch;
+        int  fd;
+    };
+
+    int epoll_fd;
+    int wake_fd;
+
+    std::atomic< bool > running;
+
+    //-- Registered descriptors. Handlers are shared so removing one mid-call is safe.
+    std::unordered_map< int, std::shared_ptr<Source> > sources;
+    std::mutex sources_lock;
+
+    //-- Work handed over from other threads with post().
+    std::vector< Task > posted;
+    std::mutex posted_lock;
+
+    Dispatcher dispatcher;
+
+    std::vector< struct epoll_event > events;
+
+public:
+    IoReactor();
+
+    ~IoReactor();
+
+    /* ===========================================================================
+    **  Watch a descriptor. Level triggered, so a handler that does not drain
+    **  its descriptor is called again on the next pass.
+    **
+    ** @param fd       Descriptor to watch, the caller keeps ownership.
+    ** @param handler  Called on the reactor thread, or the dispatcher.
+    ** @param events   epoll events of interest.
+    ** @param dispatch If true and a dispatcher is set, hand the handler to it.
+    **                 The descriptor is re-armed once the handler returns.
+    **
+    ** @return False if the descriptor could not be added.
+    ** =========================================================================== */
+    bool addDescriptor(const int fd, Handler handler, const uint32_t events = EPOLLIN, const bool dispatch = false);
+
+    bool removeDescriptor(const int fd);
+
+    /* ===========================================================================
+    **  Call ``callback`` whenever the streamer has data to read. It should
+    **  receive once, and is called again while whole frames are left buffered
+    **  (see StreamerInterface::hasBuffered). The streamer's timeout is set to
+    **  0 so a receive never blocks the other sources; a UDP gap is skipped once
+    **  the socket is drained instead of after a wait.
+    **
+    **  A new descriptor after a reconnect is followed. While the streamer has
+    **  none the callback is polled, so its receive can reconnect. Streamers
+    **  without a descriptor to begin with are refused.
+    ** =========================================================================== */
+    bool addStreamer(hriPhysio::Stream::StreamerInterface* streamer, Task callback, const bool dispatch = false);
+
+    //-- Periodic (or one shot) callback driven by a timerfd. Returns its descriptor, or -1.
+    int addTimer(const double period, Task callback, const bool repeat = true);
+
+    //-- Run a task on the reactor thread. Safe to call from any thread.
+    void post(Task task);
+
+    //-- Hand dispatched handlers to a pool instead of running them inline.
+    void setDispatcher(Dispatcher dispatcher);
+
+    std::size_t getNumSources();
+
+    //-- Wait up to ``seconds`` (negative blocks) and run everything that is ready.
+    std::size_t runOnce(const double seconds);
+
+    //-- Run until stop() is called.
+    void run();
+
+    //-- Safe to call from any thread, including handlers.
+    void stop();
+
+private:
+    void wake();
+
+    void drainPosted();
+
+    void rearm(const int fd, const uint32_t events);
+
+    void serviceStreamer(const std::shared_ptr<Watched>& watched);
+
+    //-- Move the watch to the streamer's current descriptor, or poll until it has one.
+    void followStreamer(const std::shared_ptr<Watched>& watched);
+
+
+public:
+    //-- Disallow copy and assignment operators.
+    IoReactor(const IoReactor&) = delete;
+    IoReactor &operator=(const IoReactor&) = delete;
+};
+
+#endif /* HRI_PHYSIO_CORE_IO_REACTOR_H */
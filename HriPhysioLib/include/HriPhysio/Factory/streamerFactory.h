@@ -16,7 +16,13 @@
 #include <string>
 
 #include <HriPhysio/Stream/streamerInterface.h>
+#include <HriPhysio/Stream/csvStreamer.h>
 #include <HriPhysio/Stream/lslStreamer.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
+#include <HriPhysio/Stream/replayStreamer.h>
+#include <HriPhysio/Stream/shmStreamer.h>
+#include <HriPhysio/Stream/tcpStreamer.h>
+#include <HriPhysio/Stream/udpStreamer.h>
 
 #ifdef WITH_ROS
 #include <HriPhysio/Stream/ros/rosStreamer.h>
@@ -0,0 +1,147 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_MANAGER_BATCH_PROCESSOR_H
+#define HRI_PHYSIO_MANAGER_BATCH_PROCESSOR_H
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include <HriPhysio/Processing/heartRateVariability.h>
+#include <HriPhysio/Processing/rrArtifactCorrector.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Manager {
+        class BatchProcessor;
+    }
+}
+
+/* ============================================================================
+**  Offline processing of recorded sessions (``.hrec`` or ``.csv``), e.g.
+**
+**    pipeline:
+**      - { stage: bandpass, frequency: 10.0, width: 10.0 }
+**      - { stage: rpeaks }
+**      - { stage: artifacts, method: malik }
+**      - { stage: hrv, window: 60.0, step: 30.0, features: [time, nonlinear, frequency] }
+**      - { stage: aggregate, stats: [mean, std, min, max] }
+**
+**  Filters run in order on one channel, R peaks are detected on the result
+**  (``inverted: true`` for a lead whose R wave points down), optionally cleaned of ectopic beats and outliers (see RRArtifactCorrector),
+**  and HRV features are computed over sliding windows. Feature groups are
+**  ``time`` (the default), ``nonlinear`` and ``frequency``. Each session gets a
+**  ``<session file>.features.csv`` feature table, and ``summary.csv`` gets one
+**  row per session with its overall features and the aggregates of its
+**  windows. The output directory must not be one the sessions are in.
+**
+**  Sessions are read a frame at a time, so memory does not grow with their
+**  length, and are shared out over a pool of threads.
+** ============================================================================ */
+class hriPhysio::Manager::BatchProcessor {
+
+public:
+    //-- Everything kept of one session.
+    struct Session {
+        std::string path;
+        bool        ok        = false;
+        double      start     = 0.0;
+        double      end       = 0.0;
+        std::size_t beats     = 0;
+        std::size_t corrected = 0;
+
+        //-- Features of the whole session, in column order.
+        std::vector<double> overall;
+
+        //-- Aggregate ``stat`` of ``feature`` over the windows, in configured order.
+        std::vector<double> aggregates;
+    };
+
+private:
+    struct FilterStage {
+        std::string type;
+        double      frequency;
+        double      width;
+    };
+
+    std::string dtype;
+    std::size_t num_channels;
+    std::size_t channel;
+    uint32_t    stream_id;
+    double      sampling_rate;
+    std::size_t read_frame;
+    std::size_t num_threads;
+
+    std::vector<FilterStage> filters;
+    bool        inverted_lead;
+
+    bool        correct_rr;
+    hriPhysio::Processing::RRArtifactCorrector::Method rr_method;
+    double      rr_low;
+    double      rr_high;
+    std::size_t rr_max_gap;
+
+    double window;
+    double step;
+    std::vector<std::string> groups;
+    std::vector<std::string> feature_names;
+    std::vector<std::string> stats;
+
+    std::mutex log_mutex;
+
+public:
+    BatchProcessor();
+
+    ~BatchProcessor();
+
+    //-- Load the pipeline. False if a stage is unknown or out of order.
+    bool configure(const std::string yaml_file);
+
+    //-- Zero uses every hardware thread.
+    void setNumThreads(const std::size_t threads);
+
+    //-- Every ``.hrec`` and ``.csv`` file in ``directory``, sorted by name,
+    //-- leaving out the tables and summary of an earlier run.
+    static std::vector<std::string> findSessions(const std::string& directory);
+
+    /* ===========================================================================
+    **  Process every session and write the feature tables.
+    **
+    ** @param sessions   Paths of the recorded sessions.
+    ** @param output_dir Directory the tables are written to, created if missing.
+    **                   Nothing is processed if it holds any of the sessions.
+    **
+    ** @return One entry per session, in the order given.
+    ** =========================================================================== */
+    std::vector<Session> run(const std::vector<std::string>& sessions, const std::string& output_dir);
+
+private:
+    bool process(Session& session, const std::string& output_dir);
+
+    //-- One value per feature column.
+    void features(const std::vector<double>& intervals, std::vector<double>& row) const;
+
+    void writeSummary(const std::vector<Session>& sessions, const std::string& output_dir) const;
+
+
+public:
+    //-- Disallow copy and assignment operators.
+    BatchProcessor(const BatchProcessor&) = delete;
+    BatchProcessor &operator=(const BatchProcessor&) = delete;
+};
+
+#endif /* HRI_PHYSIO_MANAGER_BATCH_PROCESSOR_H */
@@ -25,6 +25,8 @@
 #include <HriPhysio/Manager/threadManager.h>
 #include <HriPhysio/Stream/streamerInterface.h>
 #include <HriPhysio/Stream/csvStreamer.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
+#include <HriPhysio/Stream/replayStreamer.h>
 
 #include <HriPhysio/Core/ringBuffer.h>
 #include <HriPhysio/helpers.h>
@@ -45,13 +47,20 @@ private:
     std::size_t output_frame;
     std::size_t sample_overlap;
     std::size_t buffer_length;
+    double      timeout;
+    double      replay_speed;
+    bool        replay_loop;
+    std::string quantize_dtype;
+    double      quantize_scale;
+    double      quantize_offset;
     
     bool        log_data;
     std::string log_name;
+    std::string log_format;
 
     hriPhysio::Stream::StreamerInterface* stream_input;
     hriPhysio::Stream::StreamerInterface* stream_output;
-    hriPhysio::Stream::CsvStreamer stream_logger;
+    std::unique_ptr<hriPhysio::Stream::StreamerInterface> stream_logger;
 
     hriPhysio::Core::RingBuffer<hriPhysio::varType> buffer;
     hriPhysio::Core::RingBuffer<double> timestamps;
@@ -27,6 +27,7 @@
 #include <HriPhysio/Social/robotInterface.h>
 #include <HriPhysio/Stream/streamerInterface.h>
 #include <HriPhysio/Stream/csvStreamer.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
 
 #include <HriPhysio/helpers.h>
 
@@ -41,8 +42,9 @@ private:
     
     bool        log_data;
     std::string log_name;
+    std::string log_format;
 
-    hriPhysio::Stream::CsvStreamer robot_logger;
+    std::unique_ptr<hriPhysio::Stream::StreamerInterface> robot_logger;
     hriPhysio::Social::RobotInterface* robot;
 
     std::chrono::_V2::system_clock::time_point start_time;
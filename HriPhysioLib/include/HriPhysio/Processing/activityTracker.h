@@ -0,0 +1,164 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_ACTIVITY_TRACKER_H
+#define HRI_PHYSIO_PROCESSING_ACTIVITY_TRACKER_H
+
+#include <vector>
+
+#include <HriPhysio/Processing/butterworthBandPass.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class ActivityTracker;
+
+        /* ============================================================================
+        **  Movement over one epoch.
+        ** ============================================================================ */
+        struct ActivityEpoch {
+            double time       = 0.0; //-- s, end of the epoch
+            double intensity  = 0.0; //-- g, mean of max(|a| - 1 g, 0) (ENMO)
+            double counts     = 0.0; //-- g s, integral of the band passed |a|
+            std::size_t steps = 0;   //-- steps detected in the epoch
+            double cadence    = 0.0; //-- steps per minute, 0 when not stepping
+            double regularity = 0.0; //-- normalised autocorrelation at the step period
+        };
+
+
+        /* ============================================================================
+        **  Euclidean norm of interleaved three axis frames.
+        **
+        ** @param source      Interleaved x, y, z samples.
+        ** @param target      One magnitude per frame.
+        ** @param numFrames   The number of frames in the input array.
+        ** ============================================================================ */
+        void vectorMagnitude(const double* source, double* target, const std::size_t numFrames);
+    }
+}
+
+/* ============================================================================
+**  Physical activity from a three axis accelerometer, reported once per
+**  epoch (a second by default).
+**
+**  Each frame costs its magnitude, one biquad band pass over the walking
+**  band and a handful of comparisons. Intensity is the ENMO of the epoch,
+**  activity counts the integral of the rectified band passed magnitude.
+**  Steps are peaks of the band passed magnitude over an adaptive threshold,
+**  a fraction of its running RMS, at least ``minStep`` and a refractory
+**  period apart.
+**
+**  For the cadence the band passed magnitude is also averaged down to about
+**  25 Hz. At the end of each epoch the last few seconds of it are
+**  autocorrelated at step periods only, and the first strong peak gives the
+**  cadence, so the per frame cost does not depend on the window. Cadence is
+**  0 while the movement is too weak or irregular to be walking.
+** ============================================================================ */
+class hriPhysio::Processing::ActivityTracker {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    unsigned int sampling_rate;
+    double       epoch;
+    double       gravity;
+    double       min_step;
+
+
+    /* ============================================================================
+    **  Per frame state.
+    ** ============================================================================ */
+    ButterworthBandPass band;
+    double power;           //-- Running mean square of the band passed magnitude.
+    double before;          //-- The two previous band passed values.
+    double last;
+    double last_stamp;
+    double last_step;
+
+
+    /* ============================================================================
+    **  Accumulators of the current epoch.
+    ** ============================================================================ */
+    double      epoch_start;
+    std::size_t epoch_frames;
+    double      epoch_enmo;
+    double      epoch_counts;
+    std::size_t epoch_steps;
+
+
+    /* ============================================================================
+    **  The band passed magnitude, averaged down for the cadence.
+    ** ============================================================================ */
+    std::size_t         factor;     //-- Frames per decimated sample.
+    std::size_t         bin_count;
+    double              bin_sum;
+    std::vector<double> decimated;  //-- Ring of the cadence window.
+    std::size_t         position;
+    std::size_t         num_decimated;
+
+
+
+    /* ============================================================================
+    **  Scratch space.
+    ** ============================================================================ */
+    std::vector<double> magnitude;
+    std::vector<double> filtered;
+    std::vector<double> ordered;
+    std::vector<double> correlation;
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param rate      Sampling-rate of the provided signal.
+    ** @param epoch     Seconds per reported epoch.
+    ** @param gravity   1 g in the units of the stream, e.g. 1000 for mG.
+    ** @param minStep   Smallest step peak, in g.
+    ** @param window    Seconds of signal the cadence is estimated over.
+    ** ============================================================================ */
+    ActivityTracker(const unsigned int rate, const double epoch=1.0, const double gravity=1.0,
+                    const double minStep=0.05, const double window=4.0);
+
+
+    /* ============================================================================
+    **  Forget every sample seen, to start on a new signal.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Feed the next block of frames.
+    **
+    ** @param source      Interleaved x, y, z samples.
+    ** @param stamps      Array of the frame timestamps in seconds.
+    ** @param numFrames   The number of frames in the input arrays.
+    ** @param epochs      Epochs completed are appended here.
+    ** ============================================================================ */
+    void process(const double* source, const double* stamps, const std::size_t numFrames,
+                 std::vector<ActivityEpoch>& epochs);
+
+
+    unsigned int getSamplingRate() const;
+
+private:
+    //-- Close the epoch ending at ``end``.
+    void close(const double end, std::vector<ActivityEpoch>& epochs);
+
+    //-- Steps per minute from the decimated window, and its regularity.
+    double cadence(double& regularity);
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_ACTIVITY_TRACKER_H */
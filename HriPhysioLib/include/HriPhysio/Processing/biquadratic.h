@@ -40,6 +40,12 @@ protected:
     ** ============================================================================ */ 
     double a0, a1, a2, b1, b2;
 
+
+    /* ============================================================================
+    **  Last two inputs and outputs, carried between calls to filterContinuous.
+    ** ============================================================================ */
+    double x1, x2, y1, y2;
+
 public:
 
     /* ============================================================================
@@ -63,6 +69,25 @@ public:
     void filter(const double* source, double* target, const std::size_t numSamples, const double freq);
 
 
+    /* ============================================================================
+    **  Filter the next block of a signal that arrives in pieces. Unlike filter,
+    **  the filter state carries over from the previous call, so a signal filtered
+    **  block by block matches the signal filtered in one go.
+    **
+    ** @param source      Array of data to be filtered.
+    ** @param target      Array of where the filtered data should go.
+    ** @param numSamples  The number of samples in the input array.
+    ** @param  freq       The center frequency to filter at.
+    ** ============================================================================ */
+    void filterContinuous(const double* source, double* target, const std::size_t numSamples, const double freq);
+
+
+    /* ============================================================================
+    **  Clear the state kept by filterContinuous, to start on a new signal.
+    ** ============================================================================ */
+    void reset();
+
+
     /* ============================================================================
     **  Pure virtual function to be implemented by inheriter to set the following
     **  variables which get used in the bilinear transformation: a0, a1, a2, b1, b2.
@@ -0,0 +1,114 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_BURG_SPECTRUM_H
+#define HRI_PHYSIO_PROCESSING_BURG_SPECTRUM_H
+
+#include <vector>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class BurgSpectrum;
+    }
+}
+
+/* ============================================================================
+**  Autoregressive power spectrum, fitted with Burg's method.
+**
+**  The recursion follows Andersen (1978): forward and backward prediction
+**  errors are updated in place and the denominator of each reflection
+**  coefficient is carried from one order to the next, so a fit to order p
+**  costs about 3 N p multiply-adds. Every order up to the maximum is
+**  fitted, and the one with the smallest AIC, N ln(E) + 2 p, is kept.
+**
+**  The spectrum of the fitted model is closed form,
+**      P(f) = 2 E / fs / |1 + sum a_k exp(-i 2 pi f k / fs)|^2,
+**  one sided, in units of the signal squared per Hz. The denominator is
+**  kept as the cosine series c_0 + 2 sum c_k cos(k w) of the autocorrelation
+**  of the coefficients, so each frequency costs one cosine and p
+**  multiply-adds (Clenshaw's recurrence).
+** ============================================================================ */
+class hriPhysio::Processing::BurgSpectrum {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    std::size_t max_order;
+
+
+    /* ============================================================================
+    **  The selected model, and the scratch space of the recursion.
+    ** ============================================================================ */
+    std::vector<double> coefficients;   //-- a_1 .. a_p.
+    std::vector<double> correlation;    //-- Autocorrelation of 1, a_1 .. a_p.
+    double              variance;       //-- Prediction error power E.
+
+    std::vector<double> forward;
+    std::vector<double> backward;
+    std::vector<double> current;
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param maxOrder   Highest model order tried.
+    ** ============================================================================ */
+    BurgSpectrum(const std::size_t maxOrder=16);
+
+
+    /* ============================================================================
+    **  Fit a model to a signal, after removing its mean.
+    **
+    ** @param source      Evenly sampled signal.
+    ** @param numSamples  The number of samples in the input array.
+    **
+    ** @return False if the signal is too short or flat to fit.
+    ** ============================================================================ */
+    bool fit(const double* source, const std::size_t numSamples);
+
+
+    /* ============================================================================
+    **  Power spectral density of the model at ``freq``.
+    **
+    ** @param freq   Frequency in Hz.
+    ** @param rate   Sampling rate of the fitted signal in Hz.
+    ** ============================================================================ */
+    double density(const double freq, const double rate) const;
+
+
+    /* ============================================================================
+    **  Power between ``low`` and ``high`` Hz, integrated with the trapezoid
+    **  rule on a grid of ``resolution`` Hz. A line narrower than the grid,
+    **  as fitted to a noiseless sinusoid, can fall between its points.
+    ** ============================================================================ */
+    double bandPower(const double low, const double high, const double rate, const double resolution=0.001) const;
+
+
+    std::size_t getOrder() const;
+
+
+    const std::vector<double>& getCoefficients() const;
+
+
+    double getVariance() const;
+
+private:
+    //-- |1 + sum a_k exp(-i w k)|^2, given cos(w).
+    double response(const double cosine) const;
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_BURG_SPECTRUM_H */
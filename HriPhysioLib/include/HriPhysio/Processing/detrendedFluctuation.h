@@ -0,0 +1,117 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_DETRENDED_FLUCTUATION_H
+#define HRI_PHYSIO_PROCESSING_DETRENDED_FLUCTUATION_H
+
+#include <vector>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class DetrendedFluctuation;
+    }
+}
+
+/* ============================================================================
+**  Detrended fluctuation analysis (Peng et al., 1995) over the last
+**  ``capacity`` values of a series, e.g. RR intervals.
+**
+**  The series is integrated into a profile and, for each scale n, cut into
+**  boxes of n values from the start of the window. F(n) is the root mean
+**  square of the residuals of a least squares line fit in every box, and
+**  alpha is the slope of log F(n) against log n. By convention alpha1 uses
+**  scales 4 to 16 beats and alpha2 16 to 64.
+**
+**  Prefix sums of the profile, of the profile times its index and of its
+**  square give every box fit in closed form, so F(n) costs one step per
+**  box rather than per value. A line fit ignores any linear trend, so the
+**  profile does not need the mean of the window: values are integrated as
+**  they arrive, around the mean at the last rebuild. The prefix sums are
+**  rebuilt around the mean of the window once the buffer holds twice the
+**  capacity or, without one, each time the series doubles, so they stay
+**  small enough for the differences of them to keep their precision.
+** ============================================================================ */
+class hriPhysio::Processing::DetrendedFluctuation {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    std::size_t capacity;
+    std::size_t num_threads;
+
+
+    /* ============================================================================
+    **  Values buffered, and prefix sums of their profile. Entry ``i`` of a
+    **  prefix sum covers the first ``i`` values of the buffer.
+    ** ============================================================================ */
+    std::vector<double> values;
+    std::vector<double> sum;
+    std::vector<double> weighted;
+    std::vector<double> squares;
+
+    double      reference;    //-- Subtracted before integrating.
+    double      profile;      //-- The last value of the profile.
+    std::size_t rebuild_at;   //-- Buffer size the prefix sums are rebuilt at.
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param capacity   Values in the window, 0 for all of them.
+    ** @param threads    Threads to share the scales between, 0 for one per
+    **                   hardware thread.
+    ** ============================================================================ */
+    DetrendedFluctuation(const std::size_t capacity=0, const std::size_t threads=1);
+
+
+    /* ============================================================================
+    **  Forget every value.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Append values, the oldest falling out of the window past the capacity.
+    ** ============================================================================ */
+    void push(const double* source, const std::size_t numValues);
+
+
+    /* ============================================================================
+    **  F(n) of the window, NaN if it does not hold two boxes of ``scale``.
+    ** ============================================================================ */
+    double fluctuation(const std::size_t scale) const;
+
+
+    /* ============================================================================
+    **  Scaling exponent over the scales from ``minScale`` to ``maxScale``,
+    **  inclusive. Scales without two boxes in the window are left out, and
+    **  NaN is returned if fewer than two remain.
+    ** ============================================================================ */
+    double alpha(const std::size_t minScale, const std::size_t maxScale) const;
+
+
+    void setNumThreads(const std::size_t threads);
+
+
+    //-- Values in the window.
+    std::size_t size() const;
+
+private:
+    void rebuild();
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_DETRENDED_FLUCTUATION_H */
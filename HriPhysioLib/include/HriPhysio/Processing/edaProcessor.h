@@ -0,0 +1,152 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_EDA_PROCESSOR_H
+#define HRI_PHYSIO_PROCESSING_EDA_PROCESSOR_H
+
+#include <vector>
+
+#include <HriPhysio/Processing/butterworthLowPass.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class EdaProcessor;
+
+        /* ============================================================================
+        **  One skin conductance response, as in neurokit2's eda_peaks.
+        ** ============================================================================ */
+        struct SkinConductanceResponse {
+            std::size_t channel = 0;
+            double onset     = 0.0; //-- s
+            double peak      = 0.0; //-- s
+            double amplitude = 0.0; //-- uS, rise of the smoothed signal from onset to peak
+            double rise_time = 0.0; //-- s
+        };
+    }
+}
+
+/* ============================================================================
+**  Streaming electrodermal activity processing, one independent channel per
+**  participant in an interleaved frame.
+**
+**  Each channel is smoothed with a low pass filter and split, after
+**  neurokit2's ``median`` method, into a tonic level, the median of the last
+**  few seconds, and the phasic remainder. neurokit centres the window, which
+**  would delay every sample by half of it and let the tonic level climb with
+**  a response from its onset; the trailing window keeps the stage causal, and
+**  the tonic level only follows a response once it has lasted half the
+**  window, after its rise. The window is kept sorted, so a sample costs one
+**  insertion and one removal.
+**
+**  SCRs are found on the positive part of the phasic signal with
+**  hysteresis: the onset is the last trough before a rise of half
+**  ``minAmplitude``, and the peak the crest before a fall of as much, so a
+**  response is reported that long after its peak. The amplitude is measured
+**  trough to peak on the smoothed signal, and responses smaller than
+**  ``minAmplitude`` are dropped.
+** ============================================================================ */
+class hriPhysio::Processing::EdaProcessor {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    unsigned int sampling_rate;
+    std::size_t  num_channels;
+    double       min_amplitude;
+    double       cutoff;
+
+
+    /* ============================================================================
+    **  State of one participant.
+    ** ============================================================================ */
+    struct Channel {
+        ButterworthLowPass  smoother;
+        double              baseline;   //-- First sample, the filter starts from it.
+        std::vector<double> recent;     //-- Ring of the last window of samples.
+        std::vector<double> sorted;     //-- The same samples, in order.
+
+        bool   rising;
+        double previous;                //-- Last phasic value.
+        double extreme;                 //-- Crest of the phasic rise.
+        double extreme_time;
+        double peak_level;              //-- Smoothed signal at the crest.
+        double onset;                   //-- Last phasic trough.
+        double onset_time;
+        double onset_level;             //-- Smoothed signal at the trough.
+
+        Channel(const unsigned int rate);
+    };
+
+    std::vector<Channel> channels;
+
+
+    /* ============================================================================
+    **  Window shared by the channels.
+    ** ============================================================================ */
+    std::size_t length;                 //-- Samples in the tonic window.
+    std::size_t position;               //-- Next slot of the rings.
+    std::size_t num_seen;
+
+    std::vector<double> scratch;        //-- One channel of a block.
+    std::vector<double> smoothed;       //-- The whole block, interleaved.
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param rate          Sampling-rate of the provided signal.
+    ** @param numChannels   Channels per frame, one per participant.
+    ** @param window        Seconds of the tonic median window, neurokit uses 4.
+    ** @param minAmplitude  Smallest SCR reported, in the units of the signal.
+    ** @param cutoff        Low pass smoothing in Hz, 0 for none.
+    ** ============================================================================ */
+    EdaProcessor(const unsigned int rate, const std::size_t numChannels=1, const double window=4.0,
+                 const double minAmplitude=0.01, const double cutoff=3.0);
+
+
+    /* ============================================================================
+    **  Forget every sample seen, to start on new signals.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Feed the next block of frames.
+    **
+    ** @param source      Interleaved samples, ``numChannels`` per frame.
+    ** @param stamps      Array of the frame timestamps in seconds.
+    ** @param numFrames   The number of frames in the input arrays.
+    ** @param tonic       Tonic levels are appended here, interleaved.
+    ** @param phasic      And phasic components, interleaved.
+    ** @param responses   SCRs confirmed are appended here.
+    ** ============================================================================ */
+    void process(const double* source, const double* stamps, const std::size_t numFrames,
+                 std::vector<double>& tonic, std::vector<double>& phasic,
+                 std::vector<SkinConductanceResponse>& responses);
+
+
+    std::size_t getNumChannels() const;
+
+
+    unsigned int getSamplingRate() const;
+
+private:
+    void detect(Channel& channel, const std::size_t index, const double phasic, const double level,
+                const double stamp, std::vector<SkinConductanceResponse>& responses);
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_EDA_PROCESSOR_H */
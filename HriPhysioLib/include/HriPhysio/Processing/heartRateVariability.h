@@ -0,0 +1,117 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_HEART_RATE_VARIABILITY_H
+#define HRI_PHYSIO_PROCESSING_HEART_RATE_VARIABILITY_H
+
+#include <cmath>
+#include <vector>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+
+        /* ============================================================================
+        **  Time domain HRV features, as in hrv-analysis' get_time_domain_features.
+        ** ============================================================================ */
+        struct HrvTimeDomain {
+            std::size_t num_intervals = 0;
+            double mean_rr = 0.0; //-- ms
+            double sdnn    = 0.0; //-- ms, sample standard deviation
+            double rmssd   = 0.0; //-- ms
+            double pnn50   = 0.0; //-- % of successive differences over 50 ms
+            double mean_hr = 0.0; //-- beats per minute
+        };
+
+
+        /* ============================================================================
+        **  Nonlinear HRV features, as in neurokit2's hrv_nonlinear.
+        ** ============================================================================ */
+        struct HrvNonlinear {
+            std::size_t num_intervals = 0;
+            double sd1        = 0.0; //-- ms, Poincare plot width
+            double sd2        = 0.0; //-- ms, Poincare plot length
+            double sd1_sd2    = 0.0;
+            double sampen     = 0.0; //-- sample entropy, m = 2, r = 0.2 SDNN
+            double apen       = 0.0; //-- approximate entropy, same m and r
+            double dfa_alpha1 = 0.0; //-- DFA exponent over 4 to 16 beats
+            double dfa_alpha2 = 0.0; //-- DFA exponent over 16 to 64 beats
+        };
+
+
+        /* ============================================================================
+        **  Frequency domain HRV features, from an autoregressive spectrum.
+        ** ============================================================================ */
+        struct HrvFrequency {
+            std::size_t num_intervals = 0;
+            std::size_t order = 0;   //-- AR model order selected
+            double vlf   = 0.0;      //-- ms^2, 0.0033 to 0.04 Hz
+            double lf    = 0.0;      //-- ms^2, 0.04 to 0.15 Hz
+            double hf    = 0.0;      //-- ms^2, 0.15 to 0.4 Hz
+            double total = 0.0;      //-- ms^2, vlf + lf + hf
+            double lf_hf = 0.0;
+            double lf_nu = 0.0;      //-- % of lf + hf
+            double hf_nu = 0.0;      //-- % of lf + hf
+        };
+
+
+        /* ============================================================================
+        **  RR intervals between successive R peaks.
+        **
+        ** @param peaks   R peak times in seconds, in order.
+        **
+        ** @return One interval in milliseconds per pair of peaks.
+        ** ============================================================================ */
+        std::vector<double> rrIntervals(const std::vector<double>& peaks);
+
+
+        /* ============================================================================
+        **  Time domain features of a series of RR intervals.
+        **
+        ** @param rr      RR intervals in milliseconds.
+        **
+        ** @return Zeroed features if there are fewer than two intervals.
+        ** ============================================================================ */
+        HrvTimeDomain hrvTimeDomain(const std::vector<double>& rr);
+
+
+        /* ============================================================================
+        **  Poincare, entropy and DFA features of a series of RR intervals. An
+        **  exponent is NaN when the series is too short for two of its scales.
+        **
+        ** @param rr         RR intervals in milliseconds.
+        ** @param dimension  Template length of the entropies.
+        **
+        ** @return Zeroed features if there are fewer than three intervals.
+        ** ============================================================================ */
+        HrvNonlinear hrvNonlinear(const std::vector<double>& rr, const std::size_t dimension=2);
+
+
+        /* ============================================================================
+        **  Band powers of a series of RR intervals. The tachogram is resampled
+        **  evenly by linear interpolation and fitted with Burg's method, the
+        **  order chosen by AIC, so short windows of a minute or two still give
+        **  a smooth spectrum.
+        **
+        ** @param rr         RR intervals in milliseconds.
+        ** @param rate       Resampling rate of the tachogram in Hz.
+        ** @param maxOrder   Highest AR model order tried.
+        **
+        ** @return Zeroed features if the series is too short or flat to fit.
+        ** ============================================================================ */
+        HrvFrequency hrvFrequency(const std::vector<double>& rr, const double rate=4.0, const std::size_t maxOrder=16);
+
+    }
+}
+
+#endif /* HRI_PHYSIO_PROCESSING_HEART_RATE_VARIABILITY_H */
@@ -67,6 +67,13 @@ public:
     void process(const std::vector<double>& source, std::vector<double>& target);
 
 
+    /* ===========================================================================
+	**  Process ``numSamples`` from source into target, without copying
+	**  through vectors. Both must hold at least ``numSamples``.
+	** =========================================================================== */
+    void process(const double* source, double* target, const std::size_t numSamples);
+
+
     /* ===========================================================================
 	**  Resize.
 	** =========================================================================== */
@@ -0,0 +1,177 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_PULSE_DETECTOR_H
+#define HRI_PHYSIO_PROCESSING_PULSE_DETECTOR_H
+
+#include <vector>
+
+#include <HriPhysio/Processing/butterworthHighPass.h>
+#include <HriPhysio/Processing/butterworthLowPass.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class PulseDetector;
+
+        /* ============================================================================
+        **  One systolic peak of a PPG.
+        ** ============================================================================ */
+        struct PulseBeat {
+            double time      = 0.0;   //-- s, systolic peak
+            double interval  = 0.0;   //-- ms since the previous beat, 0 for the first
+            double amplitude = 0.0;   //-- the fused pulse at the peak
+            double agreement = 0.0;   //-- fraction of channels above their RMS at the peak
+            bool   good      = false; //-- the interval can be trusted
+        };
+    }
+}
+
+/* ============================================================================
+**  Streaming PPG pulse detection, after Elgendi et al. (2013), for a sensor
+**  with several LEDs watching the same pulse, e.g. the Polar OH1.
+**
+**  Each channel is band passed to 0.5-8 Hz by a high and a low pass biquad,
+**  and the channels of a frame are averaged into one pulse, two at a time
+**  with SSE2 along with their running mean squares. The positive part of the
+**  pulse is squared and averaged over a systolic peak (111 ms) and a beat
+**  (667 ms). Where the first is above the second plus a fraction of the mean
+**  square, the adaptive threshold, a block of interest opens; a block as long
+**  as a systolic peak holds one beat, at its highest sample. Both averages
+**  are centred on the same sample, so beats are found half a beat window
+**  after the fact.
+**
+**  A beat's interval is good if it is between 300 and 2000 ms, within 30%
+**  of the running interval, and at least half of the channels agree on the
+**  peak. After three plausible intervals in a row disagree with it, the
+**  running interval follows the new rhythm.
+** ============================================================================ */
+class hriPhysio::Processing::PulseDetector {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    unsigned int sampling_rate;
+    std::size_t  num_channels;
+    double       low_cutoff;
+    double       high_cutoff;
+
+
+    /* ============================================================================
+    **  Band pass of one channel.
+    ** ============================================================================ */
+    struct Channel {
+        ButterworthHighPass high;
+        ButterworthLowPass  low;
+        double              baseline;   //-- First sample, the filters start from it.
+
+        Channel(const unsigned int rate);
+    };
+
+    std::vector<Channel> channels;
+    std::vector<double>  power;         //-- Running mean square of each channel.
+
+
+    /* ============================================================================
+    **  The last beat window of the fused pulse, newest at ``position``.
+    ** ============================================================================ */
+    std::size_t peak_length;
+    std::size_t beat_length;
+    std::size_t position;
+    std::size_t num_seen;
+
+    std::vector<double> squared;        //-- Positive part of the pulse, squared.
+    std::vector<double> values;
+    std::vector<double> agreements;
+    std::vector<double> times;
+
+    double peak_sum;
+    double beat_sum;
+    double mean_square;
+
+
+    /* ============================================================================
+    **  Detection state.
+    ** ============================================================================ */
+    bool        in_block;
+    std::size_t block_length;
+    double      candidate;
+    double      candidate_time;
+    double      candidate_agreement;
+
+    double      last_beat;
+    double      expected;               //-- Running interval in ms, 0 until known.
+    std::size_t rejects;
+
+    std::vector<double> scratch;        //-- One channel of a block.
+    std::vector<double> filtered;       //-- The whole block, interleaved.
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param rate          Sampling-rate of the provided signal.
+    ** @param numChannels   Channels per frame, all watching the same pulse.
+    ** @param lowCutoff     High pass cutoff in Hz.
+    ** @param highCutoff    Low pass cutoff in Hz.
+    ** ============================================================================ */
+    PulseDetector(const unsigned int rate, const std::size_t numChannels=1,
+                  const double lowCutoff=0.5, const double highCutoff=8.0);
+
+
+    /* ============================================================================
+    **  Forget every sample and beat seen, to start on a new signal.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Feed the next block of frames. The pulse should rise at systole;
+    **  negate a signal that falls.
+    **
+    ** @param source      Interleaved samples, ``numChannels`` per frame.
+    ** @param stamps      Array of the frame timestamps in seconds.
+    ** @param numFrames   The number of frames in the input arrays.
+    ** @param pulse       The fused, band passed pulse is appended here.
+    ** @param beats       Beats found are appended here.
+    ** ============================================================================ */
+    void process(const double* source, const double* stamps, const std::size_t numFrames,
+                 std::vector<double>& pulse, std::vector<PulseBeat>& beats);
+
+
+    /* ============================================================================
+    **  Heart rate in beats per minute from the running interval, 0 until
+    **  there is one.
+    ** ============================================================================ */
+    double getHeartRate() const;
+
+
+    std::size_t getNumChannels() const;
+    unsigned int getSamplingRate() const;
+
+private:
+    //-- Mean of a frame's channels, updating their mean squares, and the
+    //-- fraction of channels above their RMS.
+    double combine(const double* frame, double& agreement);
+
+    //-- Close a block of interest, reporting its beat if it was long enough.
+    void close(std::vector<PulseBeat>& beats);
+
+    //-- The ring at ``lag`` samples before the newest.
+    std::size_t index(const std::size_t lag) const;
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_PULSE_DETECTOR_H */
@@ -0,0 +1,136 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_R_PEAK_DETECTOR_H
+#define HRI_PHYSIO_PROCESSING_R_PEAK_DETECTOR_H
+
+#include <cmath>
+#include <vector>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class RPeakDetector;
+    }
+}
+
+/* ============================================================================
+**  Streaming QRS detector after Pan and Tompkins (1985). The ECG should be
+**  band passed to roughly 5-15 Hz first. Each sample is differentiated,
+**  squared and integrated over 150 ms, and a QRS is declared while the
+**  integrated signal is above an adaptive threshold between the running
+**  signal and noise peak levels. The R peak is the largest ECG sample of
+**  the QRS, or the lowest for an inverted lead. The first two seconds only
+**  train the levels.
+**
+**  When no QRS follows for 1.66 times the running RR interval, the largest
+**  integrated peak since the last beat is searched back for, and taken as
+**  a beat if it is above half the threshold.
+** ============================================================================ */
+class hriPhysio::Processing::RPeakDetector {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    unsigned int sampling_rate;
+    double       polarity;              //-- -1 if the R wave points down.
+
+
+    /* ============================================================================
+    **  Moving window integration of the squared derivative.
+    ** ============================================================================ */
+    std::vector<double> window;
+    std::size_t window_pos;
+    double      window_sum;
+    double      previous;
+
+
+    /* ============================================================================
+    **  Recent ECG samples, where the R peak is found once a QRS starts.
+    ** ============================================================================ */
+    std::vector<double> history;
+    std::vector<double> history_stamps;
+    std::size_t history_pos;
+
+
+    /* ============================================================================
+    **  Detection state.
+    ** ============================================================================ */
+    std::size_t num_seen;
+    double signal_level;
+    double noise_level;
+    double noise_peak;
+    double last_peak;
+    double rr_average;                  //-- Running RR interval in s, 0 until known.
+
+    bool   in_qrs;
+    double qrs_peak;
+    double candidate;
+    double candidate_time;
+
+    double missed_level;                //-- Largest peak under the threshold since the last beat.
+    double missed;
+    double missed_time;
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param rate      Sampling-rate of the provided signal.
+    ** @param inverted  The lead's R wave points down. Detection does not
+    **                  depend on it, only where in the QRS the peak is put.
+    ** ============================================================================ */
+    RPeakDetector(const unsigned int rate, const bool inverted=false);
+
+
+    /* ============================================================================
+    **  Forget every level and sample seen, to start on a new signal.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Feed the next block of a filtered ECG.
+    **
+    ** @param source      Array of filtered ECG samples.
+    ** @param stamps      Array of their timestamps in seconds.
+    ** @param numSamples  The number of samples in the input array.
+    ** @param peaks       R peaks found are appended here, as timestamps.
+    ** ============================================================================ */
+    void process(const double* source, const double* stamps, const std::size_t numSamples, std::vector<double>& peaks);
+
+
+    /* ============================================================================
+    **  As above, also giving the filtered ECG at each R peak. The amplitude
+    **  swings with breathing, see RespirationTracker.
+    **
+    ** @param amplitudes  One amplitude per R peak is appended here.
+    ** ============================================================================ */
+    void process(const double* source, const double* stamps, const std::size_t numSamples,
+                 std::vector<double>& peaks, std::vector<double>& amplitudes);
+
+
+    unsigned int getSamplingRate() const;
+
+private:
+    //-- The most prominent ECG sample of the history outside the refractory period.
+    void searchHistory(double& value, double& time) const;
+
+    //-- Report a beat and update the RR interval.
+    void accept(const double time, const double value, std::vector<double>& peaks, std::vector<double>& amplitudes);
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_R_PEAK_DETECTOR_H */
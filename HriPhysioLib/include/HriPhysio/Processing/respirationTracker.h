@@ -0,0 +1,169 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_RESPIRATION_TRACKER_H
+#define HRI_PHYSIO_PROCESSING_RESPIRATION_TRACKER_H
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class RespirationTracker;
+
+        /* ============================================================================
+        **  Breathing rate over the last window, 0 where a source had too little
+        **  data or no periodicity in the breathing range.
+        ** ============================================================================ */
+        struct RespirationEstimate {
+            double time    = 0.0; //-- s, end of the window
+            double rate    = 0.0; //-- breaths per minute, all sources fused
+            double quality = 0.0; //-- normalised autocorrelation at the breathing period
+            double edr     = 0.0; //-- breaths per minute from R peak amplitudes
+            double rsa     = 0.0; //-- breaths per minute from RR intervals
+            double motion  = 0.0; //-- breaths per minute from the chest accelerometer
+        };
+    }
+}
+
+/* ============================================================================
+**  Breathing rate from a chest strap, fusing three views of the breath:
+**
+**    - ECG derived respiration, the swing of the R peak amplitude,
+**    - respiratory sinus arrhythmia, the swing of the RR intervals,
+**    - the slow motion of the chest on each accelerometer axis.
+**
+**  Each source is kept at a low, even rate: beats are interpolated onto the
+**  grid, and accelerometer samples are averaged into its bins as they
+**  arrive, so a sample costs an addition. Every ``update`` seconds the
+**  sources are detrended over the window and autocorrelated at the lags of
+**  the breathing range only. A source's weight is its highest normalised
+**  autocorrelation there, so the accelerometer axis that moves with the
+**  breath counts and the others barely do. The rate comes from the first
+**  strong peak of the weighted mean autocorrelation, refined by a parabola
+**  through its neighbours.
+** ============================================================================ */
+class hriPhysio::Processing::RespirationTracker {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    double      window;
+    double      rate;
+    double      update;
+    std::size_t num_axes;
+    double      min_bpm;
+    double      max_bpm;
+
+
+    /* ============================================================================
+    **  Beats as (time, value), and accelerometer bins per axis as they close.
+    ** ============================================================================ */
+    std::deque<std::pair<double, double>> amplitudes;
+    std::deque<std::pair<double, double>> intervals;
+    std::vector<std::deque<std::pair<double, double>>> axes;
+
+    double              last_beat;
+    double              bin_start;
+    std::size_t         bin_count;
+    std::vector<double> bin_sums;
+
+    double latest;          //-- Latest time seen from any source.
+    double last_update;
+
+
+    /* ============================================================================
+    **  Scratch space of an estimate.
+    ** ============================================================================ */
+    std::vector<double> grid;
+    std::vector<double> fused;
+    std::vector<double> correlation;
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param window    Seconds of signal in each estimate.
+    ** @param rate      Rate in Hz of the grid the sources are resampled on.
+    ** @param update    Seconds between estimates.
+    ** @param numAxes   Interleaved accelerometer channels.
+    ** @param minBpm    Slowest breathing looked for, in breaths per minute.
+    ** @param maxBpm    Fastest breathing looked for, in breaths per minute.
+    ** ============================================================================ */
+    RespirationTracker(const double window=32.0, const double rate=4.0, const double update=5.0,
+                       const std::size_t numAxes=3, const double minBpm=6.0, const double maxBpm=30.0);
+
+
+    /* ============================================================================
+    **  Forget every beat and sample.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Add R peaks, e.g. from RPeakDetector.
+    **
+    ** @param peaks       R peak times in seconds, in order.
+    ** @param amplitudes  The filtered ECG at each peak.
+    ** @param numPeaks    The number of peaks in the input arrays.
+    ** ============================================================================ */
+    void addBeats(const double* peaks, const double* amplitudes, const std::size_t numPeaks);
+
+
+    /* ============================================================================
+    **  Add chest accelerometer samples.
+    **
+    ** @param source      Interleaved samples, ``numAxes`` per frame.
+    ** @param stamps      Array of the frame timestamps in seconds.
+    ** @param numFrames   The number of frames in the input arrays.
+    ** ============================================================================ */
+    void addMotion(const double* source, const double* stamps, const std::size_t numFrames);
+
+
+    /* ============================================================================
+    **  Estimate the breathing rate over the window ending at ``now``, if
+    **  ``update`` seconds have passed since the last estimate.
+    **
+    ** @return True if ``estimate`` was filled in.
+    ** ============================================================================ */
+    bool estimate(const double now, RespirationEstimate& estimate);
+
+
+    std::size_t getNumAxes() const;
+
+private:
+    //-- Resample a source onto the grid, false if it does not cover the window.
+    bool resample(const std::deque<std::pair<double, double>>& source, const double start, const double end);
+
+    //-- Normalised autocorrelation of the detrended grid at the breathing lags.
+    void autocorrelate();
+
+    //-- Breaths per minute at the first strong peak, and its height. 0 if none.
+    double pick(const std::vector<double>& values, double& height) const;
+
+    //-- Resample, autocorrelate and add a source to the fused autocorrelation.
+    double accumulate(const std::deque<std::pair<double, double>>& source, const double start, const double end,
+                      double& weight);
+
+    void trim(std::deque<std::pair<double, double>>& source) const;
+
+    std::size_t minLag() const;
+    std::size_t maxLag() const;
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_RESPIRATION_TRACKER_H */
@@ -0,0 +1,139 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_RR_ARTIFACT_CORRECTOR_H
+#define HRI_PHYSIO_PROCESSING_RR_ARTIFACT_CORRECTOR_H
+
+#include <string>
+#include <vector>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class RRArtifactCorrector;
+    }
+}
+
+/* ============================================================================
+**  Streaming cleanup of RR intervals into NN intervals, as hrvanalysis does
+**  with remove_outliers, remove_ectopic_beats and interpolate_nan_values.
+**
+**  An interval is rejected when it is outside [low, high] ms, or when it is
+**  ectopic compared to the last accepted interval:
+**    Malik     differs by more than 20%.
+**    Kamath    grows by more than 32.5% or shrinks by more than 24.5%.
+**    Karlsson  differs by 20% or more from the mean of its neighbours,
+**              which holds each interval back until the next arrives. A
+**              next interval that is itself ectopic is not averaged in.
+**
+**  Rejected intervals are replaced by linear interpolation once the next
+**  accepted interval arrives. Past ``max_gap`` rejections in a row they
+**  are held at the last accepted value instead and the next interval in
+**  range is trusted, so nothing is held back for longer than that and a
+**  genuine change of rhythm is not rejected forever. Every interval in
+**  gives exactly one interval out.
+** ============================================================================ */
+class hriPhysio::Processing::RRArtifactCorrector {
+public:
+
+    enum class Method { Malik, Kamath, Karlsson };
+
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    Method      method;
+    double      low_rr;
+    double      high_rr;
+    std::size_t max_gap;
+
+
+    /* ============================================================================
+    **  Correction state.
+    ** ============================================================================ */
+    double      reference;      //-- Last accepted interval, 0 if none yet.
+    std::size_t gap;            //-- Rejected since then.
+    std::vector<double> held;   //-- Their values, for when there is no reference.
+
+    bool        has_pending;    //-- Karlsson's interval waiting for its neighbour.
+    double      pending;
+
+    std::size_t num_corrected;
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param method     Ectopic beat criterion.
+    ** @param low        Shortest plausible interval in ms.
+    ** @param high       Longest plausible interval in ms.
+    ** @param maxGap     Most rejected intervals in a row to interpolate over.
+    ** ============================================================================ */
+    RRArtifactCorrector(const Method method=Method::Malik, const double low=300.0,
+                        const double high=2000.0, const std::size_t maxGap=5);
+
+
+    /* ============================================================================
+    **  Name of a method ("malik", "kamath", "karlsson") to the enum.
+    **
+    ** @return False if the name is unknown.
+    ** ============================================================================ */
+    static bool parseMethod(std::string name, Method& method);
+
+
+    /* ============================================================================
+    **  Forget every interval seen, to start on a new series.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Feed the next RR intervals.
+    **
+    ** @param rr            Array of RR intervals in ms.
+    ** @param numIntervals  The number of intervals in the input array.
+    ** @param nn            Corrected intervals are appended here, in order,
+    **                      as soon as they are decided.
+    ** ============================================================================ */
+    void process(const double* rr, const std::size_t numIntervals, std::vector<double>& nn);
+
+
+    /* ============================================================================
+    **  Decide on every interval still held back, at the end of a series.
+    ** ============================================================================ */
+    void flush(std::vector<double>& nn);
+
+
+    //-- Intervals replaced so far.
+    std::size_t getNumCorrected() const;
+
+private:
+    void handle(const double value, const double next, std::vector<double>& nn);
+
+
+    bool isEctopic(const double value, const double next) const;
+
+
+    void accept(const double value, std::vector<double>& nn);
+
+
+    void reject(const double value, std::vector<double>& nn);
+
+
+    void giveUp(std::vector<double>& nn);
+
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_RR_ARTIFACT_CORRECTOR_H */
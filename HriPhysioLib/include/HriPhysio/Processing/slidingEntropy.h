@@ -0,0 +1,139 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_PROCESSING_SLIDING_ENTROPY_H
+#define HRI_PHYSIO_PROCESSING_SLIDING_ENTROPY_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Processing {
+        class SlidingEntropy;
+    }
+}
+
+/* ============================================================================
+**  Sample entropy (Richman and Moorman, 2000) and approximate entropy
+**  (Pincus, 1991) over the last ``capacity`` values of a series.
+**
+**  Templates of ``dimension`` values match when no pair of their values is
+**  further apart than ``tolerance``. Rather than comparing every pair of
+**  templates, templates are kept sorted by their first value, so only those
+**  inside the tolerance band of a new template are compared. Match counts
+**  are updated as values enter and leave the window, so sliding it by one
+**  value costs one band search rather than a full recount.
+** ============================================================================ */
+class hriPhysio::Processing::SlidingEntropy {
+private:
+
+    /* ============================================================================
+	**  Variables received from the constructor.
+	** ============================================================================ */
+    std::size_t dimension;
+    std::size_t capacity;
+    double      tolerance;
+
+
+    /* ============================================================================
+    **  The window, and for each template starting in it the number of other
+    **  templates it matches at ``dimension`` and ``dimension + 1`` values.
+    ** ============================================================================ */
+    std::deque<double>      values;
+    std::deque<std::size_t> matches;
+    std::deque<std::size_t> matches_next;
+    uint64_t                first;      //-- Position in the series of values.front().
+
+
+    //-- Templates of ``dimension`` values by their first value.
+    std::multimap<double, uint64_t> sorted;
+
+
+    //-- Matching pairs of templates, each pair counted once.
+    uint64_t pairs;
+    uint64_t pairs_next;
+
+public:
+
+    /* ============================================================================
+    **  Main Constructor.
+    **
+    ** @param dimension   Template length, ``m``.
+    ** @param capacity    Values kept in the window, 0 for unbounded.
+    ** @param tolerance   Largest difference between matching values, ``r``.
+    ** ============================================================================ */
+    SlidingEntropy(const std::size_t dimension, const std::size_t capacity, const double tolerance);
+
+
+    /* ============================================================================
+    **  Forget every value.
+    ** ============================================================================ */
+    void reset();
+
+
+    /* ============================================================================
+    **  Append values, dropping the oldest beyond the capacity.
+    ** ============================================================================ */
+    void push(const double* source, const std::size_t numValues);
+
+
+    /* ============================================================================
+    **  Change the tolerance, recounting the matches of the current window.
+    ** ============================================================================ */
+    void setTolerance(const double value);
+
+
+    /* ============================================================================
+    **  -ln(A / B), where B and A are the matching pairs among the first N - m
+    **  templates of length m and m + 1. Infinite if no template of length
+    **  m + 1 matches, NaN if none of length m does.
+    ** ============================================================================ */
+    double sampleEntropy() const;
+
+
+    /* ============================================================================
+    **  Phi(m) - Phi(m + 1), counting self matches. NaN if the window is
+    **  shorter than m + 1 values.
+    ** ============================================================================ */
+    double approximateEntropy() const;
+
+
+    std::size_t size() const;
+
+private:
+    bool close(const uint64_t lhs, const uint64_t rhs, const std::size_t length) const;
+
+
+    double at(const uint64_t position) const;
+
+
+    //-- Add or remove (``sign`` of +1 or -1) the template starting at ``position``.
+    void count(const uint64_t position, const std::size_t length, const int sign);
+
+
+    void pushOne(const double value);
+
+
+    void popOne();
+
+public:
+    /* ============================================================================
+    **  Copy operations are disallowed.
+    ** ============================================================================ */
+    SlidingEntropy(const SlidingEntropy&) = delete;
+    SlidingEntropy &operator=(const SlidingEntropy&) = delete;
+};
+
+#endif /* HRI_PHYSIO_PROCESSING_SLIDING_ENTROPY_H */
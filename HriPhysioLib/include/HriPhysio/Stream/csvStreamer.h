@@ -14,6 +14,7 @@
 #define HRI_PHYSIO_STREAM_CSV_STREAMER_H
 
 #include <iostream>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -38,9 +39,30 @@ namespace hriPhysio {
 class hriPhysio::Stream::CsvStreamer : public hriPhysio::Stream::StreamerInterface {
 
 private:
-    std::ifstream input;
     std::ofstream output;
+
+    //-- Input file, mapped read-only and parsed in place.
+    const char* map_data;
+    std::size_t map_size;
+    std::size_t map_begin;
+    std::size_t map_offset;
+
+    //-- Empty or unreadable cells, each read as 0.
+    std::size_t bad_cells;
+
+    //-- Cells published as another type than the dtype, converted to it.
+    std::size_t converted_cells;
+
+    //-- Cached "System Time" column, rebuilt once per second.
     std::string sys_time;
+    std::time_t sys_second;
+
+    //-- Rows are formatted here and written out in large blocks.
+    std::vector<char> out_buffer;
+    std::size_t out_used;
+    std::size_t flush_bytes;
+    double flush_interval;
+    std::chrono::steady_clock::time_point last_flush;
 
 
 public:
@@ -48,6 +70,20 @@ public:
 
     ~CsvStreamer();
 
+    void setFlushThreshold(const std::size_t bytes);
+    void setFlushInterval(const double seconds);
+
+    void flush();
+
+    //-- Start reading again from the first row.
+    void rewind();
+
+    //-- Cells read as 0 because they were empty, missing or not a number.
+    std::size_t getBadCells() const;
+
+    //-- Cells written after converting them to the dtype.
+    std::size_t getConvertedCells() const;
+
     bool openInputStream();
 
     bool openOutputStream();
@@ -62,6 +98,23 @@ public:
 
 
 private:
+    void updateSystemTime();
+
+    char* reserveOutput(const std::size_t bytes);
+
+    void maybeFlush();
+
+    //-- Parse the leading columns of the next row, returning the start of the data.
+    const char* beginRow(double& timestamp);
+
+    void endRow(const char* cursor);
+
+    //-- Count a cell that could not be read, warning about the first one.
+    void badCell();
+
+    //-- Count a cell that was not of the dtype, warning about the first one.
+    void convertedCell();
+
     template<typename T>
     void pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps);
 
@@ -0,0 +1,90 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_DELTA_CODEC_H
+#define HRI_PHYSIO_STREAM_DELTA_CODEC_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class DeltaCodec;
+    }
+}
+
+
+/* ============================================================================
+**  Lossless compression for sampled signals. Each channel is predicted
+**  (previous value, or linear extrapolation of the previous two), the
+**  residuals are zig-zag encoded and bit-packed 128 at a time at the width
+**  of the largest one. Floating point channels holding whole numbers take
+**  the same path; other floating point channels XOR consecutive bit
+**  patterns instead. Whatever is smallest is kept, so a channel never
+**  grows by more than its one mode byte.
+**
+**  Full blocks are packed as four interleaved 32-bit lanes so they unpack
+**  with SSE2 shifts when available.
+** ============================================================================ */
+class hriPhysio::Stream::DeltaCodec {
+
+public:
+    static constexpr std::size_t block_size = 128;
+
+    enum modeTag : uint8_t {
+        RAW            = 0,    // Values as they are.
+        DELTA          = 1,    // Residual from the previous value.
+        DELTA_OF_DELTA = 2,    // Residual from the line through the previous two.
+        XOR            = 3,    // Bit pattern XOR the previous one.
+        INTEGRAL       = 0x80, // Floating point values that are whole numbers.
+    };
+
+    //-- Largest encoding of ``num_samples`` interleaved samples.
+    static std::size_t maxEncodedSize(const hriPhysio::varTag var, const std::size_t num_channels, const std::size_t num_samples);
+
+    /* ===========================================================================
+    **  Compress interleaved samples, channel by channel.
+    **
+    ** @param values       ``num_samples * num_channels`` interleaved values.
+    ** @param num_channels Channels per sample.
+    ** @param num_samples  Samples to encode.
+    ** @param target       Destination, at least maxEncodedSize bytes.
+    **
+    ** @return Number of bytes written.
+    ** =========================================================================== */
+    template<typename T>
+    static std::size_t encode(const T* values, const std::size_t num_channels, const std::size_t num_samples, uint8_t* target);
+
+    /* ===========================================================================
+    **  Restore interleaved samples written by encode.
+    **
+    ** @param data         Encoded bytes.
+    ** @param length       How many of them there are.
+    ** @param num_channels Channels per sample.
+    ** @param num_samples  Samples to decode.
+    ** @param target       Destination for ``num_samples * num_channels`` values.
+    **
+    ** @return False if the data is truncated or malformed.
+    ** =========================================================================== */
+    template<typename T>
+    static bool decode(const uint8_t* data, const std::size_t length, const std::size_t num_channels,
+                       const std::size_t num_samples, T* target);
+
+    //-- Same as decode, for the element type named by ``var``.
+    static bool decode(const hriPhysio::varTag var, const uint8_t* data, const std::size_t length,
+                       const std::size_t num_channels, const std::size_t num_samples, void* target);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_DELTA_CODEC_H */
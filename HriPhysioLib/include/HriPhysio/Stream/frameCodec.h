@@ -0,0 +1,420 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_FRAME_CODEC_H
+#define HRI_PHYSIO_STREAM_FRAME_CODEC_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <HriPhysio/Stream/deltaCodec.h>
+#include <HriPhysio/Stream/quantizer.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        struct FrameView;
+        class  FrameCodec;
+    }
+}
+
+
+/* ============================================================================
+**  A decoded frame. Nothing is copied, the pointers reference the
+**  buffer handed to FrameCodec::decode, which must outlive the view.
+** ============================================================================ */
+struct hriPhysio::Stream::FrameView {
+    uint32_t          stream_id    = 0;
+    uint64_t          sequence     = 0;
+    hriPhysio::varTag var          = hriPhysio::varTag::CHAR;
+    uint8_t           flags        = 0;
+    uint16_t          num_channels = 0;
+    uint32_t          num_samples  = 0;
+
+    //-- Quantized frames carry integers that restore to ``value_var``.
+    hriPhysio::varTag value_var = hriPhysio::varTag::CHAR;
+    double            scale     = 1.0;
+    double            offset    = 0.0;
+
+    const uint8_t* stamps        = nullptr;
+    const uint8_t* payload       = nullptr;
+    std::size_t    payload_bytes = 0;
+    std::size_t    frame_bytes   = 0;
+
+    bool isPlanar() const;
+    bool hasStampRange() const;
+    bool isCompressed() const;
+    bool isQuantized() const;
+
+    //-- Decode a compressed payload into ``storage`` and point the view at it.
+    bool decompress(std::vector<uint8_t>& storage);
+
+    //-- Restore a quantized payload into ``storage``, after decompress. The
+    //-- payload must not already live in ``storage``.
+    bool dequantize(std::vector<uint8_t>& storage);
+
+    //-- Timestamp of a sample in seconds. Range frames interpolate.
+    double timestamp(const std::size_t sample) const;
+
+    template<typename T>
+    T value(const std::size_t sample, const std::size_t channel) const;
+
+    //-- Copy the payload out as interleaved samples, whatever the wire layout.
+    template<typename T>
+    void copyInterleaved(T* target) const;
+};
+
+
+class hriPhysio::Stream::FrameCodec {
+
+public:
+    enum flagBits : uint8_t {
+        PLANAR      = 0x01,  // Payload is channel by channel instead of sample by sample.
+        CHECKSUM    = 0x02,  // A CRC32C of the whole frame follows the payload.
+        STAMP_RANGE = 0x04,  // Only the first and last timestamps are sent.
+        COMPRESSED  = 0x08,  // Payload is DeltaCodec encoded, see FrameView::decompress.
+        QUANTIZED   = 0x10,  // Payload is scaled integers, see FrameView::dequantize.
+    };
+
+    //-- Wire layout, little-endian, every frame starts with:
+    //--   magic(2) version(1) flags(1) var(1) value_var(1) channels(2) stream_id(4)
+    //--   samples(4) sequence(8) payload_bytes(4) reserved(4)
+    //-- followed by int64 nanosecond timestamps, the double scale and offset of
+    //-- quantized frames, the payload and the optional checksum.
+    static constexpr uint16_t    frame_magic   = 0x4648; // "HF"
+    static constexpr uint8_t     frame_version = 1;
+    static constexpr std::size_t header_size   = 32;
+    static constexpr std::size_t quantize_size = 16;
+    static constexpr std::size_t checksum_size = 4;
+
+private:
+    uint32_t stream_id;
+    uint8_t  flags;
+
+    hriPhysio::Stream::Quantizer quantizer;
+
+    //-- Reused across frames so encoding does not allocate once they are warm.
+    //-- Values gathered from a varType or strided source, and their quantized
+    //-- integers, which are needed at the same time.
+    mutable std::vector<uint8_t> value_scratch;
+    mutable std::vector<uint8_t> wire_scratch;
+
+public:
+    FrameCodec();
+
+    ~FrameCodec();
+
+    void setStreamId(const uint32_t id);
+    void setPlanar(const bool enable);
+    void setChecksum(const bool enable);
+    void setStampRange(const bool enable);
+    void setCompression(const bool enable);
+
+    //-- Floating point frames are sent as the quantizer's integers while it is enabled.
+    void setQuantizer(const hriPhysio::Stream::Quantizer& quantizer);
+
+    uint32_t getStreamId() const;
+    uint8_t  getFlags() const;
+
+    const hriPhysio::Stream::Quantizer& getQuantizer() const;
+
+    /* ===========================================================================
+    **  Number of bytes a frame of this shape takes on the wire. With
+    **  compression this is an upper bound, encode returns the actual size.
+    **  Zero if the header cannot hold ``num_channels``.
+    **
+    ** @param var          Element type of the payload.
+    ** @param num_channels Channels per sample.
+    ** @param num_samples  Samples in the frame.
+    ** =========================================================================== */
+    std::size_t frameSize(const hriPhysio::varTag var, const std::size_t num_channels, const std::size_t num_samples) const;
+
+    //-- Whether a frame header can hold ``num_channels``, reporting an error if not.
+    static bool fitsHeader(const std::size_t num_channels);
+
+    //-- Largest number of samples that fit in ``frame_bytes``.
+    std::size_t maxSamples(const hriPhysio::varTag var, const std::size_t num_channels, const std::size_t frame_bytes) const;
+
+    /* ===========================================================================
+    **  Encode interleaved samples into ``target``, which must hold frameSize bytes.
+    **  Nothing is written if the header cannot hold ``num_channels``.
+    **
+    ** @param target      Destination buffer.
+    ** @param sequence    Frame sequence number.
+    ** @param values      ``num_samples * num_channels`` interleaved values.
+    ** @param stamps      Per-sample timestamps in seconds, or nullptr.
+    ** @param fallback    Timestamp used for every sample when stamps is nullptr.
+    **
+    ** @return Number of bytes written, 0 on failure.
+    ** =========================================================================== */
+    template<typename T>
+    std::size_t encode(uint8_t* target, const uint64_t sequence, const hriPhysio::varType* values,
+                       const std::size_t num_channels, const std::size_t num_samples,
+                       const double* stamps, const double fallback) const;
+
+    template<typename T>
+    std::size_t encode(uint8_t* target, const uint64_t sequence, const T* values,
+                       const std::size_t num_channels, const std::size_t num_samples,
+                       const double* stamps, const double fallback) const;
+
+    std::size_t encode(uint8_t* target, const uint64_t sequence, const std::string& message, const double stamp) const;
+
+    /* ===========================================================================
+    **  Size of the frame starting at ``data`` from its header alone.
+    **
+    ** @param data        Bytes received so far.
+    ** @param available   How many of them there are.
+    ** @param frame_bytes Set to the frame size, or 0 if the header is incomplete.
+    **
+    ** @return False if the bytes can not be the start of a frame.
+    ** =========================================================================== */
+    static bool peekSize(const uint8_t* data, const std::size_t available, std::size_t& frame_bytes);
+
+    //-- Validate and view the frame at ``data``. False if it is malformed or the checksum fails.
+    static bool decode(const uint8_t* data, const std::size_t length, FrameView& view);
+
+    static std::size_t elementSize(const hriPhysio::varTag var);
+
+    static uint32_t crc32c(const uint8_t* data, const std::size_t length, uint32_t crc = 0);
+
+private:
+    template<typename T>
+    static hriPhysio::varTag typeTag();
+
+    //-- View ``buffer`` as ``count`` values of T, growing it if needed.
+    template<typename T>
+    static T* scratch(std::vector<uint8_t>& buffer, const std::size_t count);
+
+    std::size_t stampBytes(const std::size_t num_samples) const;
+
+    //-- Type the payload of ``var`` values is sent as.
+    hriPhysio::varTag payloadType(const hriPhysio::varTag var) const;
+
+    std::size_t writeHeader(uint8_t* target, const uint64_t sequence, const hriPhysio::varTag var,
+                            const std::size_t num_channels, const std::size_t num_samples, const std::size_t payload_bytes) const;
+
+    std::size_t writeStamps(uint8_t* target, const std::size_t num_samples, const double* stamps, const double fallback) const;
+
+    std::size_t finish(uint8_t* target, const std::size_t length) const;
+
+    //-- Compress the payload at ``offset`` and patch its size into the header.
+    template<typename T>
+    std::size_t finishCompressed(uint8_t* target, const std::size_t offset, const T* values,
+                                 const std::size_t num_channels, const std::size_t num_samples) const;
+
+    template<typename T, typename Wire>
+    std::size_t encodeQuantized(uint8_t* target, const uint64_t sequence, const T* values,
+                                const std::size_t num_channels, const std::size_t num_samples,
+                                const double* stamps, const double fallback) const;
+
+    template<typename T, typename Source>
+    std::size_t encodeWith(uint8_t* target, const uint64_t sequence, Source source,
+                           const std::size_t num_channels, const std::size_t num_samples,
+                           const double* stamps, const double fallback) const;
+
+};
+
+
+template<typename T>
+T hriPhysio::Stream::FrameView::value(const std::size_t sample, const std::size_t channel) const {
+    const std::size_t idx = this->isPlanar() ? channel * num_samples + sample : sample * num_channels + channel;
+    T result;
+    std::memcpy(&result, payload + idx * sizeof(T), sizeof(T));
+    return result;
+}
+
+
+template<typename T>
+void hriPhysio::Stream::FrameView::copyInterleaved(T* target) const {
+
+    if (!this->isPlanar()) {
+        std::memcpy(target, payload, std::size_t(num_samples) * num_channels * sizeof(T));
+        return;
+    }
+
+    for (std::size_t ch = 0; ch < num_channels; ++ch) {
+        const uint8_t* source = payload + ch * num_samples * sizeof(T);
+        for (std::size_t idx = 0; idx < num_samples; ++idx) {
+            std::memcpy(target + idx * num_channels + ch, source + idx * sizeof(T), sizeof(T));
+        }
+    }
+    return;
+}
+
+
+template<typename T>
+hriPhysio::varTag hriPhysio::Stream::FrameCodec::typeTag() {
+    if constexpr (std::is_same_v<T, char>)    { return hriPhysio::varTag::CHAR;   }
+    if constexpr (std::is_same_v<T, int16_t>) { return hriPhysio::varTag::INT16;  }
+    if constexpr (std::is_same_v<T, int32_t>) { return hriPhysio::varTag::INT32;  }
+    if constexpr (std::is_same_v<T, int64_t>) { return hriPhysio::varTag::INT64;  }
+    if constexpr (std::is_same_v<T, float>)   { return hriPhysio::varTag::FLOAT;  }
+    return hriPhysio::varTag::DOUBLE;
+}
+
+
+template<typename T>
+T* hriPhysio::Stream::FrameCodec::scratch(std::vector<uint8_t>& buffer, const std::size_t count) {
+    if (buffer.size() < count * sizeof(T)) {
+        buffer.resize(count * sizeof(T));
+    }
+    return reinterpret_cast<T*>(buffer.data());
+}
+
+
+template<typename T>
+std::size_t hriPhysio::Stream::FrameCodec::finishCompressed(uint8_t* target, const std::size_t offset, const T* values,
+                                                            const std::size_t num_channels, const std::size_t num_samples) const {
+
+    const uint32_t payload_bytes = static_cast<uint32_t>(
+        hriPhysio::Stream::DeltaCodec::encode<T>(values, num_channels, num_samples, target + offset)
+    );
+    std::memcpy(target + 24, &payload_bytes, sizeof(uint32_t));
+
+    return this->finish(target, offset + payload_bytes);
+}
+
+
+template<typename T, typename Wire>
+std::size_t hriPhysio::Stream::FrameCodec::encodeQuantized(uint8_t* target, const uint64_t sequence, const T* values,
+                                                           const std::size_t num_channels, const std::size_t num_samples,
+                                                           const double* stamps, const double fallback) const {
+
+    const std::size_t count = num_channels * num_samples;
+    const double      scale = quantizer.getScale();
+    const double      shift = quantizer.getOffset();
+
+    Wire* wire = scratch<Wire>(wire_scratch, count);
+    hriPhysio::Stream::Quantizer::quantize(values, count, scale, shift, wire);
+
+    std::size_t offset = this->writeHeader(target, sequence, typeTag<Wire>(), num_channels, num_samples, count * sizeof(Wire));
+    offset += this->writeStamps(target + offset, num_samples, stamps, fallback);
+
+    //-- Quantized payloads are always interleaved.
+    target[3] = static_cast<uint8_t>((target[3] | QUANTIZED) & ~PLANAR);
+    target[5] = static_cast<uint8_t>(typeTag<T>());
+    std::memcpy(target + offset,                  &scale, sizeof(double));
+    std::memcpy(target + offset + sizeof(double), &shift, sizeof(double));
+    offset += quantize_size;
+
+    if (flags & COMPRESSED) {
+        return this->finishCompressed(target, offset, wire, num_channels, num_samples);
+    }
+
+    std::memcpy(target + offset, wire, count * sizeof(Wire));
+    return this->finish(target, offset + count * sizeof(Wire));
+}
+
+
+template<typename T, typename Source>
+std::size_t hriPhysio::Stream::FrameCodec::encodeWith(uint8_t* target, const uint64_t sequence, Source source,
+                                                      const std::size_t num_channels, const std::size_t num_samples,
+                                                      const double* stamps, const double fallback) const {
+
+    const std::size_t count = num_channels * num_samples;
+
+    if constexpr (std::is_floating_point_v<T>) {
+        if (quantizer.isEnabled()) {
+            T* values = scratch<T>(value_scratch, count);
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                values[idx] = source(idx);
+            }
+            return this->encode<T>(target, sequence, values, num_channels, num_samples, stamps, fallback);
+        }
+    }
+
+    std::size_t offset = this->writeHeader(target, sequence, typeTag<T>(), num_channels, num_samples, count * sizeof(T));
+    offset += this->writeStamps(target + offset, num_samples, stamps, fallback);
+
+    uint8_t* payload = target + offset;
+    if (flags & COMPRESSED) {
+        T* values = scratch<T>(value_scratch, count);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            values[idx] = source(idx);
+        }
+        return this->finishCompressed(target, offset, values, num_channels, num_samples);
+    }
+
+    if (flags & PLANAR) {
+        for (std::size_t idx = 0; idx < num_samples; ++idx) {
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                const T value = source(idx * num_channels + ch);
+                std::memcpy(payload + (ch * num_samples + idx) * sizeof(T), &value, sizeof(T));
+            }
+        }
+    } else {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            const T value = source(idx);
+            std::memcpy(payload + idx * sizeof(T), &value, sizeof(T));
+        }
+    }
+
+    return this->finish(target, offset + count * sizeof(T));
+}
+
+
+template<typename T>
+std::size_t hriPhysio::Stream::FrameCodec::encode(uint8_t* target, const uint64_t sequence, const hriPhysio::varType* values,
+                                                  const std::size_t num_channels, const std::size_t num_samples,
+                                                  const double* stamps, const double fallback) const {
+
+    if (!fitsHeader(num_channels)) {
+        return 0;
+    }
+
+    return this->encodeWith<T>(target, sequence, [values](std::size_t idx) { return std::get<T>(values[idx]); },
+                               num_channels, num_samples, stamps, fallback);
+}
+
+
+template<typename T>
+std::size_t hriPhysio::Stream::FrameCodec::encode(uint8_t* target, const uint64_t sequence, const T* values,
+                                                  const std::size_t num_channels, const std::size_t num_samples,
+                                                  const double* stamps, const double fallback) const {
+
+    if (!fitsHeader(num_channels)) {
+        return 0;
+    }
+
+    if constexpr (std::is_floating_point_v<T>) {
+        if (quantizer.isEnabled() && quantizer.getWireType() == hriPhysio::varTag::INT16) {
+            return this->encodeQuantized<T, int16_t>(target, sequence, values, num_channels, num_samples, stamps, fallback);
+        } else if (quantizer.isEnabled()) {
+            return this->encodeQuantized<T, int32_t>(target, sequence, values, num_channels, num_samples, stamps, fallback);
+        }
+    }
+
+    if (flags & COMPRESSED) {
+        std::size_t offset = this->writeHeader(target, sequence, typeTag<T>(), num_channels, num_samples, 0);
+        offset += this->writeStamps(target + offset, num_samples, stamps, fallback);
+        return this->finishCompressed(target, offset, values, num_channels, num_samples);
+    }
+
+    //-- Interleaved typed input is already the wire layout.
+    if (!(flags & PLANAR)) {
+        const std::size_t count = num_channels * num_samples;
+        std::size_t offset = this->writeHeader(target, sequence, typeTag<T>(), num_channels, num_samples, count * sizeof(T));
+        offset += this->writeStamps(target + offset, num_samples, stamps, fallback);
+        std::memcpy(target + offset, values, count * sizeof(T));
+        return this->finish(target, offset + count * sizeof(T));
+    }
+
+    return this->encodeWith<T>(target, sequence, [values](std::size_t idx) { return values[idx]; },
+                               num_channels, num_samples, stamps, fallback);
+}
+
+#endif /* HRI_PHYSIO_STREAM_FRAME_CODEC_H */
@@ -0,0 +1,83 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_LSL_RESOLVER_H
+#define HRI_PHYSIO_STREAM_LSL_RESOLVER_H
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <lsl_cpp.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class LslResolver;
+    }
+}
+
+/* ============================================================================
+**  One continuous resolver shared by every LslStreamer in the process.
+**  Discovery runs in the background, so opening several inlets costs a
+**  single discovery round instead of one blocking resolve per stream.
+** ============================================================================ */
+class hriPhysio::Stream::LslResolver {
+
+private:
+    std::unique_ptr<lsl::continuous_resolver> resolver;
+    std::chrono::steady_clock::time_point started;
+
+    //-- Last snapshot of the network, refreshed at most every ``refresh_period``.
+    std::vector<lsl::stream_info> results;
+    std::chrono::steady_clock::time_point last_refresh;
+
+    std::mutex lock;
+
+    LslResolver();
+
+public:
+    ~LslResolver();
+
+    static LslResolver& instance();
+
+    /* ===========================================================================
+    **  Look for a stream by name without waiting.
+    **
+    ** @param name Name of the LSL stream.
+    ** @param info Set to the stream info when found.
+    **
+    ** @return True if the stream is currently visible.
+    ** =========================================================================== */
+    bool find(const std::string& name, lsl::stream_info& info);
+
+    /* ===========================================================================
+    **  Like find, but keep looking until discovery has run for ``seconds``.
+    **  The wait is measured from when the resolver started, not from the
+    **  call, so opening several missing streams in turn waits once in total.
+    ** =========================================================================== */
+    bool waitFor(const std::string& name, lsl::stream_info& info, const double seconds);
+
+private:
+    void refresh();
+
+
+public:
+    //-- Disallow copy and assignment operators.
+    LslResolver(const LslResolver&) = delete;
+    LslResolver &operator=(const LslResolver&) = delete;
+};
+
+#endif /* HRI_PHYSIO_STREAM_LSL_RESOLVER_H */
@@ -14,13 +14,17 @@
 #define HRI_PHYSIO_STREAM_LSL_STREAMER_H
 
 #include <iostream>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <lsl_cpp.h>
 
+#include <HriPhysio/Stream/lslResolver.h>
+#include <HriPhysio/Stream/quantizer.h>
 #include <HriPhysio/Stream/streamerInterface.h>
 
 #include <HriPhysio/helpers.h>
@@ -37,6 +41,27 @@ private:
     std::unique_ptr<lsl::stream_inlet> inlet;
     std::unique_ptr<lsl::stream_outlet> outlet;
 
+    //-- Typed transfer buffers, sized once and reused by every push and pull.
+    std::tuple<
+        std::vector<char>,
+        std::vector<int16_t>,
+        std::vector<int32_t>,
+        std::vector<int64_t>,
+        std::vector<float>,
+        std::vector<double>
+    > chunks;
+    std::vector<double> chunk_stamps;
+
+    //-- Inlets whose stream is not up yet are attached later, with backoff.
+    double resolve_timeout;
+    double attach_backoff;
+    std::chrono::steady_clock::time_point next_attach;
+
+    //-- Scaled-integer transport, described in the stream info for receivers.
+    //-- Until the inlet's full info has been read nothing is pulled.
+    hriPhysio::Stream::Quantizer quantizer;
+    bool quantization_known;
+
 public:
     LslStreamer();
 
@@ -44,6 +69,12 @@ public:
 
     lsl::channel_format_t getLslFormatType();
 
+    void setResolveTimeout(const double seconds);
+
+    bool isAttached() const;
+
+    bool setQuantization(const std::string wire_dtype, const double scale, const double offset);
+
     bool openInputStream();
 
     bool openOutputStream();
@@ -57,11 +88,32 @@ public:
     void receive(std::string& buff, double* timestamps = nullptr);
 
 private:
+    bool attachInlet();
+
+    //-- Open an inlet on a resolved stream and see if it may be quantized.
+    void openInlet(const lsl::stream_info& info);
+
+    //-- Pick up the sender's quantization from the inlet's full info, waiting
+    //-- no longer than a receive may block. False if it did not arrive in time.
+    bool readQuantization();
+
     template<typename T>
     void pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps);
 
+    template<typename T>
+    void pushChunk(const std::vector<T>& samples, const std::vector<double>* timestamps);
+
+    template<typename T, typename Wire>
+    void pushQuantized(const std::vector<T>& samples, const std::vector<double>* timestamps);
+
     template<typename T>
     void pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps);
+
+    template<typename T>
+    std::size_t pullChunk(std::vector<T>& samples);
+
+    template<typename T, typename Wire>
+    std::size_t pullQuantized(std::vector<T>& samples);
     
 };
 
@@ -0,0 +1,77 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_QUANTIZER_H
+#define HRI_PHYSIO_STREAM_QUANTIZER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class Quantizer;
+    }
+}
+
+
+/* ============================================================================
+**  Scaled-integer transport for floating point streams. Values are sent as
+**  ``round((value - offset) / scale)`` in int16 or int32, saturating at the
+**  ends of the range, and restored as ``wire * scale + offset``. Sensors
+**  that sample at 16 bits lose nothing when the scale is their resolution.
+** ============================================================================ */
+class hriPhysio::Stream::Quantizer {
+
+private:
+    hriPhysio::varTag wire;
+    double scale;
+    double offset;
+    bool   enabled;
+
+public:
+    Quantizer();
+
+    ~Quantizer();
+
+    /* ===========================================================================
+    **  Turn quantization on.
+    **
+    ** @param wire_dtype ``int16`` or ``int32``, the type sent on the wire.
+    ** @param scale      Value of one wire step, must not be zero.
+    ** @param offset     Value sent as wire zero.
+    **
+    ** @return False, and quantization stays off, if the arguments are invalid.
+    ** =========================================================================== */
+    bool configure(const std::string& wire_dtype, const double scale, const double offset);
+
+    void disable();
+
+    bool isEnabled() const;
+
+    hriPhysio::varTag getWireType() const;
+    double getScale() const;
+    double getOffset() const;
+
+    //-- Quantize ``count`` values into ``target``.
+    template<typename T, typename Wire>
+    static void quantize(const T* values, const std::size_t count, const double scale, const double offset, Wire* target);
+
+    //-- Restore ``count`` wire values into ``target``.
+    template<typename Wire, typename T>
+    static void restore(const Wire* values, const std::size_t count, const double scale, const double offset, T* target);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_QUANTIZER_H */
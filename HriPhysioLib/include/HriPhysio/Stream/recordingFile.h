@@ -0,0 +1,218 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_RECORDING_FILE_H
+#define HRI_PHYSIO_STREAM_RECORDING_FILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <HriPhysio/Stream/frameCodec.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        struct RecordingZone;
+        struct RecordingChunk;
+        class  RecordingWriter;
+        class  RecordingReader;
+    }
+}
+
+
+/* ============================================================================
+**  Binary session recordings (``.hrec``), little-endian:
+**
+**    file header   magic(8) version(4) reserved(4)
+**    chunks        checksummed FrameCodec frames, one stream each, numeric
+**                  chunks DeltaCodec compressed unless disabled
+**    index         one entry per chunk, see RecordingChunk, followed by
+**                  the zone map of its channels when it has one
+**    trailer       index_offset(8) num_chunks(4) index_crc(4) magic(8)
+**
+**  Chunks are only ever appended, and the index is written on close. A
+**  file whose trailer is missing (crash, power loss) is recovered by
+**  scanning the chunks, stopping at the first one failing its checksum.
+**  Recovered chunks have no zone map.
+** ============================================================================ */
+struct hriPhysio::Stream::RecordingZone {
+    double min  = 0.0;
+    double max  = 0.0;
+    double mean = 0.0;
+    double m2   = 0.0; // Sum of squared differences from the mean.
+};
+
+
+struct hriPhysio::Stream::RecordingChunk {
+    uint64_t          offset       = 0;
+    uint32_t          frame_bytes  = 0;
+    uint32_t          stream_id    = 0;
+    double            first_time   = 0.0;
+    double            last_time    = 0.0;
+    uint32_t          num_samples  = 0;
+    uint16_t          num_channels = 0;
+    hriPhysio::varTag var          = hriPhysio::varTag::CHAR;
+
+    //-- One summary per channel, so queries can skip decoding the chunk.
+    std::vector<hriPhysio::Stream::RecordingZone> zones;
+};
+
+
+class hriPhysio::Stream::RecordingWriter {
+
+public:
+    static constexpr uint64_t    file_magic    = 0x3143455250495248; // "HRIPREC1"
+    static constexpr uint64_t    index_magic   = 0x3158444E49495248; // "HRIINDX1"
+    static constexpr uint32_t    file_version  = 2;
+    static constexpr std::size_t file_header   = 16;
+    static constexpr std::size_t index_entry   = 40;
+    static constexpr std::size_t zone_entry    = 32;
+    static constexpr std::size_t trailer_size  = 24;
+
+private:
+    int         fd;
+    std::string path;
+
+    hriPhysio::Stream::FrameCodec codec;
+    uint64_t sequence;
+
+    //-- Chunks are staged here and written in large sequential blocks.
+    std::vector<uint8_t> out_buffer;
+    std::size_t          out_used;
+    std::size_t          flush_bytes;
+    double               flush_interval;
+    std::chrono::steady_clock::time_point last_flush;
+
+    uint64_t file_offset;
+    std::vector<hriPhysio::Stream::RecordingChunk> index;
+
+public:
+    RecordingWriter();
+
+    ~RecordingWriter();
+
+    //-- Create (or truncate) ``path`` and write the file header.
+    bool open(const std::string& path);
+
+    bool isOpen() const;
+
+    void setFlushThreshold(const std::size_t bytes);
+    void setFlushInterval(const double seconds);
+    void setCompression(const bool enable);
+
+    /* ===========================================================================
+    **  Append one chunk of interleaved samples for a stream.
+    **
+    ** @param stream_id    Stream the chunk belongs to.
+    ** @param var          Element type the values are stored as.
+    ** @param values       ``num_samples * num_channels`` interleaved values.
+    ** @param num_channels Channels per sample.
+    ** @param num_samples  Samples in the chunk.
+    ** @param stamps       Per-sample timestamps in seconds.
+    **
+    ** @return False if the chunk could not be written.
+    ** =========================================================================== */
+    bool writeChunk(const uint32_t stream_id, const hriPhysio::varTag var, const hriPhysio::varType* values,
+                    const std::size_t num_channels, const std::size_t num_samples, const double* stamps);
+
+    bool writeString(const uint32_t stream_id, const std::string& message, const double stamp);
+
+    //-- Hand everything staged to the kernel.
+    bool flush();
+
+    //-- Write the index and trailer, then close the file.
+    void close();
+
+    std::size_t getNumChunks() const;
+
+private:
+    uint8_t* reserveOutput(const std::size_t bytes);
+
+    bool commit(hriPhysio::Stream::RecordingChunk chunk, const std::size_t bytes);
+
+    bool writeAll(const uint8_t* data, std::size_t length);
+
+
+public:
+    //-- Disallow copy and assignment operators.
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter &operator=(const RecordingWriter&) = delete;
+};
+
+
+class hriPhysio::Stream::RecordingReader {
+
+private:
+    const uint8_t* map_data;
+    std::size_t    map_size;
+
+    std::vector<hriPhysio::Stream::RecordingChunk> chunks;
+
+    //-- Chunk numbers of every stream, in the order they were written.
+    std::map<uint32_t, std::vector<std::size_t>> streams;
+
+    bool recovered;
+
+public:
+    RecordingReader();
+
+    ~RecordingReader();
+
+    //-- Map ``path`` and load its index, rebuilding it if the trailer is missing.
+    bool open(const std::string& path);
+
+    bool isOpen() const;
+
+    void close();
+
+    //-- True if the index was rebuilt because the file was not closed cleanly.
+    bool wasRecovered() const;
+
+    const std::vector<hriPhysio::Stream::RecordingChunk>& getChunks() const;
+
+    std::vector<uint32_t> getStreamIds() const;
+
+    //-- Chunk numbers of ``stream_id``, empty if the stream is not recorded.
+    const std::vector<std::size_t>& getStreamChunks(const uint32_t stream_id) const;
+
+    /* ===========================================================================
+    **  Binary search for the first chunk of a stream that ends at or after a time.
+    **
+    ** @param stream_id Stream to search.
+    ** @param time      Time point in seconds.
+    **
+    ** @return Position in getStreamChunks(stream_id), its size if the stream ends earlier.
+    ** =========================================================================== */
+    std::size_t seek(const uint32_t stream_id, const double time) const;
+
+    //-- View chunk number ``chunk``. False if it fails to decode.
+    bool readChunk(const std::size_t chunk, hriPhysio::Stream::FrameView& view) const;
+
+private:
+    bool loadIndex();
+
+    void scanChunks();
+
+    void addChunk(const hriPhysio::Stream::RecordingChunk& chunk);
+
+
+public:
+    //-- Disallow copy and assignment operators.
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader &operator=(const RecordingReader&) = delete;
+};
+
+#endif /* HRI_PHYSIO_STREAM_RECORDING_FILE_H */
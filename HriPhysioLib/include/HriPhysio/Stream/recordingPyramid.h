@@ -0,0 +1,143 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_RECORDING_PYRAMID_H
+#define HRI_PHYSIO_STREAM_RECORDING_PYRAMID_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <HriPhysio/Stream/recordingFile.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        struct PyramidBin;
+        class  RecordingPyramid;
+    }
+}
+
+
+/* ============================================================================
+**  Min, max and mean of every channel over a span of samples.
+** ============================================================================ */
+struct hriPhysio::Stream::PyramidBin {
+    double   first_time = 0.0;
+    double   last_time  = 0.0;
+    uint64_t count      = 0;
+
+    std::vector<double> min;
+    std::vector<double> max;
+    std::vector<double> mean;
+};
+
+
+/* ============================================================================
+**  Decimation pyramid of one recorded stream, for drawing any stretch of a
+**  long session without reading its samples. A bin of level ``k`` covers
+**  ``factor^(k+1)`` samples, and levels are added as the stream grows.
+**
+**  Kept next to the recording as ``<recording>.hpyr``, little-endian:
+**
+**    header   magic(8) version(4) factor(4) num_channels(4) num_levels(4)
+**    level    num_bins(8), then per bin first_time(8) last_time(8)
+**             count(8) and min(8) max(8) sum(8) of every channel
+**
+**  Every level covers every sample: the bins still filling at a level and
+**  below it read, and are saved, as one last bin.
+** ============================================================================ */
+class hriPhysio::Stream::RecordingPyramid {
+
+public:
+    static constexpr uint64_t    file_magic   = 0x314D525950495248; // "HRIPYRM1"
+    static constexpr uint32_t    file_version = 1;
+    static constexpr std::size_t file_header  = 24;
+    static constexpr std::size_t max_levels   = 32;
+
+private:
+    struct Level {
+        std::vector<double>   first_time;
+        std::vector<double>   last_time;
+        std::vector<uint64_t> count;
+        std::vector<double>   stats; // min, max and sum of every channel, per bin.
+
+        //-- Bin being filled, and how many bins (or samples) of the level below it holds.
+        double              open_first    = 0.0;
+        double              open_last     = 0.0;
+        uint64_t            open_count    = 0;
+        std::vector<double> open_stats;
+        std::size_t         open_children = 0;
+    };
+
+    std::size_t factor;
+    std::size_t num_channels;
+
+    std::vector<Level> levels;
+
+public:
+    RecordingPyramid();
+
+    ~RecordingPyramid();
+
+    //-- Where the pyramid of ``recording`` is kept.
+    static std::string pathFor(const std::string& recording);
+
+    //-- Samples per bin of the first level, and bins per bin above it, in [2, 16].
+    bool setFactor(const std::size_t factor);
+
+    //-- Drop every bin and start over with ``num_channels`` channels.
+    void reset(const std::size_t num_channels);
+
+    std::size_t getFactor() const;
+    std::size_t getNumChannels() const;
+    std::size_t getNumLevels() const;
+
+    //-- Closed bins of ``level``, and one more for the samples after them.
+    std::size_t getNumBins(const std::size_t level) const;
+
+    //-- Add ``num_samples`` interleaved samples, in time order.
+    void append(const double* values, const double* stamps, const std::size_t num_samples);
+
+    /* ===========================================================================
+    **  Summarize a time range in at most ``pixels`` bins.
+    **
+    ** @param start  Start of the range in seconds.
+    ** @param end    End of the range in seconds.
+    ** @param pixels Columns of the plot.
+    **
+    ** @return Bins overlapping the range, in time order. Read from the coarsest
+    **         level with at least ``pixels`` bins there, then merged by column.
+    ** =========================================================================== */
+    std::vector<hriPhysio::Stream::PyramidBin> query(const double start, const double end, const std::size_t pixels) const;
+
+    //-- Rebuild from ``stream_id`` of a recording, e.g. one that was never closed.
+    bool build(const hriPhysio::Stream::RecordingReader& reader, const uint32_t stream_id);
+
+    bool save(const std::string& path) const;
+
+    //-- Bins loaded from a file are all closed, appending starts new ones.
+    bool load(const std::string& path);
+
+private:
+    void absorb(const std::size_t level, const double first, const double last,
+                const uint64_t count, const double* stats);
+
+    void close(const std::size_t level);
+
+    //-- Open bins of ``level`` and every level below it, merged.
+    Level tail(const std::size_t level) const;
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_RECORDING_PYRAMID_H */
@@ -0,0 +1,110 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_RECORDING_QUERY_H
+#define HRI_PHYSIO_STREAM_RECORDING_QUERY_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <HriPhysio/Stream/recordingFile.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class RecordingQuery;
+    }
+}
+
+
+/* ============================================================================
+**  Windowed aggregates over one stream of a set of recordings, e.g. the
+**  mean heart rate per 30 s of every session in a study.
+**
+**  Chunks outside the time range are never touched. A chunk that falls
+**  inside a single bucket is answered from its zone map without being
+**  decoded, unless percentiles are asked for. Everything else is decoded
+**  and reduced a bucket at a time. Chunks of every file are shared out
+**  over a pool of threads.
+** ============================================================================ */
+class hriPhysio::Stream::RecordingQuery {
+
+public:
+    //-- Aggregates of one channel, over one time bucket of one file.
+    struct Bucket {
+        std::size_t file    = 0;
+        std::size_t channel = 0;
+        double      start   = 0.0;
+        double      end     = 0.0;
+        std::size_t count   = 0;
+        double      mean    = 0.0;
+        double      min     = 0.0;
+        double      max     = 0.0;
+        double      std     = 0.0; // Sample standard deviation.
+
+        //-- In the order given to setPercentiles.
+        std::vector<double> percentiles;
+    };
+
+private:
+    std::vector<std::string> paths;
+
+    uint32_t    stream_id;
+    double      start_time;
+    double      end_time;
+    double      bucket_width;
+    std::size_t num_threads;
+
+    std::vector<double> percentiles;
+
+    std::size_t chunks_summarized;
+    std::size_t chunks_decoded;
+
+public:
+    RecordingQuery();
+
+    ~RecordingQuery();
+
+    void addFile(const std::string& path);
+
+    void setStreamId(const uint32_t stream_id);
+
+    //-- Only samples with ``start <= time < end`` count. Unbounded by default.
+    void setTimeRange(const double start, const double end);
+
+    //-- Buckets start at the range start, or the first sample of each file
+    //-- if the range is unbounded. Zero puts the whole range in one bucket.
+    void setBucketWidth(const double seconds);
+
+    //-- Percentiles in [0, 100], linearly interpolated between samples.
+    void setPercentiles(const std::vector<double>& percentiles);
+
+    //-- Zero uses every hardware thread.
+    void setNumThreads(const std::size_t threads);
+
+    /* ===========================================================================
+    **  Run the query over every file added.
+    **
+    ** @return Non-empty buckets, ordered by file, bucket start, then channel.
+    ** =========================================================================== */
+    std::vector<Bucket> run();
+
+    //-- How the chunks of the last run were answered.
+    std::size_t getChunksSummarized() const;
+    std::size_t getChunksDecoded() const;
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_RECORDING_QUERY_H */
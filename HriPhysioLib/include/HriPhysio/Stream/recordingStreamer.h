@@ -0,0 +1,130 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_RECORDING_STREAMER_H
+#define HRI_PHYSIO_STREAM_RECORDING_STREAMER_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <HriPhysio/Stream/csvStreamer.h>
+#include <HriPhysio/Stream/recordingFile.h>
+#include <HriPhysio/Stream/recordingPyramid.h>
+#include <HriPhysio/Stream/streamerInterface.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class RecordingStreamer;
+
+        //-- New logger writing ``format``, "hrec" for binary recordings or "csv".
+        StreamerInterface* makeLogger(std::string format);
+    }
+}
+
+/* ============================================================================
+**  Reads and writes one stream of a binary ``.hrec`` recording. Samples
+**  are gathered into column chunks of up to ``chunk_length`` samples, and
+**  a chunk is closed early once it has been open ``chunk_interval`` seconds
+**  so a crash only ever loses the most recent interval. A decimation
+**  pyramid is kept up to date as chunks are written, and saved next to
+**  the recording when it is closed.
+** ============================================================================ */
+class hriPhysio::Stream::RecordingStreamer : public hriPhysio::Stream::StreamerInterface {
+
+private:
+    hriPhysio::Stream::RecordingWriter writer;
+    hriPhysio::Stream::RecordingReader reader;
+
+    uint32_t stream_id;
+
+    //-- Chunk being gathered for the writer.
+    std::vector<hriPhysio::varType> pending;
+    std::vector<double> pending_stamps;
+    std::size_t chunk_length;
+    double chunk_interval;
+    std::chrono::steady_clock::time_point pending_since;
+
+    hriPhysio::Stream::RecordingPyramid pyramid;
+    bool keep_pyramid;
+    std::vector<double> pyramid_values;
+
+    //-- Read position, a chunk of this stream and a sample within it.
+    std::size_t read_chunk;
+    std::size_t read_sample;
+
+    //-- Decoded view of the chunk at ``view_chunk``, so it is checked once.
+    hriPhysio::Stream::FrameView view;
+    std::size_t view_chunk;
+    bool        view_valid;
+    std::vector<uint8_t> view_values;
+
+public:
+    RecordingStreamer();
+
+    ~RecordingStreamer();
+
+    void setStreamId(const uint32_t id);
+    void setChunkLength(const std::size_t samples);
+    void setChunkInterval(const double seconds);
+    void setCompression(const bool enable);
+    void setPyramid(const bool enable);
+    bool setPyramidFactor(const std::size_t factor);
+
+    uint32_t getStreamId() const;
+
+    //-- Pyramid of everything written so far.
+    const hriPhysio::Stream::RecordingPyramid& getPyramid() const;
+
+    //-- Write out the chunk being gathered.
+    void flush();
+
+    //-- Start reading again from the first sample.
+    void rewind();
+
+    /* ===========================================================================
+    **  Move the read position to the first sample at or after a time.
+    **
+    ** @param time Time point in seconds.
+    **
+    ** @return False if the stream ends before ``time``.
+    ** =========================================================================== */
+    bool seek(const double time);
+
+    bool openInputStream();
+
+    bool openOutputStream();
+
+    // General data streams.
+    void publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps = nullptr);
+    void receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps = nullptr);
+
+    // Special string stream.
+    void publish(const std::string&  buff, const double* timestamps = nullptr);
+    void receive(std::string& buff, double* timestamps = nullptr);
+
+
+private:
+    void writePending(const std::size_t samples);
+
+    //-- The chunk at the read position, nullptr past the end or if it is corrupt.
+    const hriPhysio::Stream::FrameView* currentChunk();
+
+    template<typename T>
+    void pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_RECORDING_STREAMER_H */
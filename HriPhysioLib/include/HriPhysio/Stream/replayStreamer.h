@@ -0,0 +1,88 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_REPLAY_STREAMER_H
+#define HRI_PHYSIO_STREAM_REPLAY_STREAMER_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+#include <HriPhysio/Stream/csvStreamer.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
+#include <HriPhysio/Stream/streamerInterface.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class ReplayStreamer;
+    }
+}
+
+/* ============================================================================
+**  Input-only streamer that plays a recorded session back, releasing each
+**  frame when its last recorded timestamp comes due. The speed scales the
+**  recorded time, and a speed of zero replays as fast as possible. Names
+**  ending in ``.hrec`` are binary recordings, anything else is read as CSV.
+** ============================================================================ */
+class hriPhysio::Stream::ReplayStreamer : public hriPhysio::Stream::StreamerInterface {
+
+private:
+    std::unique_ptr<hriPhysio::Stream::StreamerInterface> source;
+
+    double speed;
+    bool   loop;
+
+    //-- Schedule: recorded time ``first_stamp`` plays at ``start_time``.
+    bool            started;
+    struct timespec start_time;
+    double          first_stamp;
+    double          last_stamp;
+    double          loop_offset;
+
+public:
+    ReplayStreamer();
+
+    ~ReplayStreamer();
+
+    void setSpeed(const double speed);
+    void setLoop(const bool loop);
+
+    double getSpeed() const;
+    bool   getLoop() const;
+
+    bool openInputStream();
+
+    bool openOutputStream();
+
+    // General data streams.
+    void publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps = nullptr);
+    void receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps = nullptr);
+
+    // Special string stream.
+    void publish(const std::string&  buff, const double* timestamps = nullptr);
+    void receive(std::string& buff, double* timestamps = nullptr);
+
+private:
+    //-- Start over at the end of the recording, false if not looping.
+    bool restart();
+
+    //-- Sleep until the (loop adjusted) time ``stamp`` is due.
+    void waitUntil(const double first, const double stamp);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_REPLAY_STREAMER_H */
@@ -0,0 +1,135 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_SHM_STREAMER_H
+#define HRI_PHYSIO_STREAM_SHM_STREAMER_H
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <HriPhysio/Stream/streamerInterface.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class ShmStreamer;
+    }
+}
+
+class hriPhysio::Stream::ShmStreamer : public hriPhysio::Stream::StreamerInterface {
+
+public:
+    /* ============================================================================
+    **  Layout of the shared segment. The header is self-describing, such that a
+    **  reader can validate (or adopt) the dtype, channels and rate of the writer.
+    **  The header is followed by ``num_slots`` slots, each holding up to
+    **  ``slot_samples`` samples of interleaved data and their timestamps.
+    ** ============================================================================ */
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t var_tag;
+        uint32_t element_size;
+        uint64_t num_channels;
+        uint64_t sampling_rate;
+        uint64_t slot_samples;
+        uint64_t slot_bytes;
+        uint64_t num_slots;
+        uint64_t writer_pid;
+
+        //-- Writer publishes the next sequence, readers sleep on ``notify``.
+        alignas(64) std::atomic<uint64_t> write_seq;
+        alignas(64) std::atomic<uint32_t> notify;
+        std::atomic<uint32_t> waiters;
+    };
+
+    struct SlotHeader {
+        std::atomic<uint64_t> seq;
+        uint64_t num_samples;
+    };
+
+    static constexpr uint32_t SEGMENT_MAGIC   = 0x4D485348; // "HSHM"
+    static constexpr uint32_t SEGMENT_VERSION = 2;
+
+private:
+    std::string shm_name;
+    int         shm_fd;
+    std::size_t shm_size;
+    uint8_t*    shm_base;
+
+    SegmentHeader* header;
+
+    //-- Number of frames kept in the ring before the writer laps readers.
+    std::size_t num_slots;
+
+    //-- Next sequence this reader expects.
+    uint64_t read_seq;
+
+    //-- Number of frames dropped because the writer lapped this reader.
+    uint64_t overruns;
+
+public:
+    ShmStreamer();
+
+    ~ShmStreamer();
+
+    void setNumSlots(const std::size_t slots);
+
+    uint64_t getOverruns() const;
+
+    bool openInputStream();
+
+    bool openOutputStream();
+
+    // General data streams.
+    void publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps = nullptr);
+    void receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps = nullptr);
+
+    // Special string stream.
+    void publish(const std::string&  buff, const double* timestamps = nullptr);
+    void receive(std::string& buff, double* timestamps = nullptr);
+
+private:
+    std::size_t getElementSize() const;
+
+    bool mapSegment(const bool create);
+
+    void unmapSegment();
+
+    SlotHeader* getSlot(const uint64_t seq) const;
+
+    double* getSlotTimestamps(SlotHeader* slot) const;
+
+    uint8_t* getSlotData(SlotHeader* slot) const;
+
+    void commitSlot(SlotHeader* slot, const uint64_t seq);
+
+    bool waitForData(const double seconds);
+
+    template<typename T>
+    void pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps);
+
+    template<typename T>
+    void pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_SHM_STREAMER_H */
@@ -0,0 +1,61 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_SOCKET_HELPERS_H
+#define HRI_PHYSIO_STREAM_SOCKET_HELPERS_H
+
+#include <string>
+
+#include <netinet/in.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+
+        /* ============================================================================
+        **  Parse a ``host:port`` stream name into an IPv4 socket address.
+        **    Note: An empty host (``:5000``) resolves to INADDR_ANY.
+        **
+        ** @param name       The stream name to parse.
+        ** @param address    Where the parsed address is written.
+        **
+        ** @return Success/Failure of the parse.
+        ** ============================================================================ */
+        bool parseSocketAddress(const std::string& name, struct sockaddr_in& address);
+
+
+        /* ============================================================================
+        **  Put a descriptor into non-blocking mode.
+        **
+        ** @param fd    The descriptor to modify.
+        **
+        ** @return Success/Failure of the change.
+        ** ============================================================================ */
+        bool setNonBlocking(const int fd);
+
+
+        /* ============================================================================
+        **  Wait until a descriptor is readable (or writable).
+        **
+        ** @param fd         The descriptor to wait on.
+        ** @param seconds    Maximum time to wait.
+        ** @param write      Wait for writability instead of readability.
+        **
+        ** @return true if the descriptor became ready before the timeout.
+        ** ============================================================================ */
+        bool waitDescriptor(const int fd, const double seconds, const bool write=false);
+
+    }
+}
+
+#endif /* HRI_PHYSIO_STREAM_SOCKET_HELPERS_H */
@@ -35,6 +35,7 @@ protected:
     std::size_t frame_length;
     std::size_t num_channels;
     std::size_t sampling_rate;
+    double      timeout;
 
     hriPhysio::varTag var;
 
@@ -44,22 +45,33 @@ protected:
 public:
     StreamerInterface();
 
-    ~StreamerInterface();
+    virtual ~StreamerInterface();
 
     void setName(const std::string name);
     void setDataType(const std::string dtype);
     void setFrameLength(const std::size_t frame_length);
     void setNumChannels(const std::size_t num_channels);
     void setSamplingRate(const std::size_t sampling_rate);
+    void setTimeout(const double seconds);
 
     std::string getName() const;
     std::string getDataType() const;
     std::size_t getFrameLength() const;
     std::size_t getNumChannels() const;
     std::size_t getSamplingRate() const;
+    double      getTimeout() const;
 
     hriPhysio::varTag getVariableTag() const;
 
+    //-- Descriptor that becomes readable when receive has data, or -1 if there is none.
+    virtual int getDescriptor() const;
+
+    //-- True if receive can return data already read, without the descriptor becoming readable.
+    virtual bool hasBuffered() const;
+
+    //-- Send floating point values as scaled integers. False if this stream can not.
+    virtual bool setQuantization(const std::string wire_dtype, const double scale, const double offset);
+
     virtual bool openInputStream() = 0;
     virtual bool openOutputStream() = 0;
 
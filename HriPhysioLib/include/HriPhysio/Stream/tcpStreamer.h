@@ -0,0 +1,147 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_TCP_STREAMER_H
+#define HRI_PHYSIO_STREAM_TCP_STREAMER_H
+
+#include <iostream>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include <HriPhysio/Stream/frameCodec.h>
+#include <HriPhysio/Stream/streamerInterface.h>
+#include <HriPhysio/Stream/socketHelpers.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class TcpStreamer;
+    }
+}
+
+class hriPhysio::Stream::TcpStreamer : public hriPhysio::Stream::StreamerInterface {
+
+private:
+    //-- A connected client of the server, with bytes the kernel did not take yet.
+    struct Client {
+        int fd;
+        std::vector<uint8_t> backlog;
+        std::size_t backlog_offset;
+    };
+
+    int sock_fd;
+    struct sockaddr_in address;
+
+    hriPhysio::Stream::FrameCodec codec;
+
+    //-- Sender (server) state.
+    std::vector<Client> clients;
+    std::vector<uint8_t> batch;
+    std::size_t batch_frames;
+    uint64_t send_seq;
+
+    double latency_bound;
+    std::size_t max_batch;
+    std::size_t max_backlog;
+
+    std::chrono::steady_clock::time_point batch_start;
+    std::chrono::steady_clock::time_point last_publish;
+    double publish_interval;
+
+    //-- Flushes a batch once it is ``latency_bound`` old, even if the
+    //-- publisher went quiet, and retries client backlogs.
+    std::thread flusher;
+    mutable std::mutex flush_mutex;
+    std::condition_variable flush_signal;
+    bool stopping;
+
+    //-- Receiver (client) state.
+    std::vector<uint8_t> recv_buffer;
+    std::size_t recv_begin;
+    std::size_t recv_end;
+    std::chrono::steady_clock::time_point next_connect;
+    std::vector<uint8_t> decode_buffer;
+    std::vector<uint8_t> restore_buffer;
+
+public:
+    TcpStreamer();
+
+    ~TcpStreamer();
+
+    void setLatencyBound(const double seconds);
+    void setMaxBatch(const std::size_t bytes);
+    void setMaxBacklog(const std::size_t bytes);
+    void setCompression(const bool enable);
+    bool setQuantization(const std::string wire_dtype, const double scale, const double offset);
+
+    std::size_t getNumClients() const;
+
+    void flush();
+
+    int getDescriptor() const;
+
+    bool hasBuffered() const;
+
+    bool openInputStream();
+
+    bool openOutputStream();
+
+    // General data streams.
+    void publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps = nullptr);
+    void receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps = nullptr);
+
+    // Special string stream.
+    void publish(const std::string&  buff, const double* timestamps = nullptr);
+    void receive(std::string& buff, double* timestamps = nullptr);
+
+private:
+    bool connectServer(const double seconds);
+
+    void acceptClients();
+
+    uint8_t* reserveFrame(const std::size_t bytes);
+
+    void maybeFlush();
+
+    //-- Write the batch and backlogs out, with ``flush_mutex`` held.
+    void flushBatch();
+
+    void flushLoop();
+
+    bool hasBacklog() const;
+
+    bool writeClient(Client& client);
+
+    bool readSocket(const double seconds);
+
+    bool frontFrame(hriPhysio::Stream::FrameView& view);
+
+    void popFrame(const std::size_t bytes);
+
+    template<typename T>
+    void pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps);
+
+    template<typename T>
+    void pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_TCP_STREAMER_H */
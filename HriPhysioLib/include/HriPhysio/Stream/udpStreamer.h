@@ -0,0 +1,143 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#ifndef HRI_PHYSIO_STREAM_UDP_STREAMER_H
+#define HRI_PHYSIO_STREAM_UDP_STREAMER_H
+
+#include <iostream>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <HriPhysio/Stream/frameCodec.h>
+#include <HriPhysio/Stream/streamerInterface.h>
+#include <HriPhysio/Stream/socketHelpers.h>
+
+#include <HriPhysio/helpers.h>
+
+namespace hriPhysio {
+    namespace Stream {
+        class UdpStreamer;
+    }
+}
+
+class hriPhysio::Stream::UdpStreamer : public hriPhysio::Stream::StreamerInterface {
+
+public:
+    //-- Counters describing the health of an input stream.
+    struct Statistics {
+        uint64_t received   = 0;  // Datagrams read from the socket.
+        uint64_t delivered  = 0;  // Datagrams handed to the caller in order.
+        uint64_t lost       = 0;  // Sequence numbers never seen within the window.
+        uint64_t reordered  = 0;  // Datagrams that arrived behind a later one.
+        uint64_t duplicates = 0;  // Datagrams already delivered or pending.
+        uint64_t malformed  = 0;  // Datagrams that did not match this stream.
+        uint64_t resyncs    = 0;  // Times the sender was taken to have restarted.
+    };
+
+private:
+    int sock_fd;
+    struct sockaddr_in address;
+
+    //-- Tuning knobs.
+    std::size_t max_datagram;
+    std::size_t batch_size;
+    std::size_t reorder_window;
+
+    //-- Sender state, reused between publish calls.
+    hriPhysio::Stream::FrameCodec codec;
+    uint64_t send_seq;
+    std::vector<uint8_t>        send_buffer;
+    std::vector<struct iovec>   send_iov;
+    std::vector<struct mmsghdr> send_msgs;
+
+    //-- Receiver state, reused between receive calls.
+    std::vector<uint8_t>        recv_buffer;
+    std::vector<struct iovec>   recv_iov;
+    std::vector<struct mmsghdr> recv_msgs;
+
+    std::map< uint64_t, std::vector<uint8_t> > pending;
+    std::vector< std::vector<uint8_t> > spare;
+    std::vector<uint8_t> decode_buffer;
+    std::vector<uint8_t> restore_buffer;
+
+    bool     have_expected;
+    uint64_t expected_seq;
+    uint64_t highest_seq;
+
+    Statistics stats;
+
+public:
+    UdpStreamer();
+
+    ~UdpStreamer();
+
+    void setMaxDatagram(const std::size_t bytes);
+    void setBatchSize(const std::size_t datagrams);
+    void setReorderWindow(const std::size_t datagrams);
+    void setCompression(const bool enable);
+    bool setQuantization(const std::string wire_dtype, const double scale, const double offset);
+
+    Statistics getStatistics() const;
+
+    int getDescriptor() const;
+
+    bool hasBuffered() const;
+
+    bool openInputStream();
+
+    bool openOutputStream();
+
+    // General data streams.
+    void publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps = nullptr);
+    void receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps = nullptr);
+
+    // Special string stream.
+    void publish(const std::string&  buff, const double* timestamps = nullptr);
+    void receive(std::string& buff, double* timestamps = nullptr);
+
+    /* ===========================================================================
+    **  Take one datagram as if it was read from the socket. A sequence number
+    **  further behind than the reorder window starts a new session, as when
+    **  the sender restarts and counts from 0 again.
+    **
+    ** @param data    The datagram.
+    ** @param length  Its size in bytes.
+    ** =========================================================================== */
+    void insertDatagram(const uint8_t* data, const std::size_t length);
+
+private:
+    void sendBatch(const std::size_t num_datagrams);
+
+    bool fillPending(const double seconds);
+
+    const std::vector<uint8_t>* frontReady() const;
+
+    void popReady();
+
+    void skipGap();
+
+    template<typename T>
+    void pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps);
+
+    template<typename T>
+    void pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps);
+
+};
+
+#endif /* HRI_PHYSIO_STREAM_UDP_STREAMER_H */
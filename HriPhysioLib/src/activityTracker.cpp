@@ -0,0 +1,280 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/activityTracker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace hriPhysio::Processing;
+
+
+namespace {
+
+    //-- Walking band of the magnitude, in Hz.
+    const double band_centre = 2.0;
+    const double band_width  = 2.5;
+
+    //-- Rate the cadence is estimated at, in Hz.
+    const double cadence_rate = 25.0;
+
+    //-- Step periods looked for, in seconds (240 down to 50 steps a minute).
+    const double shortest_step = 0.25;
+    const double longest_step  = 1.2;
+
+    //-- A step peak must clear this fraction of the running RMS.
+    const double step_threshold = 1.0;
+
+    //-- Seconds the running RMS follows.
+    const double rms_time = 2.0;
+
+    //-- The first autocorrelation peak at least this fraction of the highest
+    //-- is the step, so a stride is not taken instead.
+    const double strong_peak = 0.8;
+
+    //-- Less regular than this is not walking.
+    const double min_regularity = 0.3;
+}
+
+
+void hriPhysio::Processing::vectorMagnitude(const double* source, double* target, const std::size_t numFrames) {
+
+    std::size_t frame = 0;
+
+#if defined(__SSE2__)
+    //-- Two frames are three registers, {x0 y0} {z0 x1} {y1 z1}.
+    for (; frame + 2 <= numFrames; frame += 2) {
+        const double* in = source + 3 * frame;
+
+        const __m128d first  = _mm_loadu_pd(in);
+        const __m128d second = _mm_loadu_pd(in + 2);
+        const __m128d third  = _mm_loadu_pd(in + 4);
+
+        const __m128d a = _mm_mul_pd(first,  first);
+        const __m128d b = _mm_mul_pd(second, second);
+        const __m128d c = _mm_mul_pd(third,  third);
+
+        //-- {x0 y1} + {y0 z1} + {z0 x1}
+        const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_shuffle_pd(a, c, 0), _mm_shuffle_pd(a, c, 3)), b);
+        _mm_storeu_pd(target + frame, _mm_sqrt_pd(sum));
+    }
+#endif
+
+    for (; frame < numFrames; ++frame) {
+        const double* in = source + 3 * frame;
+        target[frame] = std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+    }
+
+    return;
+}
+
+
+ActivityTracker::ActivityTracker(const unsigned int rate, const double epoch, const double gravity,
+                                 const double minStep, const double window) :
+    sampling_rate(rate),
+    epoch(epoch),
+    gravity(gravity),
+    min_step(minStep),
+    band(rate, band_width),
+    factor(std::max<std::size_t>(std::lround(rate / cadence_rate), 1)) {
+
+    decimated.resize(std::max<std::size_t>(std::lround(window * rate / factor), 2));
+
+    this->reset();
+}
+
+
+void ActivityTracker::reset() {
+
+    band.reset();
+    power      = 0.0;
+    before     = 0.0;
+    last       = 0.0;
+    last_stamp = std::numeric_limits<double>::quiet_NaN();
+    last_step  = -std::numeric_limits<double>::infinity();
+
+    epoch_start  = std::numeric_limits<double>::quiet_NaN();
+    epoch_frames = 0;
+    epoch_enmo   = 0.0;
+    epoch_counts = 0.0;
+    epoch_steps  = 0;
+
+    bin_count = 0;
+    bin_sum   = 0.0;
+    std::fill(decimated.begin(), decimated.end(), 0.0);
+    position      = 0;
+    num_decimated = 0;
+
+    return;
+}
+
+
+void ActivityTracker::process(const double* source, const double* stamps, const std::size_t numFrames,
+                              std::vector<ActivityEpoch>& epochs) {
+
+    //-- Magnitude in g less gravity, so the band pass does not ring from 1 g.
+    magnitude.resize(numFrames);
+    filtered.resize(numFrames);
+    vectorMagnitude(source, magnitude.data(), numFrames);
+
+    const double inverse = 1.0 / gravity;
+    for (double& value : magnitude) {
+        value = value * inverse - 1.0;
+    }
+    band.filterContinuous(magnitude.data(), filtered.data(), numFrames, band_centre);
+
+    const double alpha = 1.0 / (rms_time * sampling_rate);
+
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+
+        const double stamp = stamps[frame];
+        if (std::isnan(epoch_start)) {
+            epoch_start = stamp;
+        }
+
+        //-- Close the epoch, and skip ahead whole epochs if the stream did.
+        if (stamp >= epoch_start + epoch) {
+            this->close(epoch_start + epoch, epochs);
+            epoch_start += epoch * std::floor((stamp - epoch_start) / epoch);
+        }
+
+        const double value = filtered[frame];
+        epoch_enmo   += std::max(magnitude[frame], 0.0);
+        epoch_counts += std::abs(value) / sampling_rate;
+        ++epoch_frames;
+
+        power += alpha * (value * value - power);
+
+        //-- The previous value is a step if it is a peak clear of the threshold.
+        const double threshold = std::max(min_step, step_threshold * std::sqrt(power));
+        if (last > before && last >= value && last > threshold && last_stamp - last_step >= shortest_step) {
+            ++epoch_steps;
+            last_step = last_stamp;
+        }
+        before     = last;
+        last       = value;
+        last_stamp = stamp;
+
+        bin_sum += value;
+        if (++bin_count == factor) {
+            decimated[position] = bin_sum / factor;
+            position = (position + 1) % decimated.size();
+            ++num_decimated;
+            bin_sum   = 0.0;
+            bin_count = 0;
+        }
+    }
+
+    return;
+}
+
+
+unsigned int ActivityTracker::getSamplingRate() const {
+    return this->sampling_rate;
+}
+
+
+void ActivityTracker::close(const double end, std::vector<ActivityEpoch>& epochs) {
+
+    ActivityEpoch summary;
+    summary.time  = end;
+    summary.steps = epoch_steps;
+    if (epoch_frames != 0) {
+        summary.intensity = epoch_enmo / epoch_frames;
+        summary.counts    = epoch_counts;
+    }
+    summary.cadence = this->cadence(summary.regularity);
+    epochs.push_back(summary);
+
+    epoch_frames = 0;
+    epoch_enmo   = 0.0;
+    epoch_counts = 0.0;
+    epoch_steps  = 0;
+
+    return;
+}
+
+
+double ActivityTracker::cadence(double& regularity) {
+
+    regularity = 0.0;
+
+    const std::size_t length = decimated.size();
+    if (num_decimated < length) {
+        return 0.0;
+    }
+
+    //-- Oldest first, without its mean.
+    ordered.resize(length);
+    double mean = 0.0;
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        ordered[idx] = decimated[(position + idx) % length];
+        mean += ordered[idx];
+    }
+    mean /= length;
+
+    double energy = 0.0;
+    for (double& value : ordered) {
+        value  -= mean;
+        energy += value * value;
+    }
+
+    //-- Too still to be walking.
+    if (energy / length < 0.5 * min_step * min_step) {
+        return 0.0;
+    }
+
+    //-- Normalised autocorrelation at the step lags, and one either side.
+    const double rate = static_cast<double>(sampling_rate) / factor;
+    const std::size_t lowest  = static_cast<std::size_t>(std::max(std::floor(shortest_step * rate) - 1.0, 1.0));
+    const std::size_t highest = std::min(static_cast<std::size_t>(std::ceil(longest_step * rate) + 1.0), length - 1);
+    if (highest < lowest + 2) {
+        return 0.0;
+    }
+
+    correlation.assign(highest - lowest + 1, 0.0);
+    for (std::size_t lag = lowest; lag <= highest; ++lag) {
+        double sum = 0.0;
+        for (std::size_t idx = 0; idx + lag < length; ++idx) {
+            sum += ordered[idx] * ordered[idx + lag];
+        }
+        correlation[lag - lowest] = (sum / (length - lag)) / (energy / length);
+    }
+
+    double top = 0.0;
+    for (std::size_t idx = 1; idx + 1 < correlation.size(); ++idx) {
+        if (correlation[idx] > correlation[idx - 1] && correlation[idx] >= correlation[idx + 1]) {
+            top = std::max(top, correlation[idx]);
+        }
+    }
+
+    for (std::size_t idx = 1; idx + 1 < correlation.size() && top > 0.0; ++idx) {
+        if (correlation[idx] > correlation[idx - 1] && correlation[idx] >= correlation[idx + 1] && correlation[idx] >= strong_peak * top) {
+
+            regularity = correlation[idx];
+            if (regularity < min_regularity) {
+                return 0.0;
+            }
+
+            const double curve  = correlation[idx - 1] - 2.0 * correlation[idx] + correlation[idx + 1];
+            const double offset = (curve < 0.0) ? 0.5 * (correlation[idx - 1] - correlation[idx + 1]) / curve : 0.0;
+            return 60.0 * rate / (lowest + idx + offset);
+        }
+    }
+
+    return 0.0;
+}
@@ -0,0 +1,527 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Manager/batchProcessor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include <HriPhysio/Processing/butterworthBandNoch.h>
+#include <HriPhysio/Processing/butterworthBandPass.h>
+#include <HriPhysio/Processing/butterworthHighPass.h>
+#include <HriPhysio/Processing/butterworthLowPass.h>
+#include <HriPhysio/Processing/rPeakDetector.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
+
+using namespace hriPhysio::Manager;
+
+
+namespace {
+
+    //-- Columns of the feature tables, by group.
+    const std::vector<std::string> time_names      = { "mean_rr", "sdnn", "rmssd", "pnn50", "mean_hr" };
+    const std::vector<std::string> nonlinear_names = { "sd1", "sd2", "sd1_sd2", "sampen", "apen", "dfa_alpha1", "dfa_alpha2" };
+    const std::vector<std::string> frequency_names = { "vlf", "lf", "hf", "lf_hf", "lf_nu", "hf_nu" };
+
+    //-- Appended to a session's file name for its feature table.
+    const std::string table_suffix = ".features.csv";
+    const std::string summary_name = "summary.csv";
+
+
+    const std::vector<std::string>& groupNames(const std::string& group) {
+        if (group == "time") {
+            return time_names;
+        } else if (group == "nonlinear") {
+            return nonlinear_names;
+        }
+        return frequency_names;
+    }
+
+
+    double aggregate(std::vector<double> values, const std::string& stat) {
+
+        //-- An entropy without matches is infinite, a DFA of too few beats
+        //-- is NaN, leave those out.
+        values.erase(std::remove_if(values.begin(), values.end(), [](double value) { return !std::isfinite(value); }), values.end());
+        if (values.empty()) {
+            return std::nan("");
+        }
+
+        if (stat == "min") { return *std::min_element(values.begin(), values.end()); }
+        if (stat == "max") { return *std::max_element(values.begin(), values.end()); }
+
+        if (stat == "median") {
+            const std::size_t half = values.size() / 2;
+            std::nth_element(values.begin(), values.begin() + half, values.end());
+            if (values.size() % 2 == 1) { return values[half]; }
+            return 0.5 * (values[half] + *std::max_element(values.begin(), values.begin() + half));
+        }
+
+        double sum = 0.0;
+        for (const double value : values) { sum += value; }
+        const double mean = sum / values.size();
+        if (stat == "mean") { return mean; }
+
+        //-- "std", sample standard deviation.
+        if (values.size() < 2) { return 0.0; }
+        double squares = 0.0;
+        for (const double value : values) { squares += (value - mean) * (value - mean); }
+        return std::sqrt(squares / (values.size() - 1));
+    }
+
+
+    std::unique_ptr<hriPhysio::Processing::Biquadratic> makeFilter(const std::string& type, const unsigned int rate, const double width) {
+        if (type == "lowpass")  { return std::make_unique<hriPhysio::Processing::ButterworthLowPass> (rate); }
+        if (type == "highpass") { return std::make_unique<hriPhysio::Processing::ButterworthHighPass>(rate); }
+        if (type == "bandpass") { return std::make_unique<hriPhysio::Processing::ButterworthBandPass>(rate, width); }
+        return std::make_unique<hriPhysio::Processing::ButterworthBandNoch>(rate, width);
+    }
+}
+
+
+BatchProcessor::BatchProcessor() :
+    dtype("double"),
+    num_channels(1),
+    channel(0),
+    stream_id(0),
+    sampling_rate(0.0),
+    read_frame(4096),
+    num_threads(0),
+    inverted_lead(false),
+    correct_rr(false),
+    rr_method(hriPhysio::Processing::RRArtifactCorrector::Method::Malik),
+    rr_low(300.0),
+    rr_high(2000.0),
+    rr_max_gap(5),
+    window(0.0),
+    step(0.0) {
+}
+
+
+BatchProcessor::~BatchProcessor() {
+}
+
+
+bool BatchProcessor::configure(const std::string yaml_file) {
+
+    //-- Load the yaml file.
+    YAML::Node config = YAML::LoadFile(yaml_file);
+
+    //-- Parameters about the recorded data.
+    dtype         = config[ "dtype"         ].as<std::string>( /*default=*/ "double");
+    num_channels  = config[ "num_channels"  ].as<std::size_t>( /*default=*/ 1       );
+    channel       = config[ "channel"       ].as<std::size_t>( /*default=*/ 0       );
+    stream_id     = config[ "stream_id"     ].as<uint32_t>(    /*default=*/ 0       );
+    sampling_rate = config[ "sampling_rate" ].as<double>(      /*default=*/ 0.0     );
+    read_frame    = config[ "read_frame"    ].as<std::size_t>( /*default=*/ 4096    );
+    num_threads   = config[ "threads"       ].as<std::size_t>( /*default=*/ 0       );
+
+    if (channel >= num_channels) {
+        std::cerr << "[ERROR] Channel " << channel << " is not one of the " << num_channels << " channels!!" << std::endl;
+        return false;
+    }
+
+    //-- Stages, filters first, then R peaks, artifacts, HRV and aggregates.
+    filters.clear();
+    inverted_lead = false;
+    stats.clear();
+    groups = { "time" };
+    correct_rr = false;
+    window = step = 0.0;
+
+    enum { FILTERS, PEAKS, ARTIFACTS, HRV, AGGREGATE } reached = FILTERS;
+    for (const YAML::Node& node : config["pipeline"]) {
+
+        std::string stage = node["stage"].as<std::string>( /*default=*/ "");
+        hriPhysio::toLower(stage);
+
+        if (stage == "lowpass" || stage == "highpass" || stage == "bandpass" || stage == "notch") {
+            if (reached != FILTERS) {
+                std::cerr << "[ERROR] Filter ``" << stage << "`` must come before the R peaks!!" << std::endl;
+                return false;
+            }
+            filters.push_back({ stage, node["frequency"].as<double>(), node["width"].as<double>( /*default=*/ 0.0) });
+
+        } else if (stage == "rpeaks" && reached == FILTERS) {
+            inverted_lead = node["inverted"].as<bool>( /*default=*/ false);
+            reached = PEAKS;
+
+        } else if (stage == "artifacts" && reached == PEAKS) {
+            const std::string method = node["method"].as<std::string>( /*default=*/ "malik");
+            if (!hriPhysio::Processing::RRArtifactCorrector::parseMethod(method, rr_method)) {
+                std::cerr << "[ERROR] Unknown artifact method ``" << method << "``!!" << std::endl;
+                return false;
+            }
+            rr_low     = node["low"    ].as<double>(      /*default=*/ 300.0  );
+            rr_high    = node["high"   ].as<double>(      /*default=*/ 2000.0 );
+            rr_max_gap = node["max_gap"].as<std::size_t>( /*default=*/ 5      );
+            correct_rr = true;
+            reached = ARTIFACTS;
+
+        } else if (stage == "hrv" && (reached == PEAKS || reached == ARTIFACTS)) {
+            window = node["window"].as<double>( /*default=*/ 0.0    );
+            step   = node["step"  ].as<double>( /*default=*/ window );
+            groups = node["features"].as<std::vector<std::string>>( /*default=*/ groups);
+            for (std::string& group : groups) {
+                hriPhysio::toLower(group);
+                if (group != "time" && group != "nonlinear" && group != "frequency") {
+                    std::cerr << "[ERROR] Unknown feature group ``" << group << "``!!" << std::endl;
+                    return false;
+                }
+            }
+            reached = HRV;
+
+        } else if (stage == "aggregate" && reached != FILTERS && reached != AGGREGATE) {
+            stats = node["stats"].as<std::vector<std::string>>( /*default=*/ std::vector<std::string>{ "mean", "std" });
+            for (std::string& stat : stats) {
+                hriPhysio::toLower(stat);
+                if (stat != "mean" && stat != "std" && stat != "min" && stat != "max" && stat != "median") {
+                    std::cerr << "[ERROR] Unknown aggregate ``" << stat << "``!!" << std::endl;
+                    return false;
+                }
+            }
+            reached = AGGREGATE;
+
+        } else {
+            std::cerr << "[ERROR] Stage ``" << stage << "`` is unknown or out of order!!" << std::endl;
+            return false;
+        }
+    }
+
+    if (reached == FILTERS) {
+        std::cerr << "[ERROR] The pipeline has no ``rpeaks`` stage!!" << std::endl;
+        return false;
+    }
+
+    feature_names.clear();
+    for (const std::string& group : groups) {
+        const std::vector<std::string>& names = groupNames(group);
+        feature_names.insert(feature_names.end(), names.begin(), names.end());
+    }
+
+    if (window > 0.0 && step <= 0.0) {
+        std::cerr << "[ERROR] HRV windows need a positive step!!" << std::endl;
+        return false;
+    }
+
+    std::cerr << "[CONF] Load complete.\n";
+
+    return true;
+}
+
+
+void BatchProcessor::setNumThreads(const std::size_t threads) {
+    this->num_threads = threads;
+    return;
+}
+
+
+std::vector<std::string> BatchProcessor::findSessions(const std::string& directory) {
+
+    std::vector<std::string> sessions;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        const std::string name      = entry.path().filename().string();
+        const std::string extension = entry.path().extension().string();
+
+        //-- The tables and summary of an earlier run are not sessions.
+        const bool table = name == summary_name || (name.size() > table_suffix.size() &&
+                           name.compare(name.size() - table_suffix.size(), table_suffix.size(), table_suffix) == 0);
+
+        if (entry.is_regular_file() && !table && (extension == ".hrec" || extension == ".csv")) {
+            sessions.push_back(entry.path().string());
+        }
+    }
+
+    if (error) {
+        std::cerr << "[ERROR] Could not list ``" << directory << "``: " << error.message() << "!!" << std::endl;
+    }
+
+    std::sort(sessions.begin(), sessions.end());
+
+    return sessions;
+}
+
+
+std::vector<BatchProcessor::Session> BatchProcessor::run(const std::vector<std::string>& sessions, const std::string& output_dir) {
+
+    std::vector<Session> results(sessions.size());
+    for (std::size_t idx = 0; idx < sessions.size(); ++idx) {
+        results[idx].path = sessions[idx];
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(output_dir, error);
+    if (error) {
+        std::cerr << "[ERROR] Could not create ``" << output_dir << "``: " << error.message() << "!!" << std::endl;
+        return results;
+    }
+
+    //-- The tables and summary must not land beside, or over, the recordings.
+    for (const std::string& session : sessions) {
+        std::filesystem::path parent = std::filesystem::path(session).parent_path();
+        if (parent.empty()) {
+            parent = ".";
+        }
+        if (std::filesystem::equivalent(parent, output_dir, error)) {
+            std::cerr << "[ERROR] The output directory ``" << output_dir << "`` holds the session ``" << session << "``, choose another!!" << std::endl;
+            return results;
+        }
+    }
+
+    //-- One session per thread at a time, so memory is bounded by the pool size.
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for (std::size_t idx = next++; idx < results.size(); idx = next++) {
+            results[idx].ok = this->process(results[idx], output_dir);
+        }
+    };
+
+    std::size_t threads = (num_threads != 0) ? num_threads : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    threads = std::max<std::size_t>(std::min(threads, results.size()), 1);
+
+    std::vector<std::thread> pool;
+    for (std::size_t idx = 1; idx < threads; ++idx) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    this->writeSummary(results, output_dir);
+
+    return results;
+}
+
+
+bool BatchProcessor::process(Session& session, const std::string& output_dir) {
+
+    const std::filesystem::path path(session.path);
+    const bool binary = (path.extension() == ".hrec");
+
+    std::unique_ptr<hriPhysio::Stream::StreamerInterface> input(hriPhysio::Stream::makeLogger(binary ? "hrec" : "csv"));
+    input->setName(session.path);
+    input->setDataType(dtype);
+    input->setNumChannels(num_channels);
+    input->setFrameLength(read_frame);
+
+    if (binary) {
+        static_cast<hriPhysio::Stream::RecordingStreamer*>(input.get())->setStreamId(stream_id);
+    }
+
+    if (!input->openInputStream()) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << "[WARNING] Skipping ``" << session.path << "``, it could not be opened." << std::endl;
+        return false;
+    }
+
+    std::vector<std::unique_ptr<hriPhysio::Processing::Biquadratic>> chain;
+    std::unique_ptr<hriPhysio::Processing::RPeakDetector> detector;
+
+    std::vector<hriPhysio::varType> buff;
+    std::vector<double> stamps, signal, peaks;
+    bool started = false;
+
+    while (true) {
+
+        input->receive(buff, &stamps);
+        const std::size_t samples = stamps.size();
+        if (samples == 0) {
+            break;
+        }
+
+        //-- The filters need the rate, estimated from the first frame if not configured.
+        if (!started) {
+            double rate = sampling_rate;
+            if (rate <= 0.0 && samples > 1 && stamps.back() > stamps.front()) {
+                rate = (samples - 1) / (stamps.back() - stamps.front());
+            }
+            if (rate <= 0.0) {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::cerr << "[WARNING] Skipping ``" << session.path << "``, its sampling rate is unknown." << std::endl;
+                return false;
+            }
+
+            const unsigned int rounded = static_cast<unsigned int>(std::lround(rate));
+            for (const FilterStage& stage : filters) {
+                chain.push_back(makeFilter(stage.type, rounded, stage.width));
+            }
+            detector = std::make_unique<hriPhysio::Processing::RPeakDetector>(rounded, inverted_lead);
+
+            session.start = stamps.front();
+            started = true;
+        }
+        session.end = stamps.back();
+
+        const std::size_t channels = buff.size() / samples;
+        if (channel >= channels) {
+            std::lock_guard<std::mutex> lock(log_mutex);
+            std::cerr << "[WARNING] Skipping ``" << session.path << "``, it has no channel " << channel << "." << std::endl;
+            return false;
+        }
+
+        signal.resize(samples);
+        for (std::size_t idx = 0; idx < samples; ++idx) {
+            signal[idx] = std::visit([](auto value) { return static_cast<double>(value); }, buff[idx * channels + channel]);
+        }
+
+        for (std::size_t idx = 0; idx < chain.size(); ++idx) {
+            chain[idx]->filterContinuous(signal.data(), signal.data(), samples, filters[idx].frequency);
+        }
+
+        detector->process(signal.data(), stamps.data(), samples, peaks);
+    }
+
+    if (!started) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << "[WARNING] Skipping ``" << session.path << "``, it holds no samples." << std::endl;
+        return false;
+    }
+
+    //-- Interval ``idx`` runs from ``peaks[idx]`` to ``peaks[idx + 1]``.
+    std::vector<double> intervals = hriPhysio::Processing::rrIntervals(peaks);
+    if (correct_rr) {
+        hriPhysio::Processing::RRArtifactCorrector corrector(rr_method, rr_low, rr_high, rr_max_gap);
+        std::vector<double> nn;
+        corrector.process(intervals.data(), intervals.size(), nn);
+        corrector.flush(nn);
+        session.corrected = corrector.getNumCorrected();
+        intervals.swap(nn);
+    }
+
+    session.beats = peaks.size();
+    this->features(intervals, session.overall);
+
+    //-- Windows of beats, or the whole session as one.
+    const double width   = (window > 0.0) ? window : (session.end - session.start);
+    const double advance = (window > 0.0) ? step   : std::numeric_limits<double>::infinity();
+
+    const std::filesystem::path table = std::filesystem::path(output_dir) / (path.filename().string() + table_suffix);
+    std::ofstream output(table);
+    if (!output.is_open()) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << "[ERROR] Could not open ``" << table.string() << "``!!" << std::endl;
+        return false;
+    }
+
+    output << "start,end,intervals";
+    for (const std::string& name : feature_names) { output << "," << name; }
+    output << "\n" << std::setprecision(10);
+
+    std::vector<std::vector<double>> columns(feature_names.size());
+    std::vector<double> window_intervals, row;
+
+    for (double begin = session.start; begin <= session.end; begin += advance) {
+
+        //-- The intervals between the peaks inside the window.
+        const std::size_t first = std::lower_bound(peaks.begin(), peaks.end(), begin) - peaks.begin();
+        const std::size_t last  = std::lower_bound(peaks.begin() + first, peaks.end(), begin + width) - peaks.begin();
+        window_intervals.clear();
+        if (last > first + 1) {
+            window_intervals.assign(intervals.begin() + first, intervals.begin() + (last - 1));
+        }
+
+        this->features(window_intervals, row);
+
+        output << begin << "," << begin + width << "," << window_intervals.size();
+        for (std::size_t idx = 0; idx < feature_names.size(); ++idx) {
+            output << "," << row[idx];
+            if (window_intervals.size() >= 2) {
+                columns[idx].push_back(row[idx]);
+            }
+        }
+        output << "\n";
+    }
+
+    output.close();
+    if (!output) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << "[ERROR] Could not write ``" << table.string() << "``!!" << std::endl;
+        return false;
+    }
+
+    for (std::size_t idx = 0; idx < feature_names.size(); ++idx) {
+        for (const std::string& stat : stats) {
+            session.aggregates.push_back(aggregate(columns[idx], stat));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::cerr << "[BATCH] " << session.path << ": " << session.beats << " beats, "
+              << session.corrected << " intervals corrected." << std::endl;
+
+    return true;
+}
+
+
+void BatchProcessor::features(const std::vector<double>& intervals, std::vector<double>& row) const {
+
+    row.clear();
+    for (const std::string& group : groups) {
+        if (group == "time") {
+            const hriPhysio::Processing::HrvTimeDomain time = hriPhysio::Processing::hrvTimeDomain(intervals);
+            row.insert(row.end(), { time.mean_rr, time.sdnn, time.rmssd, time.pnn50, time.mean_hr });
+        } else if (group == "nonlinear") {
+            const hriPhysio::Processing::HrvNonlinear nonlinear = hriPhysio::Processing::hrvNonlinear(intervals);
+            row.insert(row.end(), { nonlinear.sd1, nonlinear.sd2, nonlinear.sd1_sd2, nonlinear.sampen, nonlinear.apen,
+                                    nonlinear.dfa_alpha1, nonlinear.dfa_alpha2 });
+        } else {
+            const hriPhysio::Processing::HrvFrequency frequency = hriPhysio::Processing::hrvFrequency(intervals);
+            row.insert(row.end(), { frequency.vlf, frequency.lf, frequency.hf, frequency.lf_hf, frequency.lf_nu, frequency.hf_nu });
+        }
+    }
+
+    return;
+}
+
+
+void BatchProcessor::writeSummary(const std::vector<Session>& sessions, const std::string& output_dir) const {
+
+    const std::filesystem::path path = std::filesystem::path(output_dir) / summary_name;
+    std::ofstream output(path);
+
+    output << "session,duration,beats,corrected";
+    for (const std::string& name : feature_names) { output << "," << name; }
+    for (const std::string& name : feature_names) {
+        for (const std::string& stat : stats) { output << "," << name << "_" << stat; }
+    }
+    output << "\n" << std::setprecision(10);
+
+    for (const Session& session : sessions) {
+        if (!session.ok) { continue; }
+
+        output << std::filesystem::path(session.path).filename().string() << ","
+               << session.end - session.start << "," << session.beats << "," << session.corrected;
+        for (const double value : session.overall) {
+            output << "," << value;
+        }
+        for (const double value : session.aggregates) {
+            output << "," << value;
+        }
+        output << "\n";
+    }
+
+    if (!output) {
+        std::cerr << "[ERROR] Could not write ``" << path.string() << "``!!" << std::endl;
+    }
+
+    return;
+}
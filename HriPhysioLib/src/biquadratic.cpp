@@ -18,7 +18,8 @@ using namespace hriPhysio::Processing;
 Biquadratic::Biquadratic(const unsigned int rate, const double width/*=0.0*/) : 
     sampling_rate(rate),
     band_width(width),
-    center_frequency(0.0) {
+    center_frequency(0.0),
+    x1(0.0), x2(0.0), y1(0.0), y2(0.0) {
     
 }
 
@@ -37,6 +38,38 @@ void Biquadratic::filter(const double* source, double* target, const std::size_t
 }
 
 
+void Biquadratic::filterContinuous(const double* source, double* target, const std::size_t numSamples, const double freq) {
+
+    if (center_frequency != freq) {
+        updateCoefficients(freq);
+        center_frequency = freq;
+    }
+
+    //-- Same transformation as below, picking up where the last block ended.
+    for (std::size_t sample = 0; sample < numSamples; sample++) {
+
+        const double x0 = source[sample];
+        const double y0 = (a0*x0 + a1*x1 + a2*x2) - (b2*y2 + b1*y1);
+
+        x2 = x1; x1 = x0;
+        y2 = y1; y1 = y0;
+
+        target[sample] = y0;
+    }
+
+    return;
+}
+
+
+void Biquadratic::reset() {
+
+    x1 = x2 = 0.0;
+    y1 = y2 = 0.0;
+
+    return;
+}
+
+
 void Biquadratic::setSamplingRate(const unsigned int rate) {
     
     sampling_rate = rate;
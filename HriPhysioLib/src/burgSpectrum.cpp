@@ -0,0 +1,189 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/burgSpectrum.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace hriPhysio::Processing;
+
+
+BurgSpectrum::BurgSpectrum(const std::size_t maxOrder) :
+    max_order(maxOrder),
+    correlation(1, 1.0),
+    variance(0.0) {
+}
+
+
+bool BurgSpectrum::fit(const double* source, const std::size_t numSamples) {
+
+    coefficients.clear();
+    correlation.assign(1, 1.0);
+    variance = 0.0;
+
+    if (numSamples < 3) {
+        return false;
+    }
+
+    const std::size_t n = numSamples;
+
+    double mean = 0.0;
+    for (std::size_t idx = 0; idx < n; ++idx) {
+        mean += source[idx];
+    }
+    mean /= n;
+
+    forward.resize(n);
+    backward.resize(n);
+    double energy = 0.0;
+    for (std::size_t idx = 0; idx < n; ++idx) {
+        forward[idx] = backward[idx] = source[idx] - mean;
+        energy += forward[idx] * forward[idx];
+    }
+    if (energy <= 0.0) {
+        return false;
+    }
+
+    const std::size_t orders = std::min(max_order, n - 2);
+    current.assign(orders + 1, 0.0);
+    current[0] = 1.0;
+
+    //-- Order zero, white noise.
+    double error = energy / n;
+    double denominator = 2.0 * energy - forward[0] * forward[0] - forward[n - 1] * forward[n - 1];
+    double best = n * std::log(error);
+    variance = error;
+
+    double numerator = 0.0;
+    for (std::size_t idx = 0; idx + 1 < n; ++idx) {
+        numerator += forward[idx + 1] * backward[idx];
+    }
+
+    for (std::size_t k = 0; k < orders && denominator > 0.0; ++k) {
+
+        //-- Reflection coefficient.
+        const double mu = -2.0 * numerator / denominator;
+
+        //-- Levinson update of the polynomial.
+        for (std::size_t idx = 0; idx <= (k + 1) / 2; ++idx) {
+            const double lhs = current[idx]         + mu * current[k + 1 - idx];
+            const double rhs = current[k + 1 - idx] + mu * current[idx];
+            current[idx]         = lhs;
+            current[k + 1 - idx] = rhs;
+        }
+
+        //-- Prediction errors in place, and in the same pass the numerator
+        //-- of the next order, which pairs f[i + k + 2] with b[i].
+        numerator = 0.0;
+        double last = 0.0;
+        for (std::size_t idx = 0; idx + k + 1 < n; ++idx) {
+            const double f = forward[idx + k + 1] + mu * backward[idx];
+            const double b = backward[idx] + mu * forward[idx + k + 1];
+            forward[idx + k + 1] = f;
+            backward[idx]        = b;
+            numerator += f * last;
+            last = b;
+        }
+
+        error *= (1.0 - mu * mu);
+        denominator = (1.0 - mu * mu) * denominator
+                    - forward[k + 1] * forward[k + 1]
+                    - backward[n - k - 2] * backward[n - k - 2];
+
+        //-- Keep the order with the smallest AIC.
+        const std::size_t order = k + 1;
+        const double aic = n * std::log(error) + 2.0 * order;
+        if (aic < best) {
+            best = aic;
+            variance = error;
+            coefficients.assign(current.begin() + 1, current.begin() + 1 + order);
+        }
+    }
+
+    //-- |A(w)|^2 = c_0 + 2 sum c_k cos(k w).
+    const std::size_t order = coefficients.size();
+    correlation.assign(order + 1, 0.0);
+    for (std::size_t lag = 0; lag <= order; ++lag) {
+        double total = (lag == 0) ? 1.0 : coefficients[lag - 1];
+        for (std::size_t idx = 0; idx + lag < order; ++idx) {
+            total += coefficients[idx] * coefficients[idx + lag];
+        }
+        correlation[lag] = total;
+    }
+
+    return true;
+}
+
+
+double BurgSpectrum::density(const double freq, const double rate) const {
+    return 2.0 * variance / rate / this->response(std::cos(2.0 * M_PI * freq / rate));
+}
+
+
+double BurgSpectrum::bandPower(const double low, const double high, const double rate, const double resolution) const {
+
+    if (high <= low || variance <= 0.0) {
+        return 0.0;
+    }
+
+    const std::size_t steps = std::max<std::size_t>(static_cast<std::size_t>(std::ceil((high - low) / resolution)), 1);
+    const double width = (high - low) / steps;
+
+    //-- Step the cosine along the grid, cos(w + d) = 2 cos(d) cos(w) - cos(w - d).
+    const double omega = 2.0 * M_PI * low / rate;
+    const double delta = 2.0 * M_PI * width / rate;
+    const double twice = 2.0 * std::cos(delta);
+
+    double previous = std::cos(omega - delta);
+    double cosine   = std::cos(omega);
+
+    double power = 0.5 / this->response(cosine);
+    for (std::size_t idx = 1; idx < steps; ++idx) {
+        const double following = twice * cosine - previous;
+        previous = cosine;
+        cosine   = following;
+        power += 1.0 / this->response(cosine);
+    }
+    power += 0.5 / this->response(std::cos(2.0 * M_PI * high / rate));
+
+    return 2.0 * variance / rate * power * width;
+}
+
+
+std::size_t BurgSpectrum::getOrder() const {
+    return coefficients.size();
+}
+
+
+const std::vector<double>& BurgSpectrum::getCoefficients() const {
+    return coefficients;
+}
+
+
+double BurgSpectrum::getVariance() const {
+    return variance;
+}
+
+
+double BurgSpectrum::response(const double cosine) const {
+
+    //-- Clenshaw's recurrence over the Chebyshev series in cos(w).
+    double next = 0.0, after = 0.0;
+    for (std::size_t lag = correlation.size() - 1; lag > 0; --lag) {
+        const double value = 2.0 * correlation[lag] + 2.0 * cosine * next - after;
+        after = next;
+        next  = value;
+    }
+
+    return correlation[0] + cosine * next - after;
+}
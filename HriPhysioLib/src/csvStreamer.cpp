@@ -12,25 +12,163 @@
 
 #include <HriPhysio/Stream/csvStreamer.h>
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace hriPhysio::Stream;
 
 
+namespace {
+
+    //-- Widest a single formatted number can get, with its separator.
+    constexpr std::size_t max_cell = 32;
+
+    template<typename T>
+    char* writeNumber(char* target, const T value) {
+        //-- Chars are logged as numbers, not as raw bytes.
+        if constexpr (std::is_same_v<T, char>) {
+            return std::to_chars(target, target + max_cell, static_cast<int>(value)).ptr;
+        } else {
+            return std::to_chars(target, target + max_cell, value).ptr;
+        }
+    }
+
+
+    //-- Find the next ',' or '\n' in [begin, end), or end.
+    const char* findDelimiter(const char* begin, const char* end) {
+
+#if defined(__SSE2__)
+        //-- Sixteen bytes at a time.
+        const __m128i comma   = _mm_set1_epi8(',');
+        const __m128i newline = _mm_set1_epi8('\n');
+        while (begin + 16 <= end) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, comma), _mm_cmpeq_epi8(block, newline)));
+            if (mask != 0) {
+                return begin + __builtin_ctz(mask);
+            }
+            begin += 16;
+        }
+#endif
+
+        while (begin < end && *begin != ',' && *begin != '\n') {
+            ++begin;
+        }
+        return begin;
+    }
+
+
+    const char* findNewline(const char* begin, const char* end) {
+        const void* found = std::memchr(begin, '\n', end - begin);
+        return (found != nullptr) ? static_cast<const char*>(found) : end;
+    }
+
+
+    //-- Read the cell at ``begin``, false if it is not a number up to its delimiter.
+    template<typename T>
+    const char* readNumber(const char* begin, const char* end, T& value, bool& valid) {
+        std::from_chars_result result;
+        if constexpr (std::is_same_v<T, char>) {
+            int wide = 0;
+            result = std::from_chars(begin, end, wide);
+            value  = static_cast<char>(wide);
+        } else {
+            result = std::from_chars(begin, end, value);
+        }
+
+        //-- Empty or garbled cells read as zero, skip to the next delimiter.
+        valid = result.ec == std::errc() && (result.ptr == end || *result.ptr == ',' || *result.ptr == '\n' || *result.ptr == '\r');
+        if (!valid) {
+            value = T(0);
+            return findDelimiter(begin, end);
+        }
+        return result.ptr;
+    }
+}
+
+
 CsvStreamer::CsvStreamer() : 
-    StreamerInterface() {
+    StreamerInterface(),
+    map_data(nullptr),
+    map_size(0),
+    map_begin(0),
+    map_offset(0),
+    bad_cells(0),
+    converted_cells(0),
+    sys_second(0),
+    out_used(0),
+    flush_bytes(1 << 20),
+    flush_interval(1.0) {
 
 }
 
 
 CsvStreamer::~CsvStreamer() {
 
-    if (this->mode == modeTag::RECEIVER) {
-        input.close();
+    if (this->mode == modeTag::RECEIVER && map_data != nullptr) {
+        munmap(const_cast<char*>(map_data), map_size);
+        map_data = nullptr;
     } else if (this->mode == modeTag::SENDER) {
+        this->flush();
         output.close();
     }
 }
 
 
+void CsvStreamer::setFlushThreshold(const std::size_t bytes) {
+    this->flush_bytes = bytes;
+    return;
+}
+
+
+void CsvStreamer::setFlushInterval(const double seconds) {
+    this->flush_interval = seconds;
+    return;
+}
+
+
+void CsvStreamer::rewind() {
+    this->map_offset = this->map_begin;
+    this->bad_cells  = 0;
+    return;
+}
+
+
+std::size_t CsvStreamer::getBadCells() const {
+    return this->bad_cells;
+}
+
+
+std::size_t CsvStreamer::getConvertedCells() const {
+    return this->converted_cells;
+}
+
+
+void CsvStreamer::flush() {
+
+    if (out_used > 0) {
+        output.write(out_buffer.data(), out_used);
+        out_used = 0;
+    }
+    output.flush();
+
+    last_flush = std::chrono::steady_clock::now();
+
+    return;
+}
+
+
 //lsl::channel_format_t LslStreamer::getLslFormatType() {
 //
 //    lsl::channel_format_t cf_type;
@@ -73,8 +211,44 @@ bool CsvStreamer::openInputStream() {
 
     try {
 
-        //-- Open the specified file for reading from.
-        input.open(this->name);
+        //-- Map the specified file for reading from.
+        const int fd = open(this->name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "[ERROR] Could not open ``" << this->name << "``: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            std::cerr << "[ERROR] CSV file ``" << this->name << "`` is empty!!" << std::endl;
+            close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "[ERROR] Could not map ``" << this->name << "``: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        map_data = static_cast<const char*>(mapped);
+        map_size = info.st_size;
+        madvise(mapped, map_size, MADV_SEQUENTIAL);
+
+        //-- Skip the header, counting its channel columns if none were given.
+        const char* end    = map_data + map_size;
+        const char* header = findNewline(map_data, end);
+        if (this->num_channels == 0) {
+            std::size_t columns = 1;
+            for (const char* cursor = map_data; cursor < header; ++cursor) {
+                columns += (*cursor == ',');
+            }
+            this->num_channels = (columns > 2) ? columns - 2 : 1;
+        }
+
+        map_begin  = std::min<std::size_t>(header - map_data + 1, map_size);
+        map_offset = map_begin;
 
 	} catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
 
@@ -108,6 +282,9 @@ bool CsvStreamer::openOutputStream() {
     
     output << std::endl;
 
+    out_buffer.resize(flush_bytes + 4096);
+    last_flush = std::chrono::steady_clock::now();
+
 
     return true;
 }
@@ -141,22 +318,29 @@ void CsvStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const st
 
 void CsvStreamer::publish(const std::string& buff, const double* timestamps/*=nullptr*/) {
 
+    this->updateSystemTime();
+
+    char* target = this->reserveOutput(sys_time.size() + max_cell + buff.size() + 4);
+
     //-- "System Time" 
-    std::time_t t = std::time(nullptr);
-    output << std::put_time(std::localtime(&t), "%Y/%m/%d_%H:%M:%S") << ",";
+    std::memcpy(target, sys_time.data(), sys_time.size());
+    target += sys_time.size();
 
     //-- "Internal Time"
-    if (timestamps == nullptr) {
-        output << 0.0;
-    } else {
-        output << std::setprecision(10) << (*timestamps);
-    } 
+    target = writeNumber<double>(target, (timestamps == nullptr) ? 0.0 : *timestamps);
 
     //-- Data.
-    output << "," << "\"" << buff << "\"";
+    *target++ = ',';
+    *target++ = '"';
+    std::memcpy(target, buff.data(), buff.size());
+    target += buff.size();
+    *target++ = '"';
 
     //-- Move to the next line.
-    output << std::endl;
+    *target++ = '\n';
+
+    out_used = target - out_buffer.data();
+    this->maybeFlush();
 
     return;
 }
@@ -164,8 +348,6 @@ void CsvStreamer::publish(const std::string& buff, const double* timestamps/*=nu
 
 void CsvStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
 
-    std::cerr << "[CSV-IN] READING FROM: " << this->dtype << " ";
-
     switch (this->var) {
     case hriPhysio::varTag::CHAR:
         this->pullStream<char>(buff, timestamps);
@@ -192,7 +374,76 @@ void CsvStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<dou
 
 
 void CsvStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
-    
+
+    buff.clear();
+
+    double stamp = 0.0;
+    const char* cursor = this->beginRow(stamp);
+    if (cursor == nullptr) { return; }
+
+    //-- The rest of the line, without its quotes.
+    const char* end = findNewline(cursor, map_data + map_size);
+    const char* last = end;
+    if (last > cursor && last[-1] == '\r') { --last; }
+    if (last - cursor >= 2 && *cursor == '"' && last[-1] == '"') {
+        ++cursor;
+        --last;
+    }
+    buff.assign(cursor, last);
+
+    if (timestamps != nullptr) { *timestamps = stamp; }
+
+    this->endRow(end);
+
+    return;
+}
+
+
+void CsvStreamer::updateSystemTime() {
+
+    //-- Formatting the wall clock is slow, only redo it when the second changes.
+    const std::time_t now = std::time(nullptr);
+    if (now == sys_second && !sys_time.empty()) {
+        return;
+    }
+
+    std::tm local;
+    localtime_r(&now, &local);
+
+    char text[32];
+    const std::size_t length = std::strftime(text, sizeof(text), "%Y/%m/%d_%H:%M:%S,", &local);
+
+    sys_time.assign(text, length);
+    sys_second = now;
+
+    return;
+}
+
+
+char* CsvStreamer::reserveOutput(const std::size_t bytes) {
+
+    //-- Write out what is pending rather than growing past the threshold.
+    if (out_used + bytes > out_buffer.size()) {
+        if (out_used > 0) {
+            output.write(out_buffer.data(), out_used);
+            out_used = 0;
+        }
+        if (bytes > out_buffer.size()) {
+            out_buffer.resize(bytes);
+        }
+    }
+
+    return out_buffer.data() + out_used;
+}
+
+
+void CsvStreamer::maybeFlush() {
+
+    const auto now = std::chrono::steady_clock::now();
+    if (out_used >= flush_bytes || std::chrono::duration<double>(now - last_flush).count() >= flush_interval) {
+        this->flush();
+    }
+
     return;
 }
 
@@ -200,43 +451,46 @@ void CsvStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
 template<typename T>
 void CsvStreamer::pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps) {
 
-    //TODO: Should put in some error catching here for buff and timestamp.
-    //      buff should logically be the length of timestamps by the num channels.
+    if (this->num_channels == 0) { return; }
+
+    this->updateSystemTime();
 
-    std::time_t t = std::time(nullptr);
+    const std::size_t channels    = this->num_channels;
+    const std::size_t num_samples = buff.size() / channels;
+    const std::size_t num_stamps  = (timestamps != nullptr) ? timestamps->size() : 0;
+    const std::size_t row_bytes   = sys_time.size() + (channels + 1) * max_cell + 1;
 
-    std::size_t idx_buff = 0;
-    std::size_t idx_time = 0;
+    for (std::size_t idx = 0; idx < num_samples; ++idx) {
 
-    //std::cerr << "buff len: " << buff.size() << "  ts len: " << timestamps->size();
-    //if (timestamps->size() == 0) { std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!"; }
-    //std::cerr << std::endl;
+        char* target = this->reserveOutput(row_bytes);
 
-    while (idx_buff < buff.size()) {
-        
         //-- "System Time" 
-        output << std::put_time(std::localtime(&t), "%Y/%m/%d_%H:%M:%S") << ",";
+        std::memcpy(target, sys_time.data(), sys_time.size());
+        target += sys_time.size();
 
         //-- "Internal Time"
-        if (timestamps == nullptr) {
-            output << 0.0;
-        } else if (timestamps->size() == 0) {
-            output << 0.0;
-        } else {
-            output << std::setprecision(10) << timestamps->at(idx_time);
-            ++idx_time;
-        } 
+        target = writeNumber<double>(target, (idx < num_stamps) ? (*timestamps)[idx] : 0.0);
 
         //-- "Channels"
-        for (std::size_t ch = 0; ch < this->num_channels; ++ch) {
-            output << "," << std::get<T>( buff[idx_buff + ch] );
+        const hriPhysio::varType* row = buff.data() + idx * channels;
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            *target++ = ',';
+            if (const T* value = std::get_if<T>(&row[ch])) {
+                target = writeNumber<T>(target, *value);
+            } else {
+                this->convertedCell();
+                target = writeNumber<T>(target, std::visit([](auto other) { return static_cast<T>(other); }, row[ch]));
+            }
         }
-        idx_buff += this->num_channels;
 
         //-- Move to the next line.
-        output << std::endl;
+        *target++ = '\n';
+
+        out_used = target - out_buffer.data();
     }
 
+    this->maybeFlush();
+
     return;
 }
 
@@ -244,15 +498,108 @@ void CsvStreamer::pushStream(const std::vector<hriPhysio::varType>&  buff, const
 template<typename T>
 void CsvStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
 
-    //std::vector<T> samples;
-    //
-    ////-- Pull a multiplexed chunk into a flat vector.
-    //inlet->pull_chunk_multiplexed(samples, timestamps, 1.0);
-    //
-    ////-- Copy the data into the buffer.
-    //for (std::size_t idx = 0; idx < samples.size(); ++idx) {
-    //    buff[idx] = samples[idx];
-    //}
+    buff.clear();
+    if (timestamps != nullptr) { timestamps->clear(); }
+
+    if (map_data == nullptr || this->num_channels == 0) { return; }
+
+    const std::size_t channels = this->num_channels;
+    const std::size_t limit    = std::max<std::size_t>(this->frame_length, 1);
+    const char*       end      = map_data + map_size;
+
+    buff.reserve(limit * channels);
+
+    for (std::size_t row = 0; row < limit; ++row) {
+
+        double stamp = 0.0;
+        const char* cursor = this->beginRow(stamp);
+        if (cursor == nullptr) { break; }
+
+        //-- "Channels", from_chars stops on the delimiter by itself.
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            T    value = T(0);
+            bool valid = false;
+            if (cursor < end && *cursor != '\n' && *cursor != '\r') {
+                cursor = readNumber<T>(cursor, end, value, valid);
+                if (cursor < end && *cursor == ',') { ++cursor; }
+            }
+            if (!valid) { this->badCell(); }
+            buff.push_back(value);
+        }
+
+        if (timestamps != nullptr) { timestamps->push_back(stamp); }
+
+        this->endRow(cursor);
+    }
+
+    return;
+}
+
+
+const char* CsvStreamer::beginRow(double& timestamp) {
+
+    if (map_data == nullptr) { return nullptr; }
+
+    const char* end = map_data + map_size;
+    const char* cursor = nullptr;
+
+    //-- "System Time" is not needed, jump over it. Lines without columns are skipped.
+    while (true) {
+        if (map_offset >= map_size) {
+            return nullptr;
+        }
+
+        cursor = findDelimiter(map_data + map_offset, end);
+        if (cursor < end && *cursor == ',') {
+            break;
+        }
+
+        map_offset = std::min<std::size_t>(cursor - map_data + 1, map_size);
+    }
+
+    //-- "Internal Time"
+    bool valid = false;
+    cursor = readNumber<double>(cursor + 1, end, timestamp, valid);
+    if (!valid) { this->badCell(); }
+    if (cursor < end && *cursor == ',') { ++cursor; }
+
+    return cursor;
+}
+
+
+void CsvStreamer::endRow(const char* cursor) {
+
+    const char* end = map_data + map_size;
+    if (cursor < end && *cursor != '\n') {
+        cursor = findNewline(cursor, end);
+    }
+
+    map_offset = std::min<std::size_t>(cursor - map_data + 1, map_size);
+
+    return;
+}
+
+
+void CsvStreamer::badCell() {
+
+    //-- One warning per pass over the file, the rest are only counted.
+    if (bad_cells++ == 0) {
+        const std::size_t line = std::count(map_data, map_data + map_offset, '\n') + 1;
+        std::cerr << "[WARNING] CSV file ``" << this->name << "`` has an empty or unreadable cell on line "
+                  << line << ", reading it as 0." << std::endl;
+    }
+
+    return;
+}
+
+
+void CsvStreamer::convertedCell() {
+
+    //-- One warning per file, the rest are only counted.
+    if (converted_cells++ == 0) {
+        std::cerr << "[WARNING] CSV file ``" << this->name << "`` was given values that are not ``"
+                  << this->dtype << "``, converting them." << std::endl;
+    }
 
     return;
 }
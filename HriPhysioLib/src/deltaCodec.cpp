@@ -0,0 +1,526 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/deltaCodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <HriPhysio/Stream/frameCodec.h>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    constexpr std::size_t block = DeltaCodec::block_size;
+
+    //-- Residuals of the channel being worked on, reused between calls.
+    thread_local std::vector<uint64_t> first_order;
+    thread_local std::vector<uint64_t> second_order;
+
+
+    uint64_t zigzag(const int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+
+    int64_t unzigzag(const uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+
+    unsigned bitWidth(const uint64_t value) {
+        return value ? 64 - __builtin_clzll(value) : 0;
+    }
+
+
+    std::size_t varintSize(uint64_t value) {
+        std::size_t bytes = 1;
+        while (value >= 0x80) { value >>= 7; ++bytes; }
+        return bytes;
+    }
+
+
+    uint8_t* putVarint(uint8_t* target, uint64_t value) {
+        while (value >= 0x80) {
+            *target++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *target++ = static_cast<uint8_t>(value);
+        return target;
+    }
+
+
+    bool getVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) { return false; }
+            const uint8_t byte = *cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) { return true; }
+        }
+        return false;
+    }
+
+
+    template<typename T>
+    uint64_t toBits(const T value) {
+        if constexpr (sizeof(T) == sizeof(uint32_t)) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            return bits;
+        } else {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            return bits;
+        }
+    }
+
+
+    template<typename T>
+    T fromBits(const uint64_t bits) {
+        T value;
+        if constexpr (sizeof(T) == sizeof(uint32_t)) {
+            const uint32_t narrow = static_cast<uint32_t>(bits);
+            std::memcpy(&value, &narrow, sizeof(T));
+        } else {
+            std::memcpy(&value, &bits, sizeof(T));
+        }
+        return value;
+    }
+
+
+    unsigned blockWidth(const uint64_t* values, const std::size_t count) {
+        uint64_t any = 0;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            any |= values[idx];
+        }
+        return bitWidth(any);
+    }
+
+
+    //-- Width byte plus the packed residuals. Wider than 32 bits is stored as is.
+    std::size_t blockBytes(const std::size_t count, const unsigned width) {
+        if (width > 32)     { return 1 + count * sizeof(uint64_t); }
+        if (count == block) { return 1 + width * block / 8; }
+        return 1 + (count * width + 7) / 8;
+    }
+
+
+    std::size_t residualBytes(const uint64_t* residuals, const std::size_t count) {
+        std::size_t total = 0;
+        for (std::size_t start = 0; start < count; start += block) {
+            const std::size_t size = std::min(block, count - start);
+            total += blockBytes(size, blockWidth(residuals + start, size));
+        }
+        return total;
+    }
+
+
+    //-- Value ``row * 4 + lane`` sits at bit ``row * width`` of its lane, lanes interleave by 32-bit word.
+    void packLanes(const uint64_t* values, const unsigned width, uint8_t* target) {
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            uint64_t acc  = 0;
+            unsigned bits = 0;
+            std::size_t word = 0;
+            for (std::size_t row = 0; row < block / 4; ++row) {
+                acc  |= values[row * 4 + lane] << bits;
+                bits += width;
+                if (bits >= 32) {
+                    const uint32_t out = static_cast<uint32_t>(acc);
+                    std::memcpy(target + (word * 4 + lane) * sizeof(uint32_t), &out, sizeof(uint32_t));
+                    ++word;
+                    acc  >>= 32;
+                    bits  -= 32;
+                }
+            }
+        }
+    }
+
+
+    void unpackLanes(const uint8_t* source, const unsigned width, uint32_t* values) {
+
+#if defined(__SSE2__)
+        //-- All four lanes at once, every row shifts by the same amount.
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(width == 32 ? 0xFFFFFFFFu : (1u << width) - 1));
+        const __m128i* cursor = reinterpret_cast<const __m128i*>(source);
+        __m128i word = _mm_loadu_si128(cursor++);
+        unsigned shift = 0;
+
+        for (std::size_t row = 0; row < block / 4; ++row) {
+            __m128i value = _mm_srl_epi32(word, _mm_cvtsi32_si128(shift));
+            const unsigned used = 32 - shift;
+            shift += width;
+            if (shift > 32) {
+                word  = _mm_loadu_si128(cursor++);
+                value = _mm_or_si128(value, _mm_sll_epi32(word, _mm_cvtsi32_si128(used)));
+                shift -= 32;
+            } else if (shift == 32) {
+                if (row + 1 < block / 4) { word = _mm_loadu_si128(cursor++); }
+                shift = 0;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values + row * 4), _mm_and_si128(value, mask));
+        }
+#else
+        const uint64_t mask = (uint64_t(1) << width) - 1;
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            uint64_t acc  = 0;
+            unsigned bits = 0;
+            std::size_t word = 0;
+            for (std::size_t row = 0; row < block / 4; ++row) {
+                if (bits < width) {
+                    uint32_t in;
+                    std::memcpy(&in, source + (word * 4 + lane) * sizeof(uint32_t), sizeof(uint32_t));
+                    acc  |= uint64_t(in) << bits;
+                    bits += 32;
+                    ++word;
+                }
+                values[row * 4 + lane] = static_cast<uint32_t>(acc & mask);
+                acc  >>= width;
+                bits  -= width;
+            }
+        }
+#endif
+    }
+
+
+    //-- Short blocks are packed back to back, least significant bit first.
+    uint8_t* packTail(const uint64_t* values, const std::size_t count, const unsigned width, uint8_t* target) {
+        uint64_t acc  = 0;
+        unsigned bits = 0;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            acc  |= values[idx] << bits;
+            bits += width;
+            while (bits >= 8) {
+                *target++ = static_cast<uint8_t>(acc);
+                acc  >>= 8;
+                bits  -= 8;
+            }
+        }
+        if (bits > 0) {
+            *target++ = static_cast<uint8_t>(acc);
+        }
+        return target;
+    }
+
+
+    void unpackTail(const uint8_t* source, const std::size_t count, const unsigned width, uint64_t* values) {
+        const uint64_t mask = (uint64_t(1) << width) - 1;
+        uint64_t acc  = 0;
+        unsigned bits = 0;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            while (bits < width) {
+                acc  |= uint64_t(*source++) << bits;
+                bits += 8;
+            }
+            values[idx] = acc & mask;
+            acc  >>= width;
+            bits  -= width;
+        }
+    }
+
+
+    uint8_t* packResiduals(const uint64_t* residuals, const std::size_t count, uint8_t* target) {
+
+        for (std::size_t start = 0; start < count; start += block) {
+            const std::size_t size  = std::min(block, count - start);
+            const unsigned    width = blockWidth(residuals + start, size);
+
+            *target++ = static_cast<uint8_t>(width);
+            if (width > 32) {
+                std::memcpy(target, residuals + start, size * sizeof(uint64_t));
+                target += size * sizeof(uint64_t);
+            } else if (size == block) {
+                if (width > 0) { packLanes(residuals + start, width, target); }
+                target += width * block / 8;
+            } else {
+                target = packTail(residuals + start, size, width, target);
+            }
+        }
+
+        return target;
+    }
+
+
+    bool unpackResiduals(const uint8_t*& cursor, const uint8_t* end, const std::size_t count, uint64_t* residuals) {
+
+        alignas(16) uint32_t lanes[block];
+
+        for (std::size_t start = 0; start < count; start += block) {
+            const std::size_t size = std::min(block, count - start);
+            if (cursor == end) { return false; }
+
+            const unsigned width = *cursor++;
+            if (width > 64 || static_cast<std::size_t>(end - cursor) < blockBytes(size, width) - 1) {
+                return false;
+            }
+
+            if (width > 32) {
+                std::memcpy(residuals + start, cursor, size * sizeof(uint64_t));
+            } else if (size == block) {
+                if (width == 0) {
+                    std::fill(residuals + start, residuals + start + size, 0);
+                } else {
+                    unpackLanes(cursor, width, lanes);
+                    std::copy(lanes, lanes + block, residuals + start);
+                }
+            } else {
+                unpackTail(cursor, size, width, residuals + start);
+            }
+            cursor += blockBytes(size, width) - 1;
+        }
+
+        return true;
+    }
+
+
+    template<typename T>
+    bool isIntegral(const T* values, const std::size_t stride, const std::size_t count) {
+
+        if constexpr (std::is_floating_point_v<T>) {
+            //-- Exactly representable as int64, and not negative zero.
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                const T value = values[idx * stride];
+                if (!(std::fabs(value) < T(9007199254740992.0)) || value != std::trunc(value) ||
+                    (value == T(0) && std::signbit(value))) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    template<typename T>
+    uint8_t* encodeChannel(const T* values, const std::size_t stride, const std::size_t count, uint8_t* target) {
+
+        //-- Raw is what every other mode has to beat.
+        std::size_t best_bytes = 1 + count * sizeof(T);
+        uint8_t     best_mode  = DeltaCodec::RAW;
+
+        const bool integral = isIntegral(values, stride, count);
+        const auto integer  = [values, stride](const std::size_t idx) {
+            return static_cast<uint64_t>(static_cast<int64_t>(values[idx * stride]));
+        };
+
+        if (count > 1) {
+            first_order.resize(count - 1);
+            second_order.resize(count > 2 ? count - 2 : 0);
+        }
+
+        if (count > 1 && integral) {
+
+            //-- Wrapping arithmetic, any int64 sequence round trips.
+            for (std::size_t idx = 1; idx < count; ++idx) {
+                first_order[idx - 1] = zigzag(static_cast<int64_t>(integer(idx) - integer(idx - 1)));
+            }
+            for (std::size_t idx = 2; idx < count; ++idx) {
+                second_order[idx - 2] = zigzag(static_cast<int64_t>(integer(idx) - 2 * integer(idx - 1) + integer(idx - 2)));
+            }
+
+            const std::size_t head  = 1 + varintSize(zigzag(static_cast<int64_t>(integer(0))));
+            const std::size_t delta = head + residualBytes(first_order.data(), count - 1);
+            const std::size_t curve = head + varintSize(first_order[0]) + residualBytes(second_order.data(), count - 2);
+
+            const uint8_t flag = std::is_floating_point_v<T> ? DeltaCodec::INTEGRAL : 0;
+            if (delta < best_bytes) { best_bytes = delta; best_mode = DeltaCodec::DELTA          | flag; }
+            if (curve < best_bytes) { best_bytes = curve; best_mode = DeltaCodec::DELTA_OF_DELTA | flag; }
+
+        } else if (count > 1) {
+
+            if constexpr (std::is_floating_point_v<T>) {
+                for (std::size_t idx = 1; idx < count; ++idx) {
+                    first_order[idx - 1] = toBits(values[idx * stride]) ^ toBits(values[(idx - 1) * stride]);
+                }
+
+                const std::size_t bytes = 1 + sizeof(T) + residualBytes(first_order.data(), count - 1);
+                if (bytes < best_bytes) { best_bytes = bytes; best_mode = DeltaCodec::XOR; }
+            }
+        }
+
+        *target++ = best_mode;
+
+        switch (best_mode & ~DeltaCodec::INTEGRAL) {
+        case DeltaCodec::DELTA:
+            target = putVarint(target, zigzag(static_cast<int64_t>(integer(0))));
+            return packResiduals(first_order.data(), count - 1, target);
+
+        case DeltaCodec::DELTA_OF_DELTA:
+            target = putVarint(target, zigzag(static_cast<int64_t>(integer(0))));
+            target = putVarint(target, first_order[0]);
+            return packResiduals(second_order.data(), count - 2, target);
+
+        case DeltaCodec::XOR:
+            std::memcpy(target, &values[0], sizeof(T));
+            return packResiduals(first_order.data(), count - 1, target + sizeof(T));
+
+        default:
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                std::memcpy(target + idx * sizeof(T), &values[idx * stride], sizeof(T));
+            }
+            return target + count * sizeof(T);
+        }
+    }
+
+
+    template<typename T>
+    bool decodeChannel(const uint8_t*& cursor, const uint8_t* end, T* target, const std::size_t stride, const std::size_t count) {
+
+        if (cursor == end) { return false; }
+        const uint8_t mode = *cursor++;
+
+        if (mode == DeltaCodec::RAW) {
+            if (static_cast<std::size_t>(end - cursor) < count * sizeof(T)) { return false; }
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                std::memcpy(&target[idx * stride], cursor + idx * sizeof(T), sizeof(T));
+            }
+            cursor += count * sizeof(T);
+            return true;
+        }
+
+        if (count < 2) { return false; }
+        first_order.resize(count);
+
+        if (mode == DeltaCodec::XOR) {
+            if constexpr (std::is_floating_point_v<T>) {
+                if (static_cast<std::size_t>(end - cursor) < sizeof(T)) { return false; }
+                std::memcpy(&target[0], cursor, sizeof(T));
+                uint64_t bits = toBits(target[0]);
+                cursor += sizeof(T);
+
+                if (!unpackResiduals(cursor, end, count - 1, first_order.data())) { return false; }
+                for (std::size_t idx = 1; idx < count; ++idx) {
+                    bits ^= first_order[idx - 1];
+                    target[idx * stride] = fromBits<T>(bits);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        const uint8_t base = mode & ~DeltaCodec::INTEGRAL;
+        if (base != DeltaCodec::DELTA && base != DeltaCodec::DELTA_OF_DELTA) { return false; }
+
+        uint64_t first = 0;
+        if (!getVarint(cursor, end, first)) { return false; }
+        uint64_t previous = static_cast<uint64_t>(unzigzag(first));
+
+        const auto emit = [target, stride](const std::size_t idx, const uint64_t value) {
+            target[idx * stride] = static_cast<T>(static_cast<int64_t>(value));
+        };
+        emit(0, previous);
+
+        if (base == DeltaCodec::DELTA) {
+            if (!unpackResiduals(cursor, end, count - 1, first_order.data())) { return false; }
+            for (std::size_t idx = 1; idx < count; ++idx) {
+                previous += static_cast<uint64_t>(unzigzag(first_order[idx - 1]));
+                emit(idx, previous);
+            }
+            return true;
+        }
+
+        uint64_t step = 0;
+        if (!getVarint(cursor, end, step)) { return false; }
+        uint64_t current = previous + static_cast<uint64_t>(unzigzag(step));
+        emit(1, current);
+
+        if (!unpackResiduals(cursor, end, count - 2, first_order.data())) { return false; }
+        for (std::size_t idx = 2; idx < count; ++idx) {
+            const uint64_t next = 2 * current - previous + static_cast<uint64_t>(unzigzag(first_order[idx - 2]));
+            previous = current;
+            current  = next;
+            emit(idx, current);
+        }
+
+        return true;
+    }
+}
+
+
+std::size_t DeltaCodec::maxEncodedSize(const hriPhysio::varTag var, const std::size_t num_channels, const std::size_t num_samples) {
+    return num_channels * (1 + num_samples * FrameCodec::elementSize(var));
+}
+
+
+template<typename T>
+std::size_t DeltaCodec::encode(const T* values, const std::size_t num_channels, const std::size_t num_samples, uint8_t* target) {
+
+    uint8_t* cursor = target;
+    for (std::size_t ch = 0; ch < num_channels; ++ch) {
+        cursor = encodeChannel(values + ch, num_channels, num_samples, cursor);
+    }
+
+    return cursor - target;
+}
+
+
+template<typename T>
+bool DeltaCodec::decode(const uint8_t* data, const std::size_t length, const std::size_t num_channels,
+                        const std::size_t num_samples, T* target) {
+
+    const uint8_t* cursor = data;
+    const uint8_t* end    = data + length;
+    for (std::size_t ch = 0; ch < num_channels; ++ch) {
+        if (!decodeChannel(cursor, end, target + ch, num_channels, num_samples)) {
+            return false;
+        }
+    }
+
+    return cursor == end;
+}
+
+
+bool DeltaCodec::decode(const hriPhysio::varTag var, const uint8_t* data, const std::size_t length,
+                        const std::size_t num_channels, const std::size_t num_samples, void* target) {
+
+    switch (var) {
+    case hriPhysio::varTag::CHAR:
+        return decode<char>(data, length, num_channels, num_samples, static_cast<char*>(target));
+    case hriPhysio::varTag::INT16:
+        return decode<int16_t>(data, length, num_channels, num_samples, static_cast<int16_t*>(target));
+    case hriPhysio::varTag::INT32:
+        return decode<int32_t>(data, length, num_channels, num_samples, static_cast<int32_t*>(target));
+    case hriPhysio::varTag::INT64:
+    case hriPhysio::varTag::LONGLONG:
+        return decode<int64_t>(data, length, num_channels, num_samples, static_cast<int64_t*>(target));
+    case hriPhysio::varTag::FLOAT:
+        return decode<float>(data, length, num_channels, num_samples, static_cast<float*>(target));
+    case hriPhysio::varTag::DOUBLE:
+        return decode<double>(data, length, num_channels, num_samples, static_cast<double*>(target));
+    default:
+        return false;
+    }
+}
+
+
+template std::size_t DeltaCodec::encode<char>   (const char*,    const std::size_t, const std::size_t, uint8_t*);
+template std::size_t DeltaCodec::encode<int16_t>(const int16_t*, const std::size_t, const std::size_t, uint8_t*);
+template std::size_t DeltaCodec::encode<int32_t>(const int32_t*, const std::size_t, const std::size_t, uint8_t*);
+template std::size_t DeltaCodec::encode<int64_t>(const int64_t*, const std::size_t, const std::size_t, uint8_t*);
+template std::size_t DeltaCodec::encode<float>  (const float*,   const std::size_t, const std::size_t, uint8_t*);
+template std::size_t DeltaCodec::encode<double> (const double*,  const std::size_t, const std::size_t, uint8_t*);
+
+template bool DeltaCodec::decode<char>   (const uint8_t*, const std::size_t, const std::size_t, const std::size_t, char*);
+template bool DeltaCodec::decode<int16_t>(const uint8_t*, const std::size_t, const std::size_t, const std::size_t, int16_t*);
+template bool DeltaCodec::decode<int32_t>(const uint8_t*, const std::size_t, const std::size_t, const std::size_t, int32_t*);
+template bool DeltaCodec::decode<int64_t>(const uint8_t*, const std::size_t, const std::size_t, const std::size_t, int64_t*);
+template bool DeltaCodec::decode<float>  (const uint8_t*, const std::size_t, const std::size_t, const std::size_t, float*);
+template bool DeltaCodec::decode<double> (const uint8_t*, const std::size_t, const std::size_t, const std::size_t, double*);
@@ -0,0 +1,208 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/detrendedFluctuation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+using namespace hriPhysio::Processing;
+
+
+namespace {
+
+    //-- Values an unbounded series first rebuilds at, then each time it doubles.
+    const std::size_t first_rebuild = 256;
+}
+
+
+DetrendedFluctuation::DetrendedFluctuation(const std::size_t capacity, const std::size_t threads) :
+    capacity(capacity),
+    num_threads(threads) {
+
+    this->reset();
+}
+
+
+void DetrendedFluctuation::reset() {
+
+    values.clear();
+    sum.assign(1, 0.0);
+    weighted.assign(1, 0.0);
+    squares.assign(1, 0.0);
+
+    reference  = std::numeric_limits<double>::quiet_NaN();
+    profile    = 0.0;
+    rebuild_at = (capacity != 0) ? 2 * capacity : first_rebuild;
+
+    return;
+}
+
+
+void DetrendedFluctuation::push(const double* source, const std::size_t numValues) {
+
+    for (std::size_t idx = 0; idx < numValues; ++idx) {
+
+        if (std::isnan(reference)) {
+            reference = source[idx];
+        }
+
+        const double index = static_cast<double>(values.size());
+        profile += source[idx] - reference;
+
+        values.push_back(source[idx]);
+        sum.push_back(sum.back() + profile);
+        weighted.push_back(weighted.back() + index * profile);
+        squares.push_back(squares.back() + profile * profile);
+
+        if (values.size() >= rebuild_at) {
+            this->rebuild();
+        }
+    }
+
+    return;
+}
+
+
+double DetrendedFluctuation::fluctuation(const std::size_t scale) const {
+
+    const std::size_t length = this->size();
+    if (scale < 2 || length < 2 * scale) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //-- Moments of the box index t = 0 .. n-1, the same for every box.
+    const double n     = static_cast<double>(scale);
+    const double t_sum = n * (n - 1.0) / 2.0;
+    const double t_var = n * (n * n - 1.0) / 12.0;   //-- sum of (t - mean)^2
+
+    const std::size_t start = values.size() - length;
+    const std::size_t boxes = length / scale;
+
+    double residuals = 0.0;
+    for (std::size_t box = 0; box < boxes; ++box) {
+
+        const std::size_t begin = start + box * scale;
+        const std::size_t end   = begin + scale;
+
+        const double y_sum  = sum[end]     - sum[begin];
+        const double ty_sum = weighted[end] - weighted[begin] - begin * y_sum;
+        const double yy_sum = squares[end] - squares[begin];
+
+        //-- What is left of sum of (y - mean)^2 after the best line.
+        const double ty_cov = ty_sum - t_sum * y_sum / n;
+        const double y_var  = yy_sum - y_sum * y_sum / n;
+        residuals += std::max(y_var - ty_cov * ty_cov / t_var, 0.0);
+    }
+
+    return std::sqrt(residuals / (boxes * n));
+}
+
+
+double DetrendedFluctuation::alpha(const std::size_t minScale, const std::size_t maxScale) const {
+
+    const std::size_t lowest  = std::max<std::size_t>(minScale, 2);
+    const std::size_t highest = std::min(maxScale, this->size() / 2);
+    if (highest < lowest + 1) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //-- Scales are independent, share them out.
+    const std::size_t count = highest - lowest + 1;
+    std::vector<double> logs(count);
+    std::atomic<std::size_t> next(0);
+
+    auto worker = [&]() {
+        for (std::size_t item = next++; item < count; item = next++) {
+            logs[item] = std::log(this->fluctuation(lowest + item));
+        }
+    };
+
+    std::size_t threads = (num_threads != 0) ? num_threads : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    threads = std::max<std::size_t>(std::min(threads, count), 1);
+
+    std::vector<std::thread> pool;
+    for (std::size_t idx = 1; idx < threads; ++idx) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    //-- Least squares slope of log F(n) against log n.
+    double x_mean = 0.0, y_mean = 0.0;
+    std::size_t usable = 0;
+    for (std::size_t item = 0; item < count; ++item) {
+        if (std::isfinite(logs[item])) {
+            x_mean += std::log(static_cast<double>(lowest + item));
+            y_mean += logs[item];
+            ++usable;
+        }
+    }
+    if (usable < 2) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    x_mean /= usable;
+    y_mean /= usable;
+
+    double covariance = 0.0, variance = 0.0;
+    for (std::size_t item = 0; item < count; ++item) {
+        if (std::isfinite(logs[item])) {
+            const double x = std::log(static_cast<double>(lowest + item)) - x_mean;
+            covariance += x * (logs[item] - y_mean);
+            variance   += x * x;
+        }
+    }
+
+    return covariance / variance;
+}
+
+
+void DetrendedFluctuation::setNumThreads(const std::size_t threads) {
+    this->num_threads = threads;
+    return;
+}
+
+
+std::size_t DetrendedFluctuation::size() const {
+    return (capacity != 0) ? std::min(values.size(), capacity) : values.size();
+}
+
+
+void DetrendedFluctuation::rebuild() {
+
+    //-- Keep the window, integrated again around its own mean.
+    if (capacity != 0) {
+        values.erase(values.begin(), values.end() - capacity);
+    }
+
+    double mean = 0.0;
+    for (const double value : values) {
+        mean += value;
+    }
+    mean /= values.size();
+
+    const std::vector<double> window(values);
+
+    this->reset();
+    reference = mean;
+    if (capacity == 0) {
+        rebuild_at = 2 * window.size();
+    }
+    this->push(window.data(), window.size());
+
+    return;
+}
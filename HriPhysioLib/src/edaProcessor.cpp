@@ -0,0 +1,189 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/edaProcessor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace hriPhysio::Processing;
+
+
+EdaProcessor::Channel::Channel(const unsigned int rate) :
+    smoother(rate),
+    baseline(0.0),
+    rising(false),
+    previous(std::numeric_limits<double>::infinity()),
+    extreme(0.0),
+    extreme_time(0.0),
+    peak_level(0.0),
+    onset(std::numeric_limits<double>::infinity()),
+    onset_time(0.0),
+    onset_level(0.0) {
+}
+
+
+EdaProcessor::EdaProcessor(const unsigned int rate, const std::size_t numChannels, const double window,
+                           const double minAmplitude, const double cutoff) :
+    sampling_rate(rate),
+    num_channels(std::max<std::size_t>(numChannels, 1)),
+    min_amplitude(minAmplitude),
+    cutoff(cutoff),
+    length(std::max<std::size_t>(std::lround(window * rate), 1)) {
+
+    if (cutoff >= rate / 2.0) {
+        std::cerr << "[WARNING] EDA smoothing at " << cutoff << " Hz is above the Nyquist rate, skipping it." << std::endl;
+        this->cutoff = 0.0;
+    }
+
+    this->reset();
+}
+
+
+void EdaProcessor::reset() {
+
+    channels.clear();
+    for (std::size_t idx = 0; idx < num_channels; ++idx) {
+        channels.emplace_back(sampling_rate);
+        channels.back().recent.assign(length, 0.0);
+        channels.back().sorted.reserve(length);
+    }
+
+    position = 0;
+    num_seen = 0;
+
+    return;
+}
+
+
+void EdaProcessor::process(const double* source, const double* stamps, const std::size_t numFrames,
+                           std::vector<double>& tonic, std::vector<double>& phasic,
+                           std::vector<SkinConductanceResponse>& responses) {
+
+    if (numFrames == 0) {
+        return;
+    }
+
+    //-- Smooth each channel as one contiguous block. The first sample is
+    //-- taken out so the filter does not ring while rising from zero.
+    scratch.resize(numFrames);
+    smoothed.resize(numFrames * num_channels);
+    for (std::size_t ch = 0; ch < num_channels; ++ch) {
+
+        Channel& channel = channels[ch];
+        if (num_seen == 0) {
+            channel.baseline = source[ch];
+        }
+
+        for (std::size_t frame = 0; frame < numFrames; ++frame) {
+            scratch[frame] = source[frame * num_channels + ch] - channel.baseline;
+        }
+        if (cutoff > 0.0) {
+            channel.smoother.filterContinuous(scratch.data(), scratch.data(), numFrames, cutoff);
+        }
+        for (std::size_t frame = 0; frame < numFrames; ++frame) {
+            smoothed[frame * num_channels + ch] = scratch[frame] + channel.baseline;
+        }
+    }
+
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+        for (std::size_t ch = 0; ch < num_channels; ++ch) {
+
+            //-- Slide the window along by one sample.
+            Channel& channel = channels[ch];
+            if (num_seen >= length) {
+                channel.sorted.erase(std::lower_bound(channel.sorted.begin(), channel.sorted.end(), channel.recent[position]));
+            }
+
+            const double value = smoothed[frame * num_channels + ch];
+            channel.recent[position] = value;
+            channel.sorted.insert(std::upper_bound(channel.sorted.begin(), channel.sorted.end(), value), value);
+
+            const std::size_t count = channel.sorted.size();
+            const double median = (count % 2 == 1) ? channel.sorted[count / 2]
+                                : 0.5 * (channel.sorted[count / 2 - 1] + channel.sorted[count / 2]);
+
+            tonic.push_back(median);
+            phasic.push_back(value - median);
+            this->detect(channel, ch, phasic.back(), value, stamps[frame], responses);
+        }
+
+        position = (position + 1) % length;
+        ++num_seen;
+    }
+
+    return;
+}
+
+
+std::size_t EdaProcessor::getNumChannels() const {
+    return this->num_channels;
+}
+
+
+unsigned int EdaProcessor::getSamplingRate() const {
+    return this->sampling_rate;
+}
+
+
+void EdaProcessor::detect(Channel& channel, const std::size_t index, const double phasic, const double level,
+                          const double stamp, std::vector<SkinConductanceResponse>& responses) {
+
+    //-- Once a response has passed, the tonic level lets go of it and the
+    //-- phasic signal climbs back from below zero. That is not a response.
+    const double value      = std::max(phasic, 0.0);
+    const double hysteresis = 0.5 * min_amplitude;
+    const double previous   = channel.previous;
+    channel.previous = value;
+
+    if (!channel.rising) {
+
+        //-- The onset is the last trough, confirmed once the signal has risen from it.
+        if (value <= previous) {
+            channel.onset       = value;
+            channel.onset_level = level;
+            channel.onset_time  = stamp;
+        } else if (value > channel.onset + hysteresis) {
+            channel.rising       = true;
+            channel.extreme      = value;
+            channel.extreme_time = stamp;
+            channel.peak_level   = level;
+        }
+        return;
+    }
+
+    //-- Follow the crest up, it is the peak once the signal turns down.
+    if (value > channel.extreme) {
+        channel.extreme      = value;
+        channel.extreme_time = stamp;
+        channel.peak_level   = level;
+    } else if (value < channel.extreme - hysteresis) {
+
+        if (channel.peak_level - channel.onset_level >= min_amplitude) {
+            SkinConductanceResponse response;
+            response.channel   = index;
+            response.onset     = channel.onset_time;
+            response.peak      = channel.extreme_time;
+            response.amplitude = channel.peak_level - channel.onset_level;
+            response.rise_time = channel.extreme_time - channel.onset_time;
+            responses.push_back(response);
+        }
+
+        channel.rising      = false;
+        channel.onset       = value;
+        channel.onset_level = level;
+        channel.onset_time  = stamp;
+    }
+
+    return;
+}
@@ -0,0 +1,444 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/frameCodec.h>
+
+#include <array>
+#include <iostream>
+#include <limits>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Reflected Castagnoli polynomial.
+    constexpr uint32_t crc32c_polynomial = 0x82F63B78;
+
+    std::array<uint32_t, 256> makeCrcTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t idx = 0; idx < 256; ++idx) {
+            uint32_t crc = idx;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? crc32c_polynomial : 0);
+            }
+            table[idx] = crc;
+        }
+        return table;
+    }
+
+
+    int64_t toNanoseconds(const double seconds) {
+        return static_cast<int64_t>(std::llround(seconds * 1e9));
+    }
+
+
+    template<typename T>
+    void store(uint8_t* target, const T value) {
+        std::memcpy(target, &value, sizeof(T));
+    }
+
+
+    template<typename T>
+    T load(const uint8_t* source) {
+        T value;
+        std::memcpy(&value, source, sizeof(T));
+        return value;
+    }
+}
+
+
+bool FrameView::isPlanar() const {
+    return (flags & FrameCodec::PLANAR) != 0;
+}
+
+
+bool FrameView::hasStampRange() const {
+    return (flags & FrameCodec::STAMP_RANGE) != 0;
+}
+
+
+bool FrameView::isCompressed() const {
+    return (flags & FrameCodec::COMPRESSED) != 0;
+}
+
+
+bool FrameView::isQuantized() const {
+    return (flags & FrameCodec::QUANTIZED) != 0;
+}
+
+
+bool FrameView::decompress(std::vector<uint8_t>& storage) {
+
+    if (!this->isCompressed()) {
+        return true;
+    }
+
+    const std::size_t bytes = std::size_t(num_samples) * num_channels * FrameCodec::elementSize(var);
+    storage.resize(bytes);
+    if (!DeltaCodec::decode(var, payload, payload_bytes, num_channels, num_samples, storage.data())) {
+        return false;
+    }
+
+    //-- From here on it reads like any interleaved frame.
+    payload       = storage.data();
+    payload_bytes = bytes;
+    flags        &= ~(FrameCodec::COMPRESSED | FrameCodec::PLANAR);
+
+    return true;
+}
+
+
+bool FrameView::dequantize(std::vector<uint8_t>& storage) {
+
+    if (!this->isQuantized()) {
+        return true;
+    }
+    if (this->isCompressed()) {
+        return false;
+    }
+
+    const std::size_t count = std::size_t(num_samples) * num_channels;
+    storage.resize(count * FrameCodec::elementSize(value_var));
+
+    const bool wide = (var == hriPhysio::varTag::INT32);
+    if (value_var == hriPhysio::varTag::FLOAT) {
+        float* target = reinterpret_cast<float*>(storage.data());
+        if (wide) { Quantizer::restore(reinterpret_cast<const int32_t*>(payload), count, scale, offset, target); }
+        else      { Quantizer::restore(reinterpret_cast<const int16_t*>(payload), count, scale, offset, target); }
+    } else {
+        double* target = reinterpret_cast<double*>(storage.data());
+        if (wide) { Quantizer::restore(reinterpret_cast<const int32_t*>(payload), count, scale, offset, target); }
+        else      { Quantizer::restore(reinterpret_cast<const int16_t*>(payload), count, scale, offset, target); }
+    }
+
+    payload       = storage.data();
+    payload_bytes = storage.size();
+    var           = value_var;
+    flags        &= ~FrameCodec::QUANTIZED;
+
+    return true;
+}
+
+
+double FrameView::timestamp(const std::size_t sample) const {
+
+    if (!this->hasStampRange()) {
+        return load<int64_t>(stamps + sample * sizeof(int64_t)) * 1e-9;
+    }
+
+    const int64_t first = load<int64_t>(stamps);
+    const int64_t last  = load<int64_t>(stamps + sizeof(int64_t));
+    if (num_samples < 2) {
+        return first * 1e-9;
+    }
+
+    return (first + (last - first) * (static_cast<double>(sample) / (num_samples - 1))) * 1e-9;
+}
+
+
+FrameCodec::FrameCodec() :
+    stream_id(0),
+    flags(0),
+    quantizer() {
+}
+
+
+FrameCodec::~FrameCodec() {
+}
+
+
+void FrameCodec::setStreamId(const uint32_t id) {
+    this->stream_id = id;
+    return;
+}
+
+
+void FrameCodec::setPlanar(const bool enable) {
+    this->flags = enable ? (flags | PLANAR) : (flags & ~PLANAR);
+    return;
+}
+
+
+void FrameCodec::setChecksum(const bool enable) {
+    this->flags = enable ? (flags | CHECKSUM) : (flags & ~CHECKSUM);
+    return;
+}
+
+
+void FrameCodec::setStampRange(const bool enable) {
+    this->flags = enable ? (flags | STAMP_RANGE) : (flags & ~STAMP_RANGE);
+    return;
+}
+
+
+void FrameCodec::setCompression(const bool enable) {
+    this->flags = enable ? (flags | COMPRESSED) : (flags & ~COMPRESSED);
+    return;
+}
+
+
+void FrameCodec::setQuantizer(const hriPhysio::Stream::Quantizer& quantizer) {
+    this->quantizer = quantizer;
+    return;
+}
+
+
+uint32_t FrameCodec::getStreamId() const {
+    return this->stream_id;
+}
+
+
+uint8_t FrameCodec::getFlags() const {
+    return this->flags;
+}
+
+
+const hriPhysio::Stream::Quantizer& FrameCodec::getQuantizer() const {
+    return this->quantizer;
+}
+
+
+std::size_t FrameCodec::frameSize(const hriPhysio::varTag var, const std::size_t num_channels, const std::size_t num_samples) const {
+
+    if (!fitsHeader(num_channels)) {
+        return 0;
+    }
+
+    //-- A string is one sample of many characters, with a single timestamp.
+    const hriPhysio::varTag wire = this->payloadType(var);
+    const std::size_t stamped = (var == hriPhysio::varTag::STRING) ? 1 : num_samples;
+    const std::size_t payload = (flags & COMPRESSED && var != hriPhysio::varTag::STRING)
+                              ? DeltaCodec::maxEncodedSize(wire, num_channels, num_samples)
+                              : num_samples * num_channels * elementSize(wire);
+    return header_size + this->stampBytes(stamped) + ((wire != var) ? quantize_size : 0)
+         + payload + ((flags & CHECKSUM) ? checksum_size : 0);
+}
+
+
+bool FrameCodec::fitsHeader(const std::size_t num_channels) {
+
+    if (num_channels > std::numeric_limits<uint16_t>::max()) {
+        std::cerr << "[ERROR] A frame holds at most " << std::numeric_limits<uint16_t>::max()
+                  << " channels, not " << num_channels << "!!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+std::size_t FrameCodec::maxSamples(const hriPhysio::varTag var, const std::size_t num_channels, const std::size_t frame_bytes) const {
+
+    const hriPhysio::varTag wire = this->payloadType(var);
+    const std::size_t fixed = header_size + ((flags & CHECKSUM) ? checksum_size : 0) + ((flags & STAMP_RANGE) ? 2 * sizeof(int64_t) : 0)
+                            + ((flags & COMPRESSED) ? num_channels : 0) + ((wire != var) ? quantize_size : 0);
+    if (frame_bytes <= fixed) {
+        return 0;
+    }
+
+    const std::size_t per_sample = num_channels * elementSize(wire) + ((flags & STAMP_RANGE) ? 0 : sizeof(int64_t));
+    return (per_sample == 0) ? 0 : (frame_bytes - fixed) / per_sample;
+}
+
+
+std::size_t FrameCodec::encode(uint8_t* target, const uint64_t sequence, const std::string& message, const double stamp) const {
+
+    //-- Strings are a single sample of ``size`` characters.
+    std::size_t offset = this->writeHeader(target, sequence, hriPhysio::varTag::STRING, 1, message.size(), message.size());
+    offset += this->writeStamps(target + offset, 1, nullptr, stamp);
+
+    std::memcpy(target + offset, message.data(), message.size());
+
+    return this->finish(target, offset + message.size());
+}
+
+
+bool FrameCodec::peekSize(const uint8_t* data, const std::size_t available, std::size_t& frame_bytes) {
+
+    frame_bytes = 0;
+    if (available < header_size) {
+        return available < 2 || load<uint16_t>(data) == frame_magic;
+    }
+
+    if (load<uint16_t>(data) != frame_magic || data[2] != frame_version) {
+        return false;
+    }
+
+    const uint8_t  flags   = data[3];
+    const auto     var     = static_cast<hriPhysio::varTag>(data[4]);
+    const uint32_t samples = load<uint32_t>(data + 12);
+    const uint32_t payload = load<uint32_t>(data + 24);
+
+    const std::size_t stamped     = (var == hriPhysio::varTag::STRING) ? 1 : samples;
+    const std::size_t stamp_bytes = (flags & STAMP_RANGE) ? 2 * sizeof(int64_t) : stamped * sizeof(int64_t);
+
+    frame_bytes = header_size + stamp_bytes + ((flags & QUANTIZED) ? quantize_size : 0)
+                + payload + ((flags & CHECKSUM) ? checksum_size : 0);
+
+    return true;
+}
+
+
+bool FrameCodec::decode(const uint8_t* data, const std::size_t length, FrameView& view) {
+
+    std::size_t frame_bytes = 0;
+    if (!peekSize(data, length, frame_bytes) || frame_bytes == 0 || frame_bytes > length) {
+        return false;
+    }
+
+    view.flags        = data[3];
+    view.var          = static_cast<hriPhysio::varTag>(data[4]);
+    view.num_channels = load<uint16_t>(data + 6);
+    view.stream_id    = load<uint32_t>(data + 8);
+    view.num_samples  = load<uint32_t>(data + 12);
+    view.sequence     = load<uint64_t>(data + 16);
+
+    view.payload_bytes = load<uint32_t>(data + 24);
+    view.frame_bytes   = frame_bytes;
+
+    //-- Compressed payloads are checked when they are decompressed.
+    const std::size_t element = elementSize(view.var);
+    if (element == 0 || (!view.isCompressed() && view.payload_bytes != std::size_t(view.num_samples) * view.num_channels * element)) {
+        return false;
+    }
+
+    view.stamps  = data + header_size;
+    view.payload = data + frame_bytes - view.payload_bytes - ((view.flags & CHECKSUM) ? checksum_size : 0);
+
+    //-- Only floating point values travel quantized, and only as int16 or int32.
+    view.value_var = view.var;
+    view.scale     = 1.0;
+    view.offset    = 0.0;
+    if (view.isQuantized()) {
+        view.value_var = static_cast<hriPhysio::varTag>(data[5]);
+        if ((view.var != hriPhysio::varTag::INT16 && view.var != hriPhysio::varTag::INT32) ||
+            (view.value_var != hriPhysio::varTag::FLOAT && view.value_var != hriPhysio::varTag::DOUBLE)) {
+            return false;
+        }
+        view.scale  = load<double>(view.payload - quantize_size);
+        view.offset = load<double>(view.payload - quantize_size + sizeof(double));
+    }
+
+    if (view.flags & CHECKSUM) {
+        const uint32_t expected = load<uint32_t>(data + frame_bytes - checksum_size);
+        if (crc32c(data, frame_bytes - checksum_size) != expected) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+std::size_t FrameCodec::elementSize(const hriPhysio::varTag var) {
+
+    switch (var) {
+    case hriPhysio::varTag::CHAR:     return sizeof(char);
+    case hriPhysio::varTag::INT16:    return sizeof(int16_t);
+    case hriPhysio::varTag::INT32:    return sizeof(int32_t);
+    case hriPhysio::varTag::INT64:    return sizeof(int64_t);
+    case hriPhysio::varTag::LONGLONG: return sizeof(long long);
+    case hriPhysio::varTag::FLOAT:    return sizeof(float);
+    case hriPhysio::varTag::DOUBLE:   return sizeof(double);
+    case hriPhysio::varTag::STRING:   return sizeof(char);
+    default:                          return 0;
+    }
+}
+
+
+uint32_t FrameCodec::crc32c(const uint8_t* data, const std::size_t length, uint32_t crc/*=0*/) {
+
+    crc = ~crc;
+    std::size_t idx = 0;
+
+#if defined(__SSE4_2__)
+    //-- Hardware CRC, eight bytes at a time.
+    for (; idx + 8 <= length; idx += 8) {
+        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, load<uint64_t>(data + idx)));
+    }
+    for (; idx < length; ++idx) {
+        crc = _mm_crc32_u8(crc, data[idx]);
+    }
+#else
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    for (; idx < length; ++idx) {
+        crc = table[(crc ^ data[idx]) & 0xFF] ^ (crc >> 8);
+    }
+#endif
+
+    return ~crc;
+}
+
+
+std::size_t FrameCodec::stampBytes(const std::size_t num_samples) const {
+    return (flags & STAMP_RANGE) ? 2 * sizeof(int64_t) : num_samples * sizeof(int64_t);
+}
+
+
+hriPhysio::varTag FrameCodec::payloadType(const hriPhysio::varTag var) const {
+    if (quantizer.isEnabled() && (var == hriPhysio::varTag::FLOAT || var == hriPhysio::varTag::DOUBLE)) {
+        return quantizer.getWireType();
+    }
+    return var;
+}
+
+
+std::size_t FrameCodec::writeHeader(uint8_t* target, const uint64_t sequence, const hriPhysio::varTag var,
+                                    const std::size_t num_channels, const std::size_t num_samples, const std::size_t payload_bytes) const {
+
+    store<uint16_t>(target +  0, frame_magic);
+    store<uint8_t> (target +  2, frame_version);
+    store<uint8_t> (target +  3, (var == hriPhysio::varTag::STRING) ? uint8_t(flags & ~COMPRESSED) : flags);
+    store<uint8_t> (target +  4, static_cast<uint8_t>(var));
+    store<uint8_t> (target +  5, 0);
+    store<uint16_t>(target +  6, static_cast<uint16_t>(num_channels));
+    store<uint32_t>(target +  8, stream_id);
+    store<uint32_t>(target + 12, static_cast<uint32_t>(num_samples));
+    store<uint64_t>(target + 16, sequence);
+    store<uint32_t>(target + 24, static_cast<uint32_t>(payload_bytes));
+    store<uint32_t>(target + 28, 0);
+
+    return header_size;
+}
+
+
+std::size_t FrameCodec::writeStamps(uint8_t* target, const std::size_t num_samples, const double* stamps, const double fallback) const {
+
+    if (flags & STAMP_RANGE) {
+        const double first = (stamps != nullptr && num_samples > 0) ? stamps[0]               : fallback;
+        const double last  = (stamps != nullptr && num_samples > 0) ? stamps[num_samples - 1] : fallback;
+        store<int64_t>(target,                   toNanoseconds(first));
+        store<int64_t>(target + sizeof(int64_t), toNanoseconds(last));
+        return 2 * sizeof(int64_t);
+    }
+
+    for (std::size_t idx = 0; idx < num_samples; ++idx) {
+        store<int64_t>(target + idx * sizeof(int64_t), toNanoseconds(stamps != nullptr ? stamps[idx] : fallback));
+    }
+    return num_samples * sizeof(int64_t);
+}
+
+
+std::size_t FrameCodec::finish(uint8_t* target, const std::size_t length) const {
+
+    if (!(flags & CHECKSUM)) {
+        return length;
+    }
+
+    store<uint32_t>(target + length, crc32c(target, length));
+    return length + checksum_size;
+}
@@ -0,0 +1,169 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/heartRateVariability.h>
+
+#include <HriPhysio/Processing/burgSpectrum.h>
+#include <HriPhysio/Processing/detrendedFluctuation.h>
+#include <HriPhysio/Processing/slidingEntropy.h>
+
+#include <algorithm>
+
+using namespace hriPhysio::Processing;
+
+
+std::vector<double> hriPhysio::Processing::rrIntervals(const std::vector<double>& peaks) {
+
+    std::vector<double> rr;
+    for (std::size_t idx = 1; idx < peaks.size(); ++idx) {
+        rr.push_back((peaks[idx] - peaks[idx - 1]) * 1000.0);
+    }
+
+    return rr;
+}
+
+
+HrvTimeDomain hriPhysio::Processing::hrvTimeDomain(const std::vector<double>& rr) {
+
+    HrvTimeDomain features;
+    if (rr.size() < 2) {
+        return features;
+    }
+
+    const std::size_t count = rr.size();
+    double sum = 0.0, rate = 0.0;
+    for (const double interval : rr) {
+        sum  += interval;
+        rate += 60000.0 / interval;
+    }
+    const double mean = sum / count;
+
+    double squares = 0.0, successive = 0.0;
+    std::size_t over = 0;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        squares += (rr[idx] - mean) * (rr[idx] - mean);
+        if (idx > 0) {
+            const double diff = rr[idx] - rr[idx - 1];
+            successive += diff * diff;
+            over += (std::abs(diff) > 50.0) ? 1 : 0;
+        }
+    }
+
+    features.num_intervals = count;
+    features.mean_rr = mean;
+    features.sdnn    = std::sqrt(squares / (count - 1));
+    features.rmssd   = std::sqrt(successive / (count - 1));
+    features.pnn50   = 100.0 * over / (count - 1);
+    features.mean_hr = rate / count;
+
+    return features;
+}
+
+
+HrvNonlinear hriPhysio::Processing::hrvNonlinear(const std::vector<double>& rr, const std::size_t dimension) {
+
+    HrvNonlinear features;
+    if (rr.size() < 3) {
+        return features;
+    }
+
+    //-- Poincare plot, each interval against the next, rotated by 45 degrees.
+    const std::size_t count = rr.size() - 1;
+    double across = 0.0, along = 0.0;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        across += (rr[idx] - rr[idx + 1]) / std::sqrt(2.0);
+        along  += (rr[idx] + rr[idx + 1]) / std::sqrt(2.0);
+    }
+    across /= count;
+    along  /= count;
+
+    double across_squares = 0.0, along_squares = 0.0;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        const double x1 = (rr[idx] - rr[idx + 1]) / std::sqrt(2.0) - across;
+        const double x2 = (rr[idx] + rr[idx + 1]) / std::sqrt(2.0) - along;
+        across_squares += x1 * x1;
+        along_squares  += x2 * x2;
+    }
+
+    features.num_intervals = rr.size();
+    features.sd1     = std::sqrt(across_squares / (count - 1));
+    features.sd2     = std::sqrt(along_squares  / (count - 1));
+    features.sd1_sd2 = (features.sd2 > 0.0) ? features.sd1 / features.sd2 : 0.0;
+
+    //-- Entropies with the tolerance at a fifth of the SDNN.
+    const double tolerance = 0.2 * hrvTimeDomain(rr).sdnn;
+    SlidingEntropy entropy(dimension, /*capacity=*/ 0, tolerance);
+    entropy.push(rr.data(), rr.size());
+
+    features.sampen = entropy.sampleEntropy();
+    features.apen   = entropy.approximateEntropy();
+
+    DetrendedFluctuation dfa;
+    dfa.push(rr.data(), rr.size());
+
+    features.dfa_alpha1 = dfa.alpha(4, 16);
+    features.dfa_alpha2 = dfa.alpha(16, 64);
+
+    return features;
+}
+
+
+HrvFrequency hriPhysio::Processing::hrvFrequency(const std::vector<double>& rr, const double rate, const std::size_t maxOrder) {
+
+    HrvFrequency features;
+    if (rr.size() < 3 || rate <= 0.0) {
+        return features;
+    }
+
+    //-- Each interval is placed at the time of the beat that ends it.
+    std::vector<double> times(rr.size());
+    double elapsed = 0.0;
+    for (std::size_t idx = 0; idx < rr.size(); ++idx) {
+        elapsed += rr[idx] / 1000.0;
+        times[idx] = elapsed;
+    }
+
+    //-- Resample the tachogram evenly.
+    const std::size_t length = static_cast<std::size_t>((times.back() - times.front()) * rate) + 1;
+    std::vector<double> tachogram(length);
+    std::size_t beat = 0;
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        const double time = times.front() + idx / rate;
+        while (beat + 2 < times.size() && times[beat + 1] < time) {
+            ++beat;
+        }
+        const double frac = (time - times[beat]) / (times[beat + 1] - times[beat]);
+        tachogram[idx] = rr[beat] + std::min(std::max(frac, 0.0), 1.0) * (rr[beat + 1] - rr[beat]);
+    }
+
+    BurgSpectrum burg(maxOrder);
+    if (!burg.fit(tachogram.data(), tachogram.size())) {
+        return features;
+    }
+
+    features.num_intervals = rr.size();
+    features.order = burg.getOrder();
+    features.vlf   = burg.bandPower(0.0033, 0.04, rate);
+    features.lf    = burg.bandPower(0.04,   0.15, rate);
+    features.hf    = burg.bandPower(0.15,   0.4,  rate);
+    features.total = features.vlf + features.lf + features.hf;
+
+    if (features.hf > 0.0) {
+        features.lf_hf = features.lf / features.hf;
+    }
+    if (features.lf + features.hf > 0.0) {
+        features.lf_nu = 100.0 * features.lf / (features.lf + features.hf);
+        features.hf_nu = 100.0 * features.hf / (features.lf + features.hf);
+    }
+
+    return features;
+}
@@ -26,21 +26,29 @@ HilbertTransform::~HilbertTransform() {
 
 void HilbertTransform::process(const std::vector<double>& source, std::vector<double>& target) {
 
+    if (source.size() != target.size()) {
+        //-- Make the target the expected output size.
+        target.resize(source.size());
+    }
+
+    this->process(source.data(), target.data(), source.size());
+
+    return;
+}
+
+
+void HilbertTransform::process(const double* source, double* target, const std::size_t numSamples) {
+
     //-- Error checking.
 
-    if (source.size() != this->num_samples) {
+    if (numSamples != this->num_samples) {
         //-- Need to reset pocketfft elements.
-        this->resize(source.size());
-    }
-
-    if (source.size() != target.size()) {
-        //-- Make the target the expected output size.
-        target.resize(this->num_samples);
+        this->resize(numSamples);
     }
 
 
     //-- Copy the data into the complex buffer.
-    this->realToComplex(source.data(), this->input.data(), this->num_samples);
+    this->realToComplex(source, this->input.data(), this->num_samples);
 
 
     //-- Compute the forward complex-to-complex transform.
@@ -83,7 +91,7 @@ void HilbertTransform::process(const std::vector<double>& source, std::vector<do
     
 
     //-- Get the magnitude of the complex elements in the vector.
-    this->complexToReal(this->output.data(), target.data(), this->num_samples);
+    this->complexToReal(this->output.data(), target, this->num_samples);
 
 
     return;
@@ -0,0 +1,381 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Core/ioReactor.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace hriPhysio::Core;
+
+
+namespace {
+
+    //-- Events handled per epoll_wait call.
+    constexpr std::size_t max_events = 64;
+
+    //-- Seconds between receives of a streamer that lost its descriptor.
+    constexpr double reconnect_poll = 0.1;
+}
+
+
+IoReactor::IoReactor() :
+    epoll_fd(-1),
+    wake_fd(-1),
+    running(true) {
+
+    events.resize(max_events);
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epoll_fd < 0 || wake_fd < 0) {
+        std::cerr << "[ERROR] IoReactor could not be created: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events  = EPOLLIN;
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+}
+
+
+IoReactor::~IoReactor() {
+
+    //-- Close the timers this reactor created.
+    for (auto& entry : sources) {
+        if (entry.second->owned) {
+            close(entry.first);
+        }
+    }
+    sources.clear();
+
+    if (wake_fd  >= 0) { close(wake_fd);  }
+    if (epoll_fd >= 0) { close(epoll_fd); }
+}
+
+
+bool IoReactor::addDescriptor(const int fd, Handler handler, const uint32_t events/*=EPOLLIN*/, const bool dispatch/*=false*/) {
+
+    if (epoll_fd < 0 || fd < 0 || !handler) {
+        return false;
+    }
+
+    auto source = std::make_shared<Source>();
+    source->handler  = std::move(handler);
+    source->events   = events | (dispatch ? static_cast<uint32_t>(EPOLLONESHOT) : 0u);
+    source->dispatch = dispatch;
+    source->owned    = false;
+
+    std::lock_guard<std::mutex> guard(sources_lock);
+
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events  = source->events;
+    event.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        std::cerr << "[ERROR] IoReactor could not watch descriptor " << fd << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    sources[fd] = std::move(source);
+
+    return true;
+}
+
+
+bool IoReactor::removeDescriptor(const int fd) {
+
+    std::lock_guard<std::mutex> guard(sources_lock);
+
+    auto it = sources.find(fd);
+    if (it == sources.end()) {
+        return false;
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    if (it->second->owned) {
+        close(fd);
+    }
+    sources.erase(it);
+
+    return true;
+}
+
+
+bool IoReactor::addStreamer(hriPhysio::Stream::StreamerInterface* streamer, Task callback, const bool dispatch/*=false*/) {
+
+    const int fd = (streamer != nullptr) ? streamer->getDescriptor() : -1;
+    if (fd < 0 || !callback) {
+        std::cerr << "[WARNING] IoReactor can not watch a streamer without a descriptor." << std::endl;
+        return false;
+    }
+
+    streamer->setTimeout(0.0);
+
+    auto watched = std::make_shared<Watched>();
+    watched->streamer = streamer;
+    watched->callback = std::move(callback);
+    watched->dispatch = dispatch;
+    watched->fd       = fd;
+
+    return this->addDescriptor(fd, [this, watched](uint32_t) { this->serviceStreamer(watched); }, EPOLLIN, dispatch);
+}
+
+
+int IoReactor::addTimer(const double period, Task callback, const bool repeat/*=true*/) {
+
+    if (period <= 0.0) {
+        return -1;
+    }
+
+    const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[ERROR] IoReactor could not create a timer: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    struct itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec  = static_cast<time_t>(period);
+    spec.it_value.tv_nsec = static_cast<long>(std::fmod(period, 1.0) * 1e9);
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1;
+    }
+    if (repeat) {
+        spec.it_interval = spec.it_value;
+    }
+    timerfd_settime(fd, 0, &spec, nullptr);
+
+    //-- Read the expiry count so the descriptor stops being ready.
+    const bool added = this->addDescriptor(fd, [this, fd, callback, repeat](uint32_t) {
+        uint64_t expirations = 0;
+        if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            return;
+        }
+        callback();
+        if (!repeat) {
+            this->removeDescriptor(fd);
+        }
+    });
+
+    if (!added) {
+        close(fd);
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(sources_lock);
+        sources[fd]->owned = true;
+    }
+
+    return fd;
+}
+
+
+void IoReactor::post(Task task) {
+
+    {
+        std::lock_guard<std::mutex> guard(posted_lock);
+        posted.push_back(std::move(task));
+    }
+
+    this->wake();
+
+    return;
+}
+
+
+void IoReactor::setDispatcher(Dispatcher dispatcher) {
+    this->dispatcher = std::move(dispatcher);
+    return;
+}
+
+
+std::size_t IoReactor::getNumSources() {
+    std::lock_guard<std::mutex> guard(sources_lock);
+    return sources.size();
+}
+
+
+std::size_t IoReactor::runOnce(const double seconds) {
+
+    if (epoll_fd < 0) {
+        return 0;
+    }
+
+    const int timeout = (seconds < 0.0) ? -1 : static_cast<int>(std::ceil(seconds * 1000.0));
+
+    const int count = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), timeout);
+    if (count < 0) {
+        if (errno != EINTR) {
+            std::cerr << "[ERROR] IoReactor wait failed: " << std::strerror(errno) << std::endl;
+        }
+        return 0;
+    }
+
+    std::size_t handled = 0;
+    for (int idx = 0; idx < count; ++idx) {
+
+        const int      fd    = events[idx].data.fd;
+        const uint32_t ready = events[idx].events;
+
+        if (fd == wake_fd) {
+            uint64_t value = 0;
+            while (read(wake_fd, &value, sizeof(value)) == sizeof(value)) {}
+            this->drainPosted();
+            continue;
+        }
+
+        //-- A handler earlier in this pass may have removed the source.
+        std::shared_ptr<Source> source;
+        {
+            std::lock_guard<std::mutex> guard(sources_lock);
+            auto it = sources.find(fd);
+            if (it == sources.end()) { continue; }
+            source = it->second;
+        }
+
+        if (source->dispatch && dispatcher) {
+            //-- One shot until the worker is done, so it is never handled twice at once.
+            dispatcher([this, fd, ready, source]() {
+                source->handler(ready);
+                this->rearm(fd, source->events);
+            });
+        } else {
+            source->handler(ready);
+            if (source->dispatch) {
+                this->rearm(fd, source->events);
+            }
+        }
+
+        ++handled;
+    }
+
+    return handled;
+}
+
+
+void IoReactor::run() {
+
+    while (running) {
+        this->runOnce(-1.0);
+    }
+
+    //-- Allow the reactor to be run again.
+    running = true;
+
+    return;
+}
+
+
+void IoReactor::stop() {
+    running = false;
+    this->wake();
+    return;
+}
+
+
+void IoReactor::wake() {
+    const uint64_t value = 1;
+    if (write(wake_fd, &value, sizeof(value)) < 0) {
+        //-- The counter is saturated, the reactor is already awake.
+    }
+    return;
+}
+
+
+void IoReactor::drainPosted() {
+
+    std::vector< Task > tasks;
+    {
+        std::lock_guard<std::mutex> guard(posted_lock);
+        tasks.swap(posted);
+    }
+
+    for (Task& task : tasks) {
+        task();
+    }
+
+    return;
+}
+
+
+void IoReactor::rearm(const int fd, const uint32_t events) {
+
+    std::lock_guard<std::mutex> guard(sources_lock);
+
+    //-- Only if the descriptor was not removed while the handler ran.
+    if (sources.find(fd) == sources.end()) {
+        return;
+    }
+
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events  = events;
+    event.data.fd = fd;
+
+    //-- Closing a descriptor drops it from epoll, and a new socket may have
+    //-- taken the same number since.
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0 && errno == ENOENT) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    return;
+}
+
+
+void IoReactor::serviceStreamer(const std::shared_ptr<Watched>& watched) {
+
+    //-- The descriptor is not ready again for frames already read.
+    do {
+        watched->callback();
+    } while (watched->streamer->getDescriptor() >= 0 && watched->streamer->hasBuffered());
+
+    this->followStreamer(watched);
+
+    return;
+}
+
+
+void IoReactor::followStreamer(const std::shared_ptr<Watched>& watched) {
+
+    const int fd = watched->streamer->getDescriptor();
+
+    if (fd != watched->fd) {
+        if (watched->fd >= 0) {
+            this->removeDescriptor(watched->fd);
+        }
+        watched->fd = fd;
+        if (fd >= 0) {
+            this->addDescriptor(fd, [this, watched](uint32_t) { this->serviceStreamer(watched); }, EPOLLIN, watched->dispatch);
+        }
+    } else if (fd >= 0 && !watched->dispatch) {
+        //-- Dispatched sources are re-armed once the handler returns.
+        this->rearm(fd, EPOLLIN);
+    }
+
+    if (fd < 0) {
+        this->addTimer(reconnect_poll, [this, watched]() { this->serviceStreamer(watched); }, /*repeat=*/ false);
+    }
+
+    return;
+}
@@ -0,0 +1,92 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/lslResolver.h>
+
+#include <thread>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Streams not seen for this long are dropped from the results.
+    constexpr double forget_after = 5.0;
+
+    //-- How often find() asks the resolver for fresh results.
+    constexpr double refresh_period = 0.1;
+}
+
+
+LslResolver::LslResolver() :
+    resolver(new lsl::continuous_resolver(forget_after)),
+    started(std::chrono::steady_clock::now()) {
+}
+
+
+LslResolver::~LslResolver() {
+}
+
+
+LslResolver& LslResolver::instance() {
+    static LslResolver shared;
+    return shared;
+}
+
+
+bool LslResolver::find(const std::string& name, lsl::stream_info& info) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    this->refresh();
+
+    for (const lsl::stream_info& candidate : results) {
+        if (candidate.name() == name) {
+            info = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool LslResolver::waitFor(const std::string& name, lsl::stream_info& info, const double seconds) {
+
+    //-- A stream missing after that much discovery is not up yet, find() picks it up later.
+    const auto deadline = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds)
+    );
+
+    while (!this->find(name, info)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(refresh_period));
+    }
+
+    return true;
+}
+
+
+void LslResolver::refresh() {
+
+    const auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - last_refresh).count() < refresh_period) {
+        return;
+    }
+
+    results      = resolver->results();
+    last_refresh = now;
+
+    return;
+}
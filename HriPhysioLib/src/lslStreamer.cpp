@@ -12,18 +12,42 @@
 
 #include <HriPhysio/Stream/lslStreamer.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <type_traits>
+
 using namespace hriPhysio::Stream;
 
 
+namespace {
+
+    //-- Bounds on the wait between attempts to attach a missing stream.
+    constexpr double min_backoff = 0.25;
+    constexpr double max_backoff = 5.0;
+
+
+    //-- Enough digits that the receiver parses back the same double.
+    std::string exactString(const double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", value);
+        return text;
+    }
+}
+
+
 LslStreamer::LslStreamer() : 
-    StreamerInterface() {
+    StreamerInterface(),
+    resolve_timeout(5.0),
+    attach_backoff(min_backoff),
+    quantization_known(false) {
 
 }
 
 
 LslStreamer::~LslStreamer() {
 
-    if (this->mode == modeTag::RECEIVER) {
+    if (this->mode == modeTag::RECEIVER && inlet) {
         inlet->close_stream();
         inlet.reset();
     } else if (this->mode == modeTag::SENDER) {
@@ -36,6 +60,11 @@ lsl::channel_format_t LslStreamer::getLslFormatType() {
 
     lsl::channel_format_t cf_type;
 
+    //-- Quantized floating point streams go out as their integers.
+    if (quantizer.isEnabled() && (this->var == hriPhysio::varTag::FLOAT || this->var == hriPhysio::varTag::DOUBLE)) {
+        return (quantizer.getWireType() == hriPhysio::varTag::INT16) ? lsl::channel_format_t::cf_int16 : lsl::channel_format_t::cf_int32;
+    }
+
     switch (this->var) {
     case hriPhysio::varTag::CHAR:
         cf_type = lsl::channel_format_t::cf_int8;
@@ -66,6 +95,28 @@ lsl::channel_format_t LslStreamer::getLslFormatType() {
 }
 
 
+void LslStreamer::setResolveTimeout(const double seconds) {
+    this->resolve_timeout = (seconds > 0.0) ? seconds : 0.0;
+    return;
+}
+
+
+bool LslStreamer::isAttached() const {
+    return inlet != nullptr;
+}
+
+
+bool LslStreamer::setQuantization(const std::string wire_dtype, const double scale, const double offset) {
+
+    if (this->mode != modeTag::NOTSET) {
+        std::cerr << "[WARNING] LSL stream ``" << this->name << "`` is already open, quantization is unchanged." << std::endl;
+        return false;
+    }
+
+    return quantizer.configure(wire_dtype, scale, offset);
+}
+
+
 bool LslStreamer::openInputStream() {
 
     //-- Set the current mode.
@@ -77,8 +128,15 @@ bool LslStreamer::openInputStream() {
 
     try {
 
-        //-- Create a new inlet from the given input name.
-        inlet.reset(new lsl::stream_inlet(lsl::resolve_stream("name", this->name)[0]));
+        //-- Give the shared resolver a bounded time to find the stream.
+        lsl::stream_info info;
+        if (LslResolver::instance().waitFor(this->name, info, resolve_timeout)) {
+            this->openInlet(info);
+        } else {
+            std::cerr << "[WARNING] LSL stream ``" << this->name
+                      << "`` not found yet, will attach when it appears." << std::endl;
+            next_attach = std::chrono::steady_clock::now();
+        }
 
 	} catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
 
@@ -108,6 +166,14 @@ bool LslStreamer::openOutputStream() {
             /* source_id      = */ this->name
         );
 
+        //-- Tell receivers how to turn the integers back into values.
+        if (quantizer.isEnabled() && (this->var == hriPhysio::varTag::FLOAT || this->var == hriPhysio::varTag::DOUBLE)) {
+            lsl::xml_element quantization = info.desc().append_child("quantization");
+            quantization.append_child_value("type",   (quantizer.getWireType() == hriPhysio::varTag::INT16) ? "int16" : "int32");
+            quantization.append_child_value("scale",  exactString(quantizer.getScale()));
+            quantization.append_child_value("offset", exactString(quantizer.getOffset()));
+        }
+
         outlet.reset(new lsl::stream_outlet(info, /*chunk_size=*/this->frame_length, /*max_buffered=*/this->frame_length*2));
 
     } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
@@ -119,7 +185,6 @@ bool LslStreamer::openOutputStream() {
 
 void LslStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps/*=nullptr*/) {
 
-    std::cerr << "[LSL-OUT] Sending: " << this->dtype << " ";
     switch (this->var) {
     case hriPhysio::varTag::CHAR:
         this->pushStream<char>(buff, timestamps);
@@ -137,7 +202,6 @@ void LslStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const st
         this->pushStream<float>(buff, timestamps);
         break;
     case hriPhysio::varTag::DOUBLE:
-        std::cerr << "<double>" << std::endl;
         this->pushStream<double>(buff, timestamps);
         break;
     default:
@@ -157,7 +221,11 @@ void LslStreamer::publish(const std::string& buff, const double* timestamps/*=nu
 
 void LslStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
 
-    std::cerr << "[LSL-IN] Receive: " << this->dtype << " ";
+    if ((!inlet && !this->attachInlet()) || (!quantization_known && !this->readQuantization())) {
+        buff.clear();
+        if (timestamps != nullptr) { timestamps->clear(); }
+        return;
+    }
 
     switch (this->var) {
     case hriPhysio::varTag::CHAR:
@@ -176,7 +244,6 @@ void LslStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<dou
         this->pullStream<float>(buff, timestamps);
         break;
     case hriPhysio::varTag::DOUBLE:
-        std::cerr << "<double>" << std::endl;
         this->pullStream<double>(buff, timestamps);
         break;
     default:
@@ -187,8 +254,13 @@ void LslStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<dou
 
 void LslStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
 
+    if ((!inlet && !this->attachInlet()) || (!quantization_known && !this->readQuantization())) {
+        buff.clear();
+        return;
+    }
+
     //-- Pull in the string.
-    double ts = inlet->pull_sample(&buff, 1, 0.2);
+    double ts = inlet->pull_sample(&buff, 1, this->timeout);
 
     if (timestamps != nullptr) { *timestamps = ts; }
 
@@ -196,35 +268,198 @@ void LslStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
 }
 
 
+bool LslStreamer::attachInlet() {
+
+    //-- Wait out the backoff, but never longer than a receive may block.
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next_attach) {
+        std::this_thread::sleep_for(std::min(
+            next_attach - now,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->timeout))
+        ));
+        if (std::chrono::steady_clock::now() < next_attach) {
+            return false;
+        }
+    }
+
+    try {
+
+        lsl::stream_info info;
+        if (LslResolver::instance().find(this->name, info)) {
+            this->openInlet(info);
+            attach_backoff = min_backoff;
+            return true;
+        }
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; }
+
+    next_attach = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(attach_backoff)
+    );
+    attach_backoff = std::min(attach_backoff * 2.0, max_backoff);
+
+    return false;
+}
+
+
+void LslStreamer::openInlet(const lsl::stream_info& info) {
+
+    inlet.reset(new lsl::stream_inlet(info));
+    quantizer.disable();
+
+    //-- Resolved infos only have the header. Its format already rules out
+    //-- quantization unless integers arrive for a floating point stream.
+    const bool floating = (this->var == hriPhysio::varTag::FLOAT || this->var == hriPhysio::varTag::DOUBLE);
+    const lsl::channel_format_t format = info.channel_format();
+    quantization_known = !floating || (format != lsl::channel_format_t::cf_int16 && format != lsl::channel_format_t::cf_int32);
+
+    return;
+}
+
+
+bool LslStreamer::readQuantization() {
+
+    //-- Only the inlet's full info carries the description. A zero timeout
+    //-- still gives the query a moment, else it could never be answered.
+    lsl::stream_info full;
+    try {
+        full = inlet->info(std::max(this->timeout, min_backoff));
+    } catch (lsl::timeout_error&) {
+        return false;
+    }
+
+    quantization_known = true;
+
+    lsl::xml_element quantization = full.desc().child("quantization");
+    if (quantization.empty()) {
+        return true;
+    }
+
+    try {
+        quantizer.configure(
+            quantization.child_value("type"),
+            std::stod(quantization.child_value("scale")),
+            std::stod(quantization.child_value("offset"))
+        );
+    } catch (std::exception& e) {
+        std::cerr << "[WARNING] LSL stream ``" << this->name << "`` has an unreadable quantization: " << e.what() << std::endl;
+    }
+
+    return true;
+}
+
+
 template<typename T>
 void LslStreamer::pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps) {
 
-    std::vector<T> samples(buff.size());
+    std::vector<T>& samples = std::get< std::vector<T> >(chunks);
 
-    //-- Copy the data into a temporary transfer.
+    //-- Copy the data into the reused transfer, only grows on the first calls.
+    samples.resize(buff.size());
     for (std::size_t idx = 0; idx < buff.size(); ++idx) {
         samples[idx] = std::get<T>( buff[idx] );
     }
 
-    //-- Push a multiplexed chunk from a flat vector.
-    outlet->push_chunk_multiplexed(samples);
+    if constexpr (std::is_floating_point_v<T>) {
+        if (quantizer.isEnabled() && quantizer.getWireType() == hriPhysio::varTag::INT16) {
+            this->pushQuantized<T, int16_t>(samples, timestamps);
+            return;
+        } else if (quantizer.isEnabled()) {
+            this->pushQuantized<T, int32_t>(samples, timestamps);
+            return;
+        }
+    }
+
+    this->pushChunk(samples, timestamps);
 
     return;
 }
 
 
 template<typename T>
-void LslStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
+void LslStreamer::pushChunk(const std::vector<T>& samples, const std::vector<double>* timestamps) {
+
+    //-- Push a multiplexed chunk, with the callers timestamps when they line up.
+    const std::size_t num_samples = (this->num_channels != 0) ? samples.size() / this->num_channels : 0;
+    if (timestamps != nullptr && timestamps->size() == num_samples) {
+        outlet->push_chunk_multiplexed(samples.data(), timestamps->data(), samples.size());
+    } else {
+        outlet->push_chunk_multiplexed(samples.data(), samples.size());
+    }
+
+    return;
+}
+
+
+template<typename T, typename Wire>
+void LslStreamer::pushQuantized(const std::vector<T>& samples, const std::vector<double>* timestamps) {
 
-    std::vector<T> samples;
+    std::vector<Wire>& wire = std::get< std::vector<Wire> >(chunks);
+    wire.resize(samples.size());
+    hriPhysio::Stream::Quantizer::quantize(samples.data(), samples.size(), quantizer.getScale(), quantizer.getOffset(), wire.data());
 
-    //-- Pull a multiplexed chunk into a flat vector.
-    inlet->pull_chunk_multiplexed(samples, timestamps, 5.0);
+    this->pushChunk(wire, timestamps);
 
-    //-- Copy the data into the buffer.
-    for (std::size_t idx = 0; idx < samples.size(); ++idx) {
+    return;
+}
+
+
+template<typename T>
+void LslStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
+
+    std::vector<T>& samples = std::get< std::vector<T> >(chunks);
+
+    std::size_t elements = 0;
+    if constexpr (std::is_floating_point_v<T>) {
+        if (quantizer.isEnabled() && quantizer.getWireType() == hriPhysio::varTag::INT16) {
+            elements = this->pullQuantized<T, int16_t>(samples);
+        } else if (quantizer.isEnabled()) {
+            elements = this->pullQuantized<T, int32_t>(samples);
+        } else {
+            elements = this->pullChunk(samples);
+        }
+    } else {
+        elements = this->pullChunk(samples);
+    }
+
+    //-- Copy the data into the buffer, sized to what actually arrived.
+    buff.resize(elements);
+    for (std::size_t idx = 0; idx < elements; ++idx) {
         buff[idx] = samples[idx];
     }
 
+    if (timestamps != nullptr) {
+        const std::size_t num_samples = (this->num_channels != 0) ? elements / this->num_channels : 0;
+        timestamps->assign(chunk_stamps.begin(), chunk_stamps.begin() + num_samples);
+    }
+
     return;
 }
+
+
+template<typename T>
+std::size_t LslStreamer::pullChunk(std::vector<T>& samples) {
+
+    //-- Never pull more than one input frame, the reused buffers bound the copy.
+    const std::size_t max_samples  = std::max<std::size_t>(this->frame_length, 1);
+    const std::size_t max_elements = max_samples * std::max<std::size_t>(this->num_channels, 1);
+    samples.resize(max_elements);
+    chunk_stamps.resize(max_samples);
+
+    return inlet->pull_chunk_multiplexed(
+        samples.data(), chunk_stamps.data(), max_elements, max_samples, this->timeout
+    );
+}
+
+
+template<typename T, typename Wire>
+std::size_t LslStreamer::pullQuantized(std::vector<T>& samples) {
+
+    std::vector<Wire>& wire = std::get< std::vector<Wire> >(chunks);
+    const std::size_t elements = this->pullChunk(wire);
+
+    samples.resize(elements);
+    hriPhysio::Stream::Quantizer::restore(wire.data(), elements, quantizer.getScale(), quantizer.getOffset(), samples.data());
+
+    return elements;
+}
@@ -45,10 +45,21 @@ void PhysioManager::configure(const std::string yaml_file) {
     num_channels   = config[ "num_channels"   ].as<std::size_t>( /*default=*/ 1   );
     sample_overlap = config[ "sample_overlap" ].as<std::size_t>( /*default=*/ 0   );
     buffer_length  = config[ "buffer_length"  ].as<std::size_t>( /*default=*/ 100 );
+    timeout        = config[ "timeout"        ].as<double>(      /*default=*/ 1.0 );
+
+    //-- Playback of recorded sessions (REPLAY input only).
+    replay_speed = config["replay_speed"].as<double>( /*default=*/ 1.0   );
+    replay_loop  = config["replay_loop" ].as<bool>(   /*default=*/ false );
+
+    //-- Send floating point output as scaled integers (int16 or int32, off when empty).
+    quantize_dtype  = config["quantize_dtype" ].as<std::string>( /*default=*/ ""  );
+    quantize_scale  = config["quantize_scale" ].as<double>(      /*default=*/ 1.0 );
+    quantize_offset = config["quantize_offset"].as<double>(      /*default=*/ 0.0 );
 
     //-- Enable logging?
     log_data = config["log_data"].as<bool>( /*default=*/ false );
     log_name = config["log_name"].as<std::string>( /*default=*/ "");
+    log_format = config["log_format"].as<std::string>( /*default=*/ "csv");
 
     std::cerr << "[CONF] Load complete.\n";
     
@@ -71,6 +82,13 @@ void PhysioManager::configure(const std::string yaml_file) {
     stream_input->setFrameLength(input_frame);
     stream_input->setNumChannels(num_channels);
     stream_input->setSamplingRate(sampling_rate);
+    stream_input->setTimeout(timeout);
+
+    hriPhysio::Stream::ReplayStreamer* replay = dynamic_cast<hriPhysio::Stream::ReplayStreamer*>(stream_input);
+    if (replay != nullptr) {
+        replay->setSpeed(replay_speed);
+        replay->setLoop(replay_loop);
+    }
 
     stream_output->setName(output_name);
     stream_output->setDataType(dtype);
@@ -78,12 +96,17 @@ void PhysioManager::configure(const std::string yaml_file) {
     stream_output->setNumChannels(num_channels);
     stream_output->setSamplingRate(sampling_rate);
 
+    if (quantize_dtype != "") {
+        stream_output->setQuantization(quantize_dtype, quantize_scale, quantize_offset);
+    }
+
     if (log_data) {
-        stream_logger.setName(log_name);
-        stream_logger.setDataType(dtype);
-        stream_logger.setFrameLength(input_frame);
-        stream_logger.setNumChannels(num_channels);
-        stream_logger.setSamplingRate(sampling_rate);
+        stream_logger.reset(hriPhysio::Stream::makeLogger(log_format));
+        stream_logger->setName(log_name);
+        stream_logger->setDataType(dtype);
+        stream_logger->setFrameLength(input_frame);
+        stream_logger->setNumChannels(num_channels);
+        stream_logger->setSamplingRate(sampling_rate);
     }
 
 
@@ -100,7 +123,7 @@ void PhysioManager::configure(const std::string yaml_file) {
         return;
     }
 
-    if (log_data && !stream_logger.openOutputStream()) {
+    if (log_data && !stream_logger->openOutputStream()) {
         std::cerr << "Could not open logger stream.\n";
         this->close();
         return;
@@ -172,7 +195,7 @@ void PhysioManager::inputLoop() {
 
 
                 if (this->log_data) {
-                    stream_logger.publish(transfer, stamps);
+                    stream_logger->publish(transfer, stamps);
                 }
             }
 
@@ -0,0 +1,307 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/pulseDetector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace hriPhysio::Processing;
+
+
+namespace {
+
+    //-- Elgendi's windows, in seconds, and the offset of the threshold.
+    const double peak_window = 0.111;
+    const double beat_window = 0.667;
+    const double offset      = 0.02;
+
+    //-- Seconds used to learn the mean square before detecting.
+    const double learning = 2.0;
+
+    //-- Seconds the running mean squares follow.
+    const double channel_time = 2.0;
+    const double level_time   = 8.0;
+
+    //-- No two beats closer than this, in seconds.
+    const double refractory = 0.3;
+
+    //-- Intervals outside these (ms) are missed or extra beats.
+    const double shortest_ibi = 300.0;
+    const double longest_ibi  = 2000.0;
+
+    //-- How far an interval may stray from the running one.
+    const double tolerance = 0.3;
+
+    //-- Fewest channels, as a fraction, that must show a good beat.
+    const double min_agreement = 0.5;
+
+    //-- Plausible intervals in a row that move the running one.
+    const std::size_t max_rejects = 3;
+}
+
+
+PulseDetector::Channel::Channel(const unsigned int rate) :
+    high(rate),
+    low(rate),
+    baseline(0.0) {
+}
+
+
+PulseDetector::PulseDetector(const unsigned int rate, const std::size_t numChannels,
+                             const double lowCutoff, const double highCutoff) :
+    sampling_rate(rate),
+    num_channels(std::max<std::size_t>(numChannels, 1)),
+    low_cutoff(lowCutoff),
+    high_cutoff(highCutoff) {
+
+    if (high_cutoff >= rate / 2.0) {
+        std::cerr << "[WARNING] PPG low pass at " << high_cutoff << " Hz is above the Nyquist rate, skipping it." << std::endl;
+        high_cutoff = 0.0;
+    }
+
+    //-- The beat window must hold the peak window either side of its centre.
+    peak_length = std::max<std::size_t>(std::lround(peak_window * rate), 2);
+    beat_length = std::max<std::size_t>(std::lround(beat_window * rate), 3 * peak_length);
+
+    this->reset();
+}
+
+
+void PulseDetector::reset() {
+
+    channels.clear();
+    for (std::size_t idx = 0; idx < num_channels; ++idx) {
+        channels.emplace_back(sampling_rate);
+    }
+    power.assign(num_channels, 0.0);
+
+    position = 0;
+    num_seen = 0;
+    squared.assign(beat_length, 0.0);
+    values.assign(beat_length, 0.0);
+    agreements.assign(beat_length, 0.0);
+    times.assign(beat_length, 0.0);
+
+    peak_sum    = 0.0;
+    beat_sum    = 0.0;
+    mean_square = 0.0;
+
+    in_block            = false;
+    block_length        = 0;
+    candidate           = 0.0;
+    candidate_time      = 0.0;
+    candidate_agreement = 0.0;
+
+    last_beat = -std::numeric_limits<double>::infinity();
+    expected  = 0.0;
+    rejects   = 0;
+
+    return;
+}
+
+
+void PulseDetector::process(const double* source, const double* stamps, const std::size_t numFrames,
+                            std::vector<double>& pulse, std::vector<PulseBeat>& beats) {
+
+    if (numFrames == 0) {
+        return;
+    }
+
+    //-- Band pass each channel as one contiguous block. The first sample is
+    //-- taken out so the high pass does not ring from the raw level.
+    scratch.resize(numFrames);
+    filtered.resize(numFrames * num_channels);
+    for (std::size_t ch = 0; ch < num_channels; ++ch) {
+
+        Channel& channel = channels[ch];
+        if (num_seen == 0) {
+            channel.baseline = source[ch];
+        }
+
+        for (std::size_t frame = 0; frame < numFrames; ++frame) {
+            scratch[frame] = source[frame * num_channels + ch] - channel.baseline;
+        }
+        channel.high.filterContinuous(scratch.data(), scratch.data(), numFrames, low_cutoff);
+        if (high_cutoff > 0.0) {
+            channel.low.filterContinuous(scratch.data(), scratch.data(), numFrames, high_cutoff);
+        }
+        for (std::size_t frame = 0; frame < numFrames; ++frame) {
+            filtered[frame * num_channels + ch] = scratch[frame];
+        }
+    }
+
+    const std::size_t training = std::max<std::size_t>(std::lround(learning * sampling_rate), beat_length);
+    const double alpha = 1.0 / (level_time * sampling_rate);
+
+    //-- Lags of the newest and oldest sample of the peak window.
+    const std::size_t centre = beat_length / 2;
+    const std::size_t newest = centre - (peak_length - 1 - peak_length / 2);
+    const std::size_t oldest = centre + peak_length / 2;
+
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+
+        double agreement;
+        const double value = this->combine(&filtered[frame * num_channels], agreement);
+        const double level = (value > 0.0) ? value * value : 0.0;
+        pulse.push_back(value);
+
+        //-- Slide both windows along by one sample.
+        position  = (position + 1) % beat_length;
+        beat_sum += level - squared[position];
+
+        squared[position]    = level;
+        values[position]     = value;
+        agreements[position] = agreement;
+        times[position]      = stamps[frame];
+
+        peak_sum += squared[this->index(newest)] - squared[this->index(oldest + 1)];
+        ++num_seen;
+
+        if (num_seen <= training) {
+            mean_square += level / training;
+            continue;
+        }
+        mean_square += alpha * (level - mean_square);
+
+        //-- Detect on the sample both windows are centred on.
+        const double threshold = beat_sum / beat_length + offset * mean_square;
+        if (peak_sum / peak_length > threshold) {
+
+            if (!in_block) {
+                in_block     = true;
+                block_length = 0;
+                candidate    = -std::numeric_limits<double>::infinity();
+            }
+            ++block_length;
+
+            const std::size_t idx = this->index(centre);
+            if (values[idx] > candidate) {
+                candidate           = values[idx];
+                candidate_time      = times[idx];
+                candidate_agreement = agreements[idx];
+            }
+        } else if (in_block) {
+            this->close(beats);
+        }
+    }
+
+    return;
+}
+
+
+double PulseDetector::getHeartRate() const {
+    return (expected > 0.0) ? 60000.0 / expected : 0.0;
+}
+
+
+std::size_t PulseDetector::getNumChannels() const {
+    return this->num_channels;
+}
+
+
+unsigned int PulseDetector::getSamplingRate() const {
+    return this->sampling_rate;
+}
+
+
+double PulseDetector::combine(const double* frame, double& agreement) {
+
+    const double alpha = 1.0 / (channel_time * sampling_rate);
+
+    double      sum   = 0.0;
+    std::size_t above = 0;
+    std::size_t ch    = 0;
+
+#if defined(__SSE2__)
+    const __m128d rate = _mm_set1_pd(alpha);
+    const __m128d zero = _mm_setzero_pd();
+    __m128d total = zero;
+
+    for (; ch + 2 <= num_channels; ch += 2) {
+        const __m128d value  = _mm_loadu_pd(frame + ch);
+        const __m128d square = _mm_mul_pd(value, value);
+
+        __m128d mean = _mm_loadu_pd(&power[ch]);
+        mean = _mm_add_pd(mean, _mm_mul_pd(rate, _mm_sub_pd(square, mean)));
+        _mm_storeu_pd(&power[ch], mean);
+
+        total = _mm_add_pd(total, value);
+
+        const int mask = _mm_movemask_pd(_mm_and_pd(_mm_cmpgt_pd(value, zero), _mm_cmpgt_pd(square, mean)));
+        above += (mask & 1) + (mask >> 1);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, total);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; ch < num_channels; ++ch) {
+        const double value = frame[ch];
+        power[ch] += alpha * (value * value - power[ch]);
+        sum       += value;
+        above     += (value > 0.0 && value * value > power[ch]) ? 1 : 0;
+    }
+
+    agreement = static_cast<double>(above) / num_channels;
+    return sum / num_channels;
+}
+
+
+void PulseDetector::close(std::vector<PulseBeat>& beats) {
+
+    in_block = false;
+
+    //-- Blocks shorter than a systolic peak are noise.
+    if (block_length < peak_length || candidate_time - last_beat < refractory) {
+        return;
+    }
+
+    PulseBeat beat;
+    beat.time      = candidate_time;
+    beat.amplitude = candidate;
+    beat.agreement = candidate_agreement;
+
+    if (std::isfinite(last_beat)) {
+        beat.interval = (candidate_time - last_beat) * 1000.0;
+
+        const bool plausible = beat.interval >= shortest_ibi && beat.interval <= longest_ibi;
+        const bool steady    = expected == 0.0 || std::abs(beat.interval - expected) <= tolerance * expected;
+
+        if (plausible && steady) {
+            expected = (expected == 0.0) ? beat.interval : expected + 0.125 * (beat.interval - expected);
+            rejects  = 0;
+        } else if (plausible && ++rejects >= max_rejects) {
+            //-- The rhythm changed, not the beats.
+            expected = beat.interval;
+            rejects  = 0;
+        }
+
+        beat.good = plausible && steady && beat.agreement >= min_agreement;
+    }
+
+    beats.push_back(beat);
+    last_beat = candidate_time;
+
+    return;
+}
+
+
+std::size_t PulseDetector::index(const std::size_t lag) const {
+    return (position + beat_length - lag) % beat_length;
+}
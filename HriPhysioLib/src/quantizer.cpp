@@ -0,0 +1,221 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/quantizer.h>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Same ordering as minpd/maxpd, so NaN saturates high on both paths.
+    template<typename Wire>
+    double saturate(double value) {
+        const double low  = static_cast<double>(std::numeric_limits<Wire>::min());
+        const double high = static_cast<double>(std::numeric_limits<Wire>::max());
+        value = (value < high) ? value : high;
+        value = (value > low)  ? value : low;
+        return value;
+    }
+
+
+#if defined(__SSE2__)
+    //-- Four values at a time, widened to two pairs of doubles.
+    inline void loadValues(const double* source, __m128d& low, __m128d& high) {
+        low  = _mm_loadu_pd(source);
+        high = _mm_loadu_pd(source + 2);
+    }
+
+    inline void loadValues(const float* source, __m128d& low, __m128d& high) {
+        const __m128 values = _mm_loadu_ps(source);
+        low  = _mm_cvtps_pd(values);
+        high = _mm_cvtps_pd(_mm_movehl_ps(values, values));
+    }
+
+    inline void storeValues(double* target, const __m128d low, const __m128d high) {
+        _mm_storeu_pd(target,     low);
+        _mm_storeu_pd(target + 2, high);
+    }
+
+    inline void storeValues(float* target, const __m128d low, const __m128d high) {
+        _mm_storeu_ps(target, _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high)));
+    }
+
+    //-- Four wire values as int32 lanes.
+    inline __m128i loadWire(const int32_t* source) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    }
+
+    inline __m128i loadWire(const int16_t* source) {
+        const __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+        return _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+    }
+
+    inline void storeWire(int32_t* target, const __m128i values) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target), values);
+    }
+
+    inline void storeWire(int16_t* target, const __m128i values) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(target), _mm_packs_epi32(values, values));
+    }
+#endif
+}
+
+
+Quantizer::Quantizer() :
+    wire(hriPhysio::varTag::INT16),
+    scale(1.0),
+    offset(0.0),
+    enabled(false) {
+}
+
+
+Quantizer::~Quantizer() {
+}
+
+
+bool Quantizer::configure(const std::string& wire_dtype, const double scale, const double offset) {
+
+    std::string upperString(wire_dtype);
+    hriPhysio::toUpper(upperString);
+
+    hriPhysio::varTag tag;
+    if (upperString == "INT16") {
+        tag = hriPhysio::varTag::INT16;
+    } else if (upperString == "INT32") {
+        tag = hriPhysio::varTag::INT32;
+    } else {
+        std::cerr << "[ERROR] Quantized type ``" << wire_dtype << "`` is not int16 or int32!!" << std::endl;
+        return false;
+    }
+
+    if (!std::isfinite(scale) || scale == 0.0 || !std::isfinite(offset)) {
+        std::cerr << "[ERROR] Quantization needs a finite, non-zero scale and a finite offset!!" << std::endl;
+        return false;
+    }
+
+    this->wire    = tag;
+    this->scale   = scale;
+    this->offset  = offset;
+    this->enabled = true;
+
+    return true;
+}
+
+
+void Quantizer::disable() {
+    this->enabled = false;
+    return;
+}
+
+
+bool Quantizer::isEnabled() const {
+    return this->enabled;
+}
+
+
+hriPhysio::varTag Quantizer::getWireType() const {
+    return this->wire;
+}
+
+
+double Quantizer::getScale() const {
+    return this->scale;
+}
+
+
+double Quantizer::getOffset() const {
+    return this->offset;
+}
+
+
+template<typename T, typename Wire>
+void Quantizer::quantize(const T* values, const std::size_t count, const double scale, const double offset, Wire* target) {
+
+    const double inverse = 1.0 / scale;
+    std::size_t idx = 0;
+
+#if defined(__SSE2__)
+    //-- Clamp in double, then convert rounding to nearest even like nearbyint.
+    const __m128d step  = _mm_set1_pd(inverse);
+    const __m128d shift = _mm_set1_pd(offset);
+    const __m128d low   = _mm_set1_pd(static_cast<double>(std::numeric_limits<Wire>::min()));
+    const __m128d high  = _mm_set1_pd(static_cast<double>(std::numeric_limits<Wire>::max()));
+
+    for (; idx + 4 <= count; idx += 4) {
+        __m128d first, second;
+        loadValues(values + idx, first, second);
+
+        first  = _mm_max_pd(_mm_min_pd(_mm_mul_pd(_mm_sub_pd(first,  shift), step), high), low);
+        second = _mm_max_pd(_mm_min_pd(_mm_mul_pd(_mm_sub_pd(second, shift), step), high), low);
+
+        storeWire(target + idx, _mm_unpacklo_epi64(_mm_cvtpd_epi32(first), _mm_cvtpd_epi32(second)));
+    }
+#endif
+
+    for (; idx < count; ++idx) {
+        const double value = (static_cast<double>(values[idx]) - offset) * inverse;
+        target[idx] = static_cast<Wire>(std::nearbyint(saturate<Wire>(value)));
+    }
+
+    return;
+}
+
+
+template<typename Wire, typename T>
+void Quantizer::restore(const Wire* values, const std::size_t count, const double scale, const double offset, T* target) {
+
+    std::size_t idx = 0;
+
+#if defined(__SSE2__)
+    const __m128d step  = _mm_set1_pd(scale);
+    const __m128d shift = _mm_set1_pd(offset);
+
+    for (; idx + 4 <= count; idx += 4) {
+        const __m128i wide = loadWire(values + idx);
+
+        const __m128d first  = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(wide),                    step), shift);
+        const __m128d second = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(wide, 8)), step), shift);
+
+        storeValues(target + idx, first, second);
+    }
+#endif
+
+    //-- Frame payloads need not be aligned, so read through memcpy.
+    for (; idx < count; ++idx) {
+        Wire value;
+        std::memcpy(&value, values + idx, sizeof(Wire));
+        target[idx] = static_cast<T>(static_cast<double>(value) * scale + offset);
+    }
+
+    return;
+}
+
+
+template void Quantizer::quantize<float,  int16_t>(const float*,  const std::size_t, const double, const double, int16_t*);
+template void Quantizer::quantize<float,  int32_t>(const float*,  const std::size_t, const double, const double, int32_t*);
+template void Quantizer::quantize<double, int16_t>(const double*, const std::size_t, const double, const double, int16_t*);
+template void Quantizer::quantize<double, int32_t>(const double*, const std::size_t, const double, const double, int32_t*);
+
+template void Quantizer::restore<int16_t, float> (const int16_t*, const std::size_t, const double, const double, float*);
+template void Quantizer::restore<int32_t, float> (const int32_t*, const std::size_t, const double, const double, float*);
+template void Quantizer::restore<int16_t, double>(const int16_t*, const std::size_t, const double, const double, double*);
+template void Quantizer::restore<int32_t, double>(const int32_t*, const std::size_t, const double, const double, double*);
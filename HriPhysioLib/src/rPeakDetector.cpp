@@ -0,0 +1,197 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/rPeakDetector.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace hriPhysio::Processing;
+
+
+namespace {
+
+    //-- No two beats closer than this, in seconds.
+    const double refractory = 0.2;
+
+    //-- Seconds of signal used to train the levels before detecting.
+    const double learning = 2.0;
+
+    //-- Search back once the RR interval is this far past its running value.
+    const double search_back = 1.66;
+}
+
+
+RPeakDetector::RPeakDetector(const unsigned int rate, const bool inverted/*=false*/) :
+    sampling_rate(rate),
+    polarity(inverted ? -1.0 : 1.0) {
+
+    this->reset();
+}
+
+
+void RPeakDetector::reset() {
+
+    //-- 150 ms of integration, and a little more of history to search.
+    const std::size_t length = std::max<std::size_t>(std::lround(0.15 * sampling_rate), 1);
+    window.assign(length, 0.0);
+    window_pos = 0;
+    window_sum = 0.0;
+    previous   = 0.0;
+
+    history.assign(length + std::lround(0.05 * sampling_rate), -std::numeric_limits<double>::infinity());
+    history_stamps.assign(history.size(), -std::numeric_limits<double>::infinity());
+    history_pos = 0;
+
+    num_seen     = 0;
+    signal_level = 0.0;
+    noise_level  = 0.0;
+    noise_peak   = 0.0;
+    last_peak    = -std::numeric_limits<double>::infinity();
+    rr_average   = 0.0;
+
+    in_qrs         = false;
+    qrs_peak       = 0.0;
+    candidate      = 0.0;
+    candidate_time = 0.0;
+
+    missed_level = 0.0;
+    missed       = 0.0;
+    missed_time  = 0.0;
+
+    return;
+}
+
+
+void RPeakDetector::process(const double* source, const double* stamps, const std::size_t numSamples, std::vector<double>& peaks) {
+
+    std::vector<double> amplitudes;
+    this->process(source, stamps, numSamples, peaks, amplitudes);
+
+    return;
+}
+
+
+void RPeakDetector::process(const double* source, const double* stamps, const std::size_t numSamples,
+                            std::vector<double>& peaks, std::vector<double>& amplitudes) {
+
+    const std::size_t training = static_cast<std::size_t>(learning * sampling_rate);
+
+    for (std::size_t sample = 0; sample < numSamples; ++sample) {
+
+        const double value = source[sample];
+        const double stamp = stamps[sample];
+
+        //-- Squared slope, integrated over the window.
+        const double slope = (num_seen == 0) ? 0.0 : value - previous;
+        previous = value;
+
+        window_sum += slope * slope - window[window_pos];
+        window[window_pos] = slope * slope;
+        window_pos = (window_pos + 1) % window.size();
+        const double level = std::max(window_sum, 0.0) / window.size();
+
+        history[history_pos]        = value;
+        history_stamps[history_pos] = stamp;
+        history_pos = (history_pos + 1) % history.size();
+
+        ++num_seen;
+
+        //-- Train: the largest level is the first signal peak, the average is the noise.
+        if (num_seen <= training) {
+            signal_level = std::max(signal_level, level);
+            noise_level += level / training;
+            continue;
+        }
+
+        const double threshold = noise_level + 0.25 * (signal_level - noise_level);
+
+        if (!in_qrs) {
+
+            if (level <= threshold || stamp - last_peak < refractory) {
+                noise_peak = std::max(noise_peak, level);
+
+                //-- Keep the best peak under the threshold in case a beat was missed.
+                if (stamp - last_peak >= refractory && level > missed_level) {
+                    missed_level = level;
+                    this->searchHistory(missed, missed_time);
+                }
+
+                //-- Search back at half the threshold once the beat is overdue.
+                if (rr_average > 0.0 && stamp - last_peak > search_back * rr_average && missed_level > 0.5 * threshold) {
+                    signal_level = 0.25 * missed_level + 0.75 * signal_level;
+                    this->accept(missed_time, missed, peaks, amplitudes);
+                }
+                continue;
+            }
+
+            //-- The R peak may be before the integrated signal rose, so look back.
+            in_qrs   = true;
+            qrs_peak = level;
+            this->searchHistory(candidate, candidate_time);
+
+            noise_level = 0.125 * noise_peak + 0.875 * noise_level;
+            noise_peak  = 0.0;
+            continue;
+        }
+
+        qrs_peak = std::max(qrs_peak, level);
+        if (polarity * value > polarity * candidate) {
+            candidate      = value;
+            candidate_time = stamp;
+        }
+
+        if (level < threshold) {
+            signal_level = 0.125 * qrs_peak + 0.875 * signal_level;
+            in_qrs       = false;
+            this->accept(candidate_time, candidate, peaks, amplitudes);
+        }
+    }
+
+    return;
+}
+
+
+unsigned int RPeakDetector::getSamplingRate() const {
+    return this->sampling_rate;
+}
+
+
+void RPeakDetector::searchHistory(double& value, double& time) const {
+
+    double best = -std::numeric_limits<double>::infinity();
+    for (std::size_t idx = 0; idx < history.size(); ++idx) {
+        if (history_stamps[idx] - last_peak >= refractory && polarity * history[idx] > best) {
+            best  = polarity * history[idx];
+            value = history[idx];
+            time  = history_stamps[idx];
+        }
+    }
+
+    return;
+}
+
+
+void RPeakDetector::accept(const double time, const double value, std::vector<double>& peaks, std::vector<double>& amplitudes) {
+
+    peaks.push_back(time);
+    amplitudes.push_back(value);
+
+    if (std::isfinite(last_peak)) {
+        const double interval = time - last_peak;
+        rr_average = (rr_average == 0.0) ? interval : 0.125 * interval + 0.875 * rr_average;
+    }
+    last_peak    = time;
+    missed_level = 0.0;
+
+    return;
+}
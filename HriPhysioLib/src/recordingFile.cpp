@@ -0,0 +1,615 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/recordingFile.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    int64_t toNanoseconds(const double seconds) {
+        return static_cast<int64_t>(std::llround(seconds * 1e9));
+    }
+
+
+    template<typename T>
+    void store(uint8_t* target, const T value) {
+        std::memcpy(target, &value, sizeof(T));
+    }
+
+
+    template<typename T>
+    T load(const uint8_t* source) {
+        T value;
+        std::memcpy(&value, source, sizeof(T));
+        return value;
+    }
+
+
+    std::size_t entryBytes(const RecordingChunk& chunk) {
+        return RecordingWriter::index_entry + chunk.zones.size() * RecordingWriter::zone_entry;
+    }
+
+
+    std::size_t storeEntry(uint8_t* target, const RecordingChunk& chunk) {
+        store<uint64_t>(target +  0, chunk.offset);
+        store<uint32_t>(target +  8, chunk.frame_bytes);
+        store<uint32_t>(target + 12, chunk.stream_id);
+        store<int64_t> (target + 16, toNanoseconds(chunk.first_time));
+        store<int64_t> (target + 24, toNanoseconds(chunk.last_time));
+        store<uint32_t>(target + 32, chunk.num_samples);
+        store<uint16_t>(target + 36, chunk.num_channels);
+        store<uint8_t> (target + 38, static_cast<uint8_t>(chunk.var));
+        store<uint8_t> (target + 39, chunk.zones.empty() ? 0 : 1);
+
+        uint8_t* zone = target + RecordingWriter::index_entry;
+        for (const RecordingZone& summary : chunk.zones) {
+            store<double>(zone +  0, summary.min);
+            store<double>(zone +  8, summary.max);
+            store<double>(zone + 16, summary.mean);
+            store<double>(zone + 24, summary.m2);
+            zone += RecordingWriter::zone_entry;
+        }
+
+        return entryBytes(chunk);
+    }
+
+
+    //-- Zero if the entry does not fit in ``available`` bytes.
+    std::size_t loadEntry(const uint8_t* source, const std::size_t available, RecordingChunk& chunk) {
+
+        if (available < RecordingWriter::index_entry) {
+            return 0;
+        }
+        chunk.offset       = load<uint64_t>(source +  0);
+        chunk.frame_bytes  = load<uint32_t>(source +  8);
+        chunk.stream_id    = load<uint32_t>(source + 12);
+        chunk.first_time   = load<int64_t> (source + 16) * 1e-9;
+        chunk.last_time    = load<int64_t> (source + 24) * 1e-9;
+        chunk.num_samples  = load<uint32_t>(source + 32);
+        chunk.num_channels = load<uint16_t>(source + 36);
+        chunk.var          = static_cast<hriPhysio::varTag>(source[38]);
+        chunk.zones.clear();
+
+        if (source[39] == 0) {
+            return RecordingWriter::index_entry;
+        }
+        if (available < RecordingWriter::index_entry + chunk.num_channels * RecordingWriter::zone_entry) {
+            return 0;
+        }
+
+        chunk.zones.resize(chunk.num_channels);
+        const uint8_t* zone = source + RecordingWriter::index_entry;
+        for (RecordingZone& summary : chunk.zones) {
+            summary.min  = load<double>(zone +  0);
+            summary.max  = load<double>(zone +  8);
+            summary.mean = load<double>(zone + 16);
+            summary.m2   = load<double>(zone + 24);
+            zone += RecordingWriter::zone_entry;
+        }
+
+        return entryBytes(chunk);
+    }
+
+
+    double toDouble(const hriPhysio::varType& value) {
+        return std::visit([](auto element) { return static_cast<double>(element); }, value);
+    }
+
+
+    //-- Single pass (Welford) summary of every channel.
+    std::vector<RecordingZone> summarize(const hriPhysio::varType* values, const std::size_t num_channels, const std::size_t num_samples) {
+
+        std::vector<RecordingZone> zones(num_channels);
+        for (std::size_t ch = 0; ch < num_channels; ++ch) {
+            RecordingZone& zone = zones[ch];
+            zone.min = zone.max = toDouble(values[ch]);
+            for (std::size_t idx = 0; idx < num_samples; ++idx) {
+                const double value = toDouble(values[idx * num_channels + ch]);
+                const double delta = value - zone.mean;
+                zone.mean += delta / (idx + 1);
+                zone.m2   += delta * (value - zone.mean);
+                zone.min   = std::min(zone.min, value);
+                zone.max   = std::max(zone.max, value);
+            }
+        }
+
+        return zones;
+    }
+
+
+    RecordingChunk describe(const FrameView& view, const uint64_t offset) {
+        RecordingChunk chunk;
+        chunk.offset       = offset;
+        chunk.frame_bytes  = static_cast<uint32_t>(view.frame_bytes);
+        chunk.stream_id    = view.stream_id;
+        chunk.num_samples  = view.num_samples;
+        chunk.num_channels = view.num_channels;
+        chunk.var          = view.var;
+        chunk.first_time   = view.timestamp(0);
+        chunk.last_time    = (view.var == hriPhysio::varTag::STRING || view.num_samples == 0)
+                           ? chunk.first_time : view.timestamp(view.num_samples - 1);
+        return chunk;
+    }
+}
+
+
+RecordingWriter::RecordingWriter() :
+    fd(-1),
+    sequence(0),
+    out_used(0),
+    flush_bytes(1 << 20),
+    flush_interval(1.0),
+    file_offset(0) {
+
+    //-- Chunks are columns, and each one vouches for itself.
+    codec.setPlanar(true);
+    codec.setChecksum(true);
+    codec.setCompression(true);
+}
+
+
+RecordingWriter::~RecordingWriter() {
+    this->close();
+}
+
+
+bool RecordingWriter::open(const std::string& path) {
+
+    if (fd >= 0) {
+        return false;
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[ERROR] Could not open ``" << path << "``: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    this->path  = path;
+    sequence    = 0;
+    out_used    = 0;
+    file_offset = 0;
+    index.clear();
+    out_buffer.resize(flush_bytes + 4096);
+    last_flush = std::chrono::steady_clock::now();
+
+    uint8_t* header = this->reserveOutput(file_header);
+    store<uint64_t>(header + 0, file_magic);
+    store<uint32_t>(header + 8, file_version);
+    store<uint32_t>(header + 12, 0);
+    out_used    += file_header;
+    file_offset += file_header;
+
+    return this->flush();
+}
+
+
+bool RecordingWriter::isOpen() const {
+    return fd >= 0;
+}
+
+
+void RecordingWriter::setFlushThreshold(const std::size_t bytes) {
+    flush_bytes = std::max<std::size_t>(bytes, 1);
+    return;
+}
+
+
+void RecordingWriter::setFlushInterval(const double seconds) {
+    flush_interval = seconds;
+    return;
+}
+
+
+void RecordingWriter::setCompression(const bool enable) {
+    codec.setCompression(enable);
+    return;
+}
+
+
+bool RecordingWriter::writeChunk(const uint32_t stream_id, const hriPhysio::varTag var, const hriPhysio::varType* values,
+                                 const std::size_t num_channels, const std::size_t num_samples, const double* stamps) {
+
+    if (fd < 0 || num_samples == 0 || num_channels == 0 || !FrameCodec::fitsHeader(num_channels)) {
+        return false;
+    }
+
+    codec.setStreamId(stream_id);
+    uint8_t* target = this->reserveOutput(codec.frameSize(var, num_channels, num_samples));
+
+    std::size_t bytes = 0;
+    switch (var) {
+    case hriPhysio::varTag::CHAR:
+        bytes = codec.encode<char>(target, sequence, values, num_channels, num_samples, stamps, 0.0);
+        break;
+    case hriPhysio::varTag::INT16:
+        bytes = codec.encode<int16_t>(target, sequence, values, num_channels, num_samples, stamps, 0.0);
+        break;
+    case hriPhysio::varTag::INT32:
+        bytes = codec.encode<int32_t>(target, sequence, values, num_channels, num_samples, stamps, 0.0);
+        break;
+    case hriPhysio::varTag::INT64:
+    case hriPhysio::varTag::LONGLONG:
+        bytes = codec.encode<int64_t>(target, sequence, values, num_channels, num_samples, stamps, 0.0);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        bytes = codec.encode<float>(target, sequence, values, num_channels, num_samples, stamps, 0.0);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        bytes = codec.encode<double>(target, sequence, values, num_channels, num_samples, stamps, 0.0);
+        break;
+    default:
+        std::cerr << "[ERROR] Recording chunks must be numeric!!" << std::endl;
+        return false;
+    }
+
+    RecordingChunk chunk;
+    chunk.stream_id    = stream_id;
+    chunk.num_samples  = static_cast<uint32_t>(num_samples);
+    chunk.num_channels = static_cast<uint16_t>(num_channels);
+    chunk.var          = var;
+    chunk.first_time   = (stamps != nullptr) ? stamps[0]               : 0.0;
+    chunk.last_time    = (stamps != nullptr) ? stamps[num_samples - 1] : 0.0;
+    chunk.zones        = summarize(values, num_channels, num_samples);
+
+    return this->commit(chunk, bytes);
+}
+
+
+bool RecordingWriter::writeString(const uint32_t stream_id, const std::string& message, const double stamp) {
+
+    if (fd < 0) {
+        return false;
+    }
+
+    codec.setStreamId(stream_id);
+    uint8_t* target = this->reserveOutput(codec.frameSize(hriPhysio::varTag::STRING, 1, message.size()));
+
+    RecordingChunk chunk;
+    chunk.stream_id    = stream_id;
+    chunk.num_samples  = static_cast<uint32_t>(message.size());
+    chunk.num_channels = 1;
+    chunk.var          = hriPhysio::varTag::STRING;
+    chunk.first_time   = stamp;
+    chunk.last_time    = stamp;
+
+    return this->commit(chunk, codec.encode(target, sequence, message, stamp));
+}
+
+
+bool RecordingWriter::flush() {
+
+    if (fd < 0) {
+        return false;
+    }
+
+    last_flush = std::chrono::steady_clock::now();
+    if (out_used == 0) {
+        return true;
+    }
+
+    const bool success = this->writeAll(out_buffer.data(), out_used);
+    out_used = 0;
+
+    return success;
+}
+
+
+void RecordingWriter::close() {
+
+    if (fd < 0) {
+        return;
+    }
+
+    //-- Index, then the trailer that makes it discoverable.
+    const uint64_t index_offset = file_offset;
+    std::size_t index_bytes = 0;
+    for (const RecordingChunk& chunk : index) {
+        index_bytes += entryBytes(chunk);
+    }
+
+    uint8_t* entries = this->reserveOutput(index_bytes + trailer_size);
+    std::size_t written = 0;
+    for (const RecordingChunk& chunk : index) {
+        written += storeEntry(entries + written, chunk);
+    }
+
+    uint8_t* trailer = entries + index_bytes;
+    store<uint64_t>(trailer +  0, index_offset);
+    store<uint32_t>(trailer +  8, static_cast<uint32_t>(index.size()));
+    store<uint32_t>(trailer + 12, FrameCodec::crc32c(entries, index_bytes));
+    store<uint64_t>(trailer + 16, index_magic);
+    out_used += index_bytes + trailer_size;
+
+    this->flush();
+    fdatasync(fd);
+    ::close(fd);
+
+    fd = -1;
+    index.clear();
+    out_buffer.clear();
+    out_buffer.shrink_to_fit();
+
+    return;
+}
+
+
+std::size_t RecordingWriter::getNumChunks() const {
+    return index.size();
+}
+
+
+uint8_t* RecordingWriter::reserveOutput(const std::size_t bytes) {
+
+    if (out_used + bytes > out_buffer.size()) {
+        this->flush();
+        if (bytes > out_buffer.size()) {
+            out_buffer.resize(bytes);
+        }
+    }
+
+    return out_buffer.data() + out_used;
+}
+
+
+bool RecordingWriter::commit(RecordingChunk chunk, const std::size_t bytes) {
+
+    chunk.offset      = file_offset;
+    chunk.frame_bytes = static_cast<uint32_t>(bytes);
+    index.push_back(chunk);
+
+    out_used    += bytes;
+    file_offset += bytes;
+    ++sequence;
+
+    //-- Bound how much a crash can lose.
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - last_flush).count();
+    if (out_used >= flush_bytes || elapsed >= flush_interval) {
+        return this->flush();
+    }
+
+    return true;
+}
+
+
+bool RecordingWriter::writeAll(const uint8_t* data, std::size_t length) {
+
+    while (length > 0) {
+        const ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            std::cerr << "[ERROR] Could not write ``" << path << "``: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data   += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+
+RecordingReader::RecordingReader() :
+    map_data(nullptr),
+    map_size(0),
+    recovered(false) {
+}
+
+
+RecordingReader::~RecordingReader() {
+    this->close();
+}
+
+
+bool RecordingReader::open(const std::string& path) {
+
+    if (map_data != nullptr) {
+        return false;
+    }
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[ERROR] Could not open ``" << path << "``: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(RecordingWriter::file_header)) {
+        std::cerr << "[ERROR] ``" << path << "`` is not a recording!!" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "[ERROR] Could not map ``" << path << "``: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    map_data = static_cast<const uint8_t*>(mapped);
+    map_size = info.st_size;
+
+    //-- Version 1 files are the same, without zone maps.
+    const uint32_t version = load<uint32_t>(map_data + 8);
+    if (load<uint64_t>(map_data) != RecordingWriter::file_magic || version == 0 || version > RecordingWriter::file_version) {
+        std::cerr << "[ERROR] ``" << path << "`` is not a recording!!" << std::endl;
+        this->close();
+        return false;
+    }
+
+    chunks.clear();
+    streams.clear();
+
+    recovered = !this->loadIndex();
+    if (recovered) {
+        std::cerr << "[WARNING] ``" << path << "`` was not closed cleanly, rebuilding its index." << std::endl;
+        this->scanChunks();
+    }
+
+    return true;
+}
+
+
+bool RecordingReader::isOpen() const {
+    return map_data != nullptr;
+}
+
+
+void RecordingReader::close() {
+
+    if (map_data != nullptr) {
+        munmap(const_cast<uint8_t*>(map_data), map_size);
+    }
+
+    map_data = nullptr;
+    map_size = 0;
+    chunks.clear();
+    streams.clear();
+
+    return;
+}
+
+
+bool RecordingReader::wasRecovered() const {
+    return recovered;
+}
+
+
+const std::vector<RecordingChunk>& RecordingReader::getChunks() const {
+    return chunks;
+}
+
+
+std::vector<uint32_t> RecordingReader::getStreamIds() const {
+
+    std::vector<uint32_t> ids;
+    for (const auto& stream : streams) {
+        ids.push_back(stream.first);
+    }
+
+    return ids;
+}
+
+
+const std::vector<std::size_t>& RecordingReader::getStreamChunks(const uint32_t stream_id) const {
+
+    static const std::vector<std::size_t> none;
+
+    const auto found = streams.find(stream_id);
+    return (found != streams.end()) ? found->second : none;
+}
+
+
+std::size_t RecordingReader::seek(const uint32_t stream_id, const double time) const {
+
+    const std::vector<std::size_t>& order = this->getStreamChunks(stream_id);
+
+    const auto found = std::lower_bound(order.begin(), order.end(), time,
+        [this](const std::size_t chunk, const double time) { return chunks[chunk].last_time < time; }
+    );
+
+    return found - order.begin();
+}
+
+
+bool RecordingReader::readChunk(const std::size_t chunk, FrameView& view) const {
+
+    if (chunk >= chunks.size()) {
+        return false;
+    }
+
+    const RecordingChunk& entry = chunks[chunk];
+    return FrameCodec::decode(map_data + entry.offset, entry.frame_bytes, view);
+}
+
+
+bool RecordingReader::loadIndex() {
+
+    if (map_size < RecordingWriter::file_header + RecordingWriter::trailer_size) {
+        return false;
+    }
+
+    const uint8_t* trailer = map_data + map_size - RecordingWriter::trailer_size;
+    if (load<uint64_t>(trailer + 16) != RecordingWriter::index_magic) {
+        return false;
+    }
+
+    const uint64_t index_offset = load<uint64_t>(trailer);
+    const uint32_t num_chunks   = load<uint32_t>(trailer + 8);
+
+    if (index_offset < RecordingWriter::file_header || index_offset + RecordingWriter::trailer_size > map_size) {
+        return false;
+    }
+
+    const uint8_t* entries     = map_data + index_offset;
+    const std::size_t index_bytes = map_size - RecordingWriter::trailer_size - index_offset;
+    if (FrameCodec::crc32c(entries, index_bytes) != load<uint32_t>(trailer + 12)) {
+        return false;
+    }
+
+    //-- Entries vary in size with their zone maps, and must fill the index exactly.
+    std::size_t position = 0;
+    RecordingChunk chunk;
+    for (uint32_t idx = 0; idx < num_chunks; ++idx) {
+        const std::size_t bytes = loadEntry(entries + position, index_bytes - position, chunk);
+        if (bytes == 0 || chunk.offset + chunk.frame_bytes > index_offset) {
+            chunks.clear();
+            streams.clear();
+            return false;
+        }
+        this->addChunk(chunk);
+        position += bytes;
+    }
+
+    if (position != index_bytes) {
+        chunks.clear();
+        streams.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+void RecordingReader::scanChunks() {
+
+    std::size_t offset = RecordingWriter::file_header;
+    FrameView view;
+
+    //-- Everything up to the first torn or corrupt chunk is good.
+    while (offset < map_size && FrameCodec::decode(map_data + offset, map_size - offset, view)) {
+        this->addChunk(describe(view, offset));
+        offset += view.frame_bytes;
+    }
+
+    return;
+}
+
+
+void RecordingReader::addChunk(const RecordingChunk& chunk) {
+    streams[chunk.stream_id].push_back(chunks.size());
+    chunks.push_back(chunk);
+    return;
+}
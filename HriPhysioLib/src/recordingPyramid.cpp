@@ -0,0 +1,499 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/recordingPyramid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    template<typename T>
+    void storeField(std::vector<uint8_t>& target, const T value) {
+        const std::size_t at = target.size();
+        target.resize(at + sizeof(T));
+        std::memcpy(target.data() + at, &value, sizeof(T));
+    }
+
+
+    template<typename T>
+    T loadField(const uint8_t* source) {
+        T value;
+        std::memcpy(&value, source, sizeof(T));
+        return value;
+    }
+
+
+    //-- Interleaved copy of a chunk, as doubles.
+    template<typename T>
+    void toValues(const FrameView& view, std::vector<double>& values) {
+        values.resize(view.num_samples * view.num_channels);
+        for (std::size_t idx = 0; idx < view.num_samples; ++idx) {
+            for (std::size_t ch = 0; ch < view.num_channels; ++ch) {
+                values[idx * view.num_channels + ch] = static_cast<double>(view.value<T>(idx, ch));
+            }
+        }
+        return;
+    }
+
+
+    bool toValues(const FrameView& view, std::vector<double>& values) {
+        switch (view.var) {
+        case hriPhysio::varTag::CHAR:   toValues<char>   (view, values); return true;
+        case hriPhysio::varTag::INT16:  toValues<int16_t>(view, values); return true;
+        case hriPhysio::varTag::INT32:  toValues<int32_t>(view, values); return true;
+        case hriPhysio::varTag::INT64:  toValues<int64_t>(view, values); return true;
+        case hriPhysio::varTag::FLOAT:  toValues<float>  (view, values); return true;
+        case hriPhysio::varTag::DOUBLE: toValues<double> (view, values); return true;
+        default:                        return false;
+        }
+    }
+}
+
+
+RecordingPyramid::RecordingPyramid() :
+    factor(8),
+    num_channels(0) {
+}
+
+
+RecordingPyramid::~RecordingPyramid() {
+}
+
+
+std::string RecordingPyramid::pathFor(const std::string& recording) {
+    return recording + ".hpyr";
+}
+
+
+bool RecordingPyramid::setFactor(const std::size_t factor) {
+
+    if (factor < 2 || factor > 16) {
+        std::cerr << "[ERROR] Decimation factor " << factor << " is not in [2, 16]!!" << std::endl;
+        return false;
+    }
+
+    this->factor = factor;
+    this->reset(num_channels);
+
+    return true;
+}
+
+
+void RecordingPyramid::reset(const std::size_t num_channels) {
+
+    this->num_channels = num_channels;
+
+    //-- Room for every level up front, so bins can be passed up by pointer.
+    levels.clear();
+    levels.reserve(max_levels);
+    levels.emplace_back();
+    levels.back().open_stats.resize(3 * num_channels);
+
+    return;
+}
+
+
+std::size_t RecordingPyramid::getFactor() const {
+    return this->factor;
+}
+
+
+std::size_t RecordingPyramid::getNumChannels() const {
+    return this->num_channels;
+}
+
+
+std::size_t RecordingPyramid::getNumLevels() const {
+    return levels.size();
+}
+
+
+std::size_t RecordingPyramid::getNumBins(const std::size_t level) const {
+
+    if (level >= levels.size()) {
+        return 0;
+    }
+
+    return levels[level].count.size() + (this->tail(level).open_children != 0 ? 1 : 0);
+}
+
+
+void RecordingPyramid::append(const double* values, const double* stamps, const std::size_t num_samples) {
+
+    if (levels.empty() || num_channels == 0) { return; }
+
+    for (std::size_t idx = 0; idx < num_samples; ++idx) {
+
+        Level& base = levels[0];
+        const double* sample = values + idx * num_channels;
+        double* stats = base.open_stats.data();
+
+        if (base.open_children == 0) {
+            base.open_first = stamps[idx];
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                stats[3 * ch + 0] = sample[ch];
+                stats[3 * ch + 1] = sample[ch];
+                stats[3 * ch + 2] = sample[ch];
+            }
+        } else {
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                stats[3 * ch + 0]  = std::min(stats[3 * ch + 0], sample[ch]);
+                stats[3 * ch + 1]  = std::max(stats[3 * ch + 1], sample[ch]);
+                stats[3 * ch + 2] += sample[ch];
+            }
+        }
+
+        base.open_last = stamps[idx];
+        ++base.open_count;
+        if (++base.open_children == factor) {
+            this->close(0);
+        }
+    }
+
+    return;
+}
+
+
+std::vector<PyramidBin> RecordingPyramid::query(const double start, const double end, const std::size_t pixels) const {
+
+    std::vector<PyramidBin> bins;
+    if (pixels == 0 || !(end > start) || levels.empty()) {
+        return bins;
+    }
+
+    //-- The tail reads as the last bin of its level.
+    Level open;
+    auto firstTime = [&open](const Level& level, const std::size_t idx) {
+        return (idx < level.first_time.size()) ? level.first_time[idx] : open.open_first;
+    };
+    auto lastTime = [&open](const Level& level, const std::size_t idx) {
+        return (idx < level.last_time.size()) ? level.last_time[idx] : open.open_last;
+    };
+
+    std::size_t chosen = 0, lower = 0, upper = 0;
+    for (std::size_t level = levels.size(); level-- > 0;) {
+
+        const Level& current = levels[level];
+        open = this->tail(level);
+        const std::size_t total = current.count.size() + (open.open_children != 0 ? 1 : 0);
+
+        //-- First bin ending at or after ``start``, first starting at or after ``end``.
+        std::size_t low = 0, high = total;
+        while (low < high) {
+            const std::size_t mid = (low + high) / 2;
+            if (lastTime(current, mid) < start) { low = mid + 1; } else { high = mid; }
+        }
+        lower = low;
+        high  = total;
+        while (low < high) {
+            const std::size_t mid = (low + high) / 2;
+            if (firstTime(current, mid) < end) { low = mid + 1; } else { high = mid; }
+        }
+        upper = low;
+
+        chosen = level;
+        if (upper - lower >= pixels) {
+            break;
+        }
+    }
+
+    const Level& level = levels[chosen];
+    const double column_width = (end - start) / pixels;
+    std::size_t column = pixels;
+
+    for (std::size_t idx = lower; idx < upper; ++idx) {
+
+        const bool closed = idx < level.count.size();
+        const double*  stats = closed ? &level.stats[idx * 3 * num_channels] : open.open_stats.data();
+        const uint64_t count = closed ? level.count[idx] : open.open_count;
+
+        const double offset = std::max(firstTime(level, idx) - start, 0.0);
+        const std::size_t at = std::min(static_cast<std::size_t>(offset / column_width), pixels - 1);
+
+        if (at != column) {
+            column = at;
+            bins.emplace_back();
+            PyramidBin& bin = bins.back();
+            bin.first_time = firstTime(level, idx);
+            bin.last_time  = lastTime(level, idx);
+            bin.count      = count;
+            bin.min.resize(num_channels);
+            bin.max.resize(num_channels);
+            bin.mean.resize(num_channels);
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                bin.min[ch]  = stats[3 * ch + 0];
+                bin.max[ch]  = stats[3 * ch + 1];
+                bin.mean[ch] = stats[3 * ch + 2];
+            }
+            continue;
+        }
+
+        PyramidBin& bin = bins.back();
+        bin.last_time = lastTime(level, idx);
+        bin.count    += count;
+        for (std::size_t ch = 0; ch < num_channels; ++ch) {
+            bin.min[ch]   = std::min(bin.min[ch], stats[3 * ch + 0]);
+            bin.max[ch]   = std::max(bin.max[ch], stats[3 * ch + 1]);
+            bin.mean[ch] += stats[3 * ch + 2];
+        }
+    }
+
+    //-- Sums until now.
+    for (PyramidBin& bin : bins) {
+        for (double& mean : bin.mean) {
+            mean /= bin.count;
+        }
+    }
+
+    return bins;
+}
+
+
+bool RecordingPyramid::build(const RecordingReader& reader, const uint32_t stream_id) {
+
+    const std::vector<RecordingChunk>& chunks = reader.getChunks();
+    const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+    if (order.empty()) {
+        return false;
+    }
+
+    this->reset(chunks[order.front()].num_channels);
+
+    FrameView view;
+    std::vector<uint8_t> storage;
+    std::vector<double>  values, stamps;
+
+    for (const std::size_t index : order) {
+
+        if (chunks[index].var == hriPhysio::varTag::STRING || chunks[index].num_channels != num_channels) {
+            continue;
+        }
+
+        if (!reader.readChunk(index, view) || !view.decompress(storage) || !toValues(view, values)) {
+            std::cerr << "[WARNING] Skipping unreadable chunk " << index << " of the recording." << std::endl;
+            continue;
+        }
+
+        stamps.resize(view.num_samples);
+        for (std::size_t idx = 0; idx < view.num_samples; ++idx) {
+            stamps[idx] = view.timestamp(idx);
+        }
+
+        this->append(values.data(), stamps.data(), view.num_samples);
+    }
+
+    return true;
+}
+
+
+bool RecordingPyramid::save(const std::string& path) const {
+
+    std::vector<uint8_t> buffer;
+    storeField<uint64_t>(buffer, file_magic);
+    storeField<uint32_t>(buffer, file_version);
+    storeField<uint32_t>(buffer, static_cast<uint32_t>(factor));
+    storeField<uint32_t>(buffer, static_cast<uint32_t>(num_channels));
+    storeField<uint32_t>(buffer, static_cast<uint32_t>(levels.size()));
+
+    for (std::size_t level = 0; level < levels.size(); ++level) {
+
+        const Level& current = levels[level];
+        const Level  open    = this->tail(level);
+        const std::size_t closed = current.count.size();
+        const std::size_t total  = closed + (open.open_children != 0 ? 1 : 0);
+
+        storeField<uint64_t>(buffer, total);
+        for (std::size_t idx = 0; idx < total; ++idx) {
+            const double* stats = (idx < closed) ? &current.stats[idx * 3 * num_channels] : open.open_stats.data();
+            storeField<double>  (buffer, (idx < closed) ? current.first_time[idx] : open.open_first);
+            storeField<double>  (buffer, (idx < closed) ? current.last_time[idx]  : open.open_last);
+            storeField<uint64_t>(buffer, (idx < closed) ? current.count[idx]      : open.open_count);
+            for (std::size_t stat = 0; stat < 3 * num_channels; ++stat) {
+                storeField<double>(buffer, stats[stat]);
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    if (!file) {
+        std::cerr << "[ERROR] Could not write ``" << path << "``!!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool RecordingPyramid::load(const std::string& path) {
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "[ERROR] Could not open ``" << path << "``!!" << std::endl;
+        return false;
+    }
+    const std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto corrupt = [this, &path]() {
+        std::cerr << "[ERROR] ``" << path << "`` is not a decimation pyramid!!" << std::endl;
+        this->reset(0);
+        return false;
+    };
+
+    if (buffer.size() < file_header || loadField<uint64_t>(buffer.data()) != file_magic) {
+        return corrupt();
+    }
+
+    const uint32_t version  = loadField<uint32_t>(buffer.data() +  8);
+    const uint32_t factor   = loadField<uint32_t>(buffer.data() + 12);
+    const uint32_t channels = loadField<uint32_t>(buffer.data() + 16);
+    const uint32_t count    = loadField<uint32_t>(buffer.data() + 20);
+    if (version == 0 || version > file_version || factor < 2 || factor > 16 || count == 0 || count > max_levels) {
+        return corrupt();
+    }
+
+    this->factor = factor;
+    this->reset(channels);
+
+    const std::size_t bin_bytes = 24 + 24 * static_cast<std::size_t>(channels);
+    std::size_t at = file_header;
+
+    for (std::size_t level = 0; level < count; ++level) {
+
+        if (level > 0) {
+            levels.emplace_back();
+            levels.back().open_stats.resize(3 * num_channels);
+        }
+
+        if (buffer.size() - at < 8) {
+            return corrupt();
+        }
+        const uint64_t bins = loadField<uint64_t>(buffer.data() + at);
+        at += 8;
+        if (bins > (buffer.size() - at) / bin_bytes) {
+            return corrupt();
+        }
+
+        Level& current = levels.back();
+        current.first_time.resize(bins);
+        current.last_time.resize(bins);
+        current.count.resize(bins);
+        current.stats.resize(bins * 3 * num_channels);
+        for (std::size_t idx = 0; idx < bins; ++idx) {
+            current.first_time[idx] = loadField<double>  (buffer.data() + at +  0);
+            current.last_time[idx]  = loadField<double>  (buffer.data() + at +  8);
+            current.count[idx]      = loadField<uint64_t>(buffer.data() + at + 16);
+            std::memcpy(&current.stats[idx * 3 * num_channels], buffer.data() + at + 24, 24 * num_channels);
+            at += bin_bytes;
+        }
+    }
+
+    return true;
+}
+
+
+void RecordingPyramid::absorb(const std::size_t level, const double first, const double last,
+                              const uint64_t count, const double* stats) {
+
+    if (level == levels.size()) {
+        levels.emplace_back();
+        levels.back().open_stats.resize(3 * num_channels);
+    }
+
+    Level& current = levels[level];
+    double* open = current.open_stats.data();
+
+    if (current.open_children == 0) {
+        current.open_first = first;
+        current.open_count = 0;
+        std::copy(stats, stats + 3 * num_channels, open);
+    } else {
+        for (std::size_t ch = 0; ch < num_channels; ++ch) {
+            open[3 * ch + 0]  = std::min(open[3 * ch + 0], stats[3 * ch + 0]);
+            open[3 * ch + 1]  = std::max(open[3 * ch + 1], stats[3 * ch + 1]);
+            open[3 * ch + 2] += stats[3 * ch + 2];
+        }
+    }
+
+    current.open_last   = last;
+    current.open_count += count;
+    if (++current.open_children == factor) {
+        this->close(level);
+    }
+
+    return;
+}
+
+
+void RecordingPyramid::close(const std::size_t level) {
+
+    Level& current = levels[level];
+    current.first_time.push_back(current.open_first);
+    current.last_time.push_back(current.open_last);
+    current.count.push_back(current.open_count);
+    current.stats.insert(current.stats.end(), current.open_stats.begin(), current.open_stats.end());
+
+    const uint64_t count = current.open_count;
+    current.open_count    = 0;
+    current.open_children = 0;
+
+    //-- Levels are reserved, so ``current`` stays put while the bin is passed up.
+    if (level + 1 < max_levels) {
+        this->absorb(level + 1, current.first_time.back(), current.last_time.back(), count,
+                     &current.stats[current.stats.size() - 3 * num_channels]);
+    }
+
+    return;
+}
+
+
+RecordingPyramid::Level RecordingPyramid::tail(const std::size_t level) const {
+
+    Level merged;
+    merged.open_stats.resize(3 * num_channels);
+    double* stats = merged.open_stats.data();
+
+    //-- Newest samples are in the lowest level.
+    for (std::size_t below = level + 1; below-- > 0;) {
+
+        const Level& current = levels[below];
+        if (current.open_children == 0) {
+            continue;
+        }
+
+        const double* open = current.open_stats.data();
+        if (merged.open_children == 0) {
+            merged.open_first = current.open_first;
+            std::copy(open, open + 3 * num_channels, stats);
+        } else {
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                stats[3 * ch + 0]  = std::min(stats[3 * ch + 0], open[3 * ch + 0]);
+                stats[3 * ch + 1]  = std::max(stats[3 * ch + 1], open[3 * ch + 1]);
+                stats[3 * ch + 2] += open[3 * ch + 2];
+            }
+        }
+
+        merged.open_last   = current.open_last;
+        merged.open_count += current.open_count;
+        ++merged.open_children;
+    }
+
+    return merged;
+}
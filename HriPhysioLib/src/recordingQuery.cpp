@@ -0,0 +1,410 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/recordingQuery.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <tuple>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Running aggregates of one bucket of one channel.
+    struct Summary {
+        std::size_t count = 0;
+        double      mean  = 0.0;
+        double      m2    = 0.0;
+        double      min   = 0.0;
+        double      max   = 0.0;
+
+        std::vector<double> values;
+    };
+
+    //-- (file, bucket, channel).
+    using Key = std::tuple<std::size_t, int64_t, std::size_t>;
+    using Partial = std::map<Key, Summary>;
+
+
+    //-- Combine two summaries (Chan et al.), stable however they were split.
+    void merge(Summary& into, const std::size_t count, const double mean, const double m2, const double min, const double max) {
+
+        if (count == 0) {
+            return;
+        }
+
+        if (into.count == 0) {
+            into.count = count;
+            into.mean  = mean;
+            into.m2    = m2;
+            into.min   = min;
+            into.max   = max;
+            return;
+        }
+
+        const double total = static_cast<double>(into.count + count);
+        const double delta = mean - into.mean;
+        into.mean += delta * (count / total);
+        into.m2   += m2 + delta * delta * (into.count * (count / total));
+        into.min   = std::min(into.min, min);
+        into.max   = std::max(into.max, max);
+        into.count += count;
+
+        return;
+    }
+
+
+    //-- Two passes over contiguous values: min, max and sum, then squared deviations.
+    void reduce(const double* values, const std::size_t count, Summary& into, const bool keep) {
+
+        if (count == 0) {
+            return;
+        }
+
+        double low = values[0], high = values[0], sum = 0.0;
+        std::size_t idx = 0;
+
+#if defined(__SSE2__)
+        if (count >= 4) {
+            __m128d lows  = _mm_loadu_pd(values);
+            __m128d highs = lows;
+            __m128d sum_a = _mm_setzero_pd(), sum_b = _mm_setzero_pd();
+            for (; idx + 4 <= count; idx += 4) {
+                const __m128d first  = _mm_loadu_pd(values + idx);
+                const __m128d second = _mm_loadu_pd(values + idx + 2);
+                lows  = _mm_min_pd(lows,  _mm_min_pd(first, second));
+                highs = _mm_max_pd(highs, _mm_max_pd(first, second));
+                sum_a = _mm_add_pd(sum_a, first);
+                sum_b = _mm_add_pd(sum_b, second);
+            }
+
+            double lane[2];
+            _mm_storeu_pd(lane, lows);
+            low  = std::min(lane[0], lane[1]);
+            _mm_storeu_pd(lane, highs);
+            high = std::max(lane[0], lane[1]);
+            _mm_storeu_pd(lane, _mm_add_pd(sum_a, sum_b));
+            sum  = lane[0] + lane[1];
+        }
+#endif
+
+        for (; idx < count; ++idx) {
+            low  = std::min(low,  values[idx]);
+            high = std::max(high, values[idx]);
+            sum += values[idx];
+        }
+
+        const double mean = sum / count;
+        double m2 = 0.0;
+        idx = 0;
+
+#if defined(__SSE2__)
+        const __m128d centre = _mm_set1_pd(mean);
+        __m128d m2_a = _mm_setzero_pd(), m2_b = _mm_setzero_pd();
+        for (; idx + 4 <= count; idx += 4) {
+            const __m128d first  = _mm_sub_pd(_mm_loadu_pd(values + idx),     centre);
+            const __m128d second = _mm_sub_pd(_mm_loadu_pd(values + idx + 2), centre);
+            m2_a = _mm_add_pd(m2_a, _mm_mul_pd(first,  first));
+            m2_b = _mm_add_pd(m2_b, _mm_mul_pd(second, second));
+        }
+        double lane[2];
+        _mm_storeu_pd(lane, _mm_add_pd(m2_a, m2_b));
+        m2 = lane[0] + lane[1];
+#endif
+
+        for (; idx < count; ++idx) {
+            const double delta = values[idx] - mean;
+            m2 += delta * delta;
+        }
+
+        merge(into, count, mean, m2, low, high);
+        if (keep) {
+            into.values.insert(into.values.end(), values, values + count);
+        }
+
+        return;
+    }
+
+
+    //-- Channel by channel copy of a chunk, as doubles.
+    template<typename T>
+    void toColumns(const FrameView& view, std::vector<double>& columns) {
+        const std::size_t samples = view.num_samples;
+        columns.resize(samples * view.num_channels);
+        for (std::size_t ch = 0; ch < view.num_channels; ++ch) {
+            for (std::size_t idx = 0; idx < samples; ++idx) {
+                columns[ch * samples + idx] = static_cast<double>(view.value<T>(idx, ch));
+            }
+        }
+        return;
+    }
+
+
+    bool toColumns(const FrameView& view, std::vector<double>& columns) {
+        switch (view.var) {
+        case hriPhysio::varTag::CHAR:   toColumns<char>   (view, columns); return true;
+        case hriPhysio::varTag::INT16:  toColumns<int16_t>(view, columns); return true;
+        case hriPhysio::varTag::INT32:  toColumns<int32_t>(view, columns); return true;
+        case hriPhysio::varTag::INT64:  toColumns<int64_t>(view, columns); return true;
+        case hriPhysio::varTag::FLOAT:  toColumns<float>  (view, columns); return true;
+        case hriPhysio::varTag::DOUBLE: toColumns<double> (view, columns); return true;
+        default:                        return false;
+        }
+    }
+
+
+    //-- Linear interpolation between the closest ranks, like numpy.
+    double percentile(const std::vector<double>& sorted, const double percent) {
+        const double position = std::clamp(percent, 0.0, 100.0) / 100.0 * (sorted.size() - 1);
+        const std::size_t below = static_cast<std::size_t>(position);
+        if (below + 1 >= sorted.size()) {
+            return sorted.back();
+        }
+        return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+    }
+}
+
+
+RecordingQuery::RecordingQuery() :
+    stream_id(0),
+    start_time(-std::numeric_limits<double>::infinity()),
+    end_time(std::numeric_limits<double>::infinity()),
+    bucket_width(0.0),
+    num_threads(0),
+    chunks_summarized(0),
+    chunks_decoded(0) {
+}
+
+
+RecordingQuery::~RecordingQuery() {
+}
+
+
+void RecordingQuery::addFile(const std::string& path) {
+    paths.push_back(path);
+    return;
+}
+
+
+void RecordingQuery::setStreamId(const uint32_t stream_id) {
+    this->stream_id = stream_id;
+    return;
+}
+
+
+void RecordingQuery::setTimeRange(const double start, const double end) {
+    this->start_time = start;
+    this->end_time   = end;
+    return;
+}
+
+
+void RecordingQuery::setBucketWidth(const double seconds) {
+    this->bucket_width = (seconds > 0.0) ? seconds : 0.0;
+    return;
+}
+
+
+void RecordingQuery::setPercentiles(const std::vector<double>& percentiles) {
+    this->percentiles = percentiles;
+    return;
+}
+
+
+void RecordingQuery::setNumThreads(const std::size_t threads) {
+    this->num_threads = threads;
+    return;
+}
+
+
+std::vector<RecordingQuery::Bucket> RecordingQuery::run() {
+
+    chunks_summarized = 0;
+    chunks_decoded    = 0;
+
+    //-- Every chunk of every file that overlaps the range is one piece of work.
+    std::vector<std::unique_ptr<RecordingReader>> readers;
+    std::vector<double> origins;
+    std::vector<std::pair<std::size_t, std::size_t>> work;
+
+    for (std::size_t file = 0; file < paths.size(); ++file) {
+
+        readers.emplace_back(new RecordingReader());
+        origins.push_back(0.0);
+
+        RecordingReader& reader = *readers.back();
+        if (!reader.open(paths[file])) {
+            continue;
+        }
+
+        const std::vector<RecordingChunk>& chunks = reader.getChunks();
+        const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+        if (order.empty()) {
+            continue;
+        }
+
+        origins[file] = std::isfinite(start_time) ? start_time : chunks[order.front()].first_time;
+
+        for (std::size_t pos = reader.seek(stream_id, start_time); pos < order.size(); ++pos) {
+            const RecordingChunk& chunk = chunks[order[pos]];
+            if (chunk.first_time >= end_time) {
+                break;
+            }
+            if (chunk.var != hriPhysio::varTag::STRING) {
+                work.emplace_back(file, order[pos]);
+            }
+        }
+    }
+
+    const bool keep_values = !percentiles.empty();
+    const double width = bucket_width;
+
+    auto bucketOf = [width](const double time, const double origin) -> int64_t {
+        return (width > 0.0) ? static_cast<int64_t>(std::floor((time - origin) / width)) : 0;
+    };
+
+    std::atomic<std::size_t> next(0), summarized(0), decoded(0);
+
+    auto worker = [&](Partial& partial) {
+
+        std::vector<uint8_t> storage;
+        std::vector<double>  columns, times;
+
+        for (std::size_t item = next++; item < work.size(); item = next++) {
+
+            const std::size_t file  = work[item].first;
+            const std::size_t index = work[item].second;
+            const double      origin = origins[file];
+
+            const RecordingReader& reader = *readers[file];
+            const RecordingChunk&  chunk  = reader.getChunks()[index];
+
+            //-- Wholly inside one bucket, the zone map is the answer.
+            const int64_t first = bucketOf(chunk.first_time, origin);
+            if (!keep_values && chunk.zones.size() == chunk.num_channels && chunk.first_time >= start_time &&
+                chunk.last_time < end_time && first == bucketOf(chunk.last_time, origin)) {
+                for (std::size_t ch = 0; ch < chunk.num_channels; ++ch) {
+                    const RecordingZone& zone = chunk.zones[ch];
+                    merge(partial[Key(file, first, ch)], chunk.num_samples, zone.mean, zone.m2, zone.min, zone.max);
+                }
+                ++summarized;
+                continue;
+            }
+
+            FrameView view;
+            if (!reader.readChunk(index, view) || !view.decompress(storage) || !toColumns(view, columns)) {
+                std::cerr << "[WARNING] Skipping unreadable chunk " << index << " of ``" << paths[file] << "``." << std::endl;
+                continue;
+            }
+            ++decoded;
+
+            const std::size_t samples = view.num_samples;
+            times.resize(samples);
+            for (std::size_t idx = 0; idx < samples; ++idx) {
+                times[idx] = view.timestamp(idx);
+            }
+
+            //-- Timestamps are ordered, so each bucket is one run of samples.
+            std::size_t begin = std::lower_bound(times.begin(), times.end(), start_time) - times.begin();
+            while (begin < samples && times[begin] < end_time) {
+
+                const int64_t bucket = bucketOf(times[begin], origin);
+                std::size_t end = begin + 1;
+                while (end < samples && times[end] < end_time && bucketOf(times[end], origin) == bucket) {
+                    ++end;
+                }
+
+                for (std::size_t ch = 0; ch < view.num_channels; ++ch) {
+                    reduce(columns.data() + ch * samples + begin, end - begin, partial[Key(file, bucket, ch)], keep_values);
+                }
+                begin = end;
+            }
+        }
+    };
+
+    //-- One partial result per thread, merged once they are done.
+    std::size_t threads = (num_threads != 0) ? num_threads : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    threads = std::max<std::size_t>(std::min(threads, work.size()), 1);
+
+    std::vector<Partial> partials(threads);
+    std::vector<std::thread> pool;
+    for (std::size_t idx = 1; idx < threads; ++idx) {
+        pool.emplace_back(worker, std::ref(partials[idx]));
+    }
+    worker(partials[0]);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    Partial& total = partials[0];
+    for (std::size_t idx = 1; idx < threads; ++idx) {
+        for (auto& entry : partials[idx]) {
+            Summary& into = total[entry.first];
+            const Summary& from = entry.second;
+            merge(into, from.count, from.mean, from.m2, from.min, from.max);
+            into.values.insert(into.values.end(), from.values.begin(), from.values.end());
+        }
+    }
+
+    chunks_summarized = summarized;
+    chunks_decoded    = decoded;
+
+    std::vector<Bucket> buckets;
+    buckets.reserve(total.size());
+    for (auto& entry : total) {
+
+        Summary& summary = entry.second;
+
+        Bucket bucket;
+        bucket.file    = std::get<0>(entry.first);
+        bucket.channel = std::get<2>(entry.first);
+        bucket.start   = origins[bucket.file] + std::get<1>(entry.first) * width;
+        bucket.end     = (width > 0.0) ? bucket.start + width : end_time;
+        bucket.count   = summary.count;
+        bucket.mean    = summary.mean;
+        bucket.min     = summary.min;
+        bucket.max     = summary.max;
+        bucket.std     = (summary.count > 1) ? std::sqrt(summary.m2 / (summary.count - 1)) : 0.0;
+
+        if (keep_values && !summary.values.empty()) {
+            std::sort(summary.values.begin(), summary.values.end());
+            for (const double percent : percentiles) {
+                bucket.percentiles.push_back(percentile(summary.values, percent));
+            }
+        }
+
+        buckets.push_back(bucket);
+    }
+
+    return buckets;
+}
+
+
+std::size_t RecordingQuery::getChunksSummarized() const {
+    return chunks_summarized;
+}
+
+
+std::size_t RecordingQuery::getChunksDecoded() const {
+    return chunks_decoded;
+}
@@ -0,0 +1,430 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/recordingStreamer.h>
+
+#include <algorithm>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Copy samples out of a chunk, converting to the streamer's type.
+    template<typename Out, typename In>
+    void appendSamples(const FrameView& view, const std::size_t first, const std::size_t count,
+                       std::vector<hriPhysio::varType>& buff) {
+        for (std::size_t idx = first; idx < first + count; ++idx) {
+            for (std::size_t ch = 0; ch < view.num_channels; ++ch) {
+                buff.push_back(static_cast<Out>(view.value<In>(idx, ch)));
+            }
+        }
+    }
+
+
+    template<typename Out>
+    bool appendAs(const FrameView& view, const std::size_t first, const std::size_t count,
+                  std::vector<hriPhysio::varType>& buff) {
+        switch (view.var) {
+        case hriPhysio::varTag::CHAR:     appendSamples<Out, char>   (view, first, count, buff); return true;
+        case hriPhysio::varTag::INT16:    appendSamples<Out, int16_t>(view, first, count, buff); return true;
+        case hriPhysio::varTag::INT32:    appendSamples<Out, int32_t>(view, first, count, buff); return true;
+        case hriPhysio::varTag::INT64:
+        case hriPhysio::varTag::LONGLONG: appendSamples<Out, int64_t>(view, first, count, buff); return true;
+        case hriPhysio::varTag::FLOAT:    appendSamples<Out, float>  (view, first, count, buff); return true;
+        case hriPhysio::varTag::DOUBLE:   appendSamples<Out, double> (view, first, count, buff); return true;
+        default:                          return false;
+        }
+    }
+}
+
+
+StreamerInterface* hriPhysio::Stream::makeLogger(std::string format) {
+
+    hriPhysio::toLower(format);
+    if (format == "hrec") {
+        return new RecordingStreamer();
+    }
+
+    if (format != "csv") {
+        std::cerr << "[WARNING] Unknown log format ``" << format << "``, writing csv." << std::endl;
+    }
+
+    return new CsvStreamer();
+}
+
+
+RecordingStreamer::RecordingStreamer() :
+    StreamerInterface(),
+    stream_id(0),
+    chunk_length(1024),
+    chunk_interval(1.0),
+    keep_pyramid(true),
+    read_chunk(0),
+    read_sample(0),
+    view_chunk(0),
+    view_valid(false) {
+}
+
+
+RecordingStreamer::~RecordingStreamer() {
+    if (writer.isOpen()) {
+        this->flush();
+        writer.close();
+
+        if (keep_pyramid) {
+            pyramid.save(RecordingPyramid::pathFor(this->name));
+        }
+    }
+}
+
+
+void RecordingStreamer::setStreamId(const uint32_t id) {
+    this->stream_id = id;
+    return;
+}
+
+
+void RecordingStreamer::setChunkLength(const std::size_t samples) {
+    this->chunk_length = std::max<std::size_t>(samples, 1);
+    return;
+}
+
+
+void RecordingStreamer::setChunkInterval(const double seconds) {
+    this->chunk_interval = seconds;
+    return;
+}
+
+
+void RecordingStreamer::setCompression(const bool enable) {
+    writer.setCompression(enable);
+    return;
+}
+
+
+void RecordingStreamer::setPyramid(const bool enable) {
+    this->keep_pyramid = enable;
+    return;
+}
+
+
+bool RecordingStreamer::setPyramidFactor(const std::size_t factor) {
+    return pyramid.setFactor(factor);
+}
+
+
+uint32_t RecordingStreamer::getStreamId() const {
+    return this->stream_id;
+}
+
+
+const RecordingPyramid& RecordingStreamer::getPyramid() const {
+    return this->pyramid;
+}
+
+
+void RecordingStreamer::flush() {
+
+    if (!writer.isOpen()) { return; }
+
+    this->writePending(pending_stamps.size());
+    writer.flush();
+
+    return;
+}
+
+
+void RecordingStreamer::rewind() {
+    read_chunk  = 0;
+    read_sample = 0;
+    return;
+}
+
+
+bool RecordingStreamer::seek(const double time) {
+
+    if (!reader.isOpen()) { return false; }
+
+    const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+
+    read_chunk  = reader.seek(stream_id, time);
+    read_sample = 0;
+    if (read_chunk >= order.size()) {
+        return false;
+    }
+
+    const FrameView* chunk = this->currentChunk();
+    if (chunk == nullptr || chunk->var == hriPhysio::varTag::STRING) {
+        return true;
+    }
+
+    //-- First sample of the chunk that is not before ``time``.
+    std::size_t low = 0, high = chunk->num_samples;
+    while (low < high) {
+        const std::size_t mid = (low + high) / 2;
+        if (chunk->timestamp(mid) < time) { low = mid + 1; } else { high = mid; }
+    }
+    read_sample = low;
+
+    return true;
+}
+
+
+bool RecordingStreamer::openInputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::RECEIVER;
+
+    try {
+
+        if (!reader.open(this->name)) {
+            return false;
+        }
+        view_valid = false;
+        view_chunk = reader.getChunks().size();
+
+        //-- Take the channel count from the recording when not configured.
+        const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+        if (order.empty()) {
+            std::cerr << "[WARNING] ``" << this->name << "`` holds no stream " << stream_id << "!!" << std::endl;
+        } else if (this->num_channels == 0) {
+            this->num_channels = reader.getChunks()[order.front()].num_channels;
+        }
+
+        this->rewind();
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+bool RecordingStreamer::openOutputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::SENDER;
+
+    try {
+
+        if (!writer.open(this->name)) {
+            return false;
+        }
+
+        pending.clear();
+        pending_stamps.clear();
+        pyramid.reset(this->num_channels);
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+void RecordingStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps/*=nullptr*/) {
+
+    if (!writer.isOpen() || this->num_channels == 0 || this->var == hriPhysio::varTag::STRING) { return; }
+
+    const std::size_t channels    = this->num_channels;
+    const std::size_t num_samples = buff.size() / channels;
+    const std::size_t num_stamps  = (timestamps != nullptr) ? timestamps->size() : 0;
+
+    if (pending_stamps.empty()) {
+        pending_since = std::chrono::steady_clock::now();
+    }
+
+    //-- Store every value as the configured type.
+    const hriPhysio::varTag var = this->var;
+    for (std::size_t idx = 0; idx < num_samples * channels; ++idx) {
+        pending.push_back(std::visit([var](auto value) -> hriPhysio::varType {
+            switch (var) {
+            case hriPhysio::varTag::CHAR:   return static_cast<char>(value);
+            case hriPhysio::varTag::INT16:  return static_cast<int16_t>(value);
+            case hriPhysio::varTag::INT32:  return static_cast<int32_t>(value);
+            case hriPhysio::varTag::FLOAT:  return static_cast<float>(value);
+            case hriPhysio::varTag::DOUBLE: return static_cast<double>(value);
+            default:                        return static_cast<int64_t>(value);
+            }
+        }, buff[idx]));
+    }
+    for (std::size_t idx = 0; idx < num_samples; ++idx) {
+        pending_stamps.push_back((idx < num_stamps) ? (*timestamps)[idx] : 0.0);
+    }
+
+    while (pending_stamps.size() >= chunk_length) {
+        this->writePending(chunk_length);
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - pending_since).count();
+    if (!pending_stamps.empty() && elapsed >= chunk_interval) {
+        this->writePending(pending_stamps.size());
+    }
+
+    return;
+}
+
+
+void RecordingStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pullStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pullStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pullStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+    case hriPhysio::varTag::LONGLONG:
+        this->pullStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pullStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pullStream<double>(buff, timestamps);
+        break;
+    default:
+        buff.clear();
+        break;
+    }
+
+    return;
+}
+
+
+void RecordingStreamer::publish(const std::string& buff, const double* timestamps/*=nullptr*/) {
+
+    if (!writer.isOpen()) { return; }
+
+    //-- Keep the stream in time order.
+    this->writePending(pending_stamps.size());
+    writer.writeString(stream_id, buff, (timestamps != nullptr) ? *timestamps : 0.0);
+
+    return;
+}
+
+
+void RecordingStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
+
+    buff.clear();
+    if (!reader.isOpen()) { return; }
+
+    const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+
+    while (read_chunk < order.size()) {
+
+        const FrameView* chunk = this->currentChunk();
+        ++read_chunk;
+        read_sample = 0;
+
+        if (chunk != nullptr && chunk->var == hriPhysio::varTag::STRING) {
+            buff.assign(reinterpret_cast<const char*>(chunk->payload), chunk->payload_bytes);
+            if (timestamps != nullptr) { *timestamps = chunk->timestamp(0); }
+            return;
+        }
+    }
+
+    return;
+}
+
+
+void RecordingStreamer::writePending(const std::size_t samples) {
+
+    if (samples == 0) { return; }
+
+    const std::size_t values = samples * this->num_channels;
+    writer.writeChunk(stream_id, this->var, pending.data(), this->num_channels, samples, pending_stamps.data());
+
+    if (keep_pyramid) {
+        pyramid_values.resize(values);
+        for (std::size_t idx = 0; idx < values; ++idx) {
+            pyramid_values[idx] = std::visit([](auto value) { return static_cast<double>(value); }, pending[idx]);
+        }
+        pyramid.append(pyramid_values.data(), pending_stamps.data(), samples);
+    }
+
+    pending.erase(pending.begin(), pending.begin() + values);
+    pending_stamps.erase(pending_stamps.begin(), pending_stamps.begin() + samples);
+    pending_since = std::chrono::steady_clock::now();
+
+    return;
+}
+
+
+const FrameView* RecordingStreamer::currentChunk() {
+
+    const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+    if (read_chunk >= order.size()) {
+        return nullptr;
+    }
+
+    if (view_chunk != order[read_chunk]) {
+        view_chunk = order[read_chunk];
+        view_valid = reader.readChunk(view_chunk, view) && view.decompress(view_values);
+    }
+
+    return view_valid ? &view : nullptr;
+}
+
+
+template<typename T>
+void RecordingStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
+
+    buff.clear();
+    if (timestamps != nullptr) { timestamps->clear(); }
+
+    if (!reader.isOpen() || this->num_channels == 0) { return; }
+
+    const std::vector<std::size_t>& order = reader.getStreamChunks(stream_id);
+    const std::size_t limit = std::max<std::size_t>(this->frame_length, 1);
+
+    buff.reserve(limit * this->num_channels);
+
+    std::size_t taken = 0;
+    while (taken < limit && read_chunk < order.size()) {
+
+        //-- Skip anything that does not fit this stream's shape.
+        const FrameView* chunk = this->currentChunk();
+        if (chunk == nullptr || chunk->num_channels != this->num_channels ||
+            read_sample >= chunk->num_samples || chunk->var == hriPhysio::varTag::STRING) {
+            ++read_chunk;
+            read_sample = 0;
+            continue;
+        }
+
+        const std::size_t count = std::min<std::size_t>(limit - taken, chunk->num_samples - read_sample);
+        appendAs<T>(*chunk, read_sample, count, buff);
+        if (timestamps != nullptr) {
+            for (std::size_t idx = read_sample; idx < read_sample + count; ++idx) {
+                timestamps->push_back(chunk->timestamp(idx));
+            }
+        }
+
+        taken       += count;
+        read_sample += count;
+    }
+
+    return;
+}
@@ -0,0 +1,227 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/replayStreamer.h>
+
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+using namespace hriPhysio::Stream;
+
+
+ReplayStreamer::ReplayStreamer() :
+    StreamerInterface(),
+    speed(1.0),
+    loop(false),
+    started(false),
+    first_stamp(0.0),
+    last_stamp(0.0),
+    loop_offset(0.0) {
+
+    start_time.tv_sec  = 0;
+    start_time.tv_nsec = 0;
+}
+
+
+ReplayStreamer::~ReplayStreamer() {
+}
+
+
+void ReplayStreamer::setSpeed(const double speed) {
+    this->speed = (speed > 0.0) ? speed : 0.0;
+    return;
+}
+
+
+void ReplayStreamer::setLoop(const bool loop) {
+    this->loop = loop;
+    return;
+}
+
+
+double ReplayStreamer::getSpeed() const {
+    return this->speed;
+}
+
+
+bool ReplayStreamer::getLoop() const {
+    return this->loop;
+}
+
+
+bool ReplayStreamer::openInputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::RECEIVER;
+
+    try {
+
+        //-- Read the recording with the same settings.
+        const std::string extension = ".hrec";
+        if (this->name.size() > extension.size() &&
+            this->name.compare(this->name.size() - extension.size(), extension.size(), extension) == 0) {
+            source.reset(new hriPhysio::Stream::RecordingStreamer());
+        } else {
+            source.reset(new hriPhysio::Stream::CsvStreamer());
+        }
+        source->setName(this->name);
+        source->setDataType(this->dtype);
+        source->setFrameLength(this->frame_length);
+        source->setNumChannels(this->num_channels);
+        source->setSamplingRate(this->sampling_rate);
+
+        if (!source->openInputStream()) {
+            source.reset();
+            return false;
+        }
+
+        this->num_channels = source->getNumChannels();
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+bool ReplayStreamer::openOutputStream() {
+
+    std::cerr << "[ERROR] Replay streams can only be opened for input!!" << std::endl;
+    return false;
+}
+
+
+void ReplayStreamer::publish(const std::vector<hriPhysio::varType>&  /*buff*/, const std::vector<double>* /*timestamps=nullptr*/) {
+    std::cerr << "[ERROR] Replay streams can only be opened for input!!" << std::endl;
+    return;
+}
+
+
+void ReplayStreamer::publish(const std::string& /*buff*/, const double* /*timestamps=nullptr*/) {
+    std::cerr << "[ERROR] Replay streams can only be opened for input!!" << std::endl;
+    return;
+}
+
+
+void ReplayStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
+
+    buff.clear();
+    if (!source) { return; }
+
+    //-- Always collect the stamps, they drive the schedule.
+    std::vector<double> local;
+    std::vector<double>& stamps = (timestamps != nullptr) ? *timestamps : local;
+
+    source->receive(buff, &stamps);
+    if (buff.empty() && this->restart()) {
+        source->receive(buff, &stamps);
+    }
+
+    //-- End of the recording, don't let the caller spin.
+    if (buff.empty() || stamps.empty()) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(this->timeout));
+        return;
+    }
+
+    //-- Release the frame when its last sample is due, like a live sensor would.
+    for (double& stamp : stamps) {
+        stamp += loop_offset;
+    }
+    this->waitUntil(stamps.front(), stamps.back());
+
+    return;
+}
+
+
+void ReplayStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
+
+    buff.clear();
+    if (!source) { return; }
+
+    double stamp = 0.0;
+    source->receive(buff, &stamp);
+    if (buff.empty() && this->restart()) {
+        source->receive(buff, &stamp);
+    }
+
+    if (buff.empty()) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(this->timeout));
+        return;
+    }
+
+    stamp += loop_offset;
+    this->waitUntil(stamp, stamp);
+
+    if (timestamps != nullptr) { *timestamps = stamp; }
+
+    return;
+}
+
+
+bool ReplayStreamer::restart() {
+
+    if (!loop || !started) {
+        return false;
+    }
+
+    //-- The next pass continues one sample period after the last one.
+    const double period = (this->sampling_rate > 0) ? 1.0 / this->sampling_rate : 0.0;
+    loop_offset += last_stamp + period - first_stamp;
+
+    if (auto* csv = dynamic_cast<hriPhysio::Stream::CsvStreamer*>(source.get())) {
+        csv->rewind();
+    } else if (auto* recording = dynamic_cast<hriPhysio::Stream::RecordingStreamer*>(source.get())) {
+        recording->rewind();
+    }
+
+    return true;
+}
+
+
+void ReplayStreamer::waitUntil(const double first, const double stamp) {
+
+    //-- The first sample ever replayed anchors the schedule.
+    if (!started) {
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        first_stamp = first;
+        started     = true;
+    }
+    last_stamp = stamp - loop_offset;
+
+    if (speed <= 0.0) {
+        return;
+    }
+
+    //-- Absolute deadlines, so sleeping late never accumulates drift.
+    const double offset = (stamp - first_stamp) / speed;
+    if (offset <= 0.0) {
+        return;
+    }
+
+    struct timespec deadline = start_time;
+    const long long nanoseconds = static_cast<long long>(offset * 1e9);
+    deadline.tv_sec  += nanoseconds / 1000000000LL;
+    deadline.tv_nsec += nanoseconds % 1000000000LL;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+
+    return;
+}
@@ -0,0 +1,319 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/respirationTracker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace hriPhysio::Processing;
+
+
+namespace {
+
+    //-- Intervals outside these (ms) are missed or extra beats, not breathing.
+    const double shortest_rr = 300.0;
+    const double longest_rr  = 2000.0;
+
+    //-- The first peak at least this fraction of the highest is the period,
+    //-- so a multiple of it is not taken instead.
+    const double strong_peak = 0.8;
+
+    //-- A source must reach this close to both ends of the window.
+    const double coverage = 0.1;
+}
+
+
+RespirationTracker::RespirationTracker(const double window, const double rate, const double update,
+                                       const std::size_t numAxes, const double minBpm, const double maxBpm) :
+    window(window),
+    rate(rate),
+    update(update),
+    num_axes(numAxes),
+    min_bpm(minBpm),
+    max_bpm(maxBpm) {
+
+    this->reset();
+}
+
+
+void RespirationTracker::reset() {
+
+    amplitudes.clear();
+    intervals.clear();
+    axes.assign(num_axes, std::deque<std::pair<double, double>>());
+
+    last_beat = std::numeric_limits<double>::quiet_NaN();
+    bin_start = std::numeric_limits<double>::quiet_NaN();
+    bin_count = 0;
+    bin_sums.assign(num_axes, 0.0);
+
+    latest      = -std::numeric_limits<double>::infinity();
+    last_update = -std::numeric_limits<double>::infinity();
+
+    return;
+}
+
+
+void RespirationTracker::addBeats(const double* peaks, const double* amplitudes, const std::size_t numPeaks) {
+
+    for (std::size_t idx = 0; idx < numPeaks; ++idx) {
+
+        const double interval = (peaks[idx] - last_beat) * 1000.0;
+        if (interval >= shortest_rr && interval <= longest_rr) {
+            this->intervals.emplace_back(peaks[idx], interval);
+        }
+        this->amplitudes.emplace_back(peaks[idx], amplitudes[idx]);
+
+        last_beat = peaks[idx];
+        latest    = std::max(latest, peaks[idx]);
+    }
+
+    this->trim(this->amplitudes);
+    this->trim(this->intervals);
+
+    return;
+}
+
+
+void RespirationTracker::addMotion(const double* source, const double* stamps, const std::size_t numFrames) {
+
+    const double width = 1.0 / rate;
+
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+
+        const double stamp = stamps[frame];
+        if (std::isnan(bin_start)) {
+            bin_start = stamp;
+        }
+
+        //-- Close the bin once a sample falls past it, and start the next
+        //-- one here if the stream skipped ahead.
+        if (stamp >= bin_start + width) {
+            if (bin_count != 0) {
+                for (std::size_t axis = 0; axis < num_axes; ++axis) {
+                    axes[axis].emplace_back(bin_start + 0.5 * width, bin_sums[axis] / bin_count);
+                    bin_sums[axis] = 0.0;
+                }
+            }
+            bin_count = 0;
+            bin_start = (stamp >= bin_start + 2.0 * width) ? stamp : bin_start + width;
+        }
+
+        for (std::size_t axis = 0; axis < num_axes; ++axis) {
+            bin_sums[axis] += source[frame * num_axes + axis];
+        }
+        ++bin_count;
+
+        latest = std::max(latest, stamp);
+    }
+
+    for (std::deque<std::pair<double, double>>& axis : axes) {
+        this->trim(axis);
+    }
+
+    return;
+}
+
+
+bool RespirationTracker::estimate(const double now, RespirationEstimate& estimate) {
+
+    if (now - last_update < update) {
+        return false;
+    }
+    last_update = now;
+
+    estimate = RespirationEstimate();
+    estimate.time = now;
+
+    const double start = now - window;
+    fused.assign(this->maxLag() - this->minLag() + 1, 0.0);
+
+    double total = 0.0, weight = 0.0;
+
+    estimate.edr = this->accumulate(amplitudes, start, now, weight);
+    total += weight;
+
+    estimate.rsa = this->accumulate(intervals, start, now, weight);
+    total += weight;
+
+    //-- Report the axis that moves most with the breath.
+    double strongest = 0.0;
+    for (const std::deque<std::pair<double, double>>& axis : axes) {
+        const double bpm = this->accumulate(axis, start, now, weight);
+        total += weight;
+        if (weight > strongest) {
+            strongest       = weight;
+            estimate.motion = bpm;
+        }
+    }
+
+    if (total > 0.0) {
+        for (double& value : fused) {
+            value /= total;
+        }
+        estimate.rate = this->pick(fused, estimate.quality);
+    }
+
+    return true;
+}
+
+
+std::size_t RespirationTracker::getNumAxes() const {
+    return this->num_axes;
+}
+
+
+bool RespirationTracker::resample(const std::deque<std::pair<double, double>>& source, const double start, const double end) {
+
+    if (source.size() < 2 || source.front().first > start + coverage * window || source.back().first < end - coverage * window) {
+        return false;
+    }
+
+    //-- Linear interpolation, holding the ends.
+    const std::size_t length = static_cast<std::size_t>(std::lround(window * rate));
+    grid.resize(length);
+
+    std::size_t next = 0;
+    for (std::size_t idx = 0; idx < length; ++idx) {
+
+        const double time = start + (idx + 1) / rate;
+        while (next < source.size() && source[next].first < time) {
+            ++next;
+        }
+
+        if (next == 0) {
+            grid[idx] = source.front().second;
+        } else if (next == source.size()) {
+            grid[idx] = source.back().second;
+        } else {
+            const std::pair<double, double>& lhs = source[next - 1];
+            const std::pair<double, double>& rhs = source[next];
+            grid[idx] = lhs.second + (time - lhs.first) / (rhs.first - lhs.first) * (rhs.second - lhs.second);
+        }
+    }
+
+    return true;
+}
+
+
+void RespirationTracker::autocorrelate() {
+
+    const std::size_t length = grid.size();
+    const std::size_t lowest = this->minLag();
+    correlation.assign(this->maxLag() - lowest + 1, 0.0);
+
+    //-- Remove the best line, drifts of the baseline are not breathing.
+    const double t_mean = (length - 1) / 2.0;
+    double y_mean = 0.0;
+    for (const double value : grid) {
+        y_mean += value;
+    }
+    y_mean /= length;
+
+    double covariance = 0.0, variance = 0.0;
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        covariance += (idx - t_mean) * (grid[idx] - y_mean);
+        variance   += (idx - t_mean) * (idx - t_mean);
+    }
+    const double slope = (variance > 0.0) ? covariance / variance : 0.0;
+
+    double energy = 0.0;
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        grid[idx] -= y_mean + slope * (idx - t_mean);
+        energy    += grid[idx] * grid[idx];
+    }
+    if (energy <= 0.0) {
+        return;
+    }
+
+    //-- Unbiased estimate, normalised by the lag zero term.
+    for (std::size_t lag = lowest; lag < lowest + correlation.size() && lag < length; ++lag) {
+        double sum = 0.0;
+        for (std::size_t idx = 0; idx + lag < length; ++idx) {
+            sum += grid[idx] * grid[idx + lag];
+        }
+        correlation[lag - lowest] = (sum / (length - lag)) / (energy / length);
+    }
+
+    return;
+}
+
+
+double RespirationTracker::pick(const std::vector<double>& values, double& height) const {
+
+    height = 0.0;
+
+    double highest = 0.0;
+    for (std::size_t idx = 1; idx + 1 < values.size(); ++idx) {
+        if (values[idx] > values[idx - 1] && values[idx] >= values[idx + 1]) {
+            highest = std::max(highest, values[idx]);
+        }
+    }
+    if (highest <= 0.0) {
+        return 0.0;
+    }
+
+    for (std::size_t idx = 1; idx + 1 < values.size(); ++idx) {
+        if (values[idx] > values[idx - 1] && values[idx] >= values[idx + 1] && values[idx] >= strong_peak * highest) {
+
+            const double curve  = values[idx - 1] - 2.0 * values[idx] + values[idx + 1];
+            const double offset = (curve < 0.0) ? 0.5 * (values[idx - 1] - values[idx + 1]) / curve : 0.0;
+
+            height = values[idx];
+            return 60.0 * rate / (this->minLag() + idx + offset);
+        }
+    }
+
+    return 0.0;
+}
+
+
+double RespirationTracker::accumulate(const std::deque<std::pair<double, double>>& source, const double start, const double end,
+                                      double& weight) {
+
+    weight = 0.0;
+    if (!this->resample(source, start, end)) {
+        return 0.0;
+    }
+
+    this->autocorrelate();
+    const double bpm = this->pick(correlation, weight);
+
+    for (std::size_t idx = 0; idx < fused.size(); ++idx) {
+        fused[idx] += weight * correlation[idx];
+    }
+
+    return bpm;
+}
+
+
+void RespirationTracker::trim(std::deque<std::pair<double, double>>& source) const {
+
+    //-- Keep one point before the window, to interpolate from.
+    while (source.size() > 2 && source[1].first < latest - window) {
+        source.pop_front();
+    }
+
+    return;
+}
+
+
+std::size_t RespirationTracker::minLag() const {
+    return static_cast<std::size_t>(std::max(std::floor(60.0 * rate / max_bpm) - 1.0, 1.0));
+}
+
+
+std::size_t RespirationTracker::maxLag() const {
+    return static_cast<std::size_t>(std::ceil(60.0 * rate / min_bpm) + 1.0);
+}
@@ -57,6 +57,7 @@ void RobotManager::configure(int argc, char **argv) {
     //-- Enable logging?
     log_data = config["log_data"].as<bool>( /*default=*/ false );
     log_name = config["log_name"].as<std::string>( /*default=*/ "");
+    log_format = config["log_format"].as<std::string>( /*default=*/ "csv");
 
     std::cerr << "[CONF] Load complete.\n";
     
@@ -69,11 +70,12 @@ void RobotManager::configure(int argc, char **argv) {
 
     if (log_data) {
 
-        robot_logger.setName(log_name);
-        robot_logger.setDataType("STRING");
-        robot_logger.setNumChannels(1);
+        robot_logger.reset(hriPhysio::Stream::makeLogger(log_format));
+        robot_logger->setName(log_name);
+        robot_logger->setDataType("STRING");
+        robot_logger->setNumChannels(1);
     
-        if (!robot_logger.openOutputStream()) {
+        if (!robot_logger->openOutputStream()) {
             std::cerr << "Could not open logger stream.\n";
             this->close();
             return;
@@ -122,7 +124,7 @@ void RobotManager::process(const std::string& inp) {
         //-- Log the data received.
         std::chrono::duration<double> now = std::chrono::system_clock::now() - start_time;
         double t = now.count();
-        this->robot_logger.publish(inp, &t);
+        this->robot_logger->publish(inp, &t);
     }
 
     //-- Parse it up.
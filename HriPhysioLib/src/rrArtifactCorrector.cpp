@@ -0,0 +1,195 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/rrArtifactCorrector.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace hriPhysio::Processing;
+
+
+RRArtifactCorrector::RRArtifactCorrector(const Method method, const double low, const double high, const std::size_t maxGap) :
+    method(method),
+    low_rr(low),
+    high_rr(high),
+    max_gap(maxGap) {
+
+    this->reset();
+}
+
+
+bool RRArtifactCorrector::parseMethod(std::string name, Method& method) {
+
+    hriPhysio::toLower(name);
+
+    if (name == "malik")    { method = Method::Malik;    return true; }
+    if (name == "kamath")   { method = Method::Kamath;   return true; }
+    if (name == "karlsson") { method = Method::Karlsson; return true; }
+
+    return false;
+}
+
+
+void RRArtifactCorrector::reset() {
+
+    reference = 0.0;
+    gap       = 0;
+    held.clear();
+
+    has_pending = false;
+    pending     = 0.0;
+
+    num_corrected = 0;
+
+    return;
+}
+
+
+void RRArtifactCorrector::process(const double* rr, const std::size_t numIntervals, std::vector<double>& nn) {
+
+    for (std::size_t idx = 0; idx < numIntervals; ++idx) {
+
+        if (method != Method::Karlsson) {
+            this->handle(rr[idx], 0.0, nn);
+            continue;
+        }
+
+        //-- Karlsson judges each interval once its successor is known.
+        if (!has_pending) {
+            pending     = rr[idx];
+            has_pending = true;
+            continue;
+        }
+
+        const double value = pending;
+        pending = rr[idx];
+
+        const bool plausible = (low_rr <= pending && pending <= high_rr);
+        this->handle(value, plausible ? pending : 0.0, nn);
+    }
+
+    return;
+}
+
+
+void RRArtifactCorrector::flush(std::vector<double>& nn) {
+
+    if (has_pending) {
+        has_pending = false;
+        this->handle(pending, 0.0, nn);
+    }
+
+    if (gap > 0) {
+        this->giveUp(nn);
+    }
+
+    return;
+}
+
+
+std::size_t RRArtifactCorrector::getNumCorrected() const {
+    return num_corrected;
+}
+
+
+void RRArtifactCorrector::handle(const double value, const double next, std::vector<double>& nn) {
+
+    bool good = (low_rr <= value && value <= high_rr);
+    if (good && reference > 0.0) {
+        good = !this->isEctopic(value, next);
+    }
+
+    if (good) {
+        this->accept(value, nn);
+    } else {
+        this->reject(value, nn);
+    }
+
+    return;
+}
+
+
+bool RRArtifactCorrector::isEctopic(const double value, const double next) const {
+
+    const double previous = reference;
+
+    switch (method) {
+    case Method::Kamath:
+        return (value > previous * 1.325) || (value < previous * 0.755);
+
+    case Method::Karlsson:
+        //-- A neighbour that is itself far off would drag the mean with it.
+        if (next > 0.0 && std::abs(next - previous) <= 0.2 * previous) {
+            const double mean = 0.5 * (previous + next);
+            return std::abs(value - mean) >= 0.2 * mean;
+        }
+        //-- Otherwise fall back on the previous interval alone.
+        [[fallthrough]];
+
+    default:
+        return std::abs(value - previous) > 0.2 * previous;
+    }
+}
+
+
+void RRArtifactCorrector::accept(const double value, std::vector<double>& nn) {
+
+    //-- Draw a line over the gap, or fill it with this value at the start.
+    for (std::size_t idx = 1; idx <= gap; ++idx) {
+        if (reference > 0.0) {
+            nn.push_back(reference + (value - reference) * idx / (gap + 1));
+        } else {
+            nn.push_back(value);
+        }
+    }
+    num_corrected += gap;
+
+    nn.push_back(value);
+
+    reference = value;
+    gap       = 0;
+    held.clear();
+
+    return;
+}
+
+
+void RRArtifactCorrector::reject(const double value, std::vector<double>& nn) {
+
+    held.push_back(value);
+    ++gap;
+
+    if (gap > max_gap) {
+        this->giveUp(nn);
+    }
+
+    return;
+}
+
+
+void RRArtifactCorrector::giveUp(std::vector<double>& nn) {
+
+    //-- Hold the last good interval over the gap. Without one, the best
+    //-- that can be said is the nearest plausible value.
+    for (const double value : held) {
+        nn.push_back((reference > 0.0) ? reference : std::clamp(value, low_rr, high_rr));
+    }
+    num_corrected += gap;
+
+    //-- Whatever comes next sets the rhythm again.
+    reference = 0.0;
+    gap       = 0;
+    held.clear();
+
+    return;
+}
@@ -0,0 +1,659 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/shmStreamer.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <new>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Slots are cache-line aligned so neighbouring frames never share a line.
+    constexpr std::size_t cache_line = 64;
+
+    //-- Strings are carried as raw bytes in a single slot.
+    constexpr std::size_t string_capacity = 4096;
+
+    //-- How long a reader waits for a writer to create the segment.
+    constexpr double open_timeout = 5.0;
+
+    //-- Sequence value marking a slot that is being rewritten.
+    constexpr uint64_t slot_busy = UINT64_MAX;
+
+
+    std::size_t alignUp(const std::size_t value, const std::size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+
+    double monotonicSeconds() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+
+    int futexWait(std::atomic<uint32_t>* addr, const uint32_t expected, const double seconds) {
+        struct timespec ts;
+        ts.tv_sec  = static_cast<time_t>(seconds);
+        ts.tv_nsec = static_cast<long>((seconds - ts.tv_sec) * 1e9);
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+
+    int futexWake(std::atomic<uint32_t>* addr) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+
+    //-- The name setDataType accepts for a tag.
+    std::string dtypeName(const hriPhysio::varTag var) {
+        switch (var) {
+        case hriPhysio::varTag::CHAR:   return "CHAR";
+        case hriPhysio::varTag::INT16:  return "INT16";
+        case hriPhysio::varTag::INT32:  return "INT32";
+        case hriPhysio::varTag::INT64:  return "INT64";
+        case hriPhysio::varTag::FLOAT:  return "FLOAT";
+        case hriPhysio::varTag::DOUBLE: return "DOUBLE";
+        case hriPhysio::varTag::STRING: return "STRING";
+        default:                        return "";
+        }
+    }
+
+
+    //-- True if the segment was created by a writer whose process still runs.
+    //-- A segment from an older layout or a dead process is stale.
+    bool hasLiveWriter(const std::string& shm_name) {
+
+        const int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+
+        bool live = false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(ShmStreamer::SegmentHeader)) {
+            void* addr = mmap(nullptr, sizeof(ShmStreamer::SegmentHeader), PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                const ShmStreamer::SegmentHeader* header = static_cast<const ShmStreamer::SegmentHeader*>(addr);
+                if (header->magic == ShmStreamer::SEGMENT_MAGIC && header->version == ShmStreamer::SEGMENT_VERSION
+                    && header->writer_pid != 0) {
+                    const pid_t pid = static_cast<pid_t>(header->writer_pid);
+                    live = (kill(pid, 0) == 0 || errno == EPERM);
+                }
+                munmap(addr, sizeof(ShmStreamer::SegmentHeader));
+            }
+        }
+        close(fd);
+
+        return live;
+    }
+}
+
+
+ShmStreamer::ShmStreamer() :
+    StreamerInterface(),
+    shm_fd(-1),
+    shm_size(0),
+    shm_base(nullptr),
+    header(nullptr),
+    num_slots(64),
+    read_seq(0),
+    overruns(0) {
+
+}
+
+
+ShmStreamer::~ShmStreamer() {
+
+    //-- The writer that created the segment owns the name, readers and
+    //-- writers that failed to open only detach.
+    const bool owner = (this->mode == modeTag::SENDER && header != nullptr);
+
+    this->unmapSegment();
+
+    if (owner) {
+        shm_unlink(shm_name.c_str());
+    }
+}
+
+
+void ShmStreamer::setNumSlots(const std::size_t slots) {
+    this->num_slots = (slots > 1) ? slots : 2;
+    return;
+}
+
+
+uint64_t ShmStreamer::getOverruns() const {
+    return this->overruns;
+}
+
+
+bool ShmStreamer::openInputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::RECEIVER;
+
+    try {
+
+        //-- Attach to the segment created by the writer.
+        if (!this->mapSegment(/*create=*/ false)) {
+            return false;
+        }
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+bool ShmStreamer::openOutputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::SENDER;
+
+    try {
+
+        //-- Create and initialize the segment.
+        if (!this->mapSegment(/*create=*/ true)) {
+            return false;
+        }
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+void ShmStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pushStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pushStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pushStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+        this->pushStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pushStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pushStream<double>(buff, timestamps);
+        break;
+    default:
+        break;
+    }
+}
+
+
+void ShmStreamer::publish(const std::string& buff, const double* timestamps/*=nullptr*/) {
+
+    if (header == nullptr) { return; }
+
+    //-- Strings occupy a single slot, truncated to its capacity.
+    const uint64_t seq = header->write_seq.load(std::memory_order_relaxed);
+    SlotHeader* slot = this->getSlot(seq);
+    slot->seq.store(slot_busy, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const std::size_t length = std::min<std::size_t>(buff.size(), header->slot_samples);
+    if (length < buff.size()) {
+        std::cerr << "[WARNING] Shared memory stream ``" << this->name << "`` truncated a string of "
+                  << buff.size() << " bytes to " << length << "." << std::endl;
+    }
+    std::memcpy(this->getSlotData(slot), buff.data(), length);
+    this->getSlotTimestamps(slot)[0] = (timestamps != nullptr) ? *timestamps : monotonicSeconds();
+    slot->num_samples = length;
+
+    this->commitSlot(slot, seq);
+
+    return;
+}
+
+
+void ShmStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pullStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pullStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pullStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+        this->pullStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pullStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pullStream<double>(buff, timestamps);
+        break;
+    default:
+        break;
+    }
+}
+
+
+void ShmStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
+
+    buff.clear();
+    if (header == nullptr || !this->waitForData(this->timeout)) { return; }
+
+    while (header->write_seq.load(std::memory_order_acquire) > read_seq) {
+
+        //-- Skip ahead if the writer lapped us.
+        const uint64_t written = header->write_seq.load(std::memory_order_acquire);
+        if (written - read_seq > num_slots) {
+            overruns += (written - num_slots) - read_seq;
+            read_seq  = written - num_slots;
+        }
+
+        SlotHeader* slot = this->getSlot(read_seq);
+        if (slot->seq.load(std::memory_order_acquire) != read_seq) { ++read_seq; ++overruns; continue; }
+
+        const std::size_t length = slot->num_samples;
+        buff.assign(reinterpret_cast<const char*>(this->getSlotData(slot)), length);
+        const double ts = this->getSlotTimestamps(slot)[0];
+
+        //-- Validate the copy was not torn by the writer.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != read_seq) { buff.clear(); ++read_seq; ++overruns; continue; }
+
+        if (timestamps != nullptr) { *timestamps = ts; }
+        ++read_seq;
+        break;
+    }
+
+    return;
+}
+
+
+std::size_t ShmStreamer::getElementSize() const {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:   return sizeof(char);
+    case hriPhysio::varTag::INT16:  return sizeof(int16_t);
+    case hriPhysio::varTag::INT32:  return sizeof(int32_t);
+    case hriPhysio::varTag::INT64:  return sizeof(int64_t);
+    case hriPhysio::varTag::FLOAT:  return sizeof(float);
+    case hriPhysio::varTag::DOUBLE: return sizeof(double);
+    case hriPhysio::varTag::STRING: return sizeof(char);
+    default:                        return 0;
+    }
+}
+
+
+bool ShmStreamer::mapSegment(const bool create) {
+
+    //-- POSIX names are a single component, so flatten the stream name.
+    shm_name = "/hriPhysio";
+    for (const char c : this->name) {
+        shm_name += (c == '/') ? '.' : c;
+    }
+
+    if (create) {
+
+        if (this->dtype == "" || this->num_channels == 0) {
+            std::cerr << "[ERROR] Shared memory stream ``" << this->name
+                      << "`` needs a dtype and channel count to be created!!" << std::endl;
+            return false;
+        }
+
+        //-- Size the ring from the configured frame.
+        const bool is_string = (this->var == hriPhysio::varTag::STRING);
+        const std::size_t channels = is_string ? 1 : this->num_channels;
+        const std::size_t samples  = is_string ? string_capacity : std::max<std::size_t>(this->frame_length, 1);
+        const std::size_t slot_bytes = alignUp(
+            sizeof(SlotHeader) + samples * sizeof(double) + samples * channels * this->getElementSize(),
+            cache_line
+        );
+
+        shm_size = alignUp(sizeof(SegmentHeader), cache_line) + num_slots * slot_bytes;
+
+        //-- Remove a stale segment left by a writer that did not exit cleanly,
+        //-- but never one a running writer still owns.
+        shm_fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        if (shm_fd < 0 && errno == EEXIST) {
+            if (hasLiveWriter(shm_name)) {
+                std::cerr << "[ERROR] Shared memory stream ``" << this->name << "`` already has a writer!!" << std::endl;
+                return false;
+            }
+            shm_unlink(shm_name.c_str());
+            shm_fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        }
+        if (shm_fd < 0) {
+            std::cerr << "[ERROR] Could not create shared memory ``" << shm_name << "``: "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        if (ftruncate(shm_fd, shm_size) != 0) {
+            std::cerr << "[ERROR] Could not size shared memory ``" << shm_name << "``: "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        void* addr = mmap(nullptr, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        if (addr == MAP_FAILED) {
+            std::cerr << "[ERROR] Could not map shared memory ``" << shm_name << "``: "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+        shm_base = static_cast<uint8_t*>(addr);
+        header   = new (shm_base) SegmentHeader();
+
+        //-- Describe the stream for readers.
+        header->version       = SEGMENT_VERSION;
+        header->var_tag       = static_cast<uint32_t>(this->var);
+        header->element_size  = this->getElementSize();
+        header->num_channels  = channels;
+        header->sampling_rate = this->sampling_rate;
+        header->slot_samples  = samples;
+        header->slot_bytes    = slot_bytes;
+        header->num_slots     = num_slots;
+        header->writer_pid    = static_cast<uint64_t>(getpid());
+        header->write_seq.store(0);
+        header->notify.store(0);
+        header->waiters.store(0);
+
+        for (std::size_t idx = 0; idx < num_slots; ++idx) {
+            SlotHeader* slot = new (shm_base + alignUp(sizeof(SegmentHeader), cache_line) + idx * slot_bytes) SlotHeader();
+            slot->seq.store(slot_busy);
+            slot->num_samples = 0;
+        }
+
+        //-- Readers only trust the segment once the magic is visible.
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SEGMENT_MAGIC;
+
+        return true;
+    }
+
+
+    //-- Readers wait a bounded time for the writer to appear.
+    const double deadline = monotonicSeconds() + open_timeout;
+    while (true) {
+
+        shm_fd = shm_open(shm_name.c_str(), O_RDWR, 0666);
+        if (shm_fd >= 0) {
+            struct stat info;
+            if (fstat(shm_fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(SegmentHeader)) {
+                break;
+            }
+            close(shm_fd);
+            shm_fd = -1;
+        }
+
+        if (monotonicSeconds() > deadline) {
+            std::cerr << "[ERROR] Shared memory stream ``" << this->name << "`` was not found!!" << std::endl;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    struct stat info;
+    fstat(shm_fd, &info);
+    shm_size = info.st_size;
+
+    void* addr = mmap(nullptr, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[ERROR] Could not map shared memory ``" << shm_name << "``: "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    shm_base = static_cast<uint8_t*>(addr);
+    header   = reinterpret_cast<SegmentHeader*>(shm_base);
+
+    while (header->magic != SEGMENT_MAGIC) {
+        if (monotonicSeconds() > deadline) {
+            std::cerr << "[ERROR] Shared memory stream ``" << this->name << "`` was never initialized!!" << std::endl;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (header->version != SEGMENT_VERSION) {
+        std::cerr << "[ERROR] Shared memory stream ``" << this->name << "`` has an unsupported version!!" << std::endl;
+        return false;
+    }
+
+    //-- Adopt the writer's description, or make sure ours agrees with it.
+    const hriPhysio::varTag writer_var = static_cast<hriPhysio::varTag>(header->var_tag);
+    if (this->dtype == "") {
+        this->setDataType(dtypeName(writer_var));
+    } else if (this->var != writer_var) {
+        std::cerr << "[ERROR] Shared memory stream ``" << this->name << "`` dtype does not match the writer!!" << std::endl;
+        return false;
+    }
+
+    if (writer_var != hriPhysio::varTag::STRING) {
+        if (this->num_channels == 0) {
+            this->num_channels = header->num_channels;
+        } else if (this->num_channels != header->num_channels) {
+            std::cerr << "[ERROR] Shared memory stream ``" << this->name << "`` channels do not match the writer!!" << std::endl;
+            return false;
+        }
+    }
+
+    if (this->sampling_rate == 0) {
+        this->sampling_rate = header->sampling_rate;
+    }
+
+    num_slots = header->num_slots;
+
+    //-- Like an LSL inlet, only frames written after attaching are received.
+    read_seq = header->write_seq.load(std::memory_order_acquire);
+
+    return true;
+}
+
+
+void ShmStreamer::unmapSegment() {
+
+    if (shm_base != nullptr) {
+        munmap(shm_base, shm_size);
+        shm_base = nullptr;
+        header   = nullptr;
+    }
+
+    if (shm_fd >= 0) {
+        close(shm_fd);
+        shm_fd = -1;
+    }
+
+    return;
+}
+
+
+ShmStreamer::SlotHeader* ShmStreamer::getSlot(const uint64_t seq) const {
+    return reinterpret_cast<SlotHeader*>(
+        shm_base + alignUp(sizeof(SegmentHeader), cache_line) + (seq % header->num_slots) * header->slot_bytes
+    );
+}
+
+
+double* ShmStreamer::getSlotTimestamps(SlotHeader* slot) const {
+    return reinterpret_cast<double*>(reinterpret_cast<uint8_t*>(slot) + sizeof(SlotHeader));
+}
+
+
+uint8_t* ShmStreamer::getSlotData(SlotHeader* slot) const {
+    return reinterpret_cast<uint8_t*>(this->getSlotTimestamps(slot) + header->slot_samples);
+}
+
+
+void ShmStreamer::commitSlot(SlotHeader* slot, const uint64_t seq) {
+
+    //-- Make the slot and then the sequence visible to readers.
+    slot->seq.store(seq, std::memory_order_release);
+    header->write_seq.store(seq + 1, std::memory_order_release);
+
+    //-- Only pay for the syscall when somebody is asleep.
+    header->notify.fetch_add(1);
+    if (header->waiters.load() != 0) {
+        futexWake(&header->notify);
+    }
+
+    return;
+}
+
+
+bool ShmStreamer::waitForData(const double seconds) {
+
+    const double deadline = monotonicSeconds() + seconds;
+    while (true) {
+
+        const uint32_t observed = header->notify.load();
+        if (header->write_seq.load(std::memory_order_acquire) > read_seq) {
+            return true;
+        }
+
+        const double remaining = deadline - monotonicSeconds();
+        if (remaining <= 0.0) {
+            return false;
+        }
+
+        header->waiters.fetch_add(1);
+        futexWait(&header->notify, observed, remaining);
+        header->waiters.fetch_sub(1);
+    }
+}
+
+
+template<typename T>
+void ShmStreamer::pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps) {
+
+    if (header == nullptr || this->num_channels == 0) { return; }
+
+    const std::size_t channels = this->num_channels;
+    const std::size_t total    = buff.size() / channels;
+    const double      now      = monotonicSeconds();
+
+    //-- Split the frame over as many slots as it needs.
+    std::size_t sample = 0;
+    while (sample < total) {
+
+        const uint64_t seq = header->write_seq.load(std::memory_order_relaxed);
+        SlotHeader* slot = this->getSlot(seq);
+        slot->seq.store(slot_busy, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const std::size_t count = std::min<std::size_t>(total - sample, header->slot_samples);
+        double* stamps = this->getSlotTimestamps(slot);
+        T*      data   = reinterpret_cast<T*>(this->getSlotData(slot));
+
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            const std::size_t src = sample + idx;
+            stamps[idx] = (timestamps != nullptr && src < timestamps->size()) ? (*timestamps)[src] : now;
+
+            for (std::size_t ch = 0; ch < channels; ++ch) {
+                data[idx * channels + ch] = std::get<T>( buff[src * channels + ch] );
+            }
+        }
+        slot->num_samples = count;
+
+        this->commitSlot(slot, seq);
+        sample += count;
+    }
+
+    return;
+}
+
+
+template<typename T>
+void ShmStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
+
+    buff.clear();
+    if (timestamps != nullptr) { timestamps->clear(); }
+
+    if (header == nullptr || !this->waitForData(this->timeout)) { return; }
+
+    const std::size_t channels = this->num_channels;
+    const std::size_t limit    = std::max<std::size_t>(this->frame_length, 1);
+    std::size_t received = 0;
+
+    //-- Drain whole slots until the frame is full or the writer is caught up.
+    while (header->write_seq.load(std::memory_order_acquire) > read_seq) {
+
+        const uint64_t written = header->write_seq.load(std::memory_order_acquire);
+        if (written - read_seq > num_slots) {
+            overruns += (written - num_slots) - read_seq;
+            read_seq  = written - num_slots;
+        }
+
+        SlotHeader* slot = this->getSlot(read_seq);
+        if (slot->seq.load(std::memory_order_acquire) != read_seq) { ++read_seq; ++overruns; continue; }
+
+        const std::size_t count = slot->num_samples;
+        if (received != 0 && received + count > limit) { break; }
+
+        //-- Convert straight out of the segment into the caller's buffer.
+        const double* stamps = this->getSlotTimestamps(slot);
+        const T*      data   = reinterpret_cast<const T*>(this->getSlotData(slot));
+
+        buff.resize((received + count) * channels);
+        for (std::size_t idx = 0; idx < count * channels; ++idx) {
+            buff[received * channels + idx] = data[idx];
+        }
+        if (timestamps != nullptr) {
+            timestamps->insert(timestamps->end(), stamps, stamps + count);
+        }
+
+        //-- Validate the copy was not torn by the writer.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != read_seq) {
+            buff.resize(received * channels);
+            if (timestamps != nullptr) { timestamps->resize(received); }
+            ++read_seq; ++overruns;
+            continue;
+        }
+
+        received += count;
+        ++read_seq;
+    }
+
+    return;
+}
@@ -0,0 +1,221 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Processing/slidingEntropy.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace hriPhysio::Processing;
+
+
+SlidingEntropy::SlidingEntropy(const std::size_t dimension, const std::size_t capacity, const double tolerance) :
+    dimension(std::max<std::size_t>(dimension, 1)),
+    capacity(capacity),
+    tolerance(tolerance) {
+
+    this->reset();
+}
+
+
+void SlidingEntropy::reset() {
+
+    values.clear();
+    matches.clear();
+    matches_next.clear();
+    sorted.clear();
+
+    first      = 0;
+    pairs      = 0;
+    pairs_next = 0;
+
+    return;
+}
+
+
+void SlidingEntropy::push(const double* source, const std::size_t numValues) {
+
+    for (std::size_t idx = 0; idx < numValues; ++idx) {
+        this->pushOne(source[idx]);
+    }
+
+    return;
+}
+
+
+void SlidingEntropy::setTolerance(const double value) {
+
+    const std::vector<double> window(values.begin(), values.end());
+
+    tolerance = value;
+    this->reset();
+    this->push(window.data(), window.size());
+
+    return;
+}
+
+
+double SlidingEntropy::sampleEntropy() const {
+
+    if (values.size() < dimension + 1) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //-- Leave out the last template of length m, it has no m + 1 extension.
+    const uint64_t shorter = pairs - matches[values.size() - dimension];
+    const uint64_t longer  = pairs_next;
+
+    if (shorter == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (longer == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return -std::log(static_cast<double>(longer) / static_cast<double>(shorter));
+}
+
+
+double SlidingEntropy::approximateEntropy() const {
+
+    if (values.size() < dimension + 1) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const std::size_t shorter = values.size() - dimension + 1;
+    const std::size_t longer  = values.size() - dimension;
+
+    double phi = 0.0, phi_next = 0.0;
+    for (std::size_t idx = 0; idx < shorter; ++idx) {
+        phi += std::log((matches[idx] + 1.0) / shorter);
+    }
+    for (std::size_t idx = 0; idx < longer; ++idx) {
+        phi_next += std::log((matches_next[idx] + 1.0) / longer);
+    }
+
+    return phi / shorter - phi_next / longer;
+}
+
+
+std::size_t SlidingEntropy::size() const {
+    return values.size();
+}
+
+
+bool SlidingEntropy::close(const uint64_t lhs, const uint64_t rhs, const std::size_t length) const {
+
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        if (std::abs(this->at(lhs + idx) - this->at(rhs + idx)) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+double SlidingEntropy::at(const uint64_t position) const {
+    return values[position - first];
+}
+
+
+void SlidingEntropy::count(const uint64_t position, const std::size_t length, const int sign) {
+
+    const uint64_t last = first + values.size() - 1;
+    const double   key  = this->at(position);
+
+    std::deque<std::size_t>& counts = (length == dimension) ? matches : matches_next;
+    uint64_t&                total  = (length == dimension) ? pairs   : pairs_next;
+
+    //-- Only templates whose first value is within the tolerance can match.
+    const auto end = sorted.upper_bound(key + tolerance);
+    for (auto it = sorted.lower_bound(key - tolerance); it != end; ++it) {
+
+        const uint64_t other = it->second;
+        if (other == position || other + length - 1 > last) {
+            continue;
+        }
+        if (!this->close(position, other, length)) {
+            continue;
+        }
+
+        if (sign > 0) {
+            ++counts[position - first];
+            ++counts[other - first];
+            ++total;
+        } else {
+            --counts[position - first];
+            --counts[other - first];
+            --total;
+        }
+    }
+
+    return;
+}
+
+
+void SlidingEntropy::pushOne(const double value) {
+
+    values.push_back(value);
+    matches.push_back(0);
+    matches_next.push_back(0);
+
+    const uint64_t last = first + values.size() - 1;
+
+    //-- The template ending one value earlier now extends to m + 1.
+    if (values.size() >= dimension + 1) {
+        this->count(last - dimension, dimension + 1, +1);
+    }
+
+    //-- And a new template of length m ends here.
+    if (values.size() >= dimension) {
+        const uint64_t position = last - dimension + 1;
+        this->count(position, dimension, +1);
+        sorted.emplace(this->at(position), position);
+    }
+
+    if (capacity != 0 && values.size() > capacity) {
+        this->popOne();
+    }
+
+    return;
+}
+
+
+void SlidingEntropy::popOne() {
+
+    const uint64_t last = first + values.size() - 1;
+
+    if (first + dimension <= last) {
+        this->count(first, dimension + 1, -1);
+    }
+
+    if (first + dimension - 1 <= last) {
+        this->count(first, dimension, -1);
+
+        auto range = sorted.equal_range(this->at(first));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == first) {
+                sorted.erase(it);
+                break;
+            }
+        }
+    }
+
+    values.pop_front();
+    matches.pop_front();
+    matches_next.pop_front();
+    ++first;
+
+    return;
+}
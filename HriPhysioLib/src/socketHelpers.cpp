@@ -0,0 +1,95 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/socketHelpers.h>
+
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+
+bool hriPhysio::Stream::parseSocketAddress(const std::string& name, struct sockaddr_in& address) {
+
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+
+    //-- Split on the last colon, the port is mandatory.
+    const std::size_t colon = name.rfind(':');
+    if (colon == std::string::npos || colon + 1 == name.size()) {
+        return false;
+    }
+
+    const std::string host = name.substr(0, colon);
+    int port = 0;
+    try {
+        port = std::stoi(name.substr(colon + 1));
+    } catch (std::exception&) {
+        return false;
+    }
+
+    if (port < 0 || port > 65535) {
+        return false;
+    }
+    address.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (host.empty() || host == "*") {
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        return true;
+    }
+
+    //-- Dotted quad first, then fall back to a name lookup.
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) == 1) {
+        return true;
+    }
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) {
+        return false;
+    }
+
+    address.sin_addr = reinterpret_cast<struct sockaddr_in*>(result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+
+    return true;
+}
+
+
+bool hriPhysio::Stream::setNonBlocking(const int fd) {
+
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+
+bool hriPhysio::Stream::waitDescriptor(const int fd, const double seconds, const bool write/*=false*/) {
+
+    struct pollfd pfd;
+    pfd.fd      = fd;
+    pfd.events  = write ? POLLOUT : POLLIN;
+    pfd.revents = 0;
+
+    const int timeout_ms = (seconds > 0.0) ? static_cast<int>(seconds * 1000.0) : 0;
+
+    return poll(&pfd, 1, timeout_ms) > 0;
+}
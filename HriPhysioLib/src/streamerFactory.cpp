@@ -32,10 +32,34 @@ hriPhysio::Stream::StreamerInterface* StreamerFactory::getStreamer(std::string s
         return nullptr;
     }
 
+    if (streamerType == "CSV") {
+        return new hriPhysio::Stream::CsvStreamer();
+    }
+
     if (streamerType == "LSL") {
         return new hriPhysio::Stream::LslStreamer();
     }
 
+    if (streamerType == "REC") {
+        return new hriPhysio::Stream::RecordingStreamer();
+    }
+
+    if (streamerType == "REPLAY") {
+        return new hriPhysio::Stream::ReplayStreamer();
+    }
+
+    if (streamerType == "SHM") {
+        return new hriPhysio::Stream::ShmStreamer();
+    }
+
+    if (streamerType == "TCP") {
+        return new hriPhysio::Stream::TcpStreamer();
+    }
+
+    if (streamerType == "UDP") {
+        return new hriPhysio::Stream::UdpStreamer();
+    }
+
     if (streamerType == "ROS") {
         #ifdef WITH_ROS
         return new hriPhysio::Stream::RosStreamer();
@@ -20,6 +20,8 @@ StreamerInterface::StreamerInterface() :
     dtype(""),
     frame_length(0),
     num_channels(0),
+    sampling_rate(0),
+    timeout(1.0),
     mode(modeTag::NOTSET) {
 
 }
@@ -86,6 +88,13 @@ void StreamerInterface::setSamplingRate(const std::size_t sampling_rate) {
 }
 
 
+void StreamerInterface::setTimeout(const double seconds) {
+    //-- How long a receive call may block waiting for data.
+    this->timeout = (seconds > 0.0) ? seconds : 0.0;
+    return;
+}
+
+
 std::string StreamerInterface::getName() const {
     return this->name;
 }
@@ -111,6 +120,27 @@ std::size_t StreamerInterface::getSamplingRate() const {
 }
 
 
+double StreamerInterface::getTimeout() const {
+    return this->timeout;
+}
+
+
 hriPhysio::varTag StreamerInterface::getVariableTag() const {
     return this->var;
 }
+
+
+int StreamerInterface::getDescriptor() const {
+    return -1;
+}
+
+
+bool StreamerInterface::hasBuffered() const {
+    return false;
+}
+
+
+bool StreamerInterface::setQuantization(const std::string /*wire_dtype*/, const double /*scale*/, const double /*offset*/) {
+    std::cerr << "[WARNING] Stream ``" << this->name << "`` can not send quantized values." << std::endl;
+    return false;
+}
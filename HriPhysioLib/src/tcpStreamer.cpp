@@ -0,0 +1,726 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/tcpStreamer.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Anything larger than this is treated as a corrupt stream.
+    constexpr std::size_t max_frame = 64 << 20;
+
+    //-- How much room the receiver asks the kernel to fill per read.
+    constexpr std::size_t read_chunk = 256 << 10;
+
+    //-- How long to keep trying the server when opening and between retries.
+    constexpr double open_timeout  = 5.0;
+    constexpr double retry_backoff = 0.5;
+
+    //-- Shortest wait before retrying a client that did not take its backlog.
+    constexpr double min_retry = 0.001;
+
+
+    double nowSeconds() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+}
+
+
+TcpStreamer::TcpStreamer() :
+    StreamerInterface(),
+    sock_fd(-1),
+    batch_frames(0),
+    send_seq(0),
+    latency_bound(0.005),
+    max_batch(64 << 10),
+    max_backlog(8 << 20),
+    publish_interval(0.0),
+    stopping(false),
+    recv_begin(0),
+    recv_end(0) {
+
+    std::memset(&address, 0, sizeof(address));
+}
+
+
+TcpStreamer::~TcpStreamer() {
+
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            stopping = true;
+        }
+        flush_signal.notify_one();
+        flusher.join();
+    }
+
+    if (this->mode == modeTag::SENDER) {
+        this->flush();
+    }
+
+    for (Client& client : clients) {
+        close(client.fd);
+    }
+    clients.clear();
+
+    if (sock_fd >= 0) {
+        close(sock_fd);
+        sock_fd = -1;
+    }
+}
+
+
+void TcpStreamer::setLatencyBound(const double seconds) {
+    this->latency_bound = (seconds > 0.0) ? seconds : 0.0;
+    return;
+}
+
+
+void TcpStreamer::setMaxBatch(const std::size_t bytes) {
+    this->max_batch = bytes;
+    return;
+}
+
+
+void TcpStreamer::setMaxBacklog(const std::size_t bytes) {
+    this->max_backlog = bytes;
+    return;
+}
+
+
+void TcpStreamer::setCompression(const bool enable) {
+    codec.setCompression(enable);
+    return;
+}
+
+
+bool TcpStreamer::setQuantization(const std::string wire_dtype, const double scale, const double offset) {
+
+    hriPhysio::Stream::Quantizer quantizer;
+    if (!quantizer.configure(wire_dtype, scale, offset)) {
+        return false;
+    }
+
+    codec.setQuantizer(quantizer);
+    return true;
+}
+
+
+std::size_t TcpStreamer::getNumClients() const {
+    std::lock_guard<std::mutex> lock(flush_mutex);
+    return this->clients.size();
+}
+
+
+void TcpStreamer::flush() {
+    std::lock_guard<std::mutex> lock(flush_mutex);
+    this->flushBatch();
+    return;
+}
+
+
+void TcpStreamer::flushBatch() {
+
+    if (sock_fd < 0) { return; }
+
+    //-- Pick up anybody who connected since the last flush.
+    this->acceptClients();
+
+    //-- Hand the batch to every client, dropping ones that fell too far behind.
+    std::size_t keep = 0;
+    for (std::size_t idx = 0; idx < clients.size(); ++idx) {
+        if (this->writeClient(clients[idx])) {
+            if (keep != idx) { clients[keep] = std::move(clients[idx]); }
+            ++keep;
+        } else {
+            close(clients[idx].fd);
+        }
+    }
+    clients.resize(keep);
+
+    batch.clear();
+    batch_frames = 0;
+
+    return;
+}
+
+
+int TcpStreamer::getDescriptor() const {
+    //-- Changes when the client reconnects.
+    return (this->mode == modeTag::RECEIVER) ? sock_fd : -1;
+}
+
+
+bool TcpStreamer::hasBuffered() const {
+
+    std::size_t frame_bytes = 0;
+    const std::size_t available = recv_end - recv_begin;
+    const bool valid = hriPhysio::Stream::FrameCodec::peekSize(recv_buffer.data() + recv_begin, available, frame_bytes);
+
+    //-- A corrupt stream counts, receive is what drops it.
+    return !valid || (frame_bytes != 0 && frame_bytes <= available);
+}
+
+
+bool TcpStreamer::openInputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::RECEIVER;
+
+    try {
+
+        if (!hriPhysio::Stream::parseSocketAddress(this->name, address)) {
+            std::cerr << "[ERROR] TCP stream name ``" << this->name << "`` is not ``host:port``!!" << std::endl;
+            return false;
+        }
+
+        recv_buffer.resize(2 * read_chunk);
+
+        //-- Keep trying for a while, receive() reconnects later if this fails.
+        const double deadline = nowSeconds() + open_timeout;
+        while (!this->connectServer(retry_backoff)) {
+            if (nowSeconds() > deadline) {
+                std::cerr << "[WARNING] TCP stream ``" << this->name
+                          << "`` is not reachable yet, will keep trying." << std::endl;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(0.05));
+        }
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+bool TcpStreamer::openOutputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::SENDER;
+
+    try {
+
+        if (!hriPhysio::Stream::parseSocketAddress(this->name, address)) {
+            std::cerr << "[ERROR] TCP stream name ``" << this->name << "`` is not ``host:port``!!" << std::endl;
+            return false;
+        }
+
+        sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock_fd < 0) {
+            std::cerr << "[ERROR] Could not create TCP socket: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        int enable = 1;
+        setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        if (bind(sock_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(sock_fd, 16) != 0) {
+            std::cerr << "[ERROR] Could not listen on TCP stream ``" << this->name << "``: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        //-- Accepting happens on the publishing thread, so it must never block.
+        hriPhysio::Stream::setNonBlocking(sock_fd);
+
+        last_publish = std::chrono::steady_clock::now();
+
+        flusher = std::thread(&TcpStreamer::flushLoop, this);
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+void TcpStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pushStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pushStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pushStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+        this->pushStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pushStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pushStream<double>(buff, timestamps);
+        break;
+    default:
+        break;
+    }
+}
+
+
+void TcpStreamer::publish(const std::string& buff, const double* timestamps/*=nullptr*/) {
+
+    if (sock_fd < 0) { return; }
+
+    std::lock_guard<std::mutex> lock(flush_mutex);
+
+    const double stamp = (timestamps != nullptr) ? *timestamps : nowSeconds();
+    uint8_t* target = this->reserveFrame(codec.frameSize(hriPhysio::varTag::STRING, 1, buff.size()));
+    codec.encode(target, send_seq++, buff, stamp);
+
+    this->maybeFlush();
+
+    return;
+}
+
+
+void TcpStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pullStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pullStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pullStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+        this->pullStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pullStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pullStream<double>(buff, timestamps);
+        break;
+    default:
+        break;
+    }
+}
+
+
+void TcpStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
+
+    buff.clear();
+
+    hriPhysio::Stream::FrameView view;
+    bool ready = this->frontFrame(view);
+    if (!ready && this->readSocket(this->timeout)) {
+        ready = this->frontFrame(view);
+    }
+    if (!ready) { return; }
+
+    if (view.var == hriPhysio::varTag::STRING) {
+        buff.assign(reinterpret_cast<const char*>(view.payload), view.payload_bytes);
+        if (timestamps != nullptr) { *timestamps = view.timestamp(0); }
+    }
+
+    this->popFrame(view.frame_bytes);
+
+    return;
+}
+
+
+bool TcpStreamer::connectServer(const double seconds) {
+
+    if (sock_fd >= 0) { return true; }
+
+    sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock_fd < 0) {
+        return false;
+    }
+    hriPhysio::Stream::setNonBlocking(sock_fd);
+
+    //-- Non-blocking connect, bounded by the given time.
+    int result = connect(sock_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+    if (result != 0 && errno == EINPROGRESS && hriPhysio::Stream::waitDescriptor(sock_fd, seconds, /*write=*/ true)) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(sock_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        result = (error == 0) ? 0 : -1;
+    }
+
+    if (result != 0) {
+        close(sock_fd);
+        sock_fd = -1;
+        next_connect = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(retry_backoff)
+        );
+        return false;
+    }
+
+    //-- Frames are already batched by the server, don't let Nagle delay them.
+    int enable = 1;
+    setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    recv_begin = recv_end = 0;
+
+    return true;
+}
+
+
+void TcpStreamer::acceptClients() {
+
+    while (true) {
+
+        const int fd = accept(sock_fd, nullptr, nullptr);
+        if (fd < 0) {
+            break;
+        }
+
+        hriPhysio::Stream::setNonBlocking(fd);
+
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        clients.push_back(Client{ fd, {}, 0 });
+    }
+
+    return;
+}
+
+
+uint8_t* TcpStreamer::reserveFrame(const std::size_t bytes) {
+
+    if (batch.empty()) {
+        batch_start = std::chrono::steady_clock::now();
+        flush_signal.notify_one();
+    }
+
+    const std::size_t offset = batch.size();
+    batch.resize(offset + bytes);
+    ++batch_frames;
+
+    return batch.data() + offset;
+}
+
+
+void TcpStreamer::maybeFlush() {
+
+    //-- Track how often the caller publishes.
+    const auto now = std::chrono::steady_clock::now();
+    const double interval = std::chrono::duration<double>(now - last_publish).count();
+    last_publish = now;
+    publish_interval = (publish_interval == 0.0) ? interval : 0.875 * publish_interval + 0.125 * interval;
+
+    //-- Flush if the batch is big, or if waiting for the next publish would break the bound.
+    const double waited = std::chrono::duration<double>(now - batch_start).count();
+    if (batch.size() >= max_batch || waited + publish_interval >= latency_bound) {
+        this->flushBatch();
+    }
+
+    return;
+}
+
+
+void TcpStreamer::flushLoop() {
+
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    while (!stopping) {
+
+        //-- Sleep until a batch starts or a client is left with a backlog.
+        if (batch.empty() && !this->hasBacklog()) {
+            flush_signal.wait(lock);
+            continue;
+        }
+
+        const auto retry = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(std::max(latency_bound, min_retry))
+        );
+        const auto deadline = batch.empty() ? std::chrono::steady_clock::now() + retry : batch_start + retry;
+
+        flush_signal.wait_until(lock, deadline);
+        if (!stopping && std::chrono::steady_clock::now() >= deadline) {
+            this->flushBatch();
+        }
+    }
+
+    return;
+}
+
+
+bool TcpStreamer::hasBacklog() const {
+
+    for (const Client& client : clients) {
+        if (client.backlog.size() > client.backlog_offset) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool TcpStreamer::writeClient(Client& client) {
+
+    //-- Finish whatever the kernel did not take last time before new frames.
+    struct iovec iov[2];
+    int iov_count = 0;
+
+    const std::size_t pending = client.backlog.size() - client.backlog_offset;
+    if (pending > 0) {
+        iov[iov_count].iov_base = client.backlog.data() + client.backlog_offset;
+        iov[iov_count].iov_len  = pending;
+        ++iov_count;
+    }
+    if (!batch.empty()) {
+        iov[iov_count].iov_base = batch.data();
+        iov[iov_count].iov_len  = batch.size();
+        ++iov_count;
+    }
+    if (iov_count == 0) { return true; }
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = iov_count;
+
+    ssize_t written = sendmsg(client.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (written < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return false;
+        }
+        written = 0;
+    }
+
+    //-- Consume the backlog first, then keep any unsent tail of the batch.
+    std::size_t sent = written;
+    const std::size_t from_backlog = std::min(sent, pending);
+    client.backlog_offset += from_backlog;
+    sent -= from_backlog;
+
+    //-- Drop the sent prefix once it is half the backlog, so a client that
+    //-- stays slightly behind does not grow it forever.
+    if (client.backlog_offset == client.backlog.size()) {
+        client.backlog.clear();
+        client.backlog_offset = 0;
+    } else if (client.backlog_offset >= client.backlog.size() / 2) {
+        client.backlog.erase(client.backlog.begin(), client.backlog.begin() + client.backlog_offset);
+        client.backlog_offset = 0;
+    }
+
+    if (sent < batch.size()) {
+        client.backlog.insert(client.backlog.end(), batch.begin() + sent, batch.end());
+    }
+
+    //-- A client this far behind is not keeping up, let it go.
+    return (client.backlog.size() - client.backlog_offset) <= max_backlog;
+}
+
+
+bool TcpStreamer::readSocket(const double seconds) {
+
+    //-- (Re)connect with backoff when the server is away.
+    if (sock_fd < 0) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_connect) {
+            std::this_thread::sleep_for(std::min(
+                next_connect - now,
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds))
+            ));
+            return false;
+        }
+        if (!this->connectServer(seconds)) {
+            return false;
+        }
+    }
+
+    if (!hriPhysio::Stream::waitDescriptor(sock_fd, seconds)) {
+        return false;
+    }
+
+    //-- Slide unread bytes to the front and make room for a full read.
+    if (recv_begin > 0) {
+        std::memmove(recv_buffer.data(), recv_buffer.data() + recv_begin, recv_end - recv_begin);
+        recv_end  -= recv_begin;
+        recv_begin = 0;
+    }
+    if (recv_buffer.size() - recv_end < read_chunk) {
+        recv_buffer.resize(recv_end + read_chunk);
+    }
+
+    bool any = false;
+    while (recv_end < recv_buffer.size()) {
+
+        const ssize_t count = read(sock_fd, recv_buffer.data() + recv_end, recv_buffer.size() - recv_end);
+        if (count > 0) {
+            recv_end += count;
+            any = true;
+            continue;
+        }
+
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            break;
+        }
+
+        //-- Server went away, drop any partial frame and reconnect later.
+        close(sock_fd);
+        sock_fd = -1;
+        recv_begin = recv_end = 0;
+        next_connect = std::chrono::steady_clock::now();
+        return false;
+    }
+
+    return any;
+}
+
+
+bool TcpStreamer::frontFrame(hriPhysio::Stream::FrameView& view) {
+
+    const uint8_t*    data      = recv_buffer.data() + recv_begin;
+    const std::size_t available = recv_end - recv_begin;
+
+    std::size_t frame_bytes = 0;
+    const bool valid = hriPhysio::Stream::FrameCodec::peekSize(data, available, frame_bytes);
+    if (valid && (frame_bytes == 0 || frame_bytes > available)) {
+        return false;
+    }
+
+    //-- A corrupt stream can not be resynchronized, start over.
+    if (!valid || frame_bytes > max_frame || !hriPhysio::Stream::FrameCodec::decode(data, frame_bytes, view)) {
+        std::cerr << "[WARNING] TCP stream ``" << this->name << "`` is corrupt, reconnecting." << std::endl;
+        close(sock_fd);
+        sock_fd = -1;
+        recv_begin = recv_end = 0;
+        return false;
+    }
+
+    return true;
+}
+
+
+void TcpStreamer::popFrame(const std::size_t bytes) {
+
+    recv_begin += bytes;
+
+    if (recv_begin == recv_end) {
+        recv_begin = recv_end = 0;
+    }
+
+    return;
+}
+
+
+template<typename T>
+void TcpStreamer::pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps) {
+
+    if (sock_fd < 0 || this->num_channels == 0) { return; }
+
+    const std::size_t channels = this->num_channels;
+    const std::size_t count    = buff.size() / channels;
+    const double      now      = nowSeconds();
+
+    std::lock_guard<std::mutex> lock(flush_mutex);
+
+    //-- Exact per-sample timestamps, TCP is for reliable remote processing.
+    const double* stamps = (timestamps != nullptr && timestamps->size() >= count) ? timestamps->data() : nullptr;
+
+    //-- Compressed frames come in under their reserved size.
+    const std::size_t reserved = codec.frameSize(this->var, channels, count);
+    if (reserved == 0) { return; }
+
+    uint8_t* target = this->reserveFrame(reserved);
+    const std::size_t written = codec.encode<T>(target, send_seq++, buff.data(), channels, count, stamps, now);
+    batch.resize(batch.size() - reserved + written);
+
+    this->maybeFlush();
+
+    return;
+}
+
+
+template<typename T>
+void TcpStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
+
+    buff.clear();
+    if (timestamps != nullptr) { timestamps->clear(); }
+
+    if (this->num_channels == 0) { return; }
+
+    const std::size_t channels = this->num_channels;
+    const std::size_t limit    = std::max<std::size_t>(this->frame_length, 1);
+    std::size_t received = 0;
+
+    while (received < limit) {
+
+        hriPhysio::Stream::FrameView view;
+        if (!this->frontFrame(view)) {
+            //-- Only block if the caller has nothing yet.
+            if (this->readSocket(received ? 0.0 : this->timeout)) {
+                continue;
+            }
+            break;
+        }
+
+        const std::size_t count = view.num_samples;
+
+        //-- Frames of another type are skipped whole.
+        if (view.value_var != this->var || view.num_channels != channels) {
+            this->popFrame(view.frame_bytes);
+            continue;
+        }
+
+        if (received != 0 && received + count > limit) { break; }
+
+        if (!view.decompress(decode_buffer) || !view.dequantize(restore_buffer)) {
+            std::cerr << "[WARNING] TCP stream ``" << this->name << "`` sent a frame that does not decode." << std::endl;
+            this->popFrame(view.frame_bytes);
+            continue;
+        }
+
+        buff.resize((received + count) * channels);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            for (std::size_t ch = 0; ch < channels; ++ch) {
+                buff[(received + idx) * channels + ch] = view.value<T>(idx, ch);
+            }
+        }
+
+        if (timestamps != nullptr) {
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                timestamps->push_back(view.timestamp(idx));
+            }
+        }
+
+        received += count;
+        this->popFrame(view.frame_bytes);
+    }
+
+    return;
+}
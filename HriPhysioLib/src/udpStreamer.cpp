@@ -0,0 +1,602 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <HriPhysio/Stream/udpStreamer.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace hriPhysio::Stream;
+
+
+namespace {
+
+    //-- Largest datagram the receiver accepts.
+    constexpr std::size_t max_receive = 65536;
+
+
+    double nowSeconds() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+}
+
+
+UdpStreamer::UdpStreamer() :
+    StreamerInterface(),
+    sock_fd(-1),
+    max_datagram(1400),
+    batch_size(32),
+    reorder_window(64),
+    send_seq(0),
+    have_expected(false),
+    expected_seq(0),
+    highest_seq(0) {
+
+    std::memset(&address, 0, sizeof(address));
+
+    //-- Datagrams only carry their first and last timestamps.
+    codec.setStampRange(true);
+}
+
+
+UdpStreamer::~UdpStreamer() {
+
+    if (sock_fd >= 0) {
+        close(sock_fd);
+        sock_fd = -1;
+    }
+}
+
+
+void UdpStreamer::setMaxDatagram(const std::size_t bytes) {
+    //-- Must at least fit the header and a sample, and be a valid datagram.
+    this->max_datagram = std::min<std::size_t>(std::max<std::size_t>(bytes, codec.frameSize(hriPhysio::varTag::DOUBLE, 8, 1)), 65507);
+    return;
+}
+
+
+void UdpStreamer::setBatchSize(const std::size_t datagrams) {
+    this->batch_size = (datagrams > 0) ? datagrams : 1;
+    return;
+}
+
+
+void UdpStreamer::setReorderWindow(const std::size_t datagrams) {
+    this->reorder_window = datagrams;
+    return;
+}
+
+
+void UdpStreamer::setCompression(const bool enable) {
+    codec.setCompression(enable);
+    return;
+}
+
+
+bool UdpStreamer::setQuantization(const std::string wire_dtype, const double scale, const double offset) {
+
+    hriPhysio::Stream::Quantizer quantizer;
+    if (!quantizer.configure(wire_dtype, scale, offset)) {
+        return false;
+    }
+
+    codec.setQuantizer(quantizer);
+    return true;
+}
+
+
+UdpStreamer::Statistics UdpStreamer::getStatistics() const {
+    return this->stats;
+}
+
+
+int UdpStreamer::getDescriptor() const {
+    return (this->mode == modeTag::RECEIVER) ? sock_fd : -1;
+}
+
+
+bool UdpStreamer::hasBuffered() const {
+    //-- Datagrams behind a gap wait for it, or for the gap to be skipped.
+    return this->frontReady() != nullptr;
+}
+
+
+bool UdpStreamer::openInputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::RECEIVER;
+
+    try {
+
+        if (!hriPhysio::Stream::parseSocketAddress(this->name, address)) {
+            std::cerr << "[ERROR] UDP stream name ``" << this->name << "`` is not ``host:port``!!" << std::endl;
+            return false;
+        }
+
+        sock_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sock_fd < 0) {
+            std::cerr << "[ERROR] Could not create UDP socket: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        //-- Allow several analysis processes to listen on the same port.
+        int enable = 1;
+        setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        //-- Give the kernel room to absorb bursts between receive calls.
+        int rcvbuf = 4 << 20;
+        setsockopt(sock_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        //-- Multicast groups bind the port on any interface and join the group.
+        struct sockaddr_in local = address;
+        const bool multicast = IN_MULTICAST(ntohl(address.sin_addr.s_addr));
+        if (multicast) {
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+        }
+
+        if (bind(sock_fd, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0) {
+            std::cerr << "[ERROR] Could not bind UDP stream ``" << this->name << "``: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        if (multicast) {
+            struct ip_mreq group;
+            group.imr_multiaddr        = address.sin_addr;
+            group.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (setsockopt(sock_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group, sizeof(group)) != 0) {
+                std::cerr << "[ERROR] Could not join multicast group ``" << this->name << "``: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+        }
+
+        //-- Preallocate one receive batch.
+        recv_buffer.resize(batch_size * max_receive);
+        recv_iov.resize(batch_size);
+        recv_msgs.resize(batch_size);
+        for (std::size_t idx = 0; idx < batch_size; ++idx) {
+            recv_iov[idx].iov_base = recv_buffer.data() + idx * max_receive;
+            recv_iov[idx].iov_len  = max_receive;
+            std::memset(&recv_msgs[idx], 0, sizeof(struct mmsghdr));
+            recv_msgs[idx].msg_hdr.msg_iov    = &recv_iov[idx];
+            recv_msgs[idx].msg_hdr.msg_iovlen = 1;
+        }
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+bool UdpStreamer::openOutputStream() {
+
+    //-- Set the current mode.
+    if (this->mode != modeTag::NOTSET) {
+        return false;
+    }
+
+    this->mode = modeTag::SENDER;
+
+    try {
+
+        if (!hriPhysio::Stream::parseSocketAddress(this->name, address)) {
+            std::cerr << "[ERROR] UDP stream name ``" << this->name << "`` is not ``host:port``!!" << std::endl;
+            return false;
+        }
+
+        sock_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sock_fd < 0) {
+            std::cerr << "[ERROR] Could not create UDP socket: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        if (IN_MULTICAST(ntohl(address.sin_addr.s_addr))) {
+            //-- Keep multicast on the local network, and let same-host listeners hear it.
+            unsigned char ttl = 1, loop = 1;
+            setsockopt(sock_fd, IPPROTO_IP, IP_MULTICAST_TTL,  &ttl,  sizeof(ttl));
+            setsockopt(sock_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+        } else if (address.sin_addr.s_addr == htonl(INADDR_BROADCAST)) {
+            int enable = 1;
+            setsockopt(sock_fd, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+        }
+
+        //-- A connected socket lets sendmmsg skip per-message addresses.
+        if (connect(sock_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "[ERROR] Could not connect UDP stream ``" << this->name << "``: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+    } catch (std::exception& e) { std::cerr << "Got an exception: " << e.what() << std::endl; return false; }
+
+
+    return true;
+}
+
+
+void UdpStreamer::publish(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pushStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pushStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pushStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+        this->pushStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pushStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pushStream<double>(buff, timestamps);
+        break;
+    default:
+        break;
+    }
+}
+
+
+void UdpStreamer::publish(const std::string& buff, const double* timestamps/*=nullptr*/) {
+
+    if (sock_fd < 0) { return; }
+
+    //-- Strings go out as one datagram, truncated to fit.
+    const std::size_t capacity = max_datagram - codec.frameSize(hriPhysio::varTag::STRING, 1, 0);
+    const double stamp = (timestamps != nullptr) ? *timestamps : nowSeconds();
+
+    send_buffer.resize(max_datagram);
+    const std::size_t length = (buff.size() <= capacity)
+        ? codec.encode(send_buffer.data(), send_seq++, buff, stamp)
+        : codec.encode(send_buffer.data(), send_seq++, buff.substr(0, capacity), stamp);
+
+    send_iov.resize(1);
+    send_iov[0].iov_base = send_buffer.data();
+    send_iov[0].iov_len  = length;
+    this->sendBatch(1);
+
+    return;
+}
+
+
+void UdpStreamer::receive(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps/*=nullptr*/) {
+
+    switch (this->var) {
+    case hriPhysio::varTag::CHAR:
+        this->pullStream<char>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT16:
+        this->pullStream<int16_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT32:
+        this->pullStream<int32_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::INT64:
+        this->pullStream<int64_t>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::FLOAT:
+        this->pullStream<float>(buff, timestamps);
+        break;
+    case hriPhysio::varTag::DOUBLE:
+        this->pullStream<double>(buff, timestamps);
+        break;
+    default:
+        break;
+    }
+}
+
+
+void UdpStreamer::receive(std::string& buff, double* timestamps/*=nullptr*/) {
+
+    buff.clear();
+    if (sock_fd < 0) { return; }
+
+    //-- Wait for the next in-order datagram, giving up on a gap after the timeout.
+    if (this->frontReady() == nullptr) {
+        this->fillPending(this->timeout);
+        if (this->frontReady() == nullptr && !pending.empty()) {
+            this->skipGap();
+        }
+    }
+
+    const std::vector<uint8_t>* datagram = this->frontReady();
+    if (datagram == nullptr) { return; }
+
+    hriPhysio::Stream::FrameView view;
+    hriPhysio::Stream::FrameCodec::decode(datagram->data(), datagram->size(), view);
+    buff.assign(reinterpret_cast<const char*>(view.payload), view.payload_bytes);
+    if (timestamps != nullptr) { *timestamps = view.timestamp(0); }
+
+    this->popReady();
+
+    return;
+}
+
+
+void UdpStreamer::sendBatch(const std::size_t num_datagrams) {
+
+    send_msgs.resize(num_datagrams);
+    for (std::size_t idx = 0; idx < num_datagrams; ++idx) {
+        std::memset(&send_msgs[idx], 0, sizeof(struct mmsghdr));
+        send_msgs[idx].msg_hdr.msg_iov    = &send_iov[idx];
+        send_msgs[idx].msg_hdr.msg_iovlen = 1;
+    }
+
+    //-- One syscall per batch, looping only if the kernel takes a partial batch.
+    std::size_t sent = 0;
+    while (sent < num_datagrams) {
+
+        const std::size_t count = std::min(num_datagrams - sent, batch_size);
+        const int result = sendmmsg(sock_fd, send_msgs.data() + sent, count, 0);
+
+        if (result < 0) {
+            if (errno == EINTR) { continue; }
+
+            //-- Nobody listening (ECONNREFUSED) is normal for UDP, drop the batch.
+            if (errno != ECONNREFUSED) {
+                std::cerr << "[WARNING] UDP stream ``" << this->name << "`` failed to send: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        sent += result;
+    }
+
+    return;
+}
+
+
+bool UdpStreamer::fillPending(const double seconds) {
+
+    if (!hriPhysio::Stream::waitDescriptor(sock_fd, seconds)) {
+        return false;
+    }
+
+    //-- Read no further ahead than the window, the rest waits in the kernel.
+    const std::size_t capacity = reorder_window + batch_size;
+
+    bool any = false;
+    while (pending.size() < capacity) {
+
+        const std::size_t room = std::min(capacity - pending.size(), batch_size);
+        const int count = recvmmsg(sock_fd, recv_msgs.data(), room, MSG_DONTWAIT, nullptr);
+        if (count <= 0) {
+            break;
+        }
+
+        for (int idx = 0; idx < count; ++idx) {
+            this->insertDatagram(
+                static_cast<const uint8_t*>(recv_iov[idx].iov_base),
+                recv_msgs[idx].msg_len
+            );
+        }
+        any = true;
+
+        //-- A short batch means the socket is drained.
+        if (static_cast<std::size_t>(count) < room) {
+            break;
+        }
+    }
+
+    return any;
+}
+
+
+void UdpStreamer::insertDatagram(const uint8_t* data, const std::size_t length) {
+
+    ++stats.received;
+
+    const bool is_string = (this->var == hriPhysio::varTag::STRING);
+    const std::size_t channels = is_string ? 1 : this->num_channels;
+
+    //-- Drop anything that is not exactly what this stream expects.
+    hriPhysio::Stream::FrameView view;
+    if (!hriPhysio::Stream::FrameCodec::decode(data, length, view) || view.frame_bytes != length ||
+        view.value_var != this->var || view.num_channels != channels) {
+        ++stats.malformed;
+        return;
+    }
+
+    const uint64_t seq = view.sequence;
+    if (!have_expected) {
+        have_expected = true;
+        expected_seq  = seq;
+        highest_seq   = seq;
+    }
+
+    //-- Too far behind to be reordered, the sender started over.
+    if (seq < expected_seq && expected_seq - seq > std::max<std::size_t>(reorder_window, 1)) {
+        ++stats.resyncs;
+        for (std::pair<const uint64_t, std::vector<uint8_t>>& entry : pending) {
+            spare.push_back(std::move(entry.second));
+        }
+        pending.clear();
+        expected_seq = seq;
+        highest_seq  = seq;
+    }
+
+    if (seq < expected_seq || pending.count(seq)) {
+        ++stats.duplicates;
+        return;
+    }
+
+    if (seq < highest_seq) {
+        ++stats.reordered;
+    }
+    highest_seq = std::max(highest_seq, seq);
+
+    //-- Reuse a retired buffer to avoid allocating per datagram.
+    std::vector<uint8_t> copy;
+    if (!spare.empty()) {
+        copy = std::move(spare.back());
+        spare.pop_back();
+    }
+    copy.assign(data, data + length);
+    pending.emplace(seq, std::move(copy));
+
+    //-- Give up on the oldest gap once the window is exceeded.
+    while (pending.size() > reorder_window && pending.begin()->first != expected_seq) {
+        this->skipGap();
+    }
+
+    return;
+}
+
+
+const std::vector<uint8_t>* UdpStreamer::frontReady() const {
+
+    if (pending.empty() || pending.begin()->first != expected_seq) {
+        return nullptr;
+    }
+
+    return &pending.begin()->second;
+}
+
+
+void UdpStreamer::popReady() {
+
+    spare.push_back(std::move(pending.begin()->second));
+    pending.erase(pending.begin());
+
+    ++expected_seq;
+    ++stats.delivered;
+
+    return;
+}
+
+
+void UdpStreamer::skipGap() {
+
+    if (pending.empty()) { return; }
+
+    const uint64_t next = pending.begin()->first;
+    stats.lost  += next - expected_seq;
+    expected_seq = next;
+
+    return;
+}
+
+
+template<typename T>
+void UdpStreamer::pushStream(const std::vector<hriPhysio::varType>&  buff, const std::vector<double>* timestamps) {
+
+    if (sock_fd < 0 || this->num_channels == 0 || !FrameCodec::fitsHeader(this->num_channels)) { return; }
+
+    const std::size_t channels  = this->num_channels;
+    const std::size_t total     = buff.size() / channels;
+    const std::size_t per_dgram = std::max<std::size_t>(codec.maxSamples(this->var, channels, max_datagram), 1);
+    const std::size_t num_dgrams = (total + per_dgram - 1) / per_dgram;
+    const double      now        = nowSeconds();
+
+    send_buffer.resize(num_dgrams * max_datagram);
+    send_iov.resize(num_dgrams);
+
+    //-- Lay every datagram of this frame out, then hand them over in one batch.
+    for (std::size_t dgram = 0; dgram < num_dgrams; ++dgram) {
+
+        const std::size_t start = dgram * per_dgram;
+        const std::size_t count = std::min(per_dgram, total - start);
+
+        const double* stamps = nullptr;
+        if (timestamps != nullptr && start + count <= timestamps->size()) {
+            stamps = timestamps->data() + start;
+        }
+
+        uint8_t* target = send_buffer.data() + dgram * max_datagram;
+        send_iov[dgram].iov_base = target;
+        send_iov[dgram].iov_len  = codec.encode<T>(target, send_seq++, buff.data() + start * channels, channels, count, stamps, now);
+    }
+
+    this->sendBatch(num_dgrams);
+
+    return;
+}
+
+
+template<typename T>
+void UdpStreamer::pullStream(std::vector<hriPhysio::varType>& buff, std::vector<double>* timestamps) {
+
+    buff.clear();
+    if (timestamps != nullptr) { timestamps->clear(); }
+
+    if (sock_fd < 0 || this->num_channels == 0) { return; }
+
+    const std::size_t channels = this->num_channels;
+    const std::size_t limit    = std::max<std::size_t>(this->frame_length, 1);
+    std::size_t received = 0;
+
+    while (received < limit) {
+
+        //-- Hand over every datagram that is ready in sequence.
+        const std::vector<uint8_t>* datagram = this->frontReady();
+        if (datagram != nullptr) {
+
+            hriPhysio::Stream::FrameView view;
+            hriPhysio::Stream::FrameCodec::decode(datagram->data(), datagram->size(), view);
+            const std::size_t count = view.num_samples;
+            if (received != 0 && received + count > limit) { break; }
+
+            if (!view.decompress(decode_buffer) || !view.dequantize(restore_buffer)) {
+                ++stats.malformed;
+                this->popReady();
+                continue;
+            }
+
+            buff.resize((received + count) * channels);
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                for (std::size_t ch = 0; ch < channels; ++ch) {
+                    buff[(received + idx) * channels + ch] = view.value<T>(idx, ch);
+                }
+            }
+
+            //-- Spread the per-datagram time span back over its samples.
+            if (timestamps != nullptr) {
+                for (std::size_t idx = 0; idx < count; ++idx) {
+                    timestamps->push_back(view.timestamp(idx));
+                }
+            }
+
+            received += count;
+            this->popReady();
+            continue;
+        }
+
+        //-- Nothing in order. Only block if the caller has nothing yet.
+        if (this->fillPending(received ? 0.0 : this->timeout)) {
+            continue;
+        }
+
+        //-- Socket went quiet with a hole in the sequence, stop waiting for it.
+        if (received == 0 && !pending.empty()) {
+            this->skipGap();
+            continue;
+        }
+
+        break;
+    }
+
+    return;
+}
@@ -15,9 +15,10 @@ public class LSLStream {
     public void StreamOutlet(String[] dataInfo) throws IOException, InterruptedException  {
         //Create new stream info
         // args in format of: { [0] "device name",[1]  "type of data", [2]"channel count", [3]"sampling rate", [4]"device id"}
+        // Every sample pushed is an int, so send int32 (inlets convert to whatever type they pull).
         info = new LSL.StreamInfo(dataInfo[0],dataInfo[1],
                 Integer.parseInt(dataInfo[2]),Integer.parseInt(dataInfo[3]),
-                LSL.ChannelFormat.double64, dataInfo[4]);
+                LSL.ChannelFormat.int32, dataInfo[4]);
 
         //Create outlet
         outlet = new LSL.StreamOutlet(info);
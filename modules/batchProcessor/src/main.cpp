@@ -0,0 +1,72 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <HriPhysio/Manager/batchProcessor.h>
+#include <HriPhysio/helpers.h>
+
+int main (int argc, char **argv) {
+
+    //-- Init an argument parser.
+    hriPhysio::ArgParser args(argc, argv);
+
+
+    //-- Get some vars from command line.
+    const std::string &yaml_file = args.getCmdOption("--conf");
+    const std::string &input     = args.getCmdOption("--input");
+    const std::string &output    = args.getCmdOption("--output");
+
+    if (yaml_file == "" || input == "" || output == "") {
+        std::cerr << "Usage: batchProcessor --conf <pipeline.yaml> --input <session or directory> --output <directory> [--threads <n>]" << std::endl;
+        return 1;
+    }
+
+
+    //-- Load the pipeline.
+    hriPhysio::Manager::BatchProcessor processor;
+    if (!processor.configure(yaml_file)) {
+        return 1;
+    }
+
+    if (args.cmdOptionExists("--threads")) {
+        processor.setNumThreads(args.getCmdOption_asUnsignedLong("--threads"));
+    }
+
+
+    //-- A single session, or every session in a directory.
+    std::vector<std::string> sessions;
+    if (std::filesystem::is_directory(input)) {
+        sessions = hriPhysio::Manager::BatchProcessor::findSessions(input);
+    } else {
+        sessions.push_back(input);
+    }
+
+    if (sessions.empty()) {
+        std::cerr << "No sessions found in " << input << ".\n";
+        return 1;
+    }
+
+
+    //-- Process everything.
+    const std::vector<hriPhysio::Manager::BatchProcessor::Session> results = processor.run(sessions, output);
+
+    std::size_t failed = 0;
+    for (const auto& session : results) {
+        failed += session.ok ? 0 : 1;
+    }
+    std::cerr << "Processed " << results.size() - failed << " of " << results.size() << " sessions.\n";
+
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,483 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <HriPhysio/Processing/activityTracker.h>
+#include <HriPhysio/Processing/biquadratic.h>
+#include <HriPhysio/Processing/burgSpectrum.h>
+#include <HriPhysio/Processing/butterworthBandNoch.h>
+#include <HriPhysio/Processing/butterworthBandPass.h>
+#include <HriPhysio/Processing/butterworthHighPass.h>
+#include <HriPhysio/Processing/butterworthLowPass.h>
+#include <HriPhysio/Processing/detrendedFluctuation.h>
+#include <HriPhysio/Processing/edaProcessor.h>
+#include <HriPhysio/Processing/heartRateVariability.h>
+#include <HriPhysio/Processing/hilbertTransform.h>
+#include <HriPhysio/Processing/pulseDetector.h>
+#include <HriPhysio/Processing/rPeakDetector.h>
+#include <HriPhysio/Processing/respirationTracker.h>
+#include <HriPhysio/Processing/rrArtifactCorrector.h>
+#include <HriPhysio/Processing/slidingEntropy.h>
+
+namespace py = pybind11;
+
+using namespace hriPhysio::Processing;
+
+
+namespace {
+
+    //-- Contiguous float64 arrays are used in place. Anything else
+    //-- (other dtypes, strided views) is converted once by numpy.
+    using Samples = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+    //-- Outputs are never converted, writing into a copy would be lost.
+    using Output  = py::array_t<double, py::array::c_style>;
+
+
+    std::size_t numSamples(const Samples& source) {
+        if (source.ndim() != 1) {
+            throw py::value_error("Expected a one dimensional array.");
+        }
+        return static_cast<std::size_t>(source.shape(0));
+    }
+
+
+    //-- Either the caller's ``out`` array (which may be the source itself),
+    //-- or a fresh array of the same length.
+    Output outputFor(const std::size_t samples, const py::object& out) {
+
+        if (out.is_none()) {
+            return Output(static_cast<py::ssize_t>(samples));
+        }
+
+        if (!Output::check_(out)) {
+            throw py::type_error("``out`` must be a contiguous float64 array.");
+        }
+
+        Output target = py::reinterpret_borrow<Output>(out);
+        if (target.ndim() != 1 || static_cast<std::size_t>(target.shape(0)) != samples) {
+            throw py::value_error("``out`` must have the same length as the input.");
+        }
+        if (!target.writeable()) {
+            throw py::value_error("``out`` is read only.");
+        }
+        return target;
+    }
+
+
+    Output filter(Biquadratic& self, const Samples& source, const double freq, const py::object& out, const bool continuous) {
+
+        const std::size_t samples = numSamples(source);
+        Output target = outputFor(samples, out);
+
+        const double* src = source.data();
+        double*       dst = target.mutable_data();
+        {
+            py::gil_scoped_release release;
+            if (continuous) {
+                self.filterContinuous(src, dst, samples, freq);
+            } else {
+                self.filter(src, dst, samples, freq);
+            }
+        }
+        return target;
+    }
+}
+
+
+PYBIND11_MODULE(hriPhysio, m) {
+
+    m.doc() = "Native signal processing from HriPhysio, operating on numpy arrays.";
+
+
+    /* ============================================================================
+    **  Filters.
+    ** ============================================================================ */
+
+    py::class_<Biquadratic>(m, "Biquadratic")
+        .def("filter", [](Biquadratic& self, const Samples& source, const double freq, const py::object& out) {
+                return filter(self, source, freq, out, /*continuous=*/ false);
+            },
+            py::arg("source"), py::arg("freq"), py::arg("out") = py::none(),
+            "Filter a whole signal. Pass ``out=source`` to filter in place.")
+        .def("filterContinuous", [](Biquadratic& self, const Samples& source, const double freq, const py::object& out) {
+                return filter(self, source, freq, out, /*continuous=*/ true);
+            },
+            py::arg("source"), py::arg("freq"), py::arg("out") = py::none(),
+            "Filter the next block of a stream, continuing from the previous call.")
+        .def("reset",           &Biquadratic::reset)
+        .def("setSamplingRate", &Biquadratic::setSamplingRate, py::arg("rate"))
+        .def("setBandWidth",    &Biquadratic::setBandWidth,    py::arg("width"));
+
+    py::class_<ButterworthLowPass, Biquadratic>(m, "ButterworthLowPass")
+        .def(py::init<const unsigned int>(), py::arg("rate"));
+
+    py::class_<ButterworthHighPass, Biquadratic>(m, "ButterworthHighPass")
+        .def(py::init<const unsigned int>(), py::arg("rate"));
+
+    py::class_<ButterworthBandPass, Biquadratic>(m, "ButterworthBandPass")
+        .def(py::init<const unsigned int, const double>(), py::arg("rate"), py::arg("width"));
+
+    py::class_<ButterworthBandNoch, Biquadratic>(m, "ButterworthBandNoch")
+        .def(py::init<const unsigned int, const double>(), py::arg("rate"), py::arg("width"));
+
+
+    /* ============================================================================
+    **  Transforms.
+    ** ============================================================================ */
+
+    py::class_<HilbertTransform>(m, "HilbertTransform")
+        .def(py::init<std::size_t>(), py::arg("samples"))
+        .def("process", [](HilbertTransform& self, const Samples& source, const py::object& out) {
+
+                const std::size_t samples = numSamples(source);
+                Output target = outputFor(samples, out);
+
+                const double* src = source.data();
+                double*       dst = target.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    self.process(src, dst, samples);
+                }
+                return target;
+            },
+            py::arg("source"), py::arg("out") = py::none(),
+            "Amplitude envelope of the signal.")
+        .def("resize", &HilbertTransform::resize, py::arg("samples"));
+
+
+    /* ============================================================================
+    **  Heart rate.
+    ** ============================================================================ */
+
+    py::class_<RPeakDetector>(m, "RPeakDetector")
+        .def(py::init<const unsigned int, const bool>(), py::arg("rate"), py::arg("inverted") = false)
+        .def("process", [](RPeakDetector& self, const Samples& source, const Samples& stamps, const bool amplitudes) -> py::object {
+
+                const std::size_t samples = numSamples(source);
+                if (numSamples(stamps) != samples) {
+                    throw py::value_error("``source`` and ``stamps`` must have the same length.");
+                }
+
+                const double* src = source.data();
+                const double* ts  = stamps.data();
+                std::vector<double> peaks, heights;
+                {
+                    py::gil_scoped_release release;
+                    self.process(src, ts, samples, peaks, heights);
+                }
+
+                Output times(static_cast<py::ssize_t>(peaks.size()), peaks.data());
+                if (!amplitudes) {
+                    return std::move(times);
+                }
+                return py::make_tuple(times, Output(static_cast<py::ssize_t>(heights.size()), heights.data()));
+            },
+            py::arg("source"), py::arg("stamps"), py::arg("amplitudes") = false,
+            "Feed the next block of a filtered ECG, returns the times of the R peaks found in it\n"
+            "(and their amplitudes, if ``amplitudes`` is set).")
+        .def("reset",           &RPeakDetector::reset)
+        .def("getSamplingRate", &RPeakDetector::getSamplingRate);
+
+    py::class_<RRArtifactCorrector> corrector(m, "RRArtifactCorrector");
+
+    py::enum_<RRArtifactCorrector::Method>(corrector, "Method")
+        .value("Malik",    RRArtifactCorrector::Method::Malik)
+        .value("Kamath",   RRArtifactCorrector::Method::Kamath)
+        .value("Karlsson", RRArtifactCorrector::Method::Karlsson);
+
+    corrector
+        .def(py::init<const RRArtifactCorrector::Method, const double, const double, const std::size_t>(),
+             py::arg("method") = RRArtifactCorrector::Method::Malik, py::arg("low") = 300.0,
+             py::arg("high") = 2000.0, py::arg("maxGap") = 5)
+        .def("process", [](RRArtifactCorrector& self, const Samples& rr) {
+
+                const std::size_t intervals = numSamples(rr);
+                const double* src = rr.data();
+                std::vector<double> nn;
+                {
+                    py::gil_scoped_release release;
+                    self.process(src, intervals, nn);
+                }
+                return Output(static_cast<py::ssize_t>(nn.size()), nn.data());
+            },
+            py::arg("rr"),
+            "Feed the next RR intervals in ms, returns the NN intervals decided so far.")
+        .def("flush", [](RRArtifactCorrector& self) {
+                std::vector<double> nn;
+                self.flush(nn);
+                return Output(static_cast<py::ssize_t>(nn.size()), nn.data());
+            })
+        .def("reset",           &RRArtifactCorrector::reset)
+        .def("getNumCorrected", &RRArtifactCorrector::getNumCorrected);
+
+    py::class_<HrvTimeDomain>(m, "HrvTimeDomain")
+        .def_readonly("num_intervals", &HrvTimeDomain::num_intervals)
+        .def_readonly("mean_rr",       &HrvTimeDomain::mean_rr)
+        .def_readonly("sdnn",          &HrvTimeDomain::sdnn)
+        .def_readonly("rmssd",         &HrvTimeDomain::rmssd)
+        .def_readonly("pnn50",         &HrvTimeDomain::pnn50)
+        .def_readonly("mean_hr",       &HrvTimeDomain::mean_hr);
+
+    py::class_<HrvNonlinear>(m, "HrvNonlinear")
+        .def_readonly("num_intervals", &HrvNonlinear::num_intervals)
+        .def_readonly("sd1",           &HrvNonlinear::sd1)
+        .def_readonly("sd2",           &HrvNonlinear::sd2)
+        .def_readonly("sd1_sd2",       &HrvNonlinear::sd1_sd2)
+        .def_readonly("sampen",        &HrvNonlinear::sampen)
+        .def_readonly("apen",          &HrvNonlinear::apen)
+        .def_readonly("dfa_alpha1",    &HrvNonlinear::dfa_alpha1)
+        .def_readonly("dfa_alpha2",    &HrvNonlinear::dfa_alpha2);
+
+    py::class_<HrvFrequency>(m, "HrvFrequency")
+        .def_readonly("num_intervals", &HrvFrequency::num_intervals)
+        .def_readonly("order",         &HrvFrequency::order)
+        .def_readonly("vlf",           &HrvFrequency::vlf)
+        .def_readonly("lf",            &HrvFrequency::lf)
+        .def_readonly("hf",            &HrvFrequency::hf)
+        .def_readonly("total",         &HrvFrequency::total)
+        .def_readonly("lf_hf",         &HrvFrequency::lf_hf)
+        .def_readonly("lf_nu",         &HrvFrequency::lf_nu)
+        .def_readonly("hf_nu",         &HrvFrequency::hf_nu);
+
+    py::class_<SlidingEntropy>(m, "SlidingEntropy")
+        .def(py::init<const std::size_t, const std::size_t, const double>(),
+             py::arg("dimension"), py::arg("capacity"), py::arg("tolerance"))
+        .def("push", [](SlidingEntropy& self, const Samples& source) {
+                const std::size_t count = numSamples(source);
+                const double* src = source.data();
+                py::gil_scoped_release release;
+                self.push(src, count);
+            },
+            py::arg("source"))
+        .def("reset",              &SlidingEntropy::reset)
+        .def("setTolerance",       &SlidingEntropy::setTolerance, py::arg("value"))
+        .def("sampleEntropy",      &SlidingEntropy::sampleEntropy)
+        .def("approximateEntropy", &SlidingEntropy::approximateEntropy)
+        .def("__len__",            &SlidingEntropy::size);
+
+    py::class_<DetrendedFluctuation>(m, "DetrendedFluctuation")
+        .def(py::init<const std::size_t, const std::size_t>(), py::arg("capacity") = 0, py::arg("threads") = 1)
+        .def("push", [](DetrendedFluctuation& self, const Samples& source) {
+                const std::size_t count = numSamples(source);
+                const double* src = source.data();
+                py::gil_scoped_release release;
+                self.push(src, count);
+            },
+            py::arg("source"))
+        .def("reset",         &DetrendedFluctuation::reset)
+        .def("fluctuation",   &DetrendedFluctuation::fluctuation, py::arg("scale"))
+        .def("alpha",         &DetrendedFluctuation::alpha, py::arg("minScale"), py::arg("maxScale"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("setNumThreads", &DetrendedFluctuation::setNumThreads, py::arg("threads"))
+        .def("__len__",       &DetrendedFluctuation::size);
+
+    py::class_<BurgSpectrum>(m, "BurgSpectrum")
+        .def(py::init<const std::size_t>(), py::arg("maxOrder") = 16)
+        .def("fit", [](BurgSpectrum& self, const Samples& source) {
+                const std::size_t count = numSamples(source);
+                const double* src = source.data();
+                py::gil_scoped_release release;
+                return self.fit(src, count);
+            },
+            py::arg("source"))
+        .def("density",         &BurgSpectrum::density, py::arg("freq"), py::arg("rate"))
+        .def("bandPower",       &BurgSpectrum::bandPower, py::arg("low"), py::arg("high"), py::arg("rate"),
+             py::arg("resolution") = 0.001)
+        .def("getOrder",        &BurgSpectrum::getOrder)
+        .def("getCoefficients", &BurgSpectrum::getCoefficients)
+        .def("getVariance",     &BurgSpectrum::getVariance);
+
+    m.def("rrIntervals", &rrIntervals, py::arg("peaks"),
+          "Intervals in ms between successive peak times in seconds.");
+
+    m.def("hrvTimeDomain", &hrvTimeDomain, py::arg("rr"),
+          "Time domain features of RR intervals in ms.");
+
+    m.def("hrvNonlinear", &hrvNonlinear, py::arg("rr"), py::arg("dimension") = 2,
+          "Poincare and entropy features of RR intervals in ms.");
+
+    m.def("hrvFrequency", &hrvFrequency, py::arg("rr"), py::arg("rate") = 4.0, py::arg("maxOrder") = 16,
+          py::call_guard<py::gil_scoped_release>(),
+          "Band powers in ms^2 of RR intervals in ms, from a Burg AR spectrum.");
+
+
+    /* ============================================================================
+    **  Electrodermal activity.
+    ** ============================================================================ */
+
+    py::class_<SkinConductanceResponse>(m, "SkinConductanceResponse")
+        .def_readonly("channel",   &SkinConductanceResponse::channel)
+        .def_readonly("onset",     &SkinConductanceResponse::onset)
+        .def_readonly("peak",      &SkinConductanceResponse::peak)
+        .def_readonly("amplitude", &SkinConductanceResponse::amplitude)
+        .def_readonly("rise_time", &SkinConductanceResponse::rise_time);
+
+    py::class_<EdaProcessor>(m, "EdaProcessor")
+        .def(py::init<const unsigned int, const std::size_t, const double, const double, const double>(),
+             py::arg("rate"), py::arg("numChannels") = 1, py::arg("window") = 4.0,
+             py::arg("minAmplitude") = 0.01, py::arg("cutoff") = 3.0)
+        .def("process", [](EdaProcessor& self, const Samples& source, const Samples& stamps) {
+
+                //-- One row per frame, one column per participant.
+                const std::size_t frames   = numSamples(stamps);
+                const std::size_t channels = self.getNumChannels();
+                if (source.size() != static_cast<py::ssize_t>(frames * channels)) {
+                    throw py::value_error("``source`` must hold ``numChannels`` samples per stamp.");
+                }
+
+                const double* src = source.data();
+                const double* ts  = stamps.data();
+                std::vector<double> tonic, phasic;
+                std::vector<SkinConductanceResponse> responses;
+                {
+                    py::gil_scoped_release release;
+                    self.process(src, ts, frames, tonic, phasic, responses);
+                }
+
+                const std::vector<py::ssize_t> shape = { static_cast<py::ssize_t>(frames), static_cast<py::ssize_t>(channels) };
+                return py::make_tuple(Output(shape, tonic.data()), Output(shape, phasic.data()), responses);
+            },
+            py::arg("source"), py::arg("stamps"),
+            "Feed the next frames, returns their tonic and phasic parts and the SCRs confirmed.")
+        .def("reset",           &EdaProcessor::reset)
+        .def("getNumChannels",  &EdaProcessor::getNumChannels)
+        .def("getSamplingRate", &EdaProcessor::getSamplingRate);
+
+
+    /* ============================================================================
+    **  Respiration.
+    ** ============================================================================ */
+
+    py::class_<RespirationEstimate>(m, "RespirationEstimate")
+        .def_readonly("time",    &RespirationEstimate::time)
+        .def_readonly("rate",    &RespirationEstimate::rate)
+        .def_readonly("quality", &RespirationEstimate::quality)
+        .def_readonly("edr",     &RespirationEstimate::edr)
+        .def_readonly("rsa",     &RespirationEstimate::rsa)
+        .def_readonly("motion",  &RespirationEstimate::motion);
+
+    py::class_<RespirationTracker>(m, "RespirationTracker")
+        .def(py::init<const double, const double, const double, const std::size_t, const double, const double>(),
+             py::arg("window") = 32.0, py::arg("rate") = 4.0, py::arg("update") = 5.0,
+             py::arg("numAxes") = 3, py::arg("minBpm") = 6.0, py::arg("maxBpm") = 30.0)
+        .def("addBeats", [](RespirationTracker& self, const Samples& peaks, const Samples& amplitudes) {
+                const std::size_t count = numSamples(peaks);
+                if (numSamples(amplitudes) != count) {
+                    throw py::value_error("``peaks`` and ``amplitudes`` must have the same length.");
+                }
+                self.addBeats(peaks.data(), amplitudes.data(), count);
+            },
+            py::arg("peaks"), py::arg("amplitudes"))
+        .def("addMotion", [](RespirationTracker& self, const Samples& source, const Samples& stamps) {
+                const std::size_t frames = numSamples(stamps);
+                if (source.size() != static_cast<py::ssize_t>(frames * self.getNumAxes())) {
+                    throw py::value_error("``source`` must hold ``numAxes`` samples per stamp.");
+                }
+                self.addMotion(source.data(), stamps.data(), frames);
+            },
+            py::arg("source"), py::arg("stamps"),
+            "Add accelerometer frames, one row per stamp and one column per axis.")
+        .def("estimate", [](RespirationTracker& self, const double now) -> py::object {
+                RespirationEstimate estimate;
+                if (!self.estimate(now, estimate)) {
+                    return py::none();
+                }
+                return py::cast(estimate);
+            },
+            py::arg("now"),
+            "The breathing rate over the window ending at ``now``, or None if no update is due.")
+        .def("reset",      &RespirationTracker::reset)
+        .def("getNumAxes", &RespirationTracker::getNumAxes);
+
+
+    /* ============================================================================
+    **  Physical activity.
+    ** ============================================================================ */
+
+    py::class_<ActivityEpoch>(m, "ActivityEpoch")
+        .def_readonly("time",       &ActivityEpoch::time)
+        .def_readonly("intensity",  &ActivityEpoch::intensity)
+        .def_readonly("counts",     &ActivityEpoch::counts)
+        .def_readonly("steps",      &ActivityEpoch::steps)
+        .def_readonly("cadence",    &ActivityEpoch::cadence)
+        .def_readonly("regularity", &ActivityEpoch::regularity);
+
+    py::class_<ActivityTracker>(m, "ActivityTracker")
+        .def(py::init<const unsigned int, const double, const double, const double, const double>(),
+             py::arg("rate"), py::arg("epoch") = 1.0, py::arg("gravity") = 1.0,
+             py::arg("minStep") = 0.05, py::arg("window") = 4.0)
+        .def("process", [](ActivityTracker& self, const Samples& source, const Samples& stamps) {
+
+                //-- One row per frame, one column per axis.
+                const std::size_t frames = numSamples(stamps);
+                if (source.size() != static_cast<py::ssize_t>(frames * 3)) {
+                    throw py::value_error("``source`` must hold x, y and z per stamp.");
+                }
+
+                const double* src = source.data();
+                const double* ts  = stamps.data();
+                std::vector<ActivityEpoch> epochs;
+                {
+                    py::gil_scoped_release release;
+                    self.process(src, ts, frames, epochs);
+                }
+                return epochs;
+            },
+            py::arg("source"), py::arg("stamps"),
+            "Feed the next frames, returns the epochs they completed.")
+        .def("reset",           &ActivityTracker::reset)
+        .def("getSamplingRate", &ActivityTracker::getSamplingRate);
+
+
+    /* ============================================================================
+    **  Photoplethysmography.
+    ** ============================================================================ */
+
+    py::class_<PulseBeat>(m, "PulseBeat")
+        .def_readonly("time",      &PulseBeat::time)
+        .def_readonly("interval",  &PulseBeat::interval)
+        .def_readonly("amplitude", &PulseBeat::amplitude)
+        .def_readonly("agreement", &PulseBeat::agreement)
+        .def_readonly("good",      &PulseBeat::good);
+
+    py::class_<PulseDetector>(m, "PulseDetector")
+        .def(py::init<const unsigned int, const std::size_t, const double, const double>(),
+             py::arg("rate"), py::arg("numChannels") = 1, py::arg("lowCutoff") = 0.5, py::arg("highCutoff") = 8.0)
+        .def("process", [](PulseDetector& self, const Samples& source, const Samples& stamps) {
+
+                //-- One row per frame, one column per LED.
+                const std::size_t frames = numSamples(stamps);
+                if (source.size() != static_cast<py::ssize_t>(frames * self.getNumChannels())) {
+                    throw py::value_error("``source`` must hold ``numChannels`` samples per stamp.");
+                }
+
+                const double* src = source.data();
+                const double* ts  = stamps.data();
+                std::vector<double> pulse;
+                std::vector<PulseBeat> beats;
+                {
+                    py::gil_scoped_release release;
+                    self.process(src, ts, frames, pulse, beats);
+                }
+                return py::make_tuple(Output(static_cast<py::ssize_t>(pulse.size()), pulse.data()), beats);
+            },
+            py::arg("source"), py::arg("stamps"),
+            "Feed the next frames, returns their fused pulse and the beats found.")
+        .def("reset",           &PulseDetector::reset)
+        .def("getHeartRate",    &PulseDetector::getHeartRate)
+        .def("getNumChannels",  &PulseDetector::getNumChannels)
+        .def("getSamplingRate", &PulseDetector::getSamplingRate);
+}
@@ -0,0 +1,44 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <HriPhysio/Processing/butterworthHighPass.h>
+#include <HriPhysio/Processing/butterworthLowPass.h>
+
+
+//-- Prints what the library makes of the signal test_bindings.py builds,
+//-- one sample per line: the low pass, then the high pass.
+int main() {
+
+    const unsigned int rate    = 250;
+    const std::size_t  samples = 1000;
+
+    std::vector<double> signal(samples), low(samples), high(samples);
+    for (std::size_t idx = 0; idx < samples; ++idx) {
+        signal[idx] = std::sin(0.05 * idx) + 0.3 * std::sin(0.7 * idx);
+    }
+
+    hriPhysio::Processing::ButterworthLowPass lowPass(rate);
+    lowPass.filter(signal.data(), low.data(), samples, 10.0);
+
+    hriPhysio::Processing::ButterworthHighPass highPass(rate);
+    highPass.filterContinuous(signal.data(), high.data(), samples, 2.0);
+
+    for (std::size_t idx = 0; idx < samples; ++idx) {
+        std::printf("%.17g %.17g\n", low[idx], high[idx]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+# Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory, University of Waterloo
+# Authors: Austin Kothig <austin.kothig@uwaterloo.ca>
+# CopyPolicy: Released under the terms of the BSD 3-Clause License.
+
+#-- Smoke test of the hriPhysio module against the C++ library, run by ctest
+#-- with the module on PYTHONPATH and HRIPHYSIO_REFERENCE set to reference.cpp.
+
+import os
+import subprocess
+import unittest
+
+import numpy as np
+
+import hriPhysio
+
+
+RATE    = 250
+SAMPLES = 1000
+
+
+def makeSignal():
+    idx = np.arange(SAMPLES, dtype=np.float64)
+    return np.sin(0.05 * idx) + 0.3 * np.sin(0.7 * idx)
+
+
+class TestBindings(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        output  = subprocess.check_output([os.environ["HRIPHYSIO_REFERENCE"]], universal_newlines=True)
+        columns = np.array([line.split() for line in output.splitlines()], dtype=np.float64)
+        cls.low, cls.high = columns[:, 0], columns[:, 1]
+
+    def test_filter_matches_the_library(self):
+        low = hriPhysio.ButterworthLowPass(RATE).filter(makeSignal(), 10.0)
+        np.testing.assert_allclose(low, self.low, rtol=0.0, atol=1e-12)
+
+    def test_filter_continuous_in_blocks_matches_the_library(self):
+        highPass = hriPhysio.ButterworthHighPass(RATE)
+        source   = makeSignal()
+        high     = np.concatenate([highPass.filterContinuous(source[begin:begin + 64], 2.0)
+                                   for begin in range(0, SAMPLES, 64)])
+        np.testing.assert_allclose(high, self.high, rtol=0.0, atol=1e-12)
+
+    def test_out_source_filters_in_place(self):
+        source = makeSignal()
+        result = hriPhysio.ButterworthLowPass(RATE).filter(source, 10.0, out=source)
+        self.assertIs(result, source)
+        np.testing.assert_allclose(source, self.low, rtol=0.0, atol=1e-12)
+
+    def test_inputs_are_converted_but_outputs_are_not(self):
+        low = hriPhysio.ButterworthLowPass(RATE).filter(makeSignal().tolist(), 10.0)
+        np.testing.assert_allclose(low, self.low, rtol=0.0, atol=1e-12)
+
+        with self.assertRaises(TypeError):
+            hriPhysio.ButterworthLowPass(RATE).filter(makeSignal(), 10.0, out=np.zeros(SAMPLES, dtype=np.float32))
+        with self.assertRaises(ValueError):
+            hriPhysio.ButterworthLowPass(RATE).filter(makeSignal(), 10.0, out=np.zeros(SAMPLES // 2))
+
+
+if __name__ == "__main__":
+    unittest.main()
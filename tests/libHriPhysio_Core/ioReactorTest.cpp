@@ -0,0 +1,261 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <atomic>
+#include <thread>
+
+#include <unistd.h>
+
+#include <HriPhysio/Core/ioReactor.h>
+#include <HriPhysio/Stream/tcpStreamer.h>
+#include <HriPhysio/Stream/udpStreamer.h>
+
+
+TEST_CASE("Test IoReactor serves several streamers from one thread") {
+
+    hriPhysio::Core::IoReactor reactor;
+
+    std::vector< std::unique_ptr<hriPhysio::Stream::UdpStreamer> > receivers, senders;
+    std::vector< std::size_t > counts(4, 0);
+
+    for (std::size_t idx = 0; idx < counts.size(); ++idx) {
+        const std::string name = "127.0.0.1:" + std::to_string(47100 + idx);
+
+        receivers.emplace_back(new hriPhysio::Stream::UdpStreamer());
+        receivers[idx]->setName(name);
+        receivers[idx]->setDataType("int32");
+        receivers[idx]->setNumChannels(1);
+        REQUIRE(receivers[idx]->openInputStream());
+
+        senders.emplace_back(new hriPhysio::Stream::UdpStreamer());
+        senders[idx]->setName(name);
+        senders[idx]->setDataType("int32");
+        senders[idx]->setNumChannels(1);
+        REQUIRE(senders[idx]->openOutputStream());
+
+        hriPhysio::Stream::UdpStreamer* receiver = receivers[idx].get();
+        REQUIRE(reactor.addStreamer(receiver, [receiver, &counts, idx]() {
+            std::vector<hriPhysio::varType> buff;
+            receiver->receive(buff);
+            counts[idx] += buff.size();
+        }));
+    }
+    CHECK(reactor.getNumSources() == 4);
+
+    //-- Only the streams that got data are handled.
+    senders[1]->publish(std::vector<hriPhysio::varType>{ int32_t(1), int32_t(2), int32_t(3) });
+    senders[3]->publish(std::vector<hriPhysio::varType>{ int32_t(4) });
+
+    std::size_t handled = 0;
+    for (int pass = 0; pass < 10 && handled < 2; ++pass) {
+        handled += reactor.runOnce(0.1);
+    }
+
+    CHECK(counts[0] == 0);
+    CHECK(counts[1] == 3);
+    CHECK(counts[2] == 0);
+    CHECK(counts[3] == 1);
+
+    //-- Removed descriptors are no longer handled.
+    CHECK(reactor.removeDescriptor(receivers[1]->getDescriptor()));
+    CHECK_FALSE(reactor.removeDescriptor(receivers[1]->getDescriptor()));
+    CHECK(reactor.getNumSources() == 3);
+
+    //-- Senders have nothing to watch.
+    CHECK_FALSE(reactor.addStreamer(senders[0].get(), []() {}));
+}
+
+TEST_CASE("Test IoReactor calls a streamer back for every frame already read") {
+
+    hriPhysio::Core::IoReactor reactor;
+    const std::size_t num_frames = 5;
+
+    hriPhysio::Stream::UdpStreamer udp_receiver, udp_sender;
+    hriPhysio::Stream::TcpStreamer tcp_receiver, tcp_sender;
+    udp_receiver.setName("127.0.0.1:47104");
+    udp_sender.setName("127.0.0.1:47104");
+    tcp_receiver.setName("127.0.0.1:47105");
+    tcp_sender.setName("127.0.0.1:47105");
+
+    for (hriPhysio::Stream::StreamerInterface* streamer : std::vector<hriPhysio::Stream::StreamerInterface*>{ &udp_receiver, &udp_sender, &tcp_receiver, &tcp_sender }) {
+        streamer->setDataType("int32");
+        streamer->setNumChannels(1);
+        streamer->setFrameLength(1);
+    }
+    REQUIRE(tcp_sender.openOutputStream());
+    REQUIRE(udp_receiver.openInputStream());
+    REQUIRE(udp_sender.openOutputStream());
+    REQUIRE(tcp_receiver.openInputStream());
+
+    std::vector<int32_t> udp_values, tcp_values;
+    for (auto watch : { std::make_pair(static_cast<hriPhysio::Stream::StreamerInterface*>(&udp_receiver), &udp_values),
+                        std::make_pair(static_cast<hriPhysio::Stream::StreamerInterface*>(&tcp_receiver), &tcp_values) }) {
+        hriPhysio::Stream::StreamerInterface* receiver = watch.first;
+        std::vector<int32_t>* values = watch.second;
+        REQUIRE(reactor.addStreamer(receiver, [receiver, values]() {
+            std::vector<hriPhysio::varType> buff;
+            receiver->receive(buff);
+            REQUIRE(buff.size() == 1);
+            values->push_back(std::get<int32_t>(buff[0]));
+        }));
+        CHECK(receiver->getTimeout() == 0.0);
+    }
+
+    //-- Every frame is read off the socket in one go, but the callback takes one at a time.
+    for (std::size_t idx = 0; idx < num_frames; ++idx) {
+        const std::vector<hriPhysio::varType> frame{ int32_t(idx) };
+        udp_sender.publish(frame);
+        tcp_sender.publish(frame);
+    }
+    tcp_sender.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    CHECK(reactor.runOnce(0.5) == 2);
+
+    REQUIRE(udp_values.size() == num_frames);
+    REQUIRE(tcp_values.size() == num_frames);
+    for (std::size_t idx = 0; idx < num_frames; ++idx) {
+        CHECK(udp_values[idx] == int32_t(idx));
+        CHECK(tcp_values[idx] == int32_t(idx));
+    }
+}
+
+TEST_CASE("Test IoReactor follows a TCP streamer across a reconnect") {
+
+    hriPhysio::Core::IoReactor reactor;
+
+    std::unique_ptr<hriPhysio::Stream::TcpStreamer> server(new hriPhysio::Stream::TcpStreamer());
+    server->setName("127.0.0.1:47106");
+    server->setDataType("int32");
+    server->setNumChannels(1);
+    REQUIRE(server->openOutputStream());
+
+    hriPhysio::Stream::TcpStreamer client;
+    client.setName("127.0.0.1:47106");
+    client.setDataType("int32");
+    client.setNumChannels(1);
+    REQUIRE(client.openInputStream());
+
+    std::vector<int32_t> values;
+    REQUIRE(reactor.addStreamer(&client, [&client, &values]() {
+        std::vector<hriPhysio::varType> buff;
+        client.receive(buff);
+        for (const hriPhysio::varType& value : buff) {
+            values.push_back(std::get<int32_t>(value));
+        }
+    }));
+
+    server->publish(std::vector<hriPhysio::varType>{ int32_t(1) });
+    server->flush();
+    for (int pass = 0; pass < 20 && values.empty(); ++pass) {
+        reactor.runOnce(0.05);
+    }
+    REQUIRE(values.size() == 1);
+
+    //-- The server restarts, the client reconnects on a new socket.
+    server.reset(new hriPhysio::Stream::TcpStreamer());
+    server->setName("127.0.0.1:47106");
+    server->setDataType("int32");
+    server->setNumChannels(1);
+    REQUIRE(server->openOutputStream());
+
+    for (int pass = 0; pass < 100 && values.back() != 2; ++pass) {
+        server->publish(std::vector<hriPhysio::varType>{ int32_t(2) });
+        server->flush();
+        reactor.runOnce(0.05);
+    }
+    CHECK(values.back() == 2);
+    CHECK(client.getDescriptor() >= 0);
+    CHECK(reactor.getNumSources() == 1);
+}
+
+TEST_CASE("Test IoReactor timers, posted tasks and stop") {
+
+    hriPhysio::Core::IoReactor reactor;
+
+    int ticks = 0, once = 0;
+    REQUIRE(reactor.addTimer(0.01, [&ticks]() { ++ticks; }) >= 0);
+    REQUIRE(reactor.addTimer(0.01, [&once]() { ++once; }, /*repeat=*/ false) >= 0);
+
+    //-- Another thread stops the reactor through a posted task.
+    std::atomic<bool> stopped(false);
+    std::thread other([&reactor, &ticks, &stopped]() {
+        while (!stopped) {
+            reactor.post([&reactor, &ticks, &stopped]() {
+                if (ticks >= 5 && !stopped) {
+                    stopped = true;
+                    reactor.stop();
+                }
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    reactor.run();
+    other.join();
+
+    CHECK(ticks >= 5);
+    CHECK(once  == 1);
+    CHECK(reactor.getNumSources() == 1);
+}
+
+TEST_CASE("Test IoReactor hands dispatched handlers to the dispatcher") {
+
+    hriPhysio::Core::IoReactor reactor;
+
+    std::vector< hriPhysio::Core::IoReactor::Task > queue;
+    reactor.setDispatcher([&queue](hriPhysio::Core::IoReactor::Task task) {
+        queue.push_back(std::move(task));
+    });
+
+    int fired = 0;
+    REQUIRE(reactor.addTimer(0.005, [&fired]() { ++fired; }) >= 0);
+
+    //-- Timers run inline, only sources added with dispatch go to the pool.
+    reactor.runOnce(0.5);
+    CHECK(fired >= 1);
+    CHECK(queue.empty());
+
+    int pipe_fds[2];
+    REQUIRE(pipe(pipe_fds) == 0);
+
+    int reads = 0;
+    REQUIRE(reactor.addDescriptor(pipe_fds[0], [&reads, &pipe_fds](uint32_t) {
+        char byte;
+        if (read(pipe_fds[0], &byte, 1) == 1) { ++reads; }
+    }, EPOLLIN, /*dispatch=*/ true));
+
+    REQUIRE(write(pipe_fds[1], "ab", 2) == 2);
+
+    //-- One shot until the dispatched handler ran, even though data is left.
+    for (int pass = 0; pass < 5; ++pass) {
+        reactor.runOnce(0.01);
+    }
+    REQUIRE(queue.size() == 1);
+
+    queue.front()();
+    queue.clear();
+    CHECK(reads == 1);
+
+    for (int pass = 0; pass < 5 && queue.empty(); ++pass) {
+        reactor.runOnce(0.01);
+    }
+    REQUIRE(queue.size() == 1);
+    queue.front()();
+    CHECK(reads == 2);
+
+    reactor.removeDescriptor(pipe_fds[0]);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
@@ -0,0 +1,111 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Processing/activityTracker.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    double uniform(uint32_t& seed) {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0 - 0.5;
+    }
+
+
+    //-- 200 Hz of a wrist walking at ``spm`` for ``walking`` seconds, then resting.
+    void frames(const double spm, const double walking, const double seconds,
+                std::vector<double>& source, std::vector<double>& stamps) {
+        uint32_t seed = 11;
+        const double step = spm / 60.0;
+        for (std::size_t idx = 0; idx < seconds * 200; ++idx) {
+            const double time = idx / 200.0;
+            const double gait = (time < walking) ? 1.0 : 0.0;
+            stamps.push_back(time);
+            source.push_back(gait * 0.1 * std::sin(M_PI * step * time) + 0.01 * uniform(seed));
+            source.push_back(gait * 0.05 * std::cos(2.0 * M_PI * step * time) + 0.01 * uniform(seed));
+            source.push_back(1.0 + gait * (0.3 * std::sin(2.0 * M_PI * step * time)
+                                         + 0.1 * std::sin(4.0 * M_PI * step * time + 0.5)) + 0.01 * uniform(seed));
+        }
+    }
+}
+
+
+TEST_CASE("Test vectorMagnitude against the scalar norm") {
+
+    uint32_t seed = 7;
+    std::vector<double> source(3 * 7);
+    for (double& value : source) {
+        value = 4.0 * uniform(seed);
+    }
+
+    //-- Odd counts exercise the scalar tail.
+    for (std::size_t count : {0, 1, 2, 5, 7}) {
+        std::vector<double> target(count, -1.0);
+        hriPhysio::Processing::vectorMagnitude(source.data(), target.data(), count);
+
+        for (std::size_t frame = 0; frame < count; ++frame) {
+            const double* in = &source[3 * frame];
+            CHECK(target[frame] == doctest::Approx(std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2])));
+        }
+    }
+}
+
+
+TEST_CASE("Test ActivityTracker steps, cadence and rest") {
+
+    std::vector<double> source, stamps;
+    frames(120.0, 20.0, 30.0, source, stamps);
+
+    hriPhysio::Processing::ActivityTracker tracker(200);
+    std::vector<hriPhysio::Processing::ActivityEpoch> epochs;
+
+    //-- Uneven blocks, as a stream delivers them.
+    const std::size_t block = 37;
+    for (std::size_t start = 0; start < stamps.size(); start += block) {
+        const std::size_t count = std::min(block, stamps.size() - start);
+        tracker.process(&source[3 * start], &stamps[start], count, epochs);
+    }
+
+    REQUIRE(epochs.size() == 29);
+
+    std::size_t steps = 0;
+    for (const hriPhysio::Processing::ActivityEpoch& epoch : epochs) {
+        if (DEBUG) {
+            std::cout << epoch.time << "s: " << epoch.intensity << " g, " << epoch.counts << " g s, "
+                      << epoch.steps << " steps, " << epoch.cadence << " spm (" << epoch.regularity << ")" << std::endl;
+        }
+
+        CHECK(epoch.time == doctest::Approx(std::round(epoch.time)));
+
+        if (epoch.time > 5.0 && epoch.time <= 20.0) {
+            steps += epoch.steps;
+            CHECK(epoch.steps >= 1);
+            CHECK(epoch.steps <= 3);
+            CHECK(epoch.cadence == doctest::Approx(120.0).epsilon(0.05));
+            CHECK(epoch.intensity > 0.05);
+        } else if (epoch.time >= 26.0) {
+            CHECK(epoch.steps == 0);
+            CHECK(epoch.cadence == 0.0);
+            CHECK(epoch.intensity < 0.01);
+        }
+    }
+
+    //-- Two steps a second over the 15 seconds walking.
+    CHECK(steps >= 28);
+    CHECK(steps <= 32);
+}
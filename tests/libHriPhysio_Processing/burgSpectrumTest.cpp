@@ -0,0 +1,98 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Processing/burgSpectrum.h>
+#include <HriPhysio/Processing/heartRateVariability.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    //-- Uniform noise in [-0.5, 0.5).
+    double uniform(uint32_t& seed) {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0 - 0.5;
+    }
+
+
+    //-- Two minutes of RR intervals swinging at about ``freq`` Hz, with a
+    //-- jittered phase so the peak has some width, as it would in vivo.
+    std::vector<double> modulated(const double freq) {
+        std::vector<double> rr;
+        uint32_t seed = 7;
+        double time = 0.0, phase = 0.0;
+        while (time < 120.0) {
+            phase += 2.0 * M_PI * freq * 0.85 + 0.3 * uniform(seed);
+            const double interval = 850.0 + 40.0 * std::sin(phase) + 20.0 * uniform(seed);
+            rr.push_back(interval);
+            time += interval / 1000.0;
+        }
+        return rr;
+    }
+}
+
+
+TEST_CASE("Test BurgSpectrum recovers an AR(2) process") {
+
+    //-- x[n] = 1.2 x[n-1] - 0.7 x[n-2] + e[n]
+    std::vector<double> x = { 0.0, 0.0 };
+    uint32_t seed = 2021;
+    for (std::size_t idx = 0; idx < 4000; ++idx) {
+        x.push_back(1.2 * x[idx + 1] - 0.7 * x[idx] + uniform(seed));
+    }
+
+    hriPhysio::Processing::BurgSpectrum burg(/*maxOrder=*/ 10);
+    REQUIRE(burg.fit(x.data(), x.size()));
+
+    REQUIRE(burg.getOrder() >= 2);
+    CHECK(burg.getCoefficients()[0] == doctest::Approx(-1.2).epsilon(0.05));
+    CHECK(burg.getCoefficients()[1] == doctest::Approx( 0.7).epsilon(0.05));
+    CHECK(burg.getVariance() == doctest::Approx(1.0 / 12.0).epsilon(0.05));
+
+    //-- The one sided spectrum integrates to the variance of the signal.
+    double mean = 0.0, variance = 0.0;
+    for (const double value : x) { mean += value; }
+    mean /= x.size();
+    for (const double value : x) { variance += (value - mean) * (value - mean); }
+    variance /= x.size();
+
+    CHECK(burg.bandPower(0.0, 0.5, 1.0) == doctest::Approx(variance).epsilon(0.05));
+
+    //-- Nothing to fit.
+    const std::vector<double> flat(100, 3.0);
+    CHECK_FALSE(burg.fit(flat.data(), flat.size()));
+    CHECK(burg.getOrder() == 0);
+    CHECK(burg.bandPower(0.0, 0.5, 1.0) == 0.0);
+}
+
+
+TEST_CASE("Test hrvFrequency finds the band of the modulation") {
+
+    const hriPhysio::Processing::HrvFrequency respiratory = hriPhysio::Processing::hrvFrequency(modulated(0.25));
+    CHECK(respiratory.order > 0);
+    CHECK(respiratory.hf > 10.0 * respiratory.lf);
+    CHECK(respiratory.hf_nu > 90.0);
+    CHECK(respiratory.lf_nu + respiratory.hf_nu == doctest::Approx(100.0));
+    CHECK(respiratory.total == doctest::Approx(respiratory.vlf + respiratory.lf + respiratory.hf));
+
+    const hriPhysio::Processing::HrvFrequency baroreflex = hriPhysio::Processing::hrvFrequency(modulated(0.1));
+    CHECK(baroreflex.lf > 10.0 * baroreflex.hf);
+    CHECK(baroreflex.lf_hf > 10.0);
+
+    //-- Too short.
+    CHECK(hriPhysio::Processing::hrvFrequency({ 800.0, 810.0 }).num_intervals == 0);
+}
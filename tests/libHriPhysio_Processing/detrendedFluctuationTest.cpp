@@ -0,0 +1,135 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Processing/detrendedFluctuation.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    //-- Integrate around the mean and fit every box explicitly.
+    double bruteForce(const std::vector<double>& x, const std::size_t n) {
+
+        double mean = 0.0;
+        for (const double value : x) { mean += value; }
+        mean /= x.size();
+
+        std::vector<double> y;
+        double total = 0.0;
+        for (const double value : x) { total += value - mean; y.push_back(total); }
+
+        double residuals = 0.0;
+        const std::size_t boxes = x.size() / n;
+        for (std::size_t box = 0; box < boxes; ++box) {
+            double t_mean = (n - 1) / 2.0, y_mean = 0.0;
+            for (std::size_t t = 0; t < n; ++t) { y_mean += y[box * n + t]; }
+            y_mean /= n;
+
+            double cov = 0.0, var = 0.0;
+            for (std::size_t t = 0; t < n; ++t) {
+                cov += (t - t_mean) * (y[box * n + t] - y_mean);
+                var += (t - t_mean) * (t - t_mean);
+            }
+            const double slope = cov / var;
+            for (std::size_t t = 0; t < n; ++t) {
+                const double fit = y_mean + slope * (t - t_mean);
+                residuals += (y[box * n + t] - fit) * (y[box * n + t] - fit);
+            }
+        }
+        return std::sqrt(residuals / (boxes * n));
+    }
+
+
+    std::vector<double> noise(const std::size_t count, uint32_t seed) {
+        std::vector<double> x;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            seed = seed * 1664525u + 1013904223u;
+            x.push_back(800.0 + 100.0 * ((seed >> 8) / 16777216.0 - 0.5));
+        }
+        return x;
+    }
+}
+
+
+TEST_CASE("Test DetrendedFluctuation agrees with fitting every box") {
+
+    const std::vector<double> x = noise(500, 99);
+
+    hriPhysio::Processing::DetrendedFluctuation dfa;
+    dfa.push(x.data(), x.size());
+    for (const std::size_t n : { 4, 7, 16, 64, 250 }) {
+        CHECK(dfa.fluctuation(n) == doctest::Approx(bruteForce(x, n)));
+    }
+    CHECK(std::isnan(dfa.fluctuation(251)));
+
+    //-- Sliding along, including across the rebuilds of the prefix sums.
+    hriPhysio::Processing::DetrendedFluctuation sliding(/*capacity=*/ 120);
+    for (std::size_t idx = 0; idx < x.size(); ++idx) {
+        sliding.push(&x[idx], 1);
+        if (idx >= 119 && idx % 37 == 0) {
+            const std::vector<double> window(x.begin() + idx - 119, x.begin() + idx + 1);
+            CHECK(sliding.size() == 120);
+            CHECK(sliding.fluctuation(4)  == doctest::Approx(bruteForce(window, 4)));
+            CHECK(sliding.fluctuation(13) == doctest::Approx(bruteForce(window, 13)));
+        }
+    }
+}
+
+TEST_CASE("Test DetrendedFluctuation scaling exponents") {
+
+    //-- Uncorrelated noise has alpha near 0.5, its running sum near 1.5.
+    const std::vector<double> x = noise(4000, 3);
+    std::vector<double> walk;
+    double total = 0.0;
+    for (const double value : x) { total += value - 800.0; walk.push_back(total); }
+
+    hriPhysio::Processing::DetrendedFluctuation white, brown(0, /*threads=*/ 4);
+    white.push(x.data(), x.size());
+    brown.push(walk.data(), walk.size());
+
+    CHECK(white.alpha(16, 64) == doctest::Approx(0.5).epsilon(0.15));
+    CHECK(brown.alpha(16, 64) == doctest::Approx(1.5).epsilon(0.15));
+
+    //-- Threads only share the work.
+    brown.setNumThreads(1);
+    const double single = brown.alpha(4, 64);
+    brown.setNumThreads(3);
+    CHECK(brown.alpha(4, 64) == single);
+
+    //-- Too short for two scales.
+    hriPhysio::Processing::DetrendedFluctuation tiny;
+    tiny.push(x.data(), 9);
+    CHECK(std::isnan(tiny.alpha(4, 16)));
+}
+
+TEST_CASE("Test DetrendedFluctuation keeps its precision over a long series") {
+
+    //-- A first value far from the rest must not become the level the whole
+    //-- series is integrated around.
+    std::vector<double> x = noise(200000, 17);
+    x[0] = 2000.0;
+
+    hriPhysio::Processing::DetrendedFluctuation dfa;
+    for (std::size_t begin = 0; begin < x.size(); begin += 1000) {
+        dfa.push(&x[begin], 1000);
+    }
+
+    CHECK(dfa.size() == x.size());
+    for (const std::size_t n : { 4, 16, 64 }) {
+        CHECK(dfa.fluctuation(n) == doctest::Approx(bruteForce(x, n)));
+    }
+}
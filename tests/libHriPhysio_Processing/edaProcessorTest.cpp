@@ -0,0 +1,127 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Processing/edaProcessor.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    const unsigned int rate = 128;
+
+
+    //-- A response starting at ``onset`` seconds, peaking at ``amplitude``.
+    double response(const double time, const double onset, const double amplitude) {
+        const double t = time - onset;
+        if (t <= 0.0) {
+            return 0.0;
+        }
+        //-- (1 - exp(-t/0.75)) exp(-t/2) peaks at t = 0.75 ln(1 + 2/0.75).
+        const double crest = 0.75 * std::log(1.0 + 2.0 / 0.75);
+        const double scale = (1.0 - std::exp(-crest / 0.75)) * std::exp(-crest / 2.0);
+        return amplitude * (1.0 - std::exp(-t / 0.75)) * std::exp(-t / 2.0) / scale;
+    }
+
+
+    //-- A minute of two participants, interleaved, with their timestamps.
+    void simulate(std::vector<double>& frames, std::vector<double>& stamps) {
+        uint32_t seed = 11;
+        for (std::size_t idx = 0; idx < 60 * rate; ++idx) {
+            const double time = static_cast<double>(idx) / rate;
+            seed = seed * 1664525u + 1013904223u;
+            const double noise = 0.004 * ((seed >> 8) / 16777216.0 - 0.5);
+
+            stamps.push_back(time);
+            frames.push_back(5.0 + 0.01 * time + response(time, 10.0, 0.5) + response(time, 25.0, 0.3)
+                             + response(time, 40.0, 0.6) + noise);
+            frames.push_back(2.0 - 0.005 * time + response(time, 30.0, 0.2) + noise);
+        }
+    }
+}
+
+
+TEST_CASE("Test EdaProcessor finds the responses of each participant") {
+
+    std::vector<double> frames, stamps;
+    simulate(frames, stamps);
+
+    hriPhysio::Processing::EdaProcessor eda(rate, /*numChannels=*/ 2, /*window=*/ 4.0, /*minAmplitude=*/ 0.05);
+
+    std::vector<double> tonic, phasic;
+    std::vector<hriPhysio::Processing::SkinConductanceResponse> responses;
+    eda.process(frames.data(), stamps.data(), stamps.size(), tonic, phasic, responses);
+
+    REQUIRE(tonic.size()  == frames.size());
+    REQUIRE(phasic.size() == frames.size());
+
+    //-- The tonic level follows the drift, away from the responses.
+    const std::size_t quiet = 55 * rate;
+    CHECK(tonic[2 * quiet]     == doctest::Approx(5.0 + 0.01 * stamps[quiet]).epsilon(0.01));
+    CHECK(tonic[2 * quiet + 1] == doctest::Approx(2.0 - 0.005 * stamps[quiet]).epsilon(0.01));
+    CHECK(std::abs(phasic[2 * quiet]) < 0.03);
+
+    //-- In the order their peaks were confirmed.
+    const double onsets[]        = { 10.0, 25.0, 30.0, 40.0 };
+    const double amplitudes[]    = { 0.5,  0.3,  0.2,  0.6  };
+    const std::size_t channels[] = { 0,    0,    1,    0    };
+
+    REQUIRE(responses.size() == 4);
+    for (std::size_t idx = 0; idx < 4; ++idx) {
+        if (DEBUG) {
+            std::cout << responses[idx].channel << " " << responses[idx].onset << " " << responses[idx].peak
+                      << " " << responses[idx].amplitude << std::endl;
+        }
+        CHECK(responses[idx].channel == channels[idx]);
+        CHECK(responses[idx].onset == doctest::Approx(onsets[idx]).epsilon(0.01));
+        CHECK(responses[idx].amplitude == doctest::Approx(amplitudes[idx]).epsilon(0.1));
+        CHECK(responses[idx].rise_time == doctest::Approx(0.97).epsilon(0.2));
+    }
+}
+
+
+TEST_CASE("Test EdaProcessor gives the same result block by block") {
+
+    std::vector<double> frames, stamps;
+    simulate(frames, stamps);
+
+    hriPhysio::Processing::EdaProcessor whole(rate, 2), blocks(rate, 2);
+
+    std::vector<double> tonic, phasic;
+    std::vector<hriPhysio::Processing::SkinConductanceResponse> responses;
+    whole.process(frames.data(), stamps.data(), stamps.size(), tonic, phasic, responses);
+
+    std::vector<double> block_tonic, block_phasic;
+    std::vector<hriPhysio::Processing::SkinConductanceResponse> block_responses;
+    for (std::size_t start = 0; start < stamps.size(); start += 32) {
+        const std::size_t count = std::min<std::size_t>(32, stamps.size() - start);
+        blocks.process(frames.data() + 2 * start, stamps.data() + start, count,
+                       block_tonic, block_phasic, block_responses);
+    }
+
+    CHECK(block_tonic  == tonic);
+    CHECK(block_phasic == phasic);
+    REQUIRE(block_responses.size() == responses.size());
+    for (std::size_t idx = 0; idx < responses.size(); ++idx) {
+        CHECK(block_responses[idx].peak == responses[idx].peak);
+    }
+
+    //-- And from the start again after a reset.
+    blocks.reset();
+    block_tonic.clear(); block_phasic.clear(); block_responses.clear();
+    blocks.process(frames.data(), stamps.data(), stamps.size(), block_tonic, block_phasic, block_responses);
+    CHECK(block_phasic == phasic);
+}
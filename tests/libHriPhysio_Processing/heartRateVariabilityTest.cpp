@@ -0,0 +1,40 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <HriPhysio/Processing/heartRateVariability.h>
+
+#define DEBUG 0
+
+
+TEST_CASE("Test time domain HRV of a short RR series") {
+
+    const std::vector<double> peaks = { 1.0, 1.8, 2.7, 3.5, 4.4, 5.25 };
+    const std::vector<double> rr = hriPhysio::Processing::rrIntervals(peaks);
+
+    REQUIRE(rr.size() == 5);
+    CHECK(rr[0] == doctest::Approx(800.0));
+    CHECK(rr[4] == doctest::Approx(850.0));
+
+    //-- Checked against hrvanalysis.get_time_domain_features.
+    const hriPhysio::Processing::HrvTimeDomain features = hriPhysio::Processing::hrvTimeDomain({ 800.0, 900.0, 800.0, 900.0, 850.0 });
+    CHECK(features.num_intervals == 5);
+    CHECK(features.mean_rr == doctest::Approx(850.0));
+    CHECK(features.sdnn    == doctest::Approx(50.0));
+    CHECK(features.rmssd   == doctest::Approx(std::sqrt((100.0 * 100.0 * 3 + 50.0 * 50.0) / 4)));
+    CHECK(features.pnn50   == doctest::Approx(75.0));
+    CHECK(features.mean_hr == doctest::Approx((75.0 + 60000.0 / 900 * 2 + 75.0 + 60000.0 / 850) / 5));
+
+    //-- Too short to say anything.
+    CHECK(hriPhysio::Processing::hrvTimeDomain({ 800.0 }).num_intervals == 0);
+}
@@ -0,0 +1,156 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <HriPhysio/Processing/pulseDetector.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    double uniform(uint32_t& seed) {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0 - 0.5;
+    }
+
+
+    //-- A systolic wave and a dicrotic one after it.
+    double wave(const double phase) {
+        return std::exp(-std::pow((phase - 0.2) / 0.07, 2.0))
+             + 0.4 * std::exp(-std::pow((phase - 0.45) / 0.09, 2.0));
+    }
+
+
+    //-- 128 Hz of three LEDs at ``bpm``, on their own raw levels, the last
+    //-- one mostly noise. Beats listed in ``skip`` are left out.
+    void ppg(const double bpm, const double seconds, const std::vector<std::size_t>& skip,
+             std::vector<double>& source, std::vector<double>& stamps, std::vector<double>& peaks) {
+
+        uint32_t seed = 21;
+        std::vector<double> starts;
+        for (double start = 0.0; start < seconds; start += 60.0 / bpm * (1.0 + 0.03 * uniform(seed))) {
+            starts.push_back(start);
+        }
+        for (std::size_t idx = 0; idx + 1 < starts.size(); ++idx) {
+            if (std::find(skip.begin(), skip.end(), idx) == skip.end()) {
+                peaks.push_back(starts[idx] + 0.2 * (starts[idx + 1] - starts[idx]));
+            }
+        }
+
+        std::size_t beat = 0;
+        for (std::size_t idx = 0; idx < seconds * 128; ++idx) {
+            const double time = idx / 128.0;
+            while (beat + 2 < starts.size() && starts[beat + 1] <= time) {
+                ++beat;
+            }
+
+            const bool missing = std::find(skip.begin(), skip.end(), beat) != skip.end();
+            const double pulse = missing ? 0.0 : wave((time - starts[beat]) / (starts[beat + 1] - starts[beat]));
+            const double drift = 0.3 * std::sin(2.0 * M_PI * 0.1 * time);
+
+            stamps.push_back(time);
+            source.push_back(50000.0 + 1000.0 * (pulse + drift) + 20.0 * uniform(seed));
+            source.push_back(42000.0 +  600.0 * (pulse + drift) + 20.0 * uniform(seed));
+            source.push_back(30000.0 +   10.0 * pulse + 200.0 * uniform(seed));
+        }
+    }
+
+
+    std::vector<hriPhysio::Processing::PulseBeat> detect(const std::vector<double>& source, const std::vector<double>& stamps,
+                                                         const std::size_t block, double& rate) {
+
+        hriPhysio::Processing::PulseDetector detector(128, 3);
+        std::vector<double> pulse;
+        std::vector<hriPhysio::Processing::PulseBeat> beats;
+
+        for (std::size_t start = 0; start < stamps.size(); start += block) {
+            const std::size_t count = std::min(block, stamps.size() - start);
+            detector.process(&source[3 * start], &stamps[start], count, pulse, beats);
+        }
+        CHECK(pulse.size() == stamps.size());
+
+        rate = detector.getHeartRate();
+        return beats;
+    }
+}
+
+
+TEST_CASE("Test PulseDetector finds the systolic peaks") {
+
+    std::vector<double> source, stamps, peaks;
+    ppg(89.0, 60.0, {}, source, stamps, peaks);
+
+    double rate = 0.0;
+    const std::vector<hriPhysio::Processing::PulseBeat> beats = detect(source, stamps, 32, rate);
+
+    //-- Every beat after the first two seconds, on its peak.
+    std::size_t matched = 0, good = 0;
+    for (const hriPhysio::Processing::PulseBeat& beat : beats) {
+        if (DEBUG) {
+            std::cout << beat.time << "s: " << beat.interval << " ms, " << beat.amplitude << " ("
+                      << beat.agreement << (beat.good ? ", good)" : ")") << std::endl;
+        }
+
+        double nearest = 1.0;
+        for (const double peak : peaks) {
+            nearest = std::min(nearest, std::abs(peak - beat.time));
+        }
+        CHECK(nearest < 0.03);
+        matched += (nearest < 0.03) ? 1 : 0;
+        good    += beat.good ? 1 : 0;
+    }
+
+    std::size_t expected = 0;
+    for (const double peak : peaks) {
+        expected += (peak > 2.5) ? 1 : 0;
+    }
+    CHECK(matched >= expected);
+    CHECK(matched <= expected + 1);
+    CHECK(good >= matched - 2);
+
+    CHECK(rate == doctest::Approx(89.0).epsilon(0.03));
+
+    //-- The stream is cut differently, the beats are the same.
+    double other = 0.0;
+    const std::vector<hriPhysio::Processing::PulseBeat> whole = detect(source, stamps, stamps.size(), other);
+    REQUIRE(whole.size() == beats.size());
+    for (std::size_t idx = 0; idx < beats.size(); ++idx) {
+        CHECK(whole[idx].time == beats[idx].time);
+        CHECK(whole[idx].good == beats[idx].good);
+    }
+}
+
+
+TEST_CASE("Test PulseDetector flags a missed beat") {
+
+    std::vector<double> source, stamps, peaks;
+    ppg(89.0, 30.0, {20}, source, stamps, peaks);
+
+    double rate = 0.0;
+    const std::vector<hriPhysio::Processing::PulseBeat> beats = detect(source, stamps, 32, rate);
+
+    //-- The beat after the gap spans two intervals.
+    std::size_t bad = 0;
+    for (const hriPhysio::Processing::PulseBeat& beat : beats) {
+        if (beat.interval > 1000.0) {
+            CHECK_FALSE(beat.good);
+            ++bad;
+        }
+    }
+    CHECK(bad == 1);
+    CHECK(rate == doctest::Approx(89.0).epsilon(0.03));
+}
@@ -0,0 +1,199 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <HriPhysio/Processing/butterworthBandPass.h>
+#include <HriPhysio/Processing/butterworthHighPass.h>
+#include <HriPhysio/Processing/rPeakDetector.h>
+
+#define DEBUG 0
+
+
+//-- Prototypes. Implemented in processingHelperFunctions.cpp.
+void printVector(const std::vector<double>& vec);
+
+
+namespace {
+
+    double gaussian(const double time, const double centre, const double width) {
+        return std::exp(-0.5 * (time - centre) * (time - centre) / (width * width));
+    }
+
+    //-- Filter and detect as a stream would, in frames of 64 samples.
+    std::vector<double> detectBeats(const double rate, std::vector<double>& ecg, const std::vector<double>& stamps,
+                                    std::vector<double>& amplitudes, const bool inverted = false) {
+
+        hriPhysio::Processing::ButterworthHighPass baseline(rate);
+        hriPhysio::Processing::ButterworthBandPass qrs(rate, 10.0);
+        hriPhysio::Processing::RPeakDetector detector(rate, inverted);
+
+        std::vector<double> peaks;
+        for (std::size_t begin = 0; begin < ecg.size(); begin += 64) {
+            const std::size_t count = std::min<std::size_t>(64, ecg.size() - begin);
+            baseline.filterContinuous(ecg.data() + begin, ecg.data() + begin, count, 0.5);
+            qrs.filterContinuous(ecg.data() + begin, ecg.data() + begin, count, 10.0);
+            detector.process(ecg.data() + begin, stamps.data() + begin, count, peaks, amplitudes);
+        }
+        return peaks;
+    }
+
+    //-- Beats with a breathing rhythm in their spacing, on a wandering baseline with noise.
+    //-- The beat numbered ``weak`` is scaled by ``weak_scale``.
+    void synthesizeEcg(const double rate, const double seconds, std::vector<double>& ecg,
+                       std::vector<double>& stamps, std::vector<double>& beats,
+                       const std::size_t weak = std::size_t(-1), const double weak_scale = 1.0) {
+
+        for (double beat = 0.4; beat < seconds; beat += 0.8 + 0.1 * std::sin(beat * 1.5)) {
+            beats.push_back(beat);
+        }
+
+        uint32_t seed = 12345;
+        for (std::size_t idx = 0; idx < static_cast<std::size_t>(seconds * rate); ++idx) {
+            const double time = idx / rate;
+            double value = 0.3 * std::sin(2.0 * M_PI * 0.2 * time);
+            for (std::size_t num = 0; num < beats.size(); ++num) {
+                const double beat = beats[num];
+                if (std::abs(time - beat) > 0.6) { continue; }
+                value += ((num == weak) ? weak_scale : 1.0) * (
+                         1.0  * gaussian(time, beat, 0.010)
+                       - 0.2  * gaussian(time, beat + 0.03, 0.010)
+                       + 0.25 * gaussian(time, beat + 0.28, 0.040));
+            }
+            seed = seed * 1664525u + 1013904223u;
+            value += 0.02 * ((seed >> 8) / 16777216.0 - 0.5);
+
+            ecg.push_back(value);
+            stamps.push_back(time);
+        }
+    }
+}
+
+
+TEST_CASE("Test Biquadratic filters a signal block by block") {
+
+    std::vector<double> source;
+    for (std::size_t idx = 0; idx < 1000; ++idx) {
+        source.push_back(std::sin(idx * 0.3) + 0.5 * std::sin(idx * 0.01));
+    }
+
+    hriPhysio::Processing::ButterworthHighPass whole(250);
+    std::vector<double> expected(source.size());
+    whole.filter(source.data(), expected.data(), source.size(), 2.0);
+
+    //-- Uneven blocks, filtered in place.
+    hriPhysio::Processing::ButterworthHighPass blocks(250);
+    std::vector<double> target(source);
+    for (std::size_t begin = 0; begin < target.size(); begin += 73) {
+        const std::size_t count = std::min<std::size_t>(73, target.size() - begin);
+        blocks.filterContinuous(target.data() + begin, target.data() + begin, count, 2.0);
+    }
+
+    for (std::size_t idx = 0; idx < source.size(); ++idx) {
+        CHECK(target[idx] == doctest::Approx(expected[idx]));
+    }
+
+    //-- After a reset it starts over.
+    blocks.reset();
+    blocks.filterContinuous(source.data(), target.data(), 10, 2.0);
+    CHECK(target[9] == doctest::Approx(expected[9]));
+}
+
+TEST_CASE("Test RPeakDetector finds every beat of a synthetic ECG") {
+
+    const double rate = 250.0;
+    std::vector<double> ecg, stamps, beats;
+    synthesizeEcg(rate, 60.0, ecg, stamps, beats);
+
+    hriPhysio::Processing::ButterworthHighPass baseline(rate);
+    hriPhysio::Processing::ButterworthBandPass qrs(rate, 10.0);
+    hriPhysio::Processing::RPeakDetector detector(rate);
+
+    //-- As it would arrive from a stream, in frames.
+    std::vector<double> peaks;
+    for (std::size_t begin = 0; begin < ecg.size(); begin += 64) {
+        const std::size_t count = std::min<std::size_t>(64, ecg.size() - begin);
+        baseline.filterContinuous(ecg.data() + begin, ecg.data() + begin, count, 0.5);
+        qrs.filterContinuous(ecg.data() + begin, ecg.data() + begin, count, 10.0);
+        detector.process(ecg.data() + begin, stamps.data() + begin, count, peaks);
+    }
+
+    //-- Every beat after the training period, each within a few samples.
+    std::vector<double> expected;
+    std::copy_if(beats.begin(), beats.end(), std::back_inserter(expected), [](double beat) { return beat > 2.0; });
+    if (DEBUG || peaks.size() != expected.size()) {
+        printVector(peaks);
+        printVector(expected);
+    }
+    REQUIRE(peaks.size() == expected.size());
+    for (std::size_t idx = 0; idx < peaks.size(); ++idx) {
+        CHECK(std::abs(peaks[idx] - expected[idx]) < 0.03);
+    }
+
+    //-- Starting over finds the same beats, and the filtered R wave at each.
+    detector.reset();
+    std::vector<double> again, amplitudes;
+    detector.process(ecg.data(), stamps.data(), ecg.size(), again, amplitudes);
+    CHECK(again == peaks);
+    REQUIRE(amplitudes.size() == peaks.size());
+    for (std::size_t idx = 0; idx < peaks.size(); ++idx) {
+        const std::size_t sample = static_cast<std::size_t>(std::lround(peaks[idx] * rate));
+        CHECK(amplitudes[idx] == ecg[sample]);
+    }
+}
+
+TEST_CASE("Test RPeakDetector searches back for a low-amplitude beat") {
+
+    const double rate = 250.0;
+    std::vector<double> ecg, stamps, beats;
+    synthesizeEcg(rate, 40.0, ecg, stamps, beats, /*weak=*/ 30, /*weak_scale=*/ 0.65);
+
+    std::vector<double> amplitudes;
+    const std::vector<double> peaks = detectBeats(rate, ecg, stamps, amplitudes);
+
+    //-- The weak beat is under the threshold, but found once the next one is overdue.
+    std::vector<double> expected;
+    std::copy_if(beats.begin(), beats.end(), std::back_inserter(expected), [](double beat) { return beat > 2.0; });
+    if (DEBUG || peaks.size() != expected.size()) {
+        printVector(peaks);
+        printVector(expected);
+    }
+    REQUIRE(peaks.size() == expected.size());
+    for (std::size_t idx = 0; idx < peaks.size(); ++idx) {
+        CHECK(std::abs(peaks[idx] - expected[idx]) < 0.03);
+    }
+}
+
+TEST_CASE("Test RPeakDetector follows an inverted lead") {
+
+    const double rate = 250.0;
+    std::vector<double> ecg, stamps, beats;
+    synthesizeEcg(rate, 30.0, ecg, stamps, beats);
+    for (double& value : ecg) {
+        value = -value;
+    }
+
+    //-- Band passed, the S wave is as large as the R wave, so which one is the peak must be told.
+    std::vector<double> amplitudes;
+    const std::vector<double> peaks = detectBeats(rate, ecg, stamps, amplitudes, /*inverted=*/ true);
+
+    std::vector<double> expected;
+    std::copy_if(beats.begin(), beats.end(), std::back_inserter(expected), [](double beat) { return beat > 2.0; });
+    REQUIRE(peaks.size() == expected.size());
+    for (std::size_t idx = 0; idx < peaks.size(); ++idx) {
+        CHECK(std::abs(peaks[idx] - expected[idx]) < 0.03);
+        CHECK(amplitudes[idx] < 0.0);
+    }
+}
@@ -0,0 +1,121 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Processing/respirationTracker.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    double uniform(uint32_t& seed) {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0 - 0.5;
+    }
+
+
+    //-- Beats of a heart at about 70 bpm, breathing at ``bpm``.
+    void beats(const double bpm, const double seconds, std::vector<double>& peaks, std::vector<double>& amplitudes) {
+        uint32_t seed = 3;
+        double time = 0.5;
+        while (time < seconds) {
+            const double breath = std::sin(2.0 * M_PI * bpm / 60.0 * time);
+            peaks.push_back(time);
+            amplitudes.push_back(1.0 + 0.1 * breath + 0.02 * uniform(seed));
+            time += 0.85 + 0.04 * breath + 0.02 * uniform(seed);
+        }
+    }
+
+
+    //-- 50 Hz of three axes, the chest rising and falling on the last one.
+    void motion(const double bpm, const double seconds, std::vector<double>& frames, std::vector<double>& stamps) {
+        uint32_t seed = 5;
+        for (std::size_t idx = 0; idx < seconds * 50; ++idx) {
+            const double time = idx / 50.0;
+            stamps.push_back(time);
+            frames.push_back(0.1 * uniform(seed));
+            frames.push_back(0.1 * uniform(seed));
+            frames.push_back(1.0 + 0.02 * std::sin(2.0 * M_PI * bpm / 60.0 * time) + 0.01 * uniform(seed));
+        }
+    }
+}
+
+
+TEST_CASE("Test RespirationTracker agrees across its sources") {
+
+    std::vector<double> peaks, amplitudes, frames, stamps;
+    beats(15.0, 60.0, peaks, amplitudes);
+    motion(15.0, 60.0, frames, stamps);
+
+    hriPhysio::Processing::RespirationTracker tracker;
+    tracker.addBeats(peaks.data(), amplitudes.data(), peaks.size());
+    tracker.addMotion(frames.data(), stamps.data(), stamps.size());
+
+    hriPhysio::Processing::RespirationEstimate estimate;
+    REQUIRE(tracker.estimate(60.0, estimate));
+
+    if (DEBUG) {
+        std::cout << estimate.rate << " " << estimate.quality << " " << estimate.edr << " "
+                  << estimate.rsa << " " << estimate.motion << std::endl;
+    }
+
+    CHECK(estimate.time   == 60.0);
+    CHECK(estimate.rate   == doctest::Approx(15.0).epsilon(0.05));
+    CHECK(estimate.edr    == doctest::Approx(15.0).epsilon(0.05));
+    CHECK(estimate.rsa    == doctest::Approx(15.0).epsilon(0.05));
+    CHECK(estimate.motion == doctest::Approx(15.0).epsilon(0.05));
+    CHECK(estimate.quality > 0.5);
+
+    //-- Not again until the update is due.
+    CHECK_FALSE(tracker.estimate(62.0, estimate));
+    CHECK(tracker.estimate(65.0, estimate));
+}
+
+
+TEST_CASE("Test RespirationTracker follows a change of pace with what it has") {
+
+    std::vector<double> frames, stamps;
+    motion(10.0, 120.0, frames, stamps);
+
+    //-- The accelerometer alone, fed in blocks as it would stream.
+    hriPhysio::Processing::RespirationTracker tracker;
+    hriPhysio::Processing::RespirationEstimate estimate;
+    for (std::size_t start = 0; start < stamps.size(); start += 25) {
+        tracker.addMotion(frames.data() + 3 * start, stamps.data() + start, 25);
+        tracker.estimate(stamps[start + 24], estimate);
+    }
+
+    CHECK(estimate.rate   == doctest::Approx(10.0).epsilon(0.05));
+    CHECK(estimate.motion == doctest::Approx(10.0).epsilon(0.05));
+    CHECK(estimate.edr == 0.0);
+    CHECK(estimate.rsa == 0.0);
+
+    //-- Breathing faster, once the window has filled with it.
+    std::vector<double> faster, faster_stamps;
+    motion(20.0, 40.0, faster, faster_stamps);
+    for (double& stamp : faster_stamps) {
+        stamp += 120.0;
+    }
+    tracker.addMotion(faster.data(), faster_stamps.data(), faster_stamps.size());
+    REQUIRE(tracker.estimate(160.0, estimate));
+    CHECK(estimate.rate == doctest::Approx(20.0).epsilon(0.05));
+
+    //-- Nothing at all.
+    tracker.reset();
+    REQUIRE(tracker.estimate(200.0, estimate));
+    CHECK(estimate.rate == 0.0);
+    CHECK(estimate.quality == 0.0);
+}
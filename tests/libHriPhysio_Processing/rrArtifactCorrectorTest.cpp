@@ -0,0 +1,95 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <HriPhysio/Processing/rrArtifactCorrector.h>
+
+#define DEBUG 0
+
+
+TEST_CASE("Test RRArtifactCorrector interpolates over ectopic beats and outliers") {
+
+    using Method = hriPhysio::Processing::RRArtifactCorrector::Method;
+    hriPhysio::Processing::RRArtifactCorrector corrector(Method::Malik);
+
+    //-- A premature beat and its compensatory pause, then a missed beat.
+    const std::vector<double> rr = { 800.0, 810.0, 400.0, 1200.0, 805.0, 800.0, 3000.0, 790.0 };
+    std::vector<double> nn;
+    corrector.process(rr.data(), rr.size(), nn);
+    corrector.flush(nn);
+
+    const std::vector<double> expected = { 800.0, 810.0, 810.0 - 5.0 / 3, 810.0 - 10.0 / 3, 805.0, 800.0, 795.0, 790.0 };
+    REQUIRE(nn.size() == expected.size());
+    for (std::size_t idx = 0; idx < nn.size(); ++idx) {
+        CHECK(nn[idx] == doctest::Approx(expected[idx]));
+    }
+    CHECK(corrector.getNumCorrected() == 3);
+
+    //-- Kamath allows a steadier slowing down than Malik.
+    hriPhysio::Processing::RRArtifactCorrector kamath(Method::Kamath);
+    const std::vector<double> slower = { 800.0, 1000.0, 1200.0 };
+    nn.clear();
+    kamath.process(slower.data(), slower.size(), nn);
+    CHECK(nn == slower);
+    CHECK(kamath.getNumCorrected() == 0);
+}
+
+TEST_CASE("Test RRArtifactCorrector holds back at most what it must") {
+
+    using Method = hriPhysio::Processing::RRArtifactCorrector::Method;
+
+    //-- Karlsson waits one interval for the neighbour.
+    hriPhysio::Processing::RRArtifactCorrector karlsson(Method::Karlsson);
+    const std::vector<double> rr = { 800.0, 820.0, 500.0, 840.0, 830.0 };
+    std::vector<double> nn;
+    karlsson.process(&rr[0], 1, nn);
+    CHECK(nn.empty());
+    karlsson.process(&rr[1], 1, nn);
+    CHECK(nn.size() == 1);
+
+    karlsson.process(&rr[2], rr.size() - 2, nn);
+    CHECK(nn.size() == rr.size() - 1);
+    karlsson.flush(nn);
+    REQUIRE(nn.size() == rr.size());
+    CHECK(nn[2] == doctest::Approx(830.0));
+    CHECK(nn[4] == doctest::Approx(830.0));
+
+    //-- A real change of rhythm is only resisted for ``maxGap`` intervals.
+    hriPhysio::Processing::RRArtifactCorrector malik(Method::Malik, 300.0, 2000.0, /*maxGap=*/ 3);
+    std::vector<double> faster = { 800.0, 800.0, 800.0 };
+    faster.insert(faster.end(), 10, 500.0);
+    nn.clear();
+    malik.process(faster.data(), faster.size(), nn);
+    malik.flush(nn);
+
+    REQUIRE(nn.size() == faster.size());
+    for (std::size_t idx = 0; idx < 7; ++idx) {
+        CHECK(nn[idx] == doctest::Approx(800.0));
+    }
+    for (std::size_t idx = 7; idx < nn.size(); ++idx) {
+        CHECK(nn[idx] == doctest::Approx(500.0));
+    }
+    CHECK(malik.getNumCorrected() == 4);
+
+    //-- Nothing to compare the start with but the range.
+    malik.reset();
+    const std::vector<double> start = { 100.0, 800.0, 810.0 };
+    nn.clear();
+    malik.process(start.data(), start.size(), nn);
+    CHECK(nn == std::vector<double>{ 800.0, 800.0, 810.0 });
+
+    hriPhysio::Processing::RRArtifactCorrector::Method method;
+    CHECK(hriPhysio::Processing::RRArtifactCorrector::parseMethod("Kamath", method));
+    CHECK(method == Method::Kamath);
+    CHECK_FALSE(hriPhysio::Processing::RRArtifactCorrector::parseMethod("lipponen", method));
+}
@@ -0,0 +1,123 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Processing/heartRateVariability.h>
+#include <HriPhysio/Processing/slidingEntropy.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    //-- Every pair of templates, straight from the definitions.
+    void bruteForce(const std::vector<double>& x, const std::size_t m, const double r, double& sampen, double& apen) {
+
+        const std::size_t n = x.size();
+        auto matches = [&](std::size_t i, std::size_t j, std::size_t length) {
+            for (std::size_t k = 0; k < length; ++k) {
+                if (std::abs(x[i + k] - x[j + k]) > r) { return false; }
+            }
+            return true;
+        };
+
+        double shorter = 0.0, longer = 0.0;
+        for (std::size_t i = 0; i < n - m; ++i) {
+            for (std::size_t j = i + 1; j < n - m; ++j) {
+                shorter += matches(i, j, m)     ? 1.0 : 0.0;
+                longer  += matches(i, j, m + 1) ? 1.0 : 0.0;
+            }
+        }
+        sampen = -std::log(longer / shorter);
+
+        auto phi = [&](std::size_t length) {
+            const std::size_t count = n - length + 1;
+            double sum = 0.0;
+            for (std::size_t i = 0; i < count; ++i) {
+                double c = 0.0;
+                for (std::size_t j = 0; j < count; ++j) {
+                    c += matches(i, j, length) ? 1.0 : 0.0;
+                }
+                sum += std::log(c / count);
+            }
+            return sum / count;
+        };
+        apen = phi(m) - phi(m + 1);
+    }
+
+
+    std::vector<double> rhythm(const std::size_t count) {
+        std::vector<double> rr;
+        uint32_t seed = 777;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            seed = seed * 1664525u + 1013904223u;
+            rr.push_back(800.0 + 60.0 * std::sin(idx * 0.4) + 40.0 * ((seed >> 8) / 16777216.0 - 0.5));
+        }
+        return rr;
+    }
+}
+
+
+TEST_CASE("Test SlidingEntropy agrees with the pairwise definitions") {
+
+    const std::vector<double> rr = rhythm(300);
+
+    double sampen, apen;
+    bruteForce(rr, 2, 15.0, sampen, apen);
+
+    hriPhysio::Processing::SlidingEntropy entropy(2, 0, 15.0);
+    entropy.push(rr.data(), rr.size());
+    CHECK(entropy.size() == 300);
+    CHECK(entropy.sampleEntropy()      == doctest::Approx(sampen));
+    CHECK(entropy.approximateEntropy() == doctest::Approx(apen));
+
+    //-- Sliding a window of 100 along matches recomputing it each time.
+    hriPhysio::Processing::SlidingEntropy sliding(2, 100, 15.0);
+    for (std::size_t idx = 0; idx < rr.size(); ++idx) {
+        sliding.push(&rr[idx], 1);
+        if (idx >= 99 && idx % 50 == 0) {
+            const std::vector<double> window(rr.begin() + idx - 99, rr.begin() + idx + 1);
+            bruteForce(window, 2, 15.0, sampen, apen);
+            CHECK(sliding.size() == 100);
+            CHECK(sliding.sampleEntropy()      == doctest::Approx(sampen));
+            CHECK(sliding.approximateEntropy() == doctest::Approx(apen));
+        }
+    }
+
+    //-- A new tolerance recounts the same window.
+    const std::vector<double> window(rr.end() - 100, rr.end());
+    bruteForce(window, 2, 25.0, sampen, apen);
+    sliding.setTolerance(25.0);
+    CHECK(sliding.sampleEntropy()      == doctest::Approx(sampen));
+    CHECK(sliding.approximateEntropy() == doctest::Approx(apen));
+}
+
+TEST_CASE("Test nonlinear HRV of a short RR series") {
+
+    const std::vector<double> rr = { 800.0, 900.0, 800.0, 900.0, 850.0 };
+    const hriPhysio::Processing::HrvNonlinear features = hriPhysio::Processing::hrvNonlinear(rr);
+
+    //-- Successive differences (100, -100, 100, -50) and sums (1700 x3, 1750).
+    CHECK(features.num_intervals == 5);
+    CHECK(features.sd1     == doctest::Approx(std::sqrt(31875.0 / 3) / std::sqrt(2.0)));
+    CHECK(features.sd2     == doctest::Approx(25.0 / std::sqrt(2.0)));
+    CHECK(features.sd1_sd2 == doctest::Approx(features.sd1 / features.sd2));
+
+    //-- With r = 10 only (800, 900) repeats, and never with the same third value.
+    CHECK(std::isinf(features.sampen));
+    CHECK(features.apen == doctest::Approx((2.0 * std::log(0.5) + 2.0 * std::log(0.25)) / 4 - std::log(1.0 / 3)));
+
+    CHECK(hriPhysio::Processing::hrvNonlinear({ 800.0, 810.0 }).num_intervals == 0);
+}
@@ -0,0 +1,274 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <HriPhysio/Stream/csvStreamer.h>
+
+
+namespace {
+
+    std::vector<std::string> readLines(const std::string& path) {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+}
+
+
+TEST_CASE("Test CsvStreamer writes a header and one row per sample") {
+
+    const std::string path = "/tmp/hriPhysio_csvStreamerTest_write.csv";
+
+    {
+        hriPhysio::Stream::CsvStreamer writer;
+        writer.setName(path);
+        writer.setDataType("int16");
+        writer.setNumChannels(2);
+        REQUIRE(writer.openOutputStream());
+
+        std::vector<hriPhysio::varType> frame = { int16_t(1), int16_t(-2), int16_t(300), int16_t(4) };
+        std::vector<double> stamps = { 12.5, 12.625 };
+        writer.publish(frame, &stamps);
+
+        //-- Missing timestamps are written as zero.
+        writer.publish(std::vector<hriPhysio::varType>{ int16_t(7), int16_t(8) });
+
+        double stamp = 13.0;
+        writer.publish(std::string("marker"), &stamp);
+    }
+
+    const std::vector<std::string> lines = readLines(path);
+    REQUIRE(lines.size() == 5);
+    CHECK(lines[0] == "System Time,Internal Time,ch-0,ch-1");
+
+    //-- "YYYY/MM/DD_HH:MM:SS," prefix, then the rest of the row.
+    for (std::size_t idx = 1; idx < lines.size(); ++idx) {
+        REQUIRE(lines[idx].size() > 20);
+        CHECK(lines[idx][4]  == '/');
+        CHECK(lines[idx][10] == '_');
+        CHECK(lines[idx][19] == ',');
+    }
+    CHECK(lines[1].substr(20) == "12.5,1,-2");
+    CHECK(lines[2].substr(20) == "12.625,300,4");
+    CHECK(lines[3].substr(20) == "0,7,8");
+    CHECK(lines[4].substr(20) == "13,\"marker\"");
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test CsvStreamer converts values published as another type") {
+
+    const std::string path = "/tmp/hriPhysio_csvStreamerTest_convert.csv";
+
+    {
+        hriPhysio::Stream::CsvStreamer writer;
+        writer.setName(path);
+        writer.setDataType("int16");
+        writer.setNumChannels(2);
+        REQUIRE(writer.openOutputStream());
+
+        //-- A publisher sending doubles to an int16 logger.
+        std::vector<hriPhysio::varType> frame = { 12.0, int16_t(-3), -7.0, int32_t(40) };
+        std::vector<double> stamps = { 1.0, 2.0 };
+        writer.publish(frame, &stamps);
+        CHECK(writer.getConvertedCells() == 3);
+    }
+
+    const std::vector<std::string> lines = readLines(path);
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[1].substr(20) == "1,12,-3");
+    CHECK(lines[2].substr(20) == "2,-7,40");
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test CsvStreamer keeps full timestamp precision across flushes") {
+
+    const std::string path = "/tmp/hriPhysio_csvStreamerTest_flush.csv";
+
+    hriPhysio::Stream::CsvStreamer writer;
+    writer.setName(path);
+    writer.setDataType("double");
+    writer.setNumChannels(1);
+    writer.setFlushThreshold(256);
+    REQUIRE(writer.openOutputStream());
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < 1000; ++idx) {
+        frame.push_back(idx * 0.1);
+        stamps.push_back(1234567.000001 + idx);
+    }
+    writer.publish(frame, &stamps);
+    writer.flush();
+
+    const std::vector<std::string> lines = readLines(path);
+    REQUIRE(lines.size() == 1001);
+    for (std::size_t idx = 0; idx < 1000; ++idx) {
+        std::istringstream row(lines[idx + 1].substr(20));
+        double stamp = 0.0, value = 0.0;
+        char comma;
+        row >> stamp >> comma >> value;
+        CHECK(stamp == stamps[idx]);
+        CHECK(value == std::get<double>(frame[idx]));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test CsvStreamer reads back what it wrote") {
+
+    const std::string path = "/tmp/hriPhysio_csvStreamerTest_read.csv";
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < 25; ++idx) {
+        stamps.push_back(500.0 + idx * 0.004);
+        for (std::size_t ch = 0; ch < 3; ++ch) {
+            frame.push_back(static_cast<float>(idx) - 0.25f * ch);
+        }
+    }
+
+    {
+        hriPhysio::Stream::CsvStreamer writer;
+        writer.setName(path);
+        writer.setDataType("float");
+        writer.setNumChannels(3);
+        REQUIRE(writer.openOutputStream());
+        writer.publish(frame, &stamps);
+    }
+
+    //-- Channels come from the header when not configured.
+    hriPhysio::Stream::CsvStreamer reader;
+    reader.setName(path);
+    reader.setDataType("float");
+    reader.setFrameLength(10);
+    REQUIRE(reader.openInputStream());
+    CHECK(reader.getNumChannels() == 3);
+
+    std::vector<hriPhysio::varType> received, chunk;
+    std::vector<double> received_stamps, chunk_stamps;
+    std::vector<std::size_t> sizes;
+    do {
+        reader.receive(chunk, &chunk_stamps);
+        sizes.push_back(chunk_stamps.size());
+        received.insert(received.end(), chunk.begin(), chunk.end());
+        received_stamps.insert(received_stamps.end(), chunk_stamps.begin(), chunk_stamps.end());
+    } while (!chunk.empty());
+
+    CHECK(sizes == std::vector<std::size_t>{ 10, 10, 5, 0 });
+    REQUIRE(received.size() == frame.size());
+    for (std::size_t idx = 0; idx < frame.size(); ++idx) {
+        CHECK(std::get<float>(received[idx]) == std::get<float>(frame[idx]));
+    }
+    CHECK(received_stamps == stamps);
+
+    //-- Rewinding replays from the first row.
+    reader.rewind();
+    reader.receive(chunk, &chunk_stamps);
+    CHECK(chunk_stamps.front() == stamps.front());
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test CsvStreamer reader tolerates blank lines, CRLF and strings") {
+
+    const std::string path = "/tmp/hriPhysio_csvStreamerTest_messy.csv";
+    {
+        std::ofstream file(path);
+        file << "System Time,Internal Time,ch-0,ch-1\r\n"
+             << "2021/01/01_00:00:00,1.5,10,\r\n"
+             << "\n"
+             << "2021/01/01_00:00:01,2.5,30,40\r\n"
+             << "2021/01/01_00:00:02,3.5,\"hello, world\"\n";
+    }
+
+    hriPhysio::Stream::CsvStreamer reader;
+    reader.setName(path);
+    reader.setDataType("int32");
+    reader.setNumChannels(2);
+    reader.setFrameLength(2);
+    REQUIRE(reader.openInputStream());
+
+    std::vector<hriPhysio::varType> chunk;
+    std::vector<double> stamps;
+    reader.receive(chunk, &stamps);
+    REQUIRE(chunk.size() == 4);
+    CHECK(std::get<int32_t>(chunk[0]) == 10);
+    CHECK(std::get<int32_t>(chunk[1]) == 0);
+    CHECK(std::get<int32_t>(chunk[2]) == 30);
+    CHECK(std::get<int32_t>(chunk[3]) == 40);
+    CHECK(stamps == std::vector<double>{ 1.5, 2.5 });
+    CHECK(reader.getBadCells() == 1);
+
+    std::string message;
+    double stamp = 0.0;
+    reader.receive(message, &stamp);
+    CHECK(message == "hello, world");
+    CHECK(stamp == 3.5);
+
+    hriPhysio::Stream::CsvStreamer missing;
+    missing.setName("/tmp/hriPhysio_csvStreamerTest_missing.csv");
+    missing.setDataType("int32");
+    CHECK_FALSE(missing.openInputStream());
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test CsvStreamer counts garbled cells without shifting the row") {
+
+    const std::string path = "/tmp/hriPhysio_csvStreamerTest_garbled.csv";
+    {
+        std::ofstream file(path);
+        file << "System Time,Internal Time,ch-0,ch-1\n"
+             << "2021/01/01_00:00:00,1.0,12abc,5\n"
+             << "2021/01/01_00:00:01,oops,3,4\n"
+             << "2021/01/01_00:00:02,3.0,6\n"
+             << "2021/01/01_00:00:03,4.0,7,8\n";
+    }
+
+    hriPhysio::Stream::CsvStreamer reader;
+    reader.setName(path);
+    reader.setDataType("double");
+    reader.setNumChannels(2);
+    reader.setFrameLength(4);
+    REQUIRE(reader.openInputStream());
+
+    std::vector<hriPhysio::varType> chunk;
+    std::vector<double> stamps;
+    reader.receive(chunk, &stamps);
+
+    //-- A bad cell reads as 0 and the cells after it keep their column.
+    REQUIRE(chunk.size() == 8);
+    const std::vector<double> expected{ 0.0, 5.0, 3.0, 4.0, 6.0, 0.0, 7.0, 8.0 };
+    for (std::size_t idx = 0; idx < expected.size(); ++idx) {
+        CHECK(std::get<double>(chunk[idx]) == expected[idx]);
+    }
+    CHECK(stamps == std::vector<double>{ 1.0, 0.0, 3.0, 4.0 });
+    CHECK(reader.getBadCells() == 3);
+
+    //-- Each pass over the file counts afresh.
+    reader.rewind();
+    reader.receive(chunk, &stamps);
+    CHECK(reader.getBadCells() == 3);
+
+    std::remove(path.c_str());
+}
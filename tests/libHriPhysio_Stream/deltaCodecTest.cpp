@@ -0,0 +1,217 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include <HriPhysio/Stream/deltaCodec.h>
+#include <HriPhysio/Stream/frameCodec.h>
+
+#define DEBUG 0
+
+
+namespace {
+
+    template<typename T>
+    std::size_t roundTrip(const hriPhysio::varTag var, const std::vector<T>& values, const std::size_t channels) {
+
+        const std::size_t samples = values.size() / channels;
+        std::vector<uint8_t> encoded(hriPhysio::Stream::DeltaCodec::maxEncodedSize(var, channels, samples));
+
+        const std::size_t bytes = hriPhysio::Stream::DeltaCodec::encode<T>(values.data(), channels, samples, encoded.data());
+        REQUIRE(bytes <= encoded.size());
+
+        std::vector<T> decoded(values.size());
+        REQUIRE(hriPhysio::Stream::DeltaCodec::decode<T>(encoded.data(), bytes, channels, samples, decoded.data()));
+
+        //-- Bit for bit, so NaN and negative zero count too.
+        CHECK(std::memcmp(decoded.data(), values.data(), values.size() * sizeof(T)) == 0);
+
+        //-- Anything cut short is rejected.
+        if (bytes > 0) {
+            CHECK_FALSE(hriPhysio::Stream::DeltaCodec::decode<T>(encoded.data(), bytes - 1, channels, samples, decoded.data()));
+        }
+
+        return bytes;
+    }
+
+
+    //-- Two channels of a 130 Hz ECG-like signal in microvolts.
+    std::vector<int32_t> makeEcg(const std::size_t samples) {
+        std::mt19937 rng(7);
+        std::normal_distribution<double> noise(0.0, 3.0);
+        std::vector<int32_t> values;
+        for (std::size_t idx = 0; idx < samples; ++idx) {
+            const double t = idx / 130.0;
+            const double beat = std::fmod(t, 0.8);
+            const double wave = 900.0 * std::exp(-std::pow((beat - 0.2) / 0.012, 2)) + 120.0 * std::sin(2.0 * M_PI * t);
+            values.push_back(static_cast<int32_t>(wave + noise(rng)));
+            values.push_back(static_cast<int32_t>(0.5 * wave + noise(rng)));
+        }
+        return values;
+    }
+}
+
+
+TEST_CASE("Test DeltaCodec round trips every type and block shape") {
+
+    std::mt19937 rng(42);
+
+    for (const std::size_t samples : { 0, 1, 2, 3, 127, 128, 129, 256, 1000 }) {
+
+        std::vector<char>    chars;
+        std::vector<int16_t> shorts;
+        std::vector<int64_t> longs;
+        std::vector<float>   floats;
+        std::vector<double>  doubles;
+
+        int64_t walk = 0;
+        for (std::size_t idx = 0; idx < samples * 3; ++idx) {
+            walk += static_cast<int64_t>(rng() % 200) - 100;
+            chars.push_back(static_cast<char>(rng()));
+            shorts.push_back(static_cast<int16_t>(walk));
+            longs.push_back(walk * 1000003);
+            floats.push_back(static_cast<float>(walk) * 0.37f);
+            doubles.push_back(static_cast<double>(walk));
+        }
+
+        roundTrip(hriPhysio::varTag::CHAR,   chars,   3);
+        roundTrip(hriPhysio::varTag::INT16,  shorts,  3);
+        roundTrip(hriPhysio::varTag::INT64,  longs,   3);
+        roundTrip(hriPhysio::varTag::FLOAT,  floats,  3);
+        roundTrip(hriPhysio::varTag::DOUBLE, doubles, 3);
+    }
+}
+
+TEST_CASE("Test DeltaCodec is lossless at the edges") {
+
+    std::vector<int64_t> extremes = {
+        std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), 0, -1,
+        std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(), 1, 2
+    };
+    roundTrip(hriPhysio::varTag::INT64, extremes, 1);
+
+    std::vector<int16_t> saturated;
+    for (std::size_t idx = 0; idx < 300; ++idx) {
+        saturated.push_back((idx % 2) ? std::numeric_limits<int16_t>::max() : std::numeric_limits<int16_t>::min());
+    }
+    roundTrip(hriPhysio::varTag::INT16, saturated, 1);
+
+    std::vector<double> special = {
+        0.0, -0.0, 1.5, std::nan(""), std::numeric_limits<double>::infinity(), -1e300, 4.9e-324, 3.0
+    };
+    roundTrip(hriPhysio::varTag::DOUBLE, special, 2);
+
+    //-- Never more than one mode byte per channel over the raw size.
+    std::mt19937 rng(3);
+    std::vector<int32_t> noise;
+    for (std::size_t idx = 0; idx < 4000; ++idx) {
+        noise.push_back(static_cast<int32_t>(rng()));
+    }
+    CHECK(roundTrip(hriPhysio::varTag::INT32, noise, 4) <= noise.size() * sizeof(int32_t) + 4);
+}
+
+TEST_CASE("Test DeltaCodec compresses physiological signals") {
+
+    const std::vector<int32_t> ecg = makeEcg(130 * 60);
+    const std::size_t ecg_bytes = roundTrip(hriPhysio::varTag::INT32, ecg, 2);
+    CHECK(ecg_bytes * 3 < ecg.size() * sizeof(int32_t));
+
+    //-- Whole numbers stored as double take the integer path.
+    const std::vector<double> ecg_double(ecg.begin(), ecg.end());
+    const std::size_t double_bytes = roundTrip(hriPhysio::varTag::DOUBLE, ecg_double, 2);
+    CHECK(double_bytes * 6 < ecg_double.size() * sizeof(double));
+
+    //-- A slow 200 Hz accelerometer, int16 counts.
+    std::vector<int16_t> acc;
+    for (std::size_t idx = 0; idx < 200 * 60; ++idx) {
+        const double t = idx / 200.0;
+        acc.push_back(static_cast<int16_t>(1000.0 * std::sin(2.0 * M_PI * 1.7 * t)));
+        acc.push_back(static_cast<int16_t>( 400.0 * std::cos(2.0 * M_PI * 0.6 * t)));
+        acc.push_back(static_cast<int16_t>(-980));
+    }
+    const std::size_t acc_bytes = roundTrip(hriPhysio::varTag::INT16, acc, 3);
+    CHECK(acc_bytes * 3 < acc.size() * sizeof(int16_t));
+
+    //DEBUG.
+    if (DEBUG) {
+        std::cerr << "[DeltaCodec] ecg int32 "  << ecg.size() * sizeof(int32_t)       << " -> " << ecg_bytes    << std::endl;
+        std::cerr << "[DeltaCodec] ecg double " << ecg_double.size() * sizeof(double) << " -> " << double_bytes << std::endl;
+        std::cerr << "[DeltaCodec] acc int16 "  << acc.size() * sizeof(int16_t)       << " -> " << acc_bytes    << std::endl;
+    }
+}
+
+TEST_CASE("Test FrameCodec carries compressed payloads") {
+
+    const std::vector<int32_t> ecg = makeEcg(200);
+    std::vector<hriPhysio::varType> values(ecg.begin(), ecg.end());
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < 200; ++idx) {
+        stamps.push_back(50.0 + idx / 130.0);
+    }
+
+    hriPhysio::Stream::FrameCodec codec;
+    codec.setChecksum(true);
+    codec.setCompression(true);
+
+    std::vector<uint8_t> frame(codec.frameSize(hriPhysio::varTag::INT32, 2, 200));
+    const std::size_t bytes = codec.encode<int32_t>(frame.data(), 9, values.data(), 2, 200, stamps.data(), 0.0);
+    CHECK(bytes < frame.size());
+
+    std::size_t peeked = 0;
+    REQUIRE(hriPhysio::Stream::FrameCodec::peekSize(frame.data(), bytes, peeked));
+    CHECK(peeked == bytes);
+
+    hriPhysio::Stream::FrameView view;
+    REQUIRE(hriPhysio::Stream::FrameCodec::decode(frame.data(), bytes, view));
+    CHECK(view.isCompressed());
+
+    std::vector<uint8_t> storage;
+    REQUIRE(view.decompress(storage));
+    CHECK_FALSE(view.isCompressed());
+    for (std::size_t idx = 0; idx < 200; ++idx) {
+        CHECK(view.value<int32_t>(idx, 0) == ecg[2 * idx]);
+        CHECK(view.value<int32_t>(idx, 1) == ecg[2 * idx + 1]);
+    }
+    CHECK(view.timestamp(199) == doctest::Approx(stamps[199]));
+
+    //-- Strings are never compressed.
+    const std::size_t text = codec.encode(frame.data(), 10, std::string("hello"), 1.0);
+    REQUIRE(hriPhysio::Stream::FrameCodec::decode(frame.data(), text, view));
+    CHECK_FALSE(view.isCompressed());
+}
+
+TEST_CASE("Test DeltaCodec decode throughput") {
+
+    const std::vector<int32_t> ecg = makeEcg(130 * 3600);
+    std::vector<uint8_t> encoded(hriPhysio::Stream::DeltaCodec::maxEncodedSize(hriPhysio::varTag::INT32, 2, ecg.size() / 2));
+    const std::size_t bytes = hriPhysio::Stream::DeltaCodec::encode<int32_t>(ecg.data(), 2, ecg.size() / 2, encoded.data());
+
+    std::vector<int32_t> decoded(ecg.size());
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t rep = 0; rep < 10; ++rep) {
+        REQUIRE(hriPhysio::Stream::DeltaCodec::decode<int32_t>(encoded.data(), bytes, 2, ecg.size() / 2, decoded.data()));
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK(decoded == ecg);
+
+    //DEBUG.
+    if (DEBUG) {
+        std::cerr << "[DeltaCodec] decode " << 10.0 * ecg.size() * sizeof(int32_t) / elapsed / 1e6 << " MB/s" << std::endl;
+    }
+}
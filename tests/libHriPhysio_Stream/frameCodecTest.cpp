@@ -0,0 +1,183 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include <HriPhysio/Stream/frameCodec.h>
+
+#define DEBUG 0
+
+
+TEST_CASE("Test FrameCodec round trips interleaved and planar frames") {
+
+    const std::size_t channels = 3, samples = 50;
+
+    std::vector<hriPhysio::varType> values;
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < samples; ++idx) {
+        stamps.push_back(1000.0 + idx * 0.002);
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            values.push_back(static_cast<float>(idx * 10 + ch));
+        }
+    }
+
+    for (const bool planar : { false, true }) {
+
+        hriPhysio::Stream::FrameCodec codec;
+        codec.setStreamId(42);
+        codec.setPlanar(planar);
+
+        std::vector<uint8_t> buffer(codec.frameSize(hriPhysio::varTag::FLOAT, channels, samples));
+        const std::size_t written = codec.encode<float>(buffer.data(), 7, values.data(), channels, samples, stamps.data(), 0.0);
+        REQUIRE(written == buffer.size());
+
+        hriPhysio::Stream::FrameView view;
+        REQUIRE(hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size(), view));
+        CHECK(view.stream_id    == 42);
+        CHECK(view.sequence     == 7);
+        CHECK(view.var          == hriPhysio::varTag::FLOAT);
+        CHECK(view.num_channels == channels);
+        CHECK(view.num_samples  == samples);
+        CHECK(view.isPlanar()   == planar);
+        CHECK(view.frame_bytes  == written);
+
+        for (std::size_t idx = 0; idx < samples; ++idx) {
+            CHECK(view.timestamp(idx) == doctest::Approx(stamps[idx]).epsilon(1e-12));
+            for (std::size_t ch = 0; ch < channels; ++ch) {
+                CHECK(view.value<float>(idx, ch) == std::get<float>(values[idx * channels + ch]));
+            }
+        }
+
+        std::vector<float> interleaved(channels * samples);
+        view.copyInterleaved(interleaved.data());
+        for (std::size_t idx = 0; idx < interleaved.size(); ++idx) {
+            CHECK(interleaved[idx] == std::get<float>(values[idx]));
+        }
+    }
+}
+
+TEST_CASE("Test FrameCodec stamp ranges, strings and checksums") {
+
+    hriPhysio::Stream::FrameCodec codec;
+    codec.setStampRange(true);
+    codec.setChecksum(true);
+
+    //-- Range frames interpolate between the first and last stamps.
+    const int16_t values[] = { 1, 2, 3, 4, 5 };
+    const double  stamps[] = { 2.0, 2.1, 2.2, 2.3, 2.4 };
+
+    std::vector<uint8_t> buffer(codec.frameSize(hriPhysio::varTag::INT16, 1, 5));
+    REQUIRE(codec.encode<int16_t>(buffer.data(), 1, values, 1, 5, stamps, 0.0) == buffer.size());
+
+    hriPhysio::Stream::FrameView view;
+    REQUIRE(hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size(), view));
+    CHECK(view.hasStampRange());
+    CHECK(view.timestamp(2) == doctest::Approx(2.2));
+    CHECK(view.value<int16_t>(4, 0) == 5);
+
+    //-- Any flipped bit fails the checksum.
+    buffer[buffer.size() / 2] ^= 0x10;
+    CHECK_FALSE(hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size(), view));
+
+    //-- Strings carry a single stamp.
+    const std::string message = "annotation: start";
+    buffer.resize(codec.frameSize(hriPhysio::varTag::STRING, 1, message.size()));
+    REQUIRE(codec.encode(buffer.data(), 2, message, 9.5) == buffer.size());
+    REQUIRE(hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size(), view));
+    CHECK(std::string(reinterpret_cast<const char*>(view.payload), view.payload_bytes) == message);
+    CHECK(view.timestamp(0) == doctest::Approx(9.5));
+}
+
+TEST_CASE("Test FrameCodec peekSize on partial and foreign data") {
+
+    hriPhysio::Stream::FrameCodec codec;
+    const double values[] = { 1.0, 2.0 };
+
+    std::vector<uint8_t> buffer(codec.frameSize(hriPhysio::varTag::DOUBLE, 2, 1));
+    codec.encode<double>(buffer.data(), 0, values, 2, 1, nullptr, 1.0);
+
+    std::size_t frame_bytes = 1;
+    CHECK(hriPhysio::Stream::FrameCodec::peekSize(buffer.data(), 10, frame_bytes));
+    CHECK(frame_bytes == 0);
+
+    CHECK(hriPhysio::Stream::FrameCodec::peekSize(buffer.data(), buffer.size(), frame_bytes));
+    CHECK(frame_bytes == buffer.size());
+
+    hriPhysio::Stream::FrameView view;
+    CHECK_FALSE(hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size() - 1, view));
+
+    const uint8_t garbage[40] = { 'n', 'o', 't', ' ', 'a', ' ', 'f', 'r', 'a', 'm', 'e' };
+    CHECK_FALSE(hriPhysio::Stream::FrameCodec::peekSize(garbage, sizeof(garbage), frame_bytes));
+
+    //-- Known CRC32C check value.
+    const std::string check = "123456789";
+    CHECK(hriPhysio::Stream::FrameCodec::crc32c(reinterpret_cast<const uint8_t*>(check.data()), check.size()) == 0xE3069283);
+}
+
+TEST_CASE("Test FrameCodec rejects more channels than a header holds") {
+
+    hriPhysio::Stream::FrameCodec codec;
+
+    //-- The header keeps 16 bits of channels.
+    const std::size_t widest = 65535;
+    const std::vector<int16_t> values(widest + 1, 1);
+    std::vector<uint8_t> buffer(codec.frameSize(hriPhysio::varTag::INT16, widest, 1));
+
+    REQUIRE(codec.encode<int16_t>(buffer.data(), 0, values.data(), widest, 1, nullptr, 1.0) == buffer.size());
+    hriPhysio::Stream::FrameView view;
+    REQUIRE(hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size(), view));
+    CHECK(view.num_channels == widest);
+
+    CHECK(codec.frameSize(hriPhysio::varTag::INT16, widest + 1, 1) == 0);
+    CHECK(codec.encode<int16_t>(buffer.data(), 1, values.data(), widest + 1, 1, nullptr, 1.0) == 0);
+    CHECK(hriPhysio::Stream::FrameCodec::peekSize(buffer.data(), buffer.size(), view.frame_bytes));
+    CHECK(view.frame_bytes == buffer.size());
+}
+
+TEST_CASE("Test FrameCodec encode and decode throughput") {
+
+    const std::size_t channels = 8, samples = 256, rounds = 2000;
+
+    std::vector<double> values(channels * samples), stamps(samples), target(channels * samples);
+    for (std::size_t idx = 0; idx < values.size(); ++idx) { values[idx] = idx * 0.5; }
+    for (std::size_t idx = 0; idx < samples; ++idx) { stamps[idx] = idx * 0.001; }
+
+    hriPhysio::Stream::FrameCodec codec;
+    codec.setChecksum(true);
+    std::vector<uint8_t> buffer(codec.frameSize(hriPhysio::varTag::DOUBLE, channels, samples));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t decoded = 0;
+    for (std::size_t round = 0; round < rounds; ++round) {
+        codec.encode<double>(buffer.data(), round, values.data(), channels, samples, stamps.data(), 0.0);
+
+        hriPhysio::Stream::FrameView view;
+        if (hriPhysio::Stream::FrameCodec::decode(buffer.data(), buffer.size(), view)) {
+            view.copyInterleaved(target.data());
+            ++decoded;
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(decoded == rounds);
+    CHECK(target == values);
+
+    //DEBUG.
+    if (DEBUG) {
+        std::cout << "FrameCodec round trip: "
+                  << (rounds * buffer.size()) / elapsed / (1 << 20) << " MiB/s, "
+                  << (rounds * samples) / elapsed << " samples/s" << std::endl;
+    }
+}
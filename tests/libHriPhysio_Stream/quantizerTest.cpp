@@ -0,0 +1,173 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+#include <limits>
+
+#include <HriPhysio/Stream/frameCodec.h>
+#include <HriPhysio/Stream/quantizer.h>
+#include <HriPhysio/Stream/udpStreamer.h>
+
+
+TEST_CASE("Test Quantizer rounds, saturates and restores") {
+
+    //-- Odd lengths exercise both the vector body and the scalar tail.
+    for (const std::size_t count : { 0, 1, 3, 4, 5, 9, 64 }) {
+
+        std::vector<double> values;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            values.push_back(-1.25 + 0.0005 * idx * idx);
+        }
+
+        std::vector<int16_t> wire(count);
+        hriPhysio::Stream::Quantizer::quantize(values.data(), count, 0.001, -1.0, wire.data());
+
+        std::vector<double> restored(count);
+        hriPhysio::Stream::Quantizer::restore(wire.data(), count, 0.001, -1.0, restored.data());
+
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            CHECK(wire[idx] == static_cast<int16_t>(std::nearbyint((values[idx] + 1.0) / 0.001)));
+            CHECK(std::abs(restored[idx] - values[idx]) <= 0.0005 + 1e-12);
+        }
+    }
+
+    //-- Out of range and NaN values clamp to the ends of the wire type.
+    const std::vector<float> extremes = { 1e9f, -1e9f, std::nanf(""), 32767.4f, -32768.6f, 0.5f, 1.5f, -2.5f };
+    std::vector<int16_t> wire(extremes.size());
+    hriPhysio::Stream::Quantizer::quantize(extremes.data(), extremes.size(), 1.0, 0.0, wire.data());
+    CHECK(wire == std::vector<int16_t>{ 32767, -32768, 32767, 32767, -32768, 0, 2, -2 });
+
+    std::vector<int32_t> wide(extremes.size());
+    hriPhysio::Stream::Quantizer::quantize(extremes.data(), extremes.size(), 1.0, 0.0, wide.data());
+    CHECK(wide[0] == 1000000000);
+    CHECK(wide[1] == -1000000000);
+
+    std::vector<float> restored(extremes.size());
+    hriPhysio::Stream::Quantizer::restore(wide.data(), wide.size(), 0.5, 10.0, restored.data());
+    CHECK(restored[5] == doctest::Approx(10.0));
+    CHECK(restored[6] == doctest::Approx(11.0));
+
+    hriPhysio::Stream::Quantizer quantizer;
+    CHECK_FALSE(quantizer.isEnabled());
+    CHECK_FALSE(quantizer.configure("int8",  1.0, 0.0));
+    CHECK_FALSE(quantizer.configure("int16", 0.0, 0.0));
+    CHECK_FALSE(quantizer.isEnabled());
+    CHECK(quantizer.configure("INT32", 0.5, 2.0));
+    CHECK(quantizer.getWireType() == hriPhysio::varTag::INT32);
+}
+
+TEST_CASE("Test FrameCodec sends quantized frames") {
+
+    //-- 16-bit ECG counts in millivolts, sent as a double stream.
+    std::vector<hriPhysio::varType> values;
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < 130; ++idx) {
+        values.push_back(std::round(800.0 * std::sin(idx * 0.1)) * 0.001);
+        values.push_back(std::round(-300.0 * std::cos(idx * 0.05)) * 0.001);
+        stamps.push_back(20.0 + idx / 130.0);
+    }
+
+    hriPhysio::Stream::Quantizer quantizer;
+    REQUIRE(quantizer.configure("int16", 0.001, 0.0));
+
+    for (const bool compress : { false, true }) {
+
+        hriPhysio::Stream::FrameCodec codec;
+        codec.setChecksum(true);
+        codec.setPlanar(true);
+        codec.setStampRange(true);
+        codec.setCompression(compress);
+
+        hriPhysio::Stream::FrameCodec plain = codec;
+        codec.setQuantizer(quantizer);
+
+        std::vector<uint8_t> frame(codec.frameSize(hriPhysio::varTag::DOUBLE, 2, 130));
+        const std::size_t bytes = codec.encode<double>(frame.data(), 3, values.data(), 2, 130, stamps.data(), 0.0);
+        CHECK(bytes * 2 < plain.frameSize(hriPhysio::varTag::DOUBLE, 2, 130));
+
+        hriPhysio::Stream::FrameView view;
+        REQUIRE(hriPhysio::Stream::FrameCodec::decode(frame.data(), bytes, view));
+        CHECK(view.isQuantized());
+        CHECK(view.var       == hriPhysio::varTag::INT16);
+        CHECK(view.value_var == hriPhysio::varTag::DOUBLE);
+        CHECK(view.scale     == 0.001);
+
+        std::vector<uint8_t> decoded, restored;
+        REQUIRE(view.decompress(decoded));
+        REQUIRE(view.dequantize(restored));
+        CHECK(view.var == hriPhysio::varTag::DOUBLE);
+        for (std::size_t idx = 0; idx < 130; ++idx) {
+            CHECK(view.value<double>(idx, 0) == doctest::Approx(std::get<double>(values[2 * idx])));
+            CHECK(view.value<double>(idx, 1) == doctest::Approx(std::get<double>(values[2 * idx + 1])));
+        }
+        CHECK(view.timestamp(129) == doctest::Approx(stamps[129]));
+    }
+
+    //-- Integer streams are never quantized.
+    hriPhysio::Stream::FrameCodec codec;
+    codec.setQuantizer(quantizer);
+    const std::vector<int32_t> counts = { 1, 2, 3 };
+    std::vector<uint8_t> frame(codec.frameSize(hriPhysio::varTag::INT32, 1, 3));
+    const std::size_t bytes = codec.encode<int32_t>(frame.data(), 4, counts.data(), 1, 3, nullptr, 1.0);
+    CHECK(bytes == frame.size());
+
+    hriPhysio::Stream::FrameView view;
+    REQUIRE(hriPhysio::Stream::FrameCodec::decode(frame.data(), bytes, view));
+    CHECK_FALSE(view.isQuantized());
+}
+
+TEST_CASE("Test UdpStreamer restores quantized values") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    receiver.setName("127.0.0.1:47021");
+    receiver.setDataType("float");
+    receiver.setFrameLength(400);
+    receiver.setNumChannels(3);
+    REQUIRE(receiver.openInputStream());
+
+    hriPhysio::Stream::UdpStreamer sender;
+    sender.setName("127.0.0.1:47021");
+    sender.setDataType("float");
+    sender.setNumChannels(3);
+    sender.setMaxDatagram(512);
+    CHECK_FALSE(sender.setQuantization("int64", 1.0, 0.0));
+    REQUIRE(sender.setQuantization("int16", 0.004, 0.0));
+    REQUIRE(sender.openOutputStream());
+
+    //-- Accelerometer in g at the sensor's 4 mg resolution.
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < 400; ++idx) {
+        stamps.push_back(5.0 + idx * 0.005);
+        frame.push_back(static_cast<float>(std::round(250.0 * std::sin(idx * 0.02)) * 0.004));
+        frame.push_back(static_cast<float>(std::round(-50.0 + idx * 0.1) * 0.004));
+        frame.push_back(static_cast<float>(-0.98));
+    }
+    sender.publish(frame, &stamps);
+
+    std::vector<hriPhysio::varType> received;
+    std::vector<double> received_stamps;
+    receiver.receive(received, &received_stamps);
+
+    REQUIRE(received.size() == frame.size());
+    for (std::size_t idx = 0; idx < frame.size(); ++idx) {
+        CHECK(std::abs(std::get<float>(received[idx]) - std::get<float>(frame[idx])) <= 0.002f);
+    }
+    CHECK(received_stamps.back() == doctest::Approx(stamps.back()));
+
+    //-- Six bytes a sample instead of twelve, so fewer datagrams.
+    const hriPhysio::Stream::UdpStreamer::Statistics stats = receiver.getStatistics();
+    CHECK(stats.malformed == 0);
+    CHECK(stats.received <= 6);
+}
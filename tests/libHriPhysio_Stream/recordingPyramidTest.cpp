@@ -0,0 +1,144 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <HriPhysio/Stream/recordingPyramid.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
+
+
+namespace {
+
+    //-- An ECG-like trace at 100 Hz.
+    double trace(const std::size_t idx) {
+        return std::sin(idx * 0.05) + ((idx % 83 == 0) ? 3.0 : 0.0);
+    }
+
+    //-- Every bin holds exactly the samples between its first and last time.
+    void checkBins(const std::vector<hriPhysio::Stream::PyramidBin>& bins) {
+        for (const auto& bin : bins) {
+            const std::size_t first = static_cast<std::size_t>(std::llround(bin.first_time * 100.0));
+            const std::size_t last  = static_cast<std::size_t>(std::llround(bin.last_time  * 100.0));
+            REQUIRE(bin.count == last - first + 1);
+
+            double low = trace(first), high = trace(first), sum = 0.0;
+            for (std::size_t idx = first; idx <= last; ++idx) {
+                low  = std::min(low,  trace(idx));
+                high = std::max(high, trace(idx));
+                sum += trace(idx);
+            }
+            CHECK(bin.min[0]  == low);
+            CHECK(bin.max[0]  == high);
+            CHECK(bin.mean[0] == doctest::Approx(sum / bin.count));
+        }
+    }
+}
+
+
+TEST_CASE("Test RecordingPyramid builds levels incrementally") {
+
+    hriPhysio::Stream::RecordingPyramid pyramid;
+    CHECK_FALSE(pyramid.setFactor(1));
+    CHECK_FALSE(pyramid.setFactor(17));
+    REQUIRE(pyramid.setFactor(4));
+    pyramid.reset(1);
+
+    //-- Uneven pieces, so bins fill across calls.
+    std::vector<double> values, stamps;
+    for (std::size_t idx = 0; idx < 1000; ++idx) {
+        values.push_back(trace(idx));
+        stamps.push_back(idx * 0.01);
+    }
+    for (std::size_t begin = 0; begin < 1000; begin += 37) {
+        const std::size_t count = std::min<std::size_t>(37, 1000 - begin);
+        pyramid.append(values.data() + begin, stamps.data() + begin, count);
+    }
+
+    CHECK(pyramid.getNumLevels() == 5);
+    CHECK(pyramid.getNumBins(0) == 250);
+    CHECK(pyramid.getNumBins(1) == 63);
+    CHECK(pyramid.getNumBins(2) == 16);
+
+    //-- The whole session in 10 columns comes from level 2.
+    const std::vector<hriPhysio::Stream::PyramidBin> whole = pyramid.query(0.0, 10.0, 10);
+    REQUIRE(whole.size() == 10);
+    checkBins(whole);
+
+    uint64_t total = 0;
+    for (const auto& bin : whole) { total += bin.count; }
+    CHECK(total == 1000);
+    CHECK(whole.front().max[0] == 3.0);
+
+    //-- Zoomed in past the first level, its bins are returned as they are.
+    const std::vector<hriPhysio::Stream::PyramidBin> zoomed = pyramid.query(2.0, 3.0, 400);
+    REQUIRE(zoomed.size() == 25);
+    CHECK(zoomed.front().first_time == doctest::Approx(2.0));
+    checkBins(zoomed);
+
+    CHECK(pyramid.query(20.0, 30.0, 100).empty());
+    CHECK(pyramid.query(3.0, 2.0, 100).empty());
+}
+
+TEST_CASE("Test RecordingStreamer keeps a pyramid next to the recording") {
+
+    const std::string path = "/tmp/hriPhysio_recordingPyramidTest.hrec";
+    {
+        hriPhysio::Stream::RecordingStreamer writer;
+        writer.setName(path);
+        writer.setDataType("double");
+        writer.setNumChannels(1);
+        writer.setChunkLength(128);
+        REQUIRE(writer.openOutputStream());
+
+        std::vector<hriPhysio::varType> frame;
+        std::vector<double> stamps;
+        for (std::size_t idx = 0; idx < 5000; ++idx) {
+            frame.push_back(trace(idx));
+            stamps.push_back(idx * 0.01);
+        }
+        writer.publish(frame, &stamps);
+
+        //-- Queryable while the session is still being written.
+        CHECK(writer.getPyramid().getNumBins(0) == 5000 / 128 * 128 / 8);
+    }
+
+    hriPhysio::Stream::RecordingPyramid saved;
+    REQUIRE(saved.load(hriPhysio::Stream::RecordingPyramid::pathFor(path)));
+    CHECK(saved.getFactor() == 8);
+    CHECK(saved.getNumChannels() == 1);
+
+    hriPhysio::Stream::RecordingReader reader;
+    REQUIRE(reader.open(path));
+    hriPhysio::Stream::RecordingPyramid rebuilt;
+    REQUIRE(rebuilt.build(reader, 0));
+    CHECK_FALSE(rebuilt.build(reader, 3));
+    REQUIRE(rebuilt.build(reader, 0));
+
+    //-- A full session plot touches a few hundred bins, not 5000 samples.
+    const std::vector<hriPhysio::Stream::PyramidBin> from_file = saved.query(0.0, 50.0, 200);
+    const std::vector<hriPhysio::Stream::PyramidBin> from_data = rebuilt.query(0.0, 50.0, 200);
+    REQUIRE(from_file.size() == from_data.size());
+    CHECK(from_file.size() <= 200);
+    for (std::size_t idx = 0; idx < from_file.size(); ++idx) {
+        CHECK(from_file[idx].count  == from_data[idx].count);
+        CHECK(from_file[idx].min[0] == from_data[idx].min[0]);
+        CHECK(from_file[idx].max[0] == from_data[idx].max[0]);
+    }
+    checkBins(from_file);
+
+    std::remove(path.c_str());
+    std::remove(hriPhysio::Stream::RecordingPyramid::pathFor(path).c_str());
+}
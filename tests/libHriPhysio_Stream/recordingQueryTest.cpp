@@ -0,0 +1,183 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <HriPhysio/Stream/recordingQuery.h>
+
+
+namespace {
+
+    //-- A heart rate and a temperature at 10 Hz, written 50 samples a chunk.
+    double heartRate(const std::size_t idx, const std::size_t seed) {
+        return 70.0 + 10.0 * std::sin(idx * 0.07 + seed) + (idx % 7);
+    }
+
+    double temperature(const std::size_t idx, const std::size_t seed) {
+        return 33.0 + 0.001 * idx + 0.1 * seed;
+    }
+
+    void writeSession(const std::string& path, const std::size_t num_samples, const std::size_t seed) {
+
+        hriPhysio::Stream::RecordingWriter writer;
+        REQUIRE(writer.open(path));
+
+        for (std::size_t begin = 0; begin < num_samples; begin += 50) {
+            std::vector<hriPhysio::varType> values;
+            std::vector<double> stamps;
+            for (std::size_t idx = begin; idx < std::min(begin + 50, num_samples); ++idx) {
+                values.push_back(static_cast<float>(heartRate(idx, seed)));
+                values.push_back(static_cast<float>(temperature(idx, seed)));
+                stamps.push_back(idx * 0.1);
+            }
+            REQUIRE(writer.writeChunk(2, hriPhysio::varTag::FLOAT, values.data(), 2, stamps.size(), stamps.data()));
+        }
+        writer.close();
+    }
+
+    //-- The same samples, straight from the generators.
+    std::vector<double> expected(const std::size_t num_samples, const std::size_t seed, const std::size_t channel,
+                                 const double start, const double end) {
+        std::vector<double> values;
+        for (std::size_t idx = 0; idx < num_samples; ++idx) {
+            const double time = idx * 0.1;
+            if (time >= start && time < end) {
+                const double value = (channel == 0) ? heartRate(idx, seed) : temperature(idx, seed);
+                values.push_back(static_cast<float>(value));
+            }
+        }
+        return values;
+    }
+
+    void checkBucket(const hriPhysio::Stream::RecordingQuery::Bucket& bucket, const std::vector<double>& values) {
+
+        REQUIRE(bucket.count == values.size());
+
+        double sum = 0.0;
+        for (const double value : values) { sum += value; }
+        const double mean = sum / values.size();
+
+        double squares = 0.0;
+        for (const double value : values) { squares += (value - mean) * (value - mean); }
+
+        CHECK(bucket.mean == doctest::Approx(mean).epsilon(1e-9));
+        CHECK(bucket.min  == *std::min_element(values.begin(), values.end()));
+        CHECK(bucket.max  == *std::max_element(values.begin(), values.end()));
+        CHECK(bucket.std  == doctest::Approx(std::sqrt(squares / (values.size() - 1))).epsilon(1e-9));
+    }
+}
+
+
+TEST_CASE("Test RecordingQuery buckets match a brute force pass") {
+
+    const std::string path = "/tmp/hriPhysio_recordingQueryTest_buckets.hrec";
+    writeSession(path, 1000, 0);
+
+    //-- Buckets of 7 s over [12.35, 80.05) cut through chunks of 5 s.
+    for (const std::size_t threads : { 1, 4 }) {
+
+        hriPhysio::Stream::RecordingQuery query;
+        query.addFile(path);
+        query.setStreamId(2);
+        query.setTimeRange(12.35, 80.05);
+        query.setBucketWidth(7.0);
+        query.setNumThreads(threads);
+
+        const std::vector<hriPhysio::Stream::RecordingQuery::Bucket> buckets = query.run();
+        REQUIRE(buckets.size() == 20);
+
+        for (const auto& bucket : buckets) {
+            const double start = 12.35 + 7.0 * static_cast<std::size_t>((&bucket - buckets.data()) / 2);
+            CHECK(bucket.start == doctest::Approx(start));
+            CHECK(bucket.channel == static_cast<std::size_t>(&bucket - buckets.data()) % 2);
+            checkBucket(bucket, expected(1000, 0, bucket.channel, start, std::min(start + 7.0, 80.05)));
+        }
+
+        //-- Chunks before 10 s and after 80.05 s are never looked at.
+        CHECK(query.getChunksSummarized() + query.getChunksDecoded() == 15);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test RecordingQuery answers whole chunks from the zone map") {
+
+    const std::string path = "/tmp/hriPhysio_recordingQueryTest_zones.hrec";
+    writeSession(path, 1000, 1);
+
+    hriPhysio::Stream::RecordingQuery query;
+    query.addFile(path);
+    query.setStreamId(2);
+    query.setBucketWidth(20.0);
+
+    //-- Every chunk of 5 s sits inside one bucket of 20 s.
+    const std::vector<hriPhysio::Stream::RecordingQuery::Bucket> buckets = query.run();
+    REQUIRE(buckets.size() == 10);
+    CHECK(query.getChunksSummarized() == 20);
+    CHECK(query.getChunksDecoded() == 0);
+    for (const auto& bucket : buckets) {
+        checkBucket(bucket, expected(1000, 1, bucket.channel, bucket.start, bucket.end));
+    }
+
+    //-- Percentiles need the samples themselves.
+    query.setPercentiles({ 0.0, 50.0, 100.0 });
+    query.setBucketWidth(0.0);
+    const std::vector<hriPhysio::Stream::RecordingQuery::Bucket> whole = query.run();
+    REQUIRE(whole.size() == 2);
+    CHECK(query.getChunksDecoded() == 20);
+
+    std::vector<double> sorted = expected(1000, 1, 0, 0.0, 1e9);
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(whole[0].percentiles.size() == 3);
+    CHECK(whole[0].percentiles[0] == sorted.front());
+    CHECK(whole[0].percentiles[1] == doctest::Approx(0.5 * (sorted[499] + sorted[500])));
+    CHECK(whole[0].percentiles[2] == sorted.back());
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test RecordingQuery spans several files") {
+
+    const std::vector<std::string> paths = {
+        "/tmp/hriPhysio_recordingQueryTest_a.hrec",
+        "/tmp/hriPhysio_recordingQueryTest_b.hrec",
+        "/tmp/hriPhysio_recordingQueryTest_c.hrec",
+    };
+
+    hriPhysio::Stream::RecordingQuery query;
+    for (std::size_t file = 0; file < paths.size(); ++file) {
+        writeSession(paths[file], 300 + 100 * file, file);
+        query.addFile(paths[file]);
+    }
+    query.setStreamId(2);
+    query.setTimeRange(10.0, 1e9);
+    query.setNumThreads(3);
+
+    const std::vector<hriPhysio::Stream::RecordingQuery::Bucket> buckets = query.run();
+    REQUIRE(buckets.size() == 6);
+    for (const auto& bucket : buckets) {
+        CHECK(bucket.file == static_cast<std::size_t>(&bucket - buckets.data()) / 2);
+        checkBucket(bucket, expected(300 + 100 * bucket.file, bucket.file, bucket.channel, 10.0, 1e9));
+    }
+
+    //-- A stream that was never recorded has nothing to report.
+    query.setStreamId(7);
+    CHECK(query.run().empty());
+
+    for (const std::string& path : paths) {
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,184 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cstdio>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <HriPhysio/Stream/recordingStreamer.h>
+
+
+namespace {
+
+    //-- ``num_samples`` samples of two int16 channels at 100 Hz.
+    void writeSession(const std::string& path, const std::size_t num_samples, const bool close = true) {
+
+        auto* writer = new hriPhysio::Stream::RecordingStreamer();
+        writer->setName(path);
+        writer->setDataType("int16");
+        writer->setNumChannels(2);
+        writer->setChunkLength(64);
+        writer->openOutputStream();
+
+        std::vector<hriPhysio::varType> frame;
+        std::vector<double> stamps;
+        for (std::size_t idx = 0; idx < num_samples; ++idx) {
+            frame.push_back(static_cast<int16_t>(idx));
+            frame.push_back(static_cast<int16_t>(-static_cast<int>(idx)));
+            stamps.push_back(100.0 + idx * 0.01);
+
+            if (stamps.size() == 10) {
+                writer->publish(frame, &stamps);
+                frame.clear();
+                stamps.clear();
+            }
+        }
+        writer->publish(frame, &stamps);
+
+        if (close) {
+            delete writer;
+        } else {
+            //-- Leave the file as a crash would, chunks on disk but no index.
+            writer->flush();
+        }
+    }
+}
+
+
+TEST_CASE("Test RecordingStreamer reads back what it wrote") {
+
+    const std::string path = "/tmp/hriPhysio_recordingStreamerTest_roundtrip.hrec";
+    writeSession(path, 1000);
+
+    hriPhysio::Stream::RecordingReader file;
+    REQUIRE(file.open(path));
+    CHECK_FALSE(file.wasRecovered());
+    CHECK(file.getStreamIds() == std::vector<uint32_t>{ 0 });
+    CHECK(file.getChunks().size() == 16);
+    CHECK(file.getChunks().front().first_time == doctest::Approx(100.0));
+    CHECK(file.getChunks().back().last_time   == doctest::Approx(109.99));
+
+    hriPhysio::Stream::RecordingStreamer reader;
+    reader.setName(path);
+    reader.setDataType("int32");
+    reader.setFrameLength(50);
+    REQUIRE(reader.openInputStream());
+    CHECK(reader.getNumChannels() == 2);
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    std::size_t total = 0;
+    do {
+        reader.receive(frame, &stamps);
+        REQUIRE(frame.size() == stamps.size() * 2);
+        for (std::size_t idx = 0; idx < stamps.size(); ++idx) {
+            CHECK(std::get<int32_t>(frame[2 * idx])     ==  static_cast<int32_t>(total + idx));
+            CHECK(std::get<int32_t>(frame[2 * idx + 1]) == -static_cast<int32_t>(total + idx));
+            CHECK(stamps[idx] == doctest::Approx(100.0 + (total + idx) * 0.01).epsilon(1e-12));
+        }
+        total += stamps.size();
+    } while (!stamps.empty());
+    CHECK(total == 1000);
+
+    std::remove(path.c_str());
+    std::remove(hriPhysio::Stream::RecordingPyramid::pathFor(path).c_str());
+}
+
+TEST_CASE("Test RecordingStreamer seeks by time") {
+
+    const std::string path = "/tmp/hriPhysio_recordingStreamerTest_seek.hrec";
+    writeSession(path, 1000);
+
+    hriPhysio::Stream::RecordingStreamer reader;
+    reader.setName(path);
+    reader.setDataType("int16");
+    reader.setFrameLength(5);
+    REQUIRE(reader.openInputStream());
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+
+    REQUIRE(reader.seek(104.005));
+    reader.receive(frame, &stamps);
+    REQUIRE(stamps.size() == 5);
+    CHECK(stamps.front() == doctest::Approx(104.01));
+    CHECK(std::get<int16_t>(frame[0]) == 401);
+
+    REQUIRE(reader.seek(0.0));
+    reader.receive(frame, &stamps);
+    CHECK(std::get<int16_t>(frame[0]) == 0);
+
+    CHECK_FALSE(reader.seek(200.0));
+    reader.receive(frame, &stamps);
+    CHECK(frame.empty());
+
+    std::remove(path.c_str());
+    std::remove(hriPhysio::Stream::RecordingPyramid::pathFor(path).c_str());
+}
+
+TEST_CASE("Test RecordingReader recovers a file that was never closed") {
+
+    const std::string path = "/tmp/hriPhysio_recordingStreamerTest_crash.hrec";
+    writeSession(path, 300, /*close=*/ false);
+
+    //-- Tear the last chunk too.
+    struct stat info;
+    REQUIRE(stat(path.c_str(), &info) == 0);
+    REQUIRE(truncate(path.c_str(), info.st_size - 20) == 0);
+
+    hriPhysio::Stream::RecordingReader file;
+    REQUIRE(file.open(path));
+    CHECK(file.wasRecovered());
+    REQUIRE(file.getChunks().size() == 4);
+    CHECK(file.getChunks().back().last_time == doctest::Approx(102.55));
+    CHECK(file.seek(0, 101.0) == 1);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test RecordingStreamer keeps string streams") {
+
+    const std::string path = "/tmp/hriPhysio_recordingStreamerTest_string.hrec";
+    {
+        hriPhysio::Stream::RecordingStreamer writer;
+        writer.setName(path);
+        writer.setDataType("string");
+        REQUIRE(writer.openOutputStream());
+
+        double stamp = 1.5;
+        writer.publish(std::string("robot says hello"), &stamp);
+        stamp = 2.5;
+        writer.publish(std::string("robot waves"), &stamp);
+    }
+
+    hriPhysio::Stream::RecordingStreamer reader;
+    reader.setName(path);
+    reader.setDataType("string");
+    REQUIRE(reader.openInputStream());
+
+    std::string message;
+    double stamp = 0.0;
+    reader.receive(message, &stamp);
+    CHECK(message == "robot says hello");
+    CHECK(stamp == doctest::Approx(1.5));
+    reader.receive(message, &stamp);
+    CHECK(message == "robot waves");
+    CHECK(stamp == doctest::Approx(2.5));
+    reader.receive(message, &stamp);
+    CHECK(message.empty());
+
+    std::remove(path.c_str());
+    std::remove(hriPhysio::Stream::RecordingPyramid::pathFor(path).c_str());
+}
@@ -0,0 +1,151 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include <HriPhysio/Stream/csvStreamer.h>
+#include <HriPhysio/Stream/recordingStreamer.h>
+#include <HriPhysio/Stream/replayStreamer.h>
+
+
+namespace {
+
+    //-- 20 samples at 100 Hz, starting at t = 1000 s.
+    void writeRecording(const std::string& path) {
+        hriPhysio::Stream::CsvStreamer writer;
+        writer.setName(path);
+        writer.setDataType("int32");
+        writer.setNumChannels(1);
+        writer.openOutputStream();
+
+        std::vector<hriPhysio::varType> frame;
+        std::vector<double> stamps;
+        for (std::size_t idx = 0; idx < 20; ++idx) {
+            frame.push_back(static_cast<int32_t>(idx));
+            stamps.push_back(1000.0 + idx * 0.01);
+        }
+        writer.publish(frame, &stamps);
+    }
+
+    double secondsSince(const std::chrono::steady_clock::time_point& start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+TEST_CASE("Test ReplayStreamer paces frames by their recorded timestamps") {
+
+    const std::string path = "/tmp/hriPhysio_replayStreamerTest_paced.csv";
+    writeRecording(path);
+
+    hriPhysio::Stream::ReplayStreamer replay;
+    replay.setName(path);
+    replay.setDataType("int32");
+    replay.setFrameLength(5);
+    replay.setSamplingRate(100);
+    replay.setSpeed(2.0);
+    REQUIRE(replay.openInputStream());
+    CHECK_FALSE(replay.openOutputStream());
+    CHECK(replay.getNumChannels() == 1);
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    std::size_t total = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t idx = 0; idx < 4; ++idx) {
+        replay.receive(frame, &stamps);
+        REQUIRE(frame.size() == 5);
+        CHECK(std::get<int32_t>(frame[0]) == static_cast<int32_t>(total));
+        total += frame.size();
+    }
+
+    //-- The last frame ends 190 ms in, so twice as fast is ~95 ms.
+    const double elapsed = secondsSince(start);
+    CHECK(elapsed >= 0.09);
+    CHECK(elapsed <  0.5);
+    CHECK(stamps.back() == doctest::Approx(1000.19));
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test ReplayStreamer runs unthrottled and loops with continuous time") {
+
+    const std::string path = "/tmp/hriPhysio_replayStreamerTest_loop.csv";
+    writeRecording(path);
+
+    hriPhysio::Stream::ReplayStreamer replay;
+    replay.setName(path);
+    replay.setDataType("int32");
+    replay.setFrameLength(10);
+    replay.setSamplingRate(100);
+    replay.setSpeed(0.0);
+    replay.setLoop(true);
+    REQUIRE(replay.openInputStream());
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps, all_stamps;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t idx = 0; idx < 6; ++idx) {
+        replay.receive(frame, &stamps);
+        REQUIRE(frame.size() == 10);
+        all_stamps.insert(all_stamps.end(), stamps.begin(), stamps.end());
+    }
+    CHECK(secondsSince(start) < 0.05);
+
+    //-- Three passes, each continuing one period after the previous.
+    REQUIRE(all_stamps.size() == 60);
+    for (std::size_t idx = 1; idx < all_stamps.size(); ++idx) {
+        CHECK(all_stamps[idx] - all_stamps[idx - 1] == doctest::Approx(0.01));
+    }
+    CHECK(std::get<int32_t>(frame[9]) == 19);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test ReplayStreamer plays binary recordings") {
+
+    const std::string path = "/tmp/hriPhysio_replayStreamerTest_binary.hrec";
+    {
+        hriPhysio::Stream::RecordingStreamer writer;
+        writer.setName(path);
+        writer.setDataType("double");
+        writer.setNumChannels(1);
+        REQUIRE(writer.openOutputStream());
+
+        std::vector<hriPhysio::varType> frame = { 0.5, 1.5, 2.5 };
+        std::vector<double> stamps = { 10.0, 10.01, 10.02 };
+        writer.publish(frame, &stamps);
+    }
+
+    hriPhysio::Stream::ReplayStreamer replay;
+    replay.setName(path);
+    replay.setDataType("double");
+    replay.setFrameLength(3);
+    replay.setSpeed(0.0);
+    REQUIRE(replay.openInputStream());
+    CHECK(replay.getNumChannels() == 1);
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    replay.receive(frame, &stamps);
+    REQUIRE(frame.size() == 3);
+    CHECK(std::get<double>(frame[2]) == 2.5);
+    CHECK(stamps.back() == doctest::Approx(10.02));
+
+    std::remove(path.c_str());
+    std::remove(hriPhysio::Stream::RecordingPyramid::pathFor(path).c_str());
+}
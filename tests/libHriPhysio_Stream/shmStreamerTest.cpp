@@ -0,0 +1,152 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <HriPhysio/Stream/shmStreamer.h>
+
+
+TEST_CASE("Test ShmStreamer round trip of a multi-channel frame") {
+
+    hriPhysio::Stream::ShmStreamer writer;
+    writer.setName("/test/shm/roundtrip");
+    writer.setDataType("int16");
+    writer.setFrameLength(4);
+    writer.setNumChannels(2);
+    writer.setSamplingRate(100);
+    REQUIRE(writer.openOutputStream());
+
+    //-- Reader adopts the description published by the writer.
+    hriPhysio::Stream::ShmStreamer reader;
+    reader.setName("/test/shm/roundtrip");
+    reader.setFrameLength(4);
+    REQUIRE(reader.openInputStream());
+    CHECK(reader.getDataType() == "INT16");
+    CHECK(reader.getVariableTag() == hriPhysio::varTag::INT16);
+    CHECK(reader.getNumChannels() == 2);
+    CHECK(reader.getSamplingRate() == 100);
+
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps = { 1.0, 1.01, 1.02, 1.03 };
+    for (int16_t idx = 0; idx < 8; ++idx) {
+        frame.push_back(idx);
+    }
+    writer.publish(frame, &stamps);
+
+    std::vector<hriPhysio::varType> received;
+    std::vector<double> received_stamps;
+    reader.receive(received, &received_stamps);
+
+    REQUIRE(received.size() == 8);
+    REQUIRE(received_stamps.size() == 4);
+    for (std::size_t idx = 0; idx < 8; ++idx) {
+        CHECK(std::get<int16_t>(received[idx]) == static_cast<int16_t>(idx));
+    }
+    CHECK(received_stamps[3] == doctest::Approx(1.03));
+}
+
+TEST_CASE("Test ShmStreamer reader skips ahead when the writer laps it") {
+
+    hriPhysio::Stream::ShmStreamer writer;
+    writer.setName("/test/shm/overrun");
+    writer.setDataType("double");
+    writer.setFrameLength(1);
+    writer.setNumChannels(1);
+    writer.setNumSlots(4);
+    REQUIRE(writer.openOutputStream());
+
+    hriPhysio::Stream::ShmStreamer reader;
+    reader.setName("/test/shm/overrun");
+    reader.setDataType("double");
+    reader.setFrameLength(16);
+    REQUIRE(reader.openInputStream());
+
+    //-- Ten frames into a four slot ring.
+    for (int idx = 0; idx < 10; ++idx) {
+        writer.publish(std::vector<hriPhysio::varType>{ static_cast<double>(idx) });
+    }
+
+    std::vector<hriPhysio::varType> received;
+    reader.receive(received);
+
+    REQUIRE(received.size() == 4);
+    CHECK(std::get<double>(received.front()) == 6.0);
+    CHECK(std::get<double>(received.back())  == 9.0);
+    CHECK(reader.getOverruns() == 6);
+}
+
+TEST_CASE("Test ShmStreamer string stream and empty receive") {
+
+    hriPhysio::Stream::ShmStreamer writer;
+    writer.setName("/test/shm/string");
+    writer.setDataType("string");
+    writer.setNumChannels(1);
+    REQUIRE(writer.openOutputStream());
+
+    hriPhysio::Stream::ShmStreamer reader;
+    reader.setName("/test/shm/string");
+    REQUIRE(reader.openInputStream());
+
+    double stamp = 4.5;
+    writer.publish(std::string("set speech hello"), &stamp);
+
+    std::string message;
+    double received_stamp = 0.0;
+    reader.receive(message, &received_stamp);
+    CHECK(message == "set speech hello");
+    CHECK(received_stamp == 4.5);
+
+    //-- Nothing new, should time out with an empty string.
+    reader.receive(message);
+    CHECK(message == "");
+}
+
+TEST_CASE("Test ShmStreamer writer replaces only a stale segment") {
+
+    //-- Left behind by a writer that never finished, no magic.
+    const int fd = shm_open("/hriPhysio.test.shm.owner", O_CREAT | O_RDWR, 0666);
+    REQUIRE(fd >= 0);
+    REQUIRE(ftruncate(fd, 4096) == 0);
+    close(fd);
+
+    hriPhysio::Stream::ShmStreamer writer;
+    writer.setName("/test/shm/owner");
+    writer.setDataType("double");
+    writer.setNumChannels(1);
+    REQUIRE(writer.openOutputStream());
+
+    //-- A second writer must not pull the segment from under the first,
+    //-- neither when opening nor when it is destroyed.
+    {
+        hriPhysio::Stream::ShmStreamer second;
+        second.setName("/test/shm/owner");
+        second.setDataType("double");
+        second.setNumChannels(1);
+        CHECK_FALSE(second.openOutputStream());
+    }
+
+    hriPhysio::Stream::ShmStreamer reader;
+    reader.setName("/test/shm/owner");
+    REQUIRE(reader.openInputStream());
+    CHECK(reader.getDataType() == "DOUBLE");
+
+    writer.publish(std::vector<hriPhysio::varType>{ 2.5 });
+
+    std::vector<hriPhysio::varType> received;
+    reader.receive(received);
+    REQUIRE(received.size() == 1);
+    CHECK(std::get<double>(received.front()) == 2.5);
+}
@@ -0,0 +1,147 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <cmath>
+
+#include <HriPhysio/Stream/tcpStreamer.h>
+
+
+TEST_CASE("Test TcpStreamer delivers frames with timestamps to the nanosecond") {
+
+    hriPhysio::Stream::TcpStreamer server;
+    server.setName("127.0.0.1:47011");
+    server.setDataType("int32");
+    server.setNumChannels(2);
+    server.setLatencyBound(0.0);
+    REQUIRE(server.openOutputStream());
+
+    hriPhysio::Stream::TcpStreamer client;
+    client.setName("127.0.0.1:47011");
+    client.setDataType("int32");
+    client.setNumChannels(2);
+    client.setFrameLength(100);
+    REQUIRE(client.openInputStream());
+
+    //-- Four publishes of 25 samples make up one frame on the client side.
+    std::vector<double> expected_stamps;
+    for (int call = 0; call < 4; ++call) {
+        std::vector<hriPhysio::varType> frame;
+        std::vector<double> stamps;
+        for (int idx = 0; idx < 25; ++idx) {
+            const int sample = call * 25 + idx;
+            stamps.push_back(100.0 + sample * 0.001 + (sample % 3) * 1e-5);
+            frame.push_back(int32_t(sample));
+            frame.push_back(int32_t(-sample));
+        }
+        server.publish(frame, &stamps);
+        expected_stamps.insert(expected_stamps.end(), stamps.begin(), stamps.end());
+    }
+    CHECK(server.getNumClients() == 1);
+
+    std::vector<hriPhysio::varType> received;
+    std::vector<double> received_stamps;
+    while (received_stamps.size() < 100) {
+        std::vector<hriPhysio::varType> chunk;
+        std::vector<double> chunk_stamps;
+        client.receive(chunk, &chunk_stamps);
+        REQUIRE(!chunk_stamps.empty());
+        received.insert(received.end(), chunk.begin(), chunk.end());
+        received_stamps.insert(received_stamps.end(), chunk_stamps.begin(), chunk_stamps.end());
+    }
+
+    //-- Timestamps travel as int64 nanoseconds, so they round to 1 ns.
+    REQUIRE(received.size() == 200);
+    for (int sample = 0; sample < 100; ++sample) {
+        CHECK(std::get<int32_t>(received[2 * sample])     ==  sample);
+        CHECK(std::get<int32_t>(received[2 * sample + 1]) == -sample);
+        CHECK(std::abs(received_stamps[sample] - expected_stamps[sample]) <= 1e-9);
+    }
+}
+
+TEST_CASE("Test TcpStreamer batches until flushed and serves several clients") {
+
+    hriPhysio::Stream::TcpStreamer server;
+    server.setName("127.0.0.1:47012");
+    server.setDataType("string");
+    server.setLatencyBound(60.0);
+    REQUIRE(server.openOutputStream());
+
+    hriPhysio::Stream::TcpStreamer first, second;
+    for (hriPhysio::Stream::TcpStreamer* client : { &first, &second }) {
+        client->setName("127.0.0.1:47012");
+        client->setDataType("string");
+        REQUIRE(client->openInputStream());
+    }
+
+    double stamp = 4.0;
+    server.publish(std::string("hello"), &stamp);
+    stamp = 5.0;
+    server.publish(std::string("world"), &stamp);
+
+    //-- Nothing has been flushed under a generous latency bound.
+    CHECK(server.getNumClients() == 0);
+    server.flush();
+    CHECK(server.getNumClients() == 2);
+
+    for (hriPhysio::Stream::TcpStreamer* client : { &first, &second }) {
+        std::string message;
+        double received_stamp = 0.0;
+
+        client->receive(message, &received_stamp);
+        CHECK(message == "hello");
+        CHECK(received_stamp == doctest::Approx(4.0));
+
+        client->receive(message, &received_stamp);
+        CHECK(message == "world");
+        CHECK(received_stamp == doctest::Approx(5.0));
+    }
+}
+
+TEST_CASE("Test TcpStreamer flushes a batch at its deadline once the publisher goes quiet") {
+
+    hriPhysio::Stream::TcpStreamer server;
+    server.setName("127.0.0.1:47013");
+    server.setDataType("double");
+    server.setNumChannels(1);
+    server.setLatencyBound(0.05);
+    REQUIRE(server.openOutputStream());
+
+    hriPhysio::Stream::TcpStreamer client;
+    client.setName("127.0.0.1:47013");
+    client.setDataType("double");
+    client.setNumChannels(1);
+    client.setFrameLength(1);
+    client.setTimeout(2.0);
+    REQUIRE(client.openInputStream());
+
+    //-- A single publish, and nothing after it.
+    const auto start = std::chrono::steady_clock::now();
+    server.publish(std::vector<hriPhysio::varType>{ 1.5 });
+
+    std::vector<hriPhysio::varType> received;
+    client.receive(received);
+    const double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    REQUIRE(received.size() == 1);
+    CHECK(std::get<double>(received.front()) == 1.5);
+    CHECK(waited < 0.5);
+}
+
+TEST_CASE("Test TcpStreamer rejects a bad stream name") {
+
+    hriPhysio::Stream::TcpStreamer server;
+    server.setName("no-port-here");
+    server.setDataType("double");
+    CHECK_FALSE(server.openOutputStream());
+}
@@ -0,0 +1,215 @@
+/* ================================================================================
+ * Copyright: (C) 2021, SIRRL Social and Intelligent Robotics Research Laboratory,
+ *     University of Waterloo, All rights reserved.
+ *
+ * Authors:
+ *     Austin Kothig <austin.kothig@uwaterloo.ca>
+ *
+ * CopyPolicy: Released under the terms of the BSD 3-Clause License.
+ *     See the accompanying LICENSE file for details.
+ * ================================================================================
+ */
+
+#include <doctest.h>
+
+#include <HriPhysio/Stream/udpStreamer.h>
+
+
+namespace {
+
+    //-- One sample of one double channel, as the sender would frame it.
+    std::vector<uint8_t> datagram(const uint64_t seq, const double value) {
+        hriPhysio::Stream::FrameCodec codec;
+        codec.setStampRange(true);
+
+        std::vector<uint8_t> bytes(codec.frameSize(hriPhysio::varTag::DOUBLE, 1, 1));
+        const double stamp = static_cast<double>(seq);
+        bytes.resize(codec.encode<double>(bytes.data(), seq, &value, 1, 1, &stamp, stamp));
+        return bytes;
+    }
+
+
+    void insert(hriPhysio::Stream::UdpStreamer& receiver, const uint64_t seq, const double value) {
+        const std::vector<uint8_t> bytes = datagram(seq, value);
+        receiver.insertDatagram(bytes.data(), bytes.size());
+    }
+
+
+    //-- Values handed over by ``count`` receive calls, -1 for an empty one.
+    std::vector<double> drain(hriPhysio::Stream::UdpStreamer& receiver, const std::size_t count) {
+        std::vector<double> values;
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            std::vector<hriPhysio::varType> buff;
+            receiver.receive(buff);
+            values.push_back(buff.empty() ? -1.0 : std::get<double>(buff.front()));
+        }
+        return values;
+    }
+
+
+    void openReceiver(hriPhysio::Stream::UdpStreamer& receiver, const std::string& name) {
+        receiver.setName(name);
+        receiver.setDataType("double");
+        receiver.setFrameLength(1);
+        receiver.setNumChannels(1);
+        receiver.setTimeout(0.05);
+        REQUIRE(receiver.openInputStream());
+    }
+}
+
+
+TEST_CASE("Test UdpStreamer splits a large frame into a batch and reassembles it") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    receiver.setName("127.0.0.1:47001");
+    receiver.setDataType("double");
+    receiver.setFrameLength(500);
+    receiver.setNumChannels(3);
+    REQUIRE(receiver.openInputStream());
+
+    hriPhysio::Stream::UdpStreamer sender;
+    sender.setName("127.0.0.1:47001");
+    sender.setDataType("double");
+    sender.setFrameLength(500);
+    sender.setNumChannels(3);
+    sender.setMaxDatagram(512);
+    REQUIRE(sender.openOutputStream());
+
+    //-- 500 samples x 3 channels of doubles needs many 512 byte datagrams.
+    std::vector<hriPhysio::varType> frame;
+    std::vector<double> stamps;
+    for (std::size_t idx = 0; idx < 500; ++idx) {
+        stamps.push_back(10.0 + idx * 0.005);
+        for (std::size_t ch = 0; ch < 3; ++ch) {
+            frame.push_back(static_cast<double>(idx * 3 + ch));
+        }
+    }
+    sender.publish(frame, &stamps);
+
+    std::vector<hriPhysio::varType> received;
+    std::vector<double> received_stamps;
+    receiver.receive(received, &received_stamps);
+
+    REQUIRE(received.size() == frame.size());
+    REQUIRE(received_stamps.size() == stamps.size());
+    for (std::size_t idx = 0; idx < frame.size(); ++idx) {
+        CHECK(std::get<double>(received[idx]) == std::get<double>(frame[idx]));
+    }
+    CHECK(received_stamps.front() == doctest::Approx(10.0));
+    CHECK(received_stamps.back()  == doctest::Approx(10.0 + 499 * 0.005));
+
+    const hriPhysio::Stream::UdpStreamer::Statistics stats = receiver.getStatistics();
+    CHECK(stats.received == stats.delivered);
+    CHECK(stats.lost == 0);
+    CHECK(stats.malformed == 0);
+}
+
+TEST_CASE("Test UdpStreamer string datagrams and dtype mismatch") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    receiver.setName(":47002");
+    receiver.setDataType("string");
+    receiver.setNumChannels(1);
+    REQUIRE(receiver.openInputStream());
+
+    hriPhysio::Stream::UdpStreamer sender;
+    sender.setName("127.0.0.1:47002");
+    sender.setDataType("string");
+    sender.setNumChannels(1);
+    REQUIRE(sender.openOutputStream());
+
+    //-- A stream of the wrong type on the same port is ignored.
+    hriPhysio::Stream::UdpStreamer intruder;
+    intruder.setName("127.0.0.1:47002");
+    intruder.setDataType("int32");
+    intruder.setNumChannels(1);
+    REQUIRE(intruder.openOutputStream());
+    intruder.publish(std::vector<hriPhysio::varType>{ int32_t(7) });
+
+    double stamp = 2.5;
+    sender.publish(std::string("set audio default"), &stamp);
+
+    std::string message;
+    double received_stamp = 0.0;
+    receiver.receive(message, &received_stamp);
+    CHECK(message == "set audio default");
+    CHECK(received_stamp == doctest::Approx(2.5));
+    CHECK(receiver.getStatistics().malformed == 1);
+}
+
+TEST_CASE("Test UdpStreamer rejects a bad stream name") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    receiver.setName("no-port-here");
+    receiver.setDataType("double");
+    CHECK_FALSE(receiver.openInputStream());
+}
+
+TEST_CASE("Test UdpStreamer puts reordered datagrams back in sequence") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    openReceiver(receiver, "127.0.0.1:47003");
+
+    insert(receiver, 0, 0.0);
+    insert(receiver, 2, 2.0);
+    insert(receiver, 1, 1.0);
+    insert(receiver, 3, 3.0);
+    insert(receiver, 1, 1.0);
+
+    CHECK(drain(receiver, 5) == std::vector<double>{ 0.0, 1.0, 2.0, 3.0, -1.0 });
+
+    const hriPhysio::Stream::UdpStreamer::Statistics stats = receiver.getStatistics();
+    CHECK(stats.reordered  == 1);
+    CHECK(stats.duplicates == 1);
+    CHECK(stats.lost       == 0);
+    CHECK(stats.delivered  == 4);
+}
+
+TEST_CASE("Test UdpStreamer gives up on a lost datagram") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    receiver.setReorderWindow(4);
+    openReceiver(receiver, "127.0.0.1:47004");
+
+    //-- The window overflows while 1 is missing.
+    insert(receiver, 0, 0.0);
+    for (uint64_t seq = 2; seq < 8; ++seq) {
+        insert(receiver, seq, static_cast<double>(seq));
+    }
+    CHECK(drain(receiver, 7) == std::vector<double>{ 0.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0 });
+    CHECK(receiver.getStatistics().lost == 1);
+
+    //-- The socket goes quiet with 9 missing.
+    insert(receiver, 8, 8.0);
+    insert(receiver, 10, 10.0);
+    CHECK(drain(receiver, 2) == std::vector<double>{ 8.0, 10.0 });
+    CHECK(receiver.getStatistics().lost == 2);
+}
+
+TEST_CASE("Test UdpStreamer follows a sender that restarts its sequence") {
+
+    hriPhysio::Stream::UdpStreamer receiver;
+    receiver.setReorderWindow(8);
+    openReceiver(receiver, "127.0.0.1:47005");
+
+    for (uint64_t seq = 0; seq < 100; ++seq) {
+        insert(receiver, seq, static_cast<double>(seq));
+    }
+    CHECK(drain(receiver, 100).back() == 99.0);
+
+    //-- A late duplicate within the window is still only a duplicate.
+    insert(receiver, 97, 97.0);
+    CHECK(receiver.getStatistics().resyncs == 0);
+    CHECK(receiver.getStatistics().duplicates == 1);
+
+    //-- Counting from 0 again is a new session, not 100 duplicates.
+    for (uint64_t seq = 0; seq < 3; ++seq) {
+        insert(receiver, seq, 1000.0 + seq);
+    }
+    CHECK(drain(receiver, 4) == std::vector<double>{ 1000.0, 1001.0, 1002.0, -1.0 });
+
+    const hriPhysio::Stream::UdpStreamer::Statistics stats = receiver.getStatistics();
+    CHECK(stats.resyncs    == 1);
+    CHECK(stats.duplicates == 1);
+    CHECK(stats.delivered  == 103);
+}